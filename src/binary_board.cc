@@ -0,0 +1,101 @@
+// Copyright 2012 Ondrej Sykora
+//
+// This file is part of MineSeeker.
+//
+// MineSeeker is free software: you can redistribute it and/or modify it under
+// the terms of the GNU General Public License as published by the Free
+// Software Foundation, either version 3 of the License, or (at your option)
+// any later version.
+//
+// MineSeeker is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+// more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// MineSeeker. If not, see <http://www.gnu.org/licenses/>.
+
+#include "binary_board.h"
+
+#include <sstream>
+
+#include "glog/logging.h"
+
+namespace mineseeker {
+
+namespace {
+// The first word of the header of the binary format.
+const char kMagic[] = "mineseeker-board";
+}  // namespace
+
+void AppendBinaryBoardHeader(int width, int height, string* out) {
+  CHECK_NOTNULL(out);
+  std::stringstream header;
+  header << kMagic << " " << width << " " << height << "\n";
+  out->append(header.str());
+}
+
+void AppendBinaryBoardRow(const vector<bool>& mines, string* out) {
+  CHECK_NOTNULL(out);
+  for (int byte_start = 0; byte_start < mines.size(); byte_start += 8) {
+    char byte = 0;
+    for (int bit = 0; bit < 8 && byte_start + bit < mines.size(); ++bit) {
+      if (mines[byte_start + bit]) {
+        byte |= 1 << bit;
+      }
+    }
+    out->push_back(byte);
+  }
+}
+
+BinaryBoardReader::BinaryBoardReader(std::istream* in)
+    : in_(CHECK_NOTNULL(in)),
+      width_(0),
+      height_(0),
+      num_rows_read_(0) {}
+
+bool BinaryBoardReader::ReadHeader() {
+  string header;
+  if (!std::getline(*in_, header)) {
+    LOG(ERROR) << "Missing header of the binary board";
+    return false;
+  }
+  std::istringstream header_stream(header);
+  string magic;
+  header_stream >> magic >> width_ >> height_;
+  if (!header_stream || magic != kMagic) {
+    LOG(ERROR) << "Invalid header of the binary board: " << header;
+    return false;
+  }
+  if (width_ <= 0) {
+    LOG(ERROR) << "Invalid width: " << width_;
+    return false;
+  }
+  if (height_ <= 0) {
+    LOG(ERROR) << "Invalid height: " << height_;
+    return false;
+  }
+  row_buffer_.resize((width_ + 7) / 8);
+  return true;
+}
+
+bool BinaryBoardReader::ReadRow(vector<bool>* mines) {
+  CHECK_NOTNULL(mines);
+  mines->clear();
+  if (num_rows_read_ >= height_) {
+    return false;
+  }
+  in_->read(&row_buffer_[0], row_buffer_.size());
+  if (in_->gcount() != row_buffer_.size()) {
+    LOG(ERROR) << "The binary board ended at row " << num_rows_read_;
+    return false;
+  }
+  mines->resize(width_);
+  for (int x = 0; x < width_; ++x) {
+    (*mines)[x] = (row_buffer_[x / 8] >> (x % 8)) & 1;
+  }
+  ++num_rows_read_;
+  return true;
+}
+
+}  // namespace mineseeker
@@ -0,0 +1,82 @@
+// Copyright 2012 Ondrej Sykora
+//
+// This file is part of MineSeeker.
+//
+// MineSeeker is free software: you can redistribute it and/or modify it under
+// the terms of the GNU General Public License as published by the Free
+// Software Foundation, either version 3 of the License, or (at your option)
+// any later version.
+//
+// MineSeeker is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+// more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// MineSeeker. If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef MINESEEKER_BINARY_BOARD_H_
+#define MINESEEKER_BINARY_BOARD_H_
+
+#include <istream>
+
+#include "common.h"
+
+namespace mineseeker {
+
+// Functions for the binary format of mine fields, which can be written and
+// read one row at a time, so that the mine field does not need to fit in the
+// memory. The format starts with the text line
+// mineseeker-board {width} {height}
+// followed by the rows of the mine field from the top. Each row takes
+// (width + 7) / 8 bytes; the bit x % 8 of the byte x / 8 is set if there is a
+// mine at the position x of the row.
+
+// Appends the header of a mine field of the given size to 'out'.
+void AppendBinaryBoardHeader(int width, int height, string* out);
+// Appends a row of a mine field to 'out'. The size of 'mines' is the width of
+// the mine field.
+void AppendBinaryBoardRow(const vector<bool>& mines, string* out);
+
+// Reads a mine field in the binary format row by row.
+//
+// Typical usage:
+// BinaryBoardReader reader(&std::cin);
+// if (!reader.ReadHeader()) { ... }
+// vector<bool> mines;
+// while (reader.ReadRow(&mines)) { ... }
+class BinaryBoardReader {
+ public:
+  // Creates a reader that reads from 'in'. Does not take ownership of the
+  // stream.
+  explicit BinaryBoardReader(std::istream* in);
+
+  // Reads the header of the mine field. Returns false if the header is not
+  // valid.
+  bool ReadHeader();
+  // Reads the next row of the mine field to 'mines'. Returns false if all rows
+  // were read or if the input ended prematurely. Erases any content that was
+  // stored in mines previously.
+  bool ReadRow(vector<bool>* mines);
+
+  // The size of the mine field; valid after ReadHeader succeeded.
+  int width() const { return width_; }
+  int height() const { return height_; }
+  // The number of rows read so far.
+  int num_rows_read() const { return num_rows_read_; }
+
+ private:
+  std::istream* const in_;
+  int width_;
+  int height_;
+  int num_rows_read_;
+  // The buffer for the bytes of a single row.
+  string row_buffer_;
+
+  BinaryBoardReader(const BinaryBoardReader&);
+  void operator=(const BinaryBoardReader&);
+};
+
+}  // namespace mineseeker
+
+#endif  // MINESEEKER_BINARY_BOARD_H_
@@ -0,0 +1,88 @@
+// Copyright 2012 Ondrej Sykora
+//
+// This file is part of MineSeeker.
+//
+// MineSeeker is free software: you can redistribute it and/or modify it under
+// the terms of the GNU General Public License as published by the Free
+// Software Foundation, either version 3 of the License, or (at your option)
+// any later version.
+//
+// MineSeeker is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+// more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// MineSeeker. If not, see <http://www.gnu.org/licenses/>.
+
+#include "binary_board.h"
+
+#include <sstream>
+
+#include "common.h"
+#include "glog/logging.h"
+#include "gtest/gtest.h"
+
+namespace mineseeker {
+
+TEST(BinaryBoardTest, TestRoundTrip) {
+  const int kWidth = 19;
+  const int kHeight = 5;
+  string board;
+  AppendBinaryBoardHeader(kWidth, kHeight, &board);
+  EXPECT_EQ("mineseeker-board 19 5\n", board);
+  vector<vector<bool> > rows(kHeight, vector<bool>(kWidth, false));
+  for (int y = 0; y < kHeight; ++y) {
+    for (int x = 0; x < kWidth; ++x) {
+      rows[y][x] = (x * 7 + y * 3) % 5 == 0;
+    }
+    AppendBinaryBoardRow(rows[y], &board);
+  }
+  EXPECT_EQ(board.find('\n') + 1 + kHeight * 3, board.size());
+
+  std::istringstream in(board);
+  BinaryBoardReader reader(&in);
+  ASSERT_TRUE(reader.ReadHeader());
+  EXPECT_EQ(kWidth, reader.width());
+  EXPECT_EQ(kHeight, reader.height());
+  vector<bool> row;
+  for (int y = 0; y < kHeight; ++y) {
+    ASSERT_TRUE(reader.ReadRow(&row));
+    EXPECT_EQ(rows[y], row);
+    EXPECT_EQ(y + 1, reader.num_rows_read());
+  }
+  EXPECT_FALSE(reader.ReadRow(&row));
+  EXPECT_TRUE(row.empty());
+}
+
+TEST(BinaryBoardTest, TestRowBits) {
+  vector<bool> row(10, false);
+  row[0] = true;
+  row[3] = true;
+  row[9] = true;
+  string out;
+  AppendBinaryBoardRow(row, &out);
+  ASSERT_EQ(2, out.size());
+  EXPECT_EQ(0x09, out[0]);
+  EXPECT_EQ(0x02, out[1]);
+}
+
+TEST(BinaryBoardTest, TestInvalidInput) {
+  std::istringstream bad_magic("minesweeper-board 3 3\n");
+  BinaryBoardReader bad_magic_reader(&bad_magic);
+  EXPECT_FALSE(bad_magic_reader.ReadHeader());
+
+  std::istringstream bad_size("mineseeker-board 0 3\n");
+  BinaryBoardReader bad_size_reader(&bad_size);
+  EXPECT_FALSE(bad_size_reader.ReadHeader());
+
+  std::istringstream truncated("mineseeker-board 3 3\n\x01\x02");
+  BinaryBoardReader truncated_reader(&truncated);
+  ASSERT_TRUE(truncated_reader.ReadHeader());
+  vector<bool> row;
+  EXPECT_TRUE(truncated_reader.ReadRow(&row));
+  EXPECT_TRUE(truncated_reader.ReadRow(&row));
+  EXPECT_FALSE(truncated_reader.ReadRow(&row));
+}
+
+}  // namespace mineseeker
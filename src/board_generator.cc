@@ -0,0 +1,404 @@
+// Copyright 2012 Ondrej Sykora
+//
+// This file is part of MineSeeker.
+//
+// MineSeeker is free software: you can redistribute it and/or modify it under
+// the terms of the GNU General Public License as published by the Free
+// Software Foundation, either version 3 of the License, or (at your option)
+// any later version.
+//
+// MineSeeker is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+// more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// MineSeeker. If not, see <http://www.gnu.org/licenses/>.
+
+#include "board_generator.h"
+
+#include <stdlib.h>
+#include <algorithm>
+
+#include "glog/logging.h"
+#include "mineseeker.h"
+#include "minesweeper.h"
+
+namespace mineseeker {
+
+namespace {
+// The number of boards sampled by GenerateNoGuessBoardMines before it gives
+// up.
+const int kMaxNoGuessAttempts = 100;
+// The maximal number of times a board is solved from the first click by
+// GenerateNoGuessBoardMines; all but the first solve verify the board after
+// some mines were moved.
+const int kMaxNoGuessSolves = 10;
+
+// The increment of the Weyl sequence of SplitMix64.
+const uint64 kGoldenGamma = 0x9e3779b97f4a7c15ULL;
+
+// The finalizer of SplitMix64.
+uint64 Mix(uint64 value) {
+  value = (value ^ (value >> 30)) * 0xbf58476d1ce4e5b9ULL;
+  value = (value ^ (value >> 27)) * 0x94d049bb133111ebULL;
+  return value ^ (value >> 31);
+}
+
+// Appends the decimal representation of a non-negative number to 'out'.
+void AppendNumber(int value, string* out) {
+  DCHECK_GE(value, 0);
+  char buffer[16];
+  int length = 0;
+  do {
+    buffer[length++] = '0' + value % 10;
+    value /= 10;
+  } while (value > 0);
+  while (length > 0) {
+    out->push_back(buffer[--length]);
+  }
+}
+
+// Returns the sorted positions of the field (click_x, click_y) and its
+// neighbors.
+void GetFirstClickArea(int width,
+                       int height,
+                       int click_x,
+                       int click_y,
+                       vector<int>* area) {
+  CHECK_GE(click_x, 0);
+  CHECK_LT(click_x, width);
+  CHECK_GE(click_y, 0);
+  CHECK_LT(click_y, height);
+  area->clear();
+  for (int y = std::max(0, click_y - 1);
+       y <= std::min(height - 1, click_y + 1); ++y) {
+    for (int x = std::max(0, click_x - 1);
+         x <= std::min(width - 1, click_x + 1); ++x) {
+      area->push_back(y * width + x);
+    }
+  }
+}
+
+// Selects the positions of the mines uniformly at random out of the positions
+// that are not in the sorted list 'area'.
+void SampleMinePositionsOutsideArea(int width,
+                                    int height,
+                                    int mines,
+                                    const vector<int>& area,
+                                    CounterRandom* random,
+                                    vector<int>* positions) {
+  CHECK_LE(mines, width * height - static_cast<int>(area.size()))
+      << "There is not enough space for the mines outside of the first click";
+  SampleMinePositions(width * height - area.size(), mines, random, positions);
+  // The positions are sampled from the fields outside of the area, numbered
+  // in their order on the board; the position is shifted past each field of
+  // the area that precedes it.
+  for (int i = 0; i < positions->size(); ++i) {
+    int* const position = &(*positions)[i];
+    for (int j = 0; j < area.size() && area[j] <= *position; ++j) {
+      ++*position;
+    }
+  }
+}
+
+// Moves the mines from the hidden neighbors of one of the uncovered fields at
+// the boundary of the uncovered region to randomly selected hidden fields
+// without mines, and notifies the seeker about the changes. The field with the
+// smallest number of mines to move is selected. The mines are moved preferably
+// to fields that have no uncovered neighbors, so that the numbers known to the
+// seeker do not change; when there are not enough of them, they are moved to
+// other fields at the boundary. Returns false if there is no such field, or
+// if there are not enough fields for the mines.
+bool MoveMinesFromBoundary(CounterRandom* random,
+                           MineSweeper* mine_sweeper,
+                           MineSeeker* seeker) {
+  const int width = mine_sweeper->width();
+  const int height = mine_sweeper->height();
+  vector<int> interior_targets;
+  vector<int> boundary_targets;
+  int selected_x = -1;
+  int selected_y = -1;
+  int selected_mines = 0;
+  int num_selected_ties = 0;
+  for (int y = 0; y < height; ++y) {
+    for (int x = 0; x < width; ++x) {
+      const MineSeekerField::State state = seeker->StateAtPosition(x, y);
+      if (state == MineSeekerField::MINE) {
+        continue;
+      }
+      int hidden_neighbors = 0;
+      int hidden_mines = 0;
+      bool has_uncovered_neighbor = false;
+      for (int j = std::max(0, y - 1); j <= std::min(height - 1, y + 1); ++j) {
+        for (int i = std::max(0, x - 1); i <= std::min(width - 1, x + 1);
+             ++i) {
+          if (i == x && j == y) {
+            continue;
+          }
+          switch (seeker->StateAtPosition(i, j)) {
+            case MineSeekerField::HIDDEN:
+              ++hidden_neighbors;
+              if (mine_sweeper->IsMine(i, j)) {
+                ++hidden_mines;
+              }
+              break;
+            case MineSeekerField::UNCOVERED:
+              has_uncovered_neighbor = true;
+              break;
+            case MineSeekerField::MINE:
+              break;
+          }
+        }
+      }
+      if (state == MineSeekerField::HIDDEN) {
+        if (!mine_sweeper->IsMine(x, y)) {
+          (has_uncovered_neighbor ? &boundary_targets : &interior_targets)
+              ->push_back(y * width + x);
+        }
+        continue;
+      }
+      if (hidden_neighbors == 0) {
+        continue;
+      }
+      // The ties are broken uniformly at random by reservoir sampling.
+      if (num_selected_ties == 0 || hidden_mines < selected_mines) {
+        num_selected_ties = 0;
+      } else if (hidden_mines > selected_mines) {
+        continue;
+      }
+      ++num_selected_ties;
+      if (random->Uniform(num_selected_ties) == 0) {
+        selected_x = x;
+        selected_y = y;
+        selected_mines = hidden_mines;
+      }
+    }
+  }
+  if (num_selected_ties == 0) {
+    return false;
+  }
+  // The hidden neighbors of the selected field must stay without mines.
+  int num_boundary_targets = 0;
+  for (int i = 0; i < boundary_targets.size(); ++i) {
+    const int target_x = boundary_targets[i] % width;
+    const int target_y = boundary_targets[i] / width;
+    if (std::abs(target_x - selected_x) > 1
+        || std::abs(target_y - selected_y) > 1) {
+      boundary_targets[num_boundary_targets++] = boundary_targets[i];
+    }
+  }
+  boundary_targets.resize(num_boundary_targets);
+  if (selected_mines > interior_targets.size() + boundary_targets.size()) {
+    return false;
+  }
+  for (int j = selected_y - 1; j <= selected_y + 1; ++j) {
+    for (int i = selected_x - 1; i <= selected_x + 1; ++i) {
+      if (i < 0 || i >= width || j < 0 || j >= height
+          || seeker->StateAtPosition(i, j) != MineSeekerField::HIDDEN
+          || !mine_sweeper->IsMine(i, j)) {
+        continue;
+      }
+      vector<int>* const targets =
+          interior_targets.empty() ? &boundary_targets : &interior_targets;
+      const int target_index = random->Uniform(targets->size());
+      const int target = (*targets)[target_index];
+      (*targets)[target_index] = targets->back();
+      targets->pop_back();
+      mine_sweeper->MoveMine(i, j, target % width, target / width);
+      seeker->HandleChangedMine(i, j);
+      seeker->HandleChangedMine(target % width, target / width);
+    }
+  }
+  return true;
+}
+
+// Returns true if the seeker uncovered all fields without a mine. The mines
+// that have no uncovered neighbors can't be marked by the seeker, because it
+// does not use the total number of mines; they do not need a guess either.
+bool UncoveredAllSafeFields(const MineSweeper& mine_sweeper,
+                            const MineSeeker& seeker) {
+  for (int y = 0; y < mine_sweeper.height(); ++y) {
+    for (int x = 0; x < mine_sweeper.width(); ++x) {
+      if (seeker.StateAtPosition(x, y) == MineSeekerField::HIDDEN
+          && !mine_sweeper.IsMine(x, y)) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+// Makes the board solvable from the first click without guessing by moving
+// its mines. Returns false if this was not possible.
+bool RemoveGuessesFromBoard(int click_x,
+                            int click_y,
+                            CounterRandom* random,
+                            MineSweeper* mine_sweeper) {
+  for (int solve = 0; solve < kMaxNoGuessSolves; ++solve) {
+    MineSeeker seeker(*mine_sweeper);
+    seeker.UseEnumerationInsteadOfLocalTiers();
+    seeker.mutable_scheduler()->set_tier_budget(MineSeeker::GUESS_TIER, 0);
+    seeker.UncoverField(click_x, click_y);
+    bool moved_mines = false;
+    while (!seeker.ContinueSolving()
+           && !UncoveredAllSafeFields(*mine_sweeper, seeker)) {
+      if (!MoveMinesFromBoundary(random, mine_sweeper, &seeker)) {
+        return false;
+      }
+      moved_mines = true;
+    }
+    if (!moved_mines) {
+      return true;
+    }
+  }
+  return false;
+}
+}  // namespace
+
+CounterRandom CounterRandom::Split(uint64 index) const {
+  // Mixing the key once more keeps the streams of the sub-tasks apart from
+  // the stream of this generator.
+  return CounterRandom(Mix(Mix(key_) + (index + 1) * kGoldenGamma));
+}
+
+uint64 CounterRandom::Next() {
+  ++counter_;
+  return Mix(key_ + counter_ * kGoldenGamma);
+}
+
+int CounterRandom::Uniform(int bound) {
+  DCHECK_GT(bound, 0);
+  // Lemire's multiply-shift method with rejection of the biased values.
+  const uint64 range = bound;
+  const uint64 threshold = (-range) % range;
+  for (;;) {
+    const uint64 value = Next() >> 32;
+    const uint64 product = value * range;
+    if ((product & 0xffffffffULL) >= threshold) {
+      return product >> 32;
+    }
+  }
+}
+
+void SampleMinePositions(int num_fields,
+                         int mines,
+                         CounterRandom* random,
+                         vector<int>* positions) {
+  CHECK_NOTNULL(random);
+  CHECK_NOTNULL(positions);
+  CHECK_GE(mines, 0);
+  CHECK_LE(mines, num_fields);
+  positions->clear();
+  positions->reserve(mines);
+  if (mines <= num_fields / 2) {
+    // At most half of the positions are used, so the expected number of
+    // rejections per mine is at most one.
+    vector<uint64> used((num_fields + 63) / 64, 0);
+    while (positions->size() < mines) {
+      const int position = random->Uniform(num_fields);
+      uint64* const word = &used[position / 64];
+      const uint64 bit = 1ULL << (position % 64);
+      if ((*word & bit) == 0) {
+        *word |= bit;
+        positions->push_back(position);
+      }
+    }
+  } else {
+    vector<int> fields(num_fields);
+    for (int i = 0; i < num_fields; ++i) {
+      fields[i] = i;
+    }
+    for (int i = 0; i < mines; ++i) {
+      const int selected = i + random->Uniform(num_fields - i);
+      std::swap(fields[i], fields[selected]);
+      positions->push_back(fields[i]);
+    }
+  }
+}
+
+void GenerateBoardMines(int width,
+                        int height,
+                        int mines,
+                        uint64 seed,
+                        int64 board_index,
+                        vector<int>* positions) {
+  CHECK_GT(width, 0);
+  CHECK_GT(height, 0);
+  CounterRandom random = CounterRandom(seed).Split(board_index);
+  SampleMinePositions(width * height, mines, &random, positions);
+}
+
+void GenerateFirstClickSafeBoardMines(int width,
+                                      int height,
+                                      int mines,
+                                      uint64 seed,
+                                      int64 board_index,
+                                      int click_x,
+                                      int click_y,
+                                      vector<int>* positions) {
+  CHECK_NOTNULL(positions);
+  vector<int> area;
+  GetFirstClickArea(width, height, click_x, click_y, &area);
+  CounterRandom random = CounterRandom(seed).Split(board_index);
+  SampleMinePositionsOutsideArea(width, height, mines, area, &random,
+                                 positions);
+}
+
+bool GenerateNoGuessBoardMines(int width,
+                               int height,
+                               int mines,
+                               uint64 seed,
+                               int64 board_index,
+                               int click_x,
+                               int click_y,
+                               vector<int>* positions) {
+  CHECK_NOTNULL(positions);
+  vector<int> area;
+  GetFirstClickArea(width, height, click_x, click_y, &area);
+  CounterRandom random = CounterRandom(seed).Split(board_index);
+  for (int attempt = 0; attempt < kMaxNoGuessAttempts; ++attempt) {
+    SampleMinePositionsOutsideArea(width, height, mines, area, &random,
+                                   positions);
+    MineSweeper mine_sweeper(width, height);
+    for (int i = 0; i < positions->size(); ++i) {
+      mine_sweeper.SetMine((*positions)[i] % width, (*positions)[i] / width,
+                           true);
+    }
+    mine_sweeper.CloseMineField();
+    if (RemoveGuessesFromBoard(click_x, click_y, &random, &mine_sweeper)) {
+      positions->clear();
+      for (int y = 0; y < height; ++y) {
+        for (int x = 0; x < width; ++x) {
+          if (mine_sweeper.IsMine(x, y)) {
+            positions->push_back(y * width + x);
+          }
+        }
+      }
+      return true;
+    }
+  }
+  positions->clear();
+  return false;
+}
+
+void AppendBoardToString(int width,
+                         int height,
+                         const vector<int>& positions,
+                         string* out) {
+  CHECK_NOTNULL(out);
+  AppendNumber(width, out);
+  out->push_back(' ');
+  AppendNumber(height, out);
+  out->push_back('\n');
+  AppendNumber(positions.size(), out);
+  out->push_back('\n');
+  for (int i = 0; i < positions.size(); ++i) {
+    AppendNumber(positions[i] % width, out);
+    out->push_back(' ');
+    AppendNumber(positions[i] / width, out);
+    out->push_back('\n');
+  }
+}
+
+}  // namespace mineseeker
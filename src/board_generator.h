@@ -0,0 +1,127 @@
+// Copyright 2012 Ondrej Sykora
+//
+// This file is part of MineSeeker.
+//
+// MineSeeker is free software: you can redistribute it and/or modify it under
+// the terms of the GNU General Public License as published by the Free
+// Software Foundation, either version 3 of the License, or (at your option)
+// any later version.
+//
+// MineSeeker is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+// more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// MineSeeker. If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef MINESEEKER_BOARD_GENERATOR_H_
+#define MINESEEKER_BOARD_GENERATOR_H_
+
+#include "common.h"
+
+namespace mineseeker {
+
+// A counter-based pseudo-random number generator. The n-th value of the
+// generator is a hash of the key and n (the finalizer of SplitMix64 applied to
+// a Weyl sequence), so the values do not depend on any hidden state, and
+// generators with different keys produce independent streams. A generator for
+// a sub-task (e.g. a single board out of many) is obtained by Split, which
+// derives a new key from the key of the generator and the index of the
+// sub-task.
+//
+// Typical usage:
+// CounterRandom random(seed);
+// CounterRandom board_random = random.Split(board_index);
+// const int x = board_random.Uniform(width);
+class CounterRandom {
+ public:
+  explicit CounterRandom(uint64 key) : key_(key), counter_(0) {}
+
+  // Returns a generator for the sub-task with the given index. The new
+  // generator starts from the first value of its stream.
+  CounterRandom Split(uint64 index) const;
+
+  // Returns the next 64-bit value.
+  uint64 Next();
+  // Returns a uniformly distributed integer in [0, bound). The bound must be
+  // positive.
+  int Uniform(int bound);
+
+  uint64 key() const { return key_; }
+  uint64 counter() const { return counter_; }
+
+ private:
+  uint64 key_;
+  uint64 counter_;
+};
+
+// Selects 'mines' distinct positions out of 'num_fields' positions uniformly
+// at random, and stores them to 'positions' in the order in which they were
+// selected. Sparse boards use rejection sampling against a bitmap of the used
+// positions; dense boards, where the rejections would be frequent, use a
+// partial Fisher-Yates shuffle of all positions. Both take time proportional
+// to the number of mines (plus the size of the board for the bitmap or the
+// shuffled array). Erases any content that was stored in positions
+// previously.
+void SampleMinePositions(int num_fields,
+                         int mines,
+                         CounterRandom* random,
+                         vector<int>* positions);
+
+// Generates the mines of the board with the given index out of a batch of
+// boards generated from 'seed'. The positions are the indices y * width + x of
+// the fields with mines. The result depends only on the parameters, so the
+// boards of a batch can be generated in any order and in parallel.
+void GenerateBoardMines(int width,
+                        int height,
+                        int mines,
+                        uint64 seed,
+                        int64 board_index,
+                        vector<int>* positions);
+
+// Generates the mines of a board like GenerateBoardMines, but keeps the field
+// (click_x, click_y) and its neighbors free of mines, so that the first click
+// at this field is safe and opens a region of the board. The board must have
+// enough fields outside of this area for all the mines.
+void GenerateFirstClickSafeBoardMines(int width,
+                                      int height,
+                                      int mines,
+                                      uint64 seed,
+                                      int64 board_index,
+                                      int click_x,
+                                      int click_y,
+                                      vector<int>* positions);
+
+// Generates the mines of a board that starts with a safe first click at
+// (click_x, click_y) like GenerateFirstClickSafeBoardMines, and that MineSeeker
+// solves from this click without guessing and without asking for safe fields.
+// The board is repaired rather than sampled again: whenever the solver gets
+// stuck, the mines around one of the uncovered fields at the boundary of the
+// uncovered region are moved to hidden fields away from the boundary, which
+// makes the hidden neighbors of the field safe, and the solver continues from
+// its current state. The deductions made before a move may depend on the old
+// numbers, so the final board is solved once more from the first click to
+// verify it. Returns false if no such board was found in a fixed number of
+// attempts, e.g. when the board is too dense to move the mines away from the
+// boundary. Erases any content that was stored in positions previously; the
+// positions are sorted.
+bool GenerateNoGuessBoardMines(int width,
+                               int height,
+                               int mines,
+                               uint64 seed,
+                               int64 board_index,
+                               int click_x,
+                               int click_y,
+                               vector<int>* positions);
+
+// Appends the board in the input format of MineSweeper::LoadFromString to
+// 'out'.
+void AppendBoardToString(int width,
+                         int height,
+                         const vector<int>& positions,
+                         string* out);
+
+}  // namespace mineseeker
+
+#endif  // MINESEEKER_BOARD_GENERATOR_H_
@@ -0,0 +1,223 @@
+// Copyright 2012 Ondrej Sykora
+//
+// This file is part of MineSeeker.
+//
+// MineSeeker is free software: you can redistribute it and/or modify it under
+// the terms of the GNU General Public License as published by the Free
+// Software Foundation, either version 3 of the License, or (at your option)
+// any later version.
+//
+// MineSeeker is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+// more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// MineSeeker. If not, see <http://www.gnu.org/licenses/>.
+
+#include <stdlib.h>
+#include <algorithm>
+#include <set>
+
+#include "board_generator.h"
+#include "common.h"
+#include "glog/logging.h"
+#include "gtest/gtest.h"
+#include "mineseeker.h"
+#include "minesweeper.h"
+#include "scoped_ptr.h"
+
+namespace mineseeker {
+
+TEST(CounterRandomTest, TestDeterministic) {
+  CounterRandom first(42);
+  CounterRandom second(42);
+  for (int i = 0; i < 100; ++i) {
+    EXPECT_EQ(first.Next(), second.Next());
+  }
+  EXPECT_EQ(100, first.counter());
+
+  // The streams of the sub-tasks do not depend on the state of the parent
+  // generator, and they differ from each other.
+  CounterRandom parent(42);
+  CounterRandom split_before = parent.Split(3);
+  parent.Next();
+  CounterRandom split_after = parent.Split(3);
+  EXPECT_EQ(split_before.key(), split_after.key());
+  EXPECT_NE(parent.Split(3).Next(), parent.Split(4).Next());
+  EXPECT_NE(CounterRandom(42).Next(), CounterRandom(43).Next());
+}
+
+TEST(CounterRandomTest, TestUniform) {
+  CounterRandom random(7);
+  const int kBound = 10;
+  const int kNumSamples = 100000;
+  vector<int> counts(kBound, 0);
+  for (int i = 0; i < kNumSamples; ++i) {
+    const int value = random.Uniform(kBound);
+    ASSERT_LE(0, value);
+    ASSERT_GT(kBound, value);
+    ++counts[value];
+  }
+  for (int i = 0; i < kBound; ++i) {
+    EXPECT_NEAR(kNumSamples / kBound, counts[i], kNumSamples / kBound / 10);
+  }
+  EXPECT_EQ(0, random.Uniform(1));
+}
+
+// Checks that the positions are distinct and that they are in the range.
+void ExpectValidPositions(int num_fields, int mines,
+                          const vector<int>& positions) {
+  ASSERT_EQ(mines, positions.size());
+  std::set<int> distinct_positions;
+  for (int i = 0; i < positions.size(); ++i) {
+    EXPECT_LE(0, positions[i]);
+    EXPECT_GT(num_fields, positions[i]);
+    distinct_positions.insert(positions[i]);
+  }
+  EXPECT_EQ(mines, distinct_positions.size());
+}
+
+TEST(BoardGeneratorTest, TestSampleMinePositions) {
+  const int kNumFields = 100;
+  vector<int> positions;
+  // Both the sparse and the dense sampler, including the extreme densities.
+  const int kMines[] = { 0, 1, 10, 50, 51, 90, 99, 100 };
+  for (int i = 0; i < ARRAYSIZE(kMines); ++i) {
+    CounterRandom random(i);
+    SampleMinePositions(kNumFields, kMines[i], &random, &positions);
+    ExpectValidPositions(kNumFields, kMines[i], positions);
+  }
+}
+
+TEST(BoardGeneratorTest, TestSampleIsUniform) {
+  const int kNumFields = 10;
+  const int kNumSamples = 20000;
+  vector<int> positions;
+  // With 3 or 8 mines out of 10, each field has a mine with probability 0.3 or
+  // 0.8.
+  const int kMines[] = { 3, 8 };
+  for (int i = 0; i < ARRAYSIZE(kMines); ++i) {
+    CounterRandom random(123);
+    vector<int> counts(kNumFields, 0);
+    for (int sample = 0; sample < kNumSamples; ++sample) {
+      SampleMinePositions(kNumFields, kMines[i], &random, &positions);
+      for (int j = 0; j < positions.size(); ++j) {
+        ++counts[positions[j]];
+      }
+    }
+    const int expected = kNumSamples * kMines[i] / kNumFields;
+    for (int field = 0; field < kNumFields; ++field) {
+      EXPECT_NEAR(expected, counts[field], expected / 20) << field;
+    }
+  }
+}
+
+TEST(BoardGeneratorTest, TestGenerateBoardMines) {
+  vector<int> first;
+  vector<int> second;
+  GenerateBoardMines(30, 16, 99, 5, 1000, &first);
+  ExpectValidPositions(30 * 16, 99, first);
+  GenerateBoardMines(30, 16, 99, 5, 1000, &second);
+  EXPECT_EQ(first, second);
+  GenerateBoardMines(30, 16, 99, 5, 1001, &second);
+  EXPECT_NE(first, second);
+  GenerateBoardMines(30, 16, 99, 6, 1000, &second);
+  EXPECT_NE(first, second);
+}
+
+// Checks that there are no mines at the field (click_x, click_y) and its
+// neighbors.
+void ExpectFirstClickIsSafe(int width,
+                            int click_x,
+                            int click_y,
+                            const vector<int>& positions) {
+  for (int i = 0; i < positions.size(); ++i) {
+    const int x = positions[i] % width;
+    const int y = positions[i] / width;
+    EXPECT_FALSE(std::abs(x - click_x) <= 1 && std::abs(y - click_y) <= 1)
+        << "Mine at " << x << " " << y;
+  }
+}
+
+TEST(BoardGeneratorTest, TestGenerateFirstClickSafeBoardMines) {
+  vector<int> positions;
+  // The clicks in the corner and in the middle, with the sparse and the dense
+  // sampler; the densest boards fill all fields around the safe area.
+  const int kClickX[] = { 0, 15, 29 };
+  const int kClickY[] = { 0, 8, 15 };
+  const int kMines[] = { 99, 300, 30 * 16 - 9 };
+  for (int i = 0; i < ARRAYSIZE(kClickX); ++i) {
+    for (int j = 0; j < ARRAYSIZE(kMines); ++j) {
+      if (kMines[j] == 30 * 16 - 9 && kClickX[i] != 15) {
+        continue;
+      }
+      GenerateFirstClickSafeBoardMines(30, 16, kMines[j], 7, i, kClickX[i],
+                                       kClickY[i], &positions);
+      ExpectValidPositions(30 * 16, kMines[j], positions);
+      ExpectFirstClickIsSafe(30, kClickX[i], kClickY[i], positions);
+    }
+  }
+}
+
+TEST(BoardGeneratorTest, TestGenerateNoGuessBoardMines) {
+  const int kWidth = 30;
+  const int kHeight = 16;
+  const int kMines = 99;
+  const int kClickX = 3;
+  const int kClickY = 4;
+  const int kNumBoards = 10;
+  vector<int> positions;
+  for (int board = 0; board < kNumBoards; ++board) {
+    ASSERT_TRUE(GenerateNoGuessBoardMines(kWidth, kHeight, kMines, 11, board,
+                                          kClickX, kClickY, &positions));
+    ExpectValidPositions(kWidth * kHeight, kMines, positions);
+    ExpectFirstClickIsSafe(kWidth, kClickX, kClickY, positions);
+    EXPECT_TRUE(std::is_sorted(positions.begin(), positions.end()));
+
+    vector<int> repeated;
+    ASSERT_TRUE(GenerateNoGuessBoardMines(kWidth, kHeight, kMines, 11, board,
+                                          kClickX, kClickY, &repeated));
+    EXPECT_EQ(positions, repeated);
+
+    // A new solver uncovers all fields without mines from the first click
+    // without guessing.
+    MineSweeper mine_sweeper(kWidth, kHeight);
+    for (int i = 0; i < positions.size(); ++i) {
+      mine_sweeper.SetMine(positions[i] % kWidth, positions[i] / kWidth, true);
+    }
+    mine_sweeper.CloseMineField();
+    MineSeeker seeker(mine_sweeper);
+    seeker.mutable_scheduler()->set_tier_budget(MineSeeker::GUESS_TIER, 0);
+    EXPECT_TRUE(seeker.UncoverField(kClickX, kClickY));
+    seeker.ContinueSolving();
+    EXPECT_EQ(0, seeker.guesses());
+    for (int y = 0; y < kHeight; ++y) {
+      for (int x = 0; x < kWidth; ++x) {
+        if (!mine_sweeper.IsMine(x, y)) {
+          EXPECT_EQ(MineSeekerField::UNCOVERED, seeker.StateAtPosition(x, y))
+              << "Board " << board << ", field " << x << " " << y;
+        }
+      }
+    }
+  }
+}
+
+TEST(BoardGeneratorTest, TestAppendBoardToString) {
+  vector<int> positions;
+  GenerateBoardMines(16, 12, 40, 1, 0, &positions);
+  string board;
+  AppendBoardToString(16, 12, positions, &board);
+  EXPECT_EQ(0, board.find("16 12\n40\n"));
+
+  scoped_ptr<MineSweeper> mine_sweeper(MineSweeper::LoadFromString(board));
+  ASSERT_TRUE(mine_sweeper.get() != NULL);
+  EXPECT_EQ(16, mine_sweeper->width());
+  EXPECT_EQ(12, mine_sweeper->height());
+  EXPECT_EQ(40, mine_sweeper->NumberOfMines());
+  for (int i = 0; i < positions.size(); ++i) {
+    EXPECT_TRUE(mine_sweeper->IsMine(positions[i] % 16, positions[i] / 16));
+  }
+}
+
+}  // namespace mineseeker
@@ -0,0 +1,93 @@
+// Copyright 2012 Ondrej Sykora
+//
+// This file is part of MineSeeker.
+//
+// MineSeeker is free software: you can redistribute it and/or modify it under
+// the terms of the GNU General Public License as published by the Free
+// Software Foundation, either version 3 of the License, or (at your option)
+// any later version.
+//
+// MineSeeker is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+// more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// MineSeeker. If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef MINESEEKER_BOARD_GEOMETRY_H_
+#define MINESEEKER_BOARD_GEOMETRY_H_
+
+#include "common.h"
+#include "glog/logging.h"
+
+namespace mineseeker {
+
+// The number of neighbors of a field.
+const int kNumNeighbors = 8;
+
+// The relative coordinates of the neighbors of a field. The neighbors are
+// ordered by their bits in the configurations of mines; the neighbor with
+// index i is represented by the bit (1 << i).
+constexpr int kNeighborOffsetX[kNumNeighbors] = { -1, 0, 1, -1, 1, -1, 0, 1 };
+constexpr int kNeighborOffsetY[kNumNeighbors] = { -1, -1, -1, 0, 0, 1, 1, 1 };
+
+// The geometry of a board whose size is known only at runtime.
+class DynamicBoardGeometry {
+ public:
+  DynamicBoardGeometry(int width, int height)
+      : width_(width), height_(height) {}
+
+  int width() const { return width_; }
+  int height() const { return height_; }
+  bool IsInside(int x, int y) const {
+    return static_cast<unsigned>(x) < static_cast<unsigned>(width_)
+        && static_cast<unsigned>(y) < static_cast<unsigned>(height_);
+  }
+
+ private:
+  const int width_;
+  const int height_;
+};
+
+// The geometry of a board whose size is a compile-time constant. Code that is
+// templated by the geometry gets the bounds of the board as constants, so the
+// compiler can fold the bounds checks and fully unroll the loops over the
+// neighbors. The constructor takes the runtime size only to check that it
+// matches the template parameters.
+template<int kWidthValue, int kHeightValue>
+class FixedBoardGeometry {
+ public:
+  static const int kWidth = kWidthValue;
+  static const int kHeight = kHeightValue;
+
+  FixedBoardGeometry(int width, int height) {
+    DCHECK_EQ(kWidth, width);
+    DCHECK_EQ(kHeight, height);
+  }
+
+  static bool Matches(int width, int height) {
+    return width == kWidth && height == kHeight;
+  }
+
+  static int width() { return kWidth; }
+  static int height() { return kHeight; }
+  static bool IsInside(int x, int y) {
+    return static_cast<unsigned>(x) < static_cast<unsigned>(kWidth)
+        && static_cast<unsigned>(y) < static_cast<unsigned>(kHeight);
+  }
+};
+
+template<int kWidthValue, int kHeightValue>
+const int FixedBoardGeometry<kWidthValue, kHeightValue>::kWidth;
+template<int kWidthValue, int kHeightValue>
+const int FixedBoardGeometry<kWidthValue, kHeightValue>::kHeight;
+
+// The geometries of the standard difficulty presets.
+typedef FixedBoardGeometry<9, 9> BeginnerBoardGeometry;
+typedef FixedBoardGeometry<16, 16> IntermediateBoardGeometry;
+typedef FixedBoardGeometry<30, 16> ExpertBoardGeometry;
+
+}  // namespace mineseeker
+
+#endif  // MINESEEKER_BOARD_GEOMETRY_H_
@@ -18,12 +18,17 @@
 #ifndef MINESEEKER_COMMON_H_
 #define MINESEEKER_COMMON_H_
 
+#include <stdint.h>
 #include <string>
 #include <vector>
 
 using std::string;
 using std::vector;
 
+typedef int8_t int8;
+typedef int64_t int64;
+typedef uint64_t uint64;
+
 // Determines the size of an array (that is defined as an array, not a pointer)
 // within the scope of the use of the macro.
 #define ARRAYSIZE(array) (sizeof(array) / sizeof(*array))
@@ -0,0 +1,284 @@
+// Copyright 2012 Ondrej Sykora
+//
+// This file is part of MineSeeker.
+//
+// MineSeeker is free software: you can redistribute it and/or modify it under
+// the terms of the GNU General Public License as published by the Free
+// Software Foundation, either version 3 of the License, or (at your option)
+// any later version.
+//
+// MineSeeker is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+// more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// MineSeeker. If not, see <http://www.gnu.org/licenses/>.
+
+#include "configuration_intern_table.h"
+
+namespace mineseeker {
+
+const int ConfigurationInternTable::kChunkSize;
+const int ConfigurationInternTable::kMaxChunks;
+const int ConfigurationInternTable::kNumShards;
+const int ConfigurationInternTable::kMemoIndexBits;
+const int ConfigurationInternTable::kMemoSize;
+const int ConfigurationInternTable::kHandleBits;
+const int ConfigurationInternTable::kOperationBits;
+const int ConfigurationInternTable::kMaxSets =
+    ConfigurationInternTable::kChunkSize * ConfigurationInternTable::kMaxChunks;
+const int ConfigurationInternTable::kNoHandle = -1;
+const int ConfigurationInternTable::kNumBasicSets =
+    ConfigurationSet::kNumConfigurations + 1;
+const int ConfigurationInternTable::kEmptySetHandle = 0;
+
+namespace {
+// Mixes the bits of a 64-bit value (the finalizer of MurmurHash3).
+uint64 MixBits(uint64 value) {
+  value ^= value >> 33;
+  value *= 0xff51afd7ed558ccdULL;
+  value ^= value >> 33;
+  value *= 0xc4ceb9fe1a85ec53ULL;
+  value ^= value >> 33;
+  return value;
+}
+
+// The memoized operations, encoded to 21 bits. The highest bit is set for
+// Remove; FilterByNeighbors uses the lower 20 bits for its arguments.
+const int kRemoveOperation = 1 << 20;
+
+int RemoveOperation(int configuration) {
+  return kRemoveOperation | configuration;
+}
+
+int FilterByNeighborsOperation(int known_neighbors,
+                               int mine_neighbors,
+                               int num_mines) {
+  return (known_neighbors << 12) | (mine_neighbors << 4) | (num_mines + 1);
+}
+
+// The valid bit of an entry of the memo.
+const uint64 kValidMemoEntry = 1ULL << 63;
+}  // namespace
+
+uint64 ConfigurationInternTable::SetKey::Hash() const {
+  uint64 hash = 0;
+  for (int i = 0; i < ConfigurationSet::kNumWords; ++i) {
+    hash = MixBits(hash ^ words[i]);
+  }
+  return hash;
+}
+
+ConfigurationInternTable::ConfigurationInternTable()
+    : max_sets_(kMaxSets),
+      ref_count_(1),
+      num_sets_(0),
+      num_memo_hits_(0),
+      num_memo_misses_(0) {
+  InternBasicSets();
+}
+
+ConfigurationInternTable::ConfigurationInternTable(int max_sets)
+    : max_sets_(max_sets),
+      ref_count_(1),
+      num_sets_(0),
+      num_memo_hits_(0),
+      num_memo_misses_(0) {
+  CHECK_LE(max_sets, kMaxSets);
+  InternBasicSets();
+}
+
+void ConfigurationInternTable::InternBasicSets() {
+  // The handles must fit to an entry of the memo.
+  DCHECK_LE(kMaxSets, 1 << kHandleBits);
+  DCHECK_LE(kNumBasicSets, kChunkSize);
+  CHECK_GE(max_sets_, kNumBasicSets);
+  for (int i = 0; i < kMaxChunks; ++i) {
+    chunks_[i].store(NULL, std::memory_order_relaxed);
+  }
+  for (int i = 0; i < kMemoSize; ++i) {
+    memo_[i].store(0, std::memory_order_relaxed);
+  }
+  // The basic sets have fixed handles, and they are found by BasicSetHandle
+  // without the hash table.
+  Chunk* const chunk = new Chunk();
+  for (int configuration = 0;
+       configuration < ConfigurationSet::kNumConfigurations;
+       ++configuration) {
+    chunk->sets[configuration + 1].set(configuration);
+  }
+  chunks_[0].store(chunk, std::memory_order_relaxed);
+  num_sets_.store(kNumBasicSets, std::memory_order_release);
+}
+
+int ConfigurationInternTable::BasicSetHandle(
+    const ConfigurationSet& configurations) {
+  int handle = kEmptySetHandle;
+  for (int i = 0; i < ConfigurationSet::kNumWords; ++i) {
+    const uint64 word = configurations.word(i);
+    if (word == 0) {
+      continue;
+    }
+    if (handle != kEmptySetHandle || (word & (word - 1)) != 0) {
+      return kNoHandle;
+    }
+    handle = 1 + i * ConfigurationSet::kBitsPerWord + __builtin_ctzll(word);
+  }
+  return handle;
+}
+
+ConfigurationInternTable::~ConfigurationInternTable() {
+  for (int i = 0; i < kMaxChunks; ++i) {
+    delete chunks_[i].load(std::memory_order_relaxed);
+  }
+}
+
+int ConfigurationInternTable::Intern(const ConfigurationSet& configurations) {
+  const int basic_handle = BasicSetHandle(configurations);
+  if (basic_handle != kNoHandle) {
+    return basic_handle;
+  }
+  const SetKey key(configurations);
+  Shard* const shard = ShardForHash(key.Hash());
+  std::lock_guard<std::mutex> lock(shard->mutex);
+  const std::unordered_map<SetKey, int, SetKeyHash>::const_iterator it =
+      shard->handles.find(key);
+  if (it != shard->handles.end()) {
+    return it->second;
+  }
+
+  // The handles are allocated across all shards.
+  int handle = num_sets_.load(std::memory_order_relaxed);
+  do {
+    if (handle >= max_sets_) {
+      return kNoHandle;
+    }
+  } while (!num_sets_.compare_exchange_weak(handle, handle + 1,
+                                            std::memory_order_relaxed));
+  std::atomic<Chunk*>* const chunk_pointer = &chunks_[handle / kChunkSize];
+  Chunk* chunk = chunk_pointer->load(std::memory_order_acquire);
+  if (chunk == NULL) {
+    // Sets from other shards may need the same chunk at the same time.
+    Chunk* const new_chunk = new Chunk();
+    if (chunk_pointer->compare_exchange_strong(chunk, new_chunk,
+                                               std::memory_order_acq_rel)) {
+      chunk = new_chunk;
+    } else {
+      delete new_chunk;
+    }
+  }
+  chunk->sets[handle % kChunkSize] = configurations;
+  shard->handles.insert(std::make_pair(key, handle));
+  return handle;
+}
+
+int ConfigurationInternTable::RemoveAll(int handle,
+                                        const ConfigurationSet& removed) {
+  const ConfigurationSet& configurations = Get(handle);
+  bool has_common_configurations = false;
+  for (int i = 0; i < ConfigurationSet::kNumWords; ++i) {
+    if ((configurations.word(i) & removed.word(i)) != 0) {
+      has_common_configurations = true;
+      break;
+    }
+  }
+  if (!has_common_configurations) {
+    return handle;
+  }
+  ConfigurationSet narrowed(configurations);
+  narrowed.RemoveAll(removed);
+  const int narrowed_handle = Intern(narrowed);
+  return narrowed_handle != kNoHandle ? narrowed_handle : handle;
+}
+
+int ConfigurationInternTable::Remove(int handle, int configuration) {
+  DCHECK_GE(configuration, 0);
+  DCHECK_LT(configuration, ConfigurationSet::kNumConfigurations);
+  if (!Get(handle)[configuration]) {
+    return handle;
+  }
+  const int operation = RemoveOperation(configuration);
+  int narrowed_handle = kNoHandle;
+  if (LookupMemo(handle, operation, &narrowed_handle)) {
+    return narrowed_handle;
+  }
+  ConfigurationSet narrowed(Get(handle));
+  narrowed.Remove(configuration);
+  narrowed_handle = Intern(narrowed);
+  if (narrowed_handle == kNoHandle) {
+    return handle;
+  }
+  StoreMemo(handle, operation, narrowed_handle);
+  return narrowed_handle;
+}
+
+int ConfigurationInternTable::FilterByNeighbors(int handle,
+                                                int known_neighbors,
+                                                int mine_neighbors,
+                                                int num_mines) {
+  DCHECK_EQ(0, mine_neighbors & ~known_neighbors);
+  DCHECK_GE(num_mines, -1);
+  const int operation = FilterByNeighborsOperation(known_neighbors,
+                                                   mine_neighbors, num_mines);
+  int filtered_handle = kNoHandle;
+  if (LookupMemo(handle, operation, &filtered_handle)) {
+    return filtered_handle;
+  }
+  const ConfigurationSet& configurations = Get(handle);
+  ConfigurationSet removed;
+  for (int configuration = 0;
+       configuration < ConfigurationSet::kNumConfigurations;
+       ++configuration) {
+    if (configurations[configuration]
+        && ((configuration & known_neighbors) != mine_neighbors
+            || (num_mines >= 0
+                && num_mines != __builtin_popcount(configuration)))) {
+      removed.set(configuration);
+    }
+  }
+  filtered_handle = RemoveAll(handle, removed);
+  // A result that did not fit to the table is not memoized, so that it is
+  // computed again once the table is compacted.
+  if (filtered_handle != handle || removed.count() == 0) {
+    StoreMemo(handle, operation, filtered_handle);
+  }
+  return filtered_handle;
+}
+
+int ConfigurationInternTable::MemoIndex(int handle, int operation) {
+  return (operation ^ MixBits(handle)) & (kMemoSize - 1);
+}
+
+uint64 ConfigurationInternTable::MemoEntryTag(int handle, int operation) {
+  return kValidMemoEntry
+      | (static_cast<uint64>(handle)
+         << (kHandleBits + kOperationBits - kMemoIndexBits))
+      | (static_cast<uint64>(operation >> kMemoIndexBits) << kHandleBits);
+}
+
+bool ConfigurationInternTable::LookupMemo(int handle,
+                                          int operation,
+                                          int* result) {
+  DCHECK(result != NULL);
+  const uint64 kResultMask = (1ULL << kHandleBits) - 1;
+  const uint64 entry =
+      memo_[MemoIndex(handle, operation)].load(std::memory_order_acquire);
+  if ((entry & ~kResultMask) != MemoEntryTag(handle, operation)) {
+    num_memo_misses_.fetch_add(1, std::memory_order_relaxed);
+    return false;
+  }
+  num_memo_hits_.fetch_add(1, std::memory_order_relaxed);
+  *result = entry & kResultMask;
+  return true;
+}
+
+void ConfigurationInternTable::StoreMemo(int handle,
+                                         int operation,
+                                         int result) {
+  DCHECK_GE(result, 0);
+  memo_[MemoIndex(handle, operation)].store(
+      MemoEntryTag(handle, operation) | result, std::memory_order_release);
+}
+
+}  // namespace mineseeker
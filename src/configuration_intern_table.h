@@ -0,0 +1,216 @@
+// Copyright 2012 Ondrej Sykora
+//
+// This file is part of MineSeeker.
+//
+// MineSeeker is free software: you can redistribute it and/or modify it under
+// the terms of the GNU General Public License as published by the Free
+// Software Foundation, either version 3 of the License, or (at your option)
+// any later version.
+//
+// MineSeeker is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+// more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// MineSeeker. If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef MINESEEKER_CONFIGURATION_INTERN_TABLE_H_
+#define MINESEEKER_CONFIGURATION_INTERN_TABLE_H_
+
+#include <atomic>
+#include <mutex>
+#include <unordered_map>
+
+#include "common.h"
+#include "configuration_set.h"
+#include "glog/logging.h"
+
+namespace mineseeker {
+
+// A table of interned (hash-consed) configuration sets. Each distinct set is
+// stored only once and it is identified by an integer handle, so equal sets
+// have equal handles. The sets in the table never change; narrowing a set
+// returns the handle of another interned set. The results of the narrowing
+// operations are memoized in a fixed-size direct-mapped cache indexed by the
+// handle of the narrowed set and the narrowing mask, so repeated narrowing of
+// the same set is usually a single load; a new result simply replaces the
+// entry it collides with, so the memo never grows. The entries of the cache
+// are single atomic words, so the memo does not need any locks.
+//
+// The table is append-only, so it can be shared by multiple mine seekers; it is
+// reference counted. The number of sets in the table is bounded. When the
+// table is full, Intern returns kNoHandle, and the narrowing operations return
+// the handle of the set they were asked to narrow; this is sound, because the
+// solver only loses the removed configurations, but the owner of the table
+// should replace it by a compacted table (see
+// MineSeekerState::CompactConfigurationTable). The empty set and all sets with
+// a single configuration are interned when the table is created, so they are
+// always available.
+//
+// All methods are thread-safe. The interning is split to shards with separate
+// locks by the hash of the interned set, so that the threads rarely wait for
+// each other.
+//
+// Typical usage:
+// ConfigurationInternTable* table = new ConfigurationInternTable();
+// const int all = table->Intern(all_configurations);
+// const int narrowed = table->Remove(all, 3);
+// table->Unref();
+class ConfigurationInternTable {
+ public:
+  // The maximal number of distinct sets in any table.
+  static const int kMaxSets;
+  // The value returned by Intern when the table is full.
+  static const int kNoHandle;
+  // The number of sets interned by the constructor: the empty set and all sets
+  // with a single configuration.
+  static const int kNumBasicSets;
+  // The handle of the empty set in every table.
+  static const int kEmptySetHandle;
+
+  // Creates a new table with a reference count of one that can hold up to
+  // kMaxSets sets.
+  ConfigurationInternTable();
+  // Creates a new table with a reference count of one that can hold up to
+  // max_sets sets. max_sets must be at most kMaxSets, and large enough for the
+  // sets interned by the constructor.
+  explicit ConfigurationInternTable(int max_sets);
+
+  // Methods for reference counting. The table is deleted when the last
+  // reference is released.
+  void Ref() { ref_count_.fetch_add(1); }
+  void Unref() {
+    if (ref_count_.fetch_sub(1) == 1) {
+      delete this;
+    }
+  }
+
+  // Returns the handle of the set; adds the set to the table if it was not
+  // there yet. Returns kNoHandle if the set is not in the table and the table
+  // is full.
+  int Intern(const ConfigurationSet& configurations);
+  // Returns the set with the given handle. The reference is valid as long as
+  // the table exists.
+  const ConfigurationSet& Get(int handle) const {
+    DCHECK_GE(handle, 0);
+    DCHECK_LT(handle, num_sets());
+    const Chunk* const chunk =
+        chunks_[handle / kChunkSize].load(std::memory_order_acquire);
+    return chunk->sets[handle % kChunkSize];
+  }
+
+  // Narrowing operations. Each of them returns the handle of the narrowed set;
+  // the handle is equal to 'handle' if the narrowing did not remove anything,
+  // or if the narrowed set is not in the table and the table is full.
+  //
+  // Removes all configurations in 'removed' from the set.
+  int RemoveAll(int handle, const ConfigurationSet& removed);
+  // Removes a single configuration from the set. Memoized.
+  int Remove(int handle, int configuration);
+  // Keeps only the configurations that fit with the neighbors of a field: the
+  // configurations that have mines exactly at the neighbors from mine_neighbors
+  // among the neighbors from known_neighbors and, if num_mines is not -1,
+  // exactly num_mines mines. Memoized.
+  int FilterByNeighbors(int handle,
+                        int known_neighbors,
+                        int mine_neighbors,
+                        int num_mines);
+
+  // Returns the number of distinct sets in the table, and the maximal number of
+  // sets.
+  int num_sets() const { return num_sets_.load(std::memory_order_acquire); }
+  int max_sets() const { return max_sets_; }
+  // Returns the number of the memoized narrowing operations that were found in
+  // the table, and the number of operations that had to be computed.
+  int64 num_memo_hits() const { return num_memo_hits_.load(); }
+  int64 num_memo_misses() const { return num_memo_misses_.load(); }
+
+ private:
+  // The number of sets in a single chunk, the maximal number of chunks and the
+  // number of shards of the hash table of the sets.
+  static const int kChunkSize = 1024;
+  static const int kMaxChunks = 4096;
+  static const int kNumShards = 16;
+  // The number of entries of the memo. An entry is a single 64-bit word: a
+  // valid bit, the handle of the narrowed set, the bits of the operation that
+  // are not implied by the index of the entry, and the handle of the result.
+  static const int kMemoIndexBits = 12;
+  static const int kMemoSize = 1 << kMemoIndexBits;
+  // The numbers of bits of a handle and of an encoded narrowing operation.
+  static const int kHandleBits = 22;
+  static const int kOperationBits = 21;
+
+  // A chunk of the storage of the sets. The chunks are never moved, so the
+  // sets can be read without locking.
+  struct Chunk {
+    ConfigurationSet sets[kChunkSize];
+  };
+
+  // The contents of a set used as a key of the hash table.
+  struct SetKey {
+    explicit SetKey(const ConfigurationSet& configurations) {
+      for (int i = 0; i < ConfigurationSet::kNumWords; ++i) {
+        words[i] = configurations.word(i);
+      }
+    }
+    bool operator==(const SetKey& other) const {
+      for (int i = 0; i < ConfigurationSet::kNumWords; ++i) {
+        if (words[i] != other.words[i]) {
+          return false;
+        }
+      }
+      return true;
+    }
+    uint64 Hash() const;
+
+    uint64 words[ConfigurationSet::kNumWords];
+  };
+  struct SetKeyHash {
+    size_t operator()(const SetKey& key) const { return key.Hash(); }
+  };
+
+  // A shard of the hash table of the interned sets.
+  struct Shard {
+    std::mutex mutex;
+    std::unordered_map<SetKey, int, SetKeyHash> handles;
+  };
+
+  ~ConfigurationInternTable();
+
+  // Interns the empty set and the sets with a single configuration.
+  void InternBasicSets();
+  // Returns the handle of the set if it is a basic set, i.e. the empty set
+  // (kEmptySetHandle) or a set with a single configuration c (handle c + 1);
+  // otherwise, returns kNoHandle.
+  static int BasicSetHandle(const ConfigurationSet& configurations);
+  // Returns the shard for the given hash.
+  Shard* ShardForHash(uint64 hash) { return &shards_[hash % kNumShards]; }
+  // Looks up the result of the operation 'operation' (of kOperationBits bits)
+  // on the set 'handle'. Returns true and stores the result to 'result' if the
+  // operation is in the memo.
+  bool LookupMemo(int handle, int operation, int* result);
+  // Stores the result of an operation to the memo.
+  void StoreMemo(int handle, int operation, int result);
+  // Returns the index of the entry of the memo for the given operation, and
+  // the bits of the entry above the result: the valid bit, the handle of the
+  // narrowed set and the bits of the operation not implied by the index.
+  static int MemoIndex(int handle, int operation);
+  static uint64 MemoEntryTag(int handle, int operation);
+
+  const int max_sets_;
+  std::atomic<int> ref_count_;
+  std::atomic<int> num_sets_;
+  std::atomic<int64> num_memo_hits_;
+  std::atomic<int64> num_memo_misses_;
+  std::atomic<Chunk*> chunks_[kMaxChunks];
+  Shard shards_[kNumShards];
+  std::atomic<uint64> memo_[kMemoSize];
+
+  ConfigurationInternTable(const ConfigurationInternTable&);
+  void operator=(const ConfigurationInternTable&);
+};
+
+}  // namespace mineseeker
+
+#endif  // MINESEEKER_CONFIGURATION_INTERN_TABLE_H_
@@ -0,0 +1,185 @@
+// Copyright 2012 Ondrej Sykora
+//
+// This file is part of MineSeeker.
+//
+// MineSeeker is free software: you can redistribute it and/or modify it under
+// the terms of the GNU General Public License as published by the Free
+// Software Foundation, either version 3 of the License, or (at your option)
+// any later version.
+//
+// MineSeeker is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+// more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// MineSeeker. If not, see <http://www.gnu.org/licenses/>.
+
+#include "common.h"
+#include "configuration_intern_table.h"
+#include "configuration_set.h"
+#include "glog/logging.h"
+#include "gtest/gtest.h"
+#include "thread_pool.h"
+
+namespace mineseeker {
+
+namespace {
+const int kNumBasicSets = ConfigurationInternTable::kNumBasicSets;
+}  // namespace
+
+TEST(ConfigurationInternTableTest, TestIntern) {
+  ConfigurationInternTable* const table = new ConfigurationInternTable();
+  EXPECT_EQ(kNumBasicSets, table->num_sets());
+  EXPECT_EQ(ConfigurationInternTable::kMaxSets, table->max_sets());
+  EXPECT_EQ(ConfigurationInternTable::kEmptySetHandle,
+            table->Intern(ConfigurationSet()));
+
+  ConfigurationSet configurations;
+  configurations.set(7);
+  const int first = table->Intern(configurations);
+  configurations.set(8);
+  const int second = table->Intern(configurations);
+  EXPECT_NE(first, second);
+  EXPECT_EQ(kNumBasicSets + 1, table->num_sets());
+  EXPECT_EQ(1, table->Get(first).count());
+  EXPECT_EQ(2, table->Get(second).count());
+
+  // Equal sets have equal handles.
+  ConfigurationSet same_configurations;
+  same_configurations.set(8);
+  same_configurations.set(7);
+  EXPECT_EQ(second, table->Intern(same_configurations));
+  EXPECT_EQ(kNumBasicSets + 1, table->num_sets());
+  table->Unref();
+}
+
+TEST(ConfigurationInternTableTest, TestFullTable) {
+  ConfigurationInternTable* const table =
+      new ConfigurationInternTable(kNumBasicSets + 2);
+  ConfigurationSet configurations;
+  configurations.set();
+  const int all = table->Intern(configurations);
+  const int without_three = table->Remove(all, 3);
+  EXPECT_NE(all, without_three);
+  EXPECT_EQ(kNumBasicSets + 2, table->num_sets());
+
+  // The table is full; a new set can't be interned, and the narrowing returns
+  // the original set.
+  configurations.Remove(4);
+  EXPECT_EQ(ConfigurationInternTable::kNoHandle,
+            table->Intern(configurations));
+  EXPECT_EQ(all, table->Remove(all, 4));
+  ConfigurationSet removed;
+  removed.set(5);
+  EXPECT_EQ(all, table->RemoveAll(all, removed));
+  EXPECT_EQ(all, table->FilterByNeighbors(all, 1, 1, -1));
+  EXPECT_EQ(kNumBasicSets + 2, table->num_sets());
+
+  // The sets that are already in the table are still available.
+  EXPECT_EQ(without_three, table->Remove(all, 3));
+  const int filtered = table->FilterByNeighbors(all, 0xff, 0x81, 2);
+  EXPECT_EQ(1, table->Get(filtered).count());
+  EXPECT_TRUE(table->Get(filtered)[0x81]);
+  EXPECT_EQ(0, table->Get(table->Remove(filtered, 0x81)).count());
+  table->Unref();
+}
+
+TEST(ConfigurationInternTableTest, TestNarrowing) {
+  ConfigurationInternTable* const table = new ConfigurationInternTable();
+  ConfigurationSet configurations;
+  configurations.set();
+  const int all = table->Intern(configurations);
+
+  // Removing a configuration that is not in the set returns the same handle.
+  const int without_three = table->Remove(all, 3);
+  EXPECT_NE(all, without_three);
+  EXPECT_EQ(without_three, table->Remove(without_three, 3));
+  EXPECT_EQ(ConfigurationSet::kNumConfigurations - 1,
+            table->Get(without_three).count());
+  EXPECT_FALSE(table->Get(without_three)[3]);
+  EXPECT_TRUE(table->Get(all)[3]);
+
+  ConfigurationSet removed;
+  removed.set(3);
+  EXPECT_EQ(without_three, table->RemoveAll(all, removed));
+  EXPECT_EQ(without_three, table->RemoveAll(without_three, removed));
+
+  // The configurations with a mine at the neighbor 0, no mine at the neighbor
+  // 1 and exactly two mines.
+  const int filtered = table->FilterByNeighbors(all, 3, 1, 2);
+  const ConfigurationSet& filtered_configurations = table->Get(filtered);
+  EXPECT_EQ(6, filtered_configurations.count());
+  for (int configuration = 0;
+       configuration < ConfigurationSet::kNumConfigurations;
+       ++configuration) {
+    EXPECT_EQ((configuration & 3) == 1
+                  && __builtin_popcount(configuration) == 2,
+              filtered_configurations[configuration]);
+  }
+  // Without the number of mines.
+  EXPECT_EQ(64, table->Get(table->FilterByNeighbors(all, 3, 1, -1)).count());
+  table->Unref();
+}
+
+TEST(ConfigurationInternTableTest, TestMemoization) {
+  ConfigurationInternTable* const table = new ConfigurationInternTable();
+  ConfigurationSet configurations;
+  configurations.set();
+  const int all = table->Intern(configurations);
+
+  const int filtered = table->FilterByNeighbors(all, 0xf0, 0x10, 3);
+  EXPECT_EQ(0, table->num_memo_hits());
+  EXPECT_EQ(1, table->num_memo_misses());
+  const int num_sets = table->num_sets();
+  EXPECT_EQ(filtered, table->FilterByNeighbors(all, 0xf0, 0x10, 3));
+  EXPECT_EQ(1, table->num_memo_hits());
+  EXPECT_EQ(num_sets, table->num_sets());
+
+  const int removed = table->Remove(filtered, 0x13);
+  EXPECT_EQ(removed, table->Remove(filtered, 0x13));
+  EXPECT_EQ(2, table->num_memo_hits());
+  table->Unref();
+}
+
+namespace {
+// Interns a set with the configurations item % 256 and (item + 1) % 256 and
+// stores its handle.
+class InterningTask : public ThreadPool::Task {
+ public:
+  InterningTask(ConfigurationInternTable* table, vector<int>* handles)
+      : table_(table), handles_(handles) {}
+
+  virtual void Run(int item) {
+    ConfigurationSet configurations;
+    configurations.set(item % ConfigurationSet::kNumConfigurations);
+    configurations.set((item + 1) % ConfigurationSet::kNumConfigurations);
+    (*handles_)[item] = table_->Intern(configurations);
+  }
+
+ private:
+  ConfigurationInternTable* const table_;
+  vector<int>* const handles_;
+};
+}  // namespace
+
+TEST(ConfigurationInternTableTest, TestConcurrentIntern) {
+  const int kNumItems = 5000;
+  ConfigurationInternTable* const table = new ConfigurationInternTable();
+  vector<int> handles(kNumItems, -1);
+  ThreadPool thread_pool(4);
+  InterningTask task(table, &handles);
+  thread_pool.ParallelFor(kNumItems, &task);
+
+  EXPECT_EQ(kNumBasicSets + ConfigurationSet::kNumConfigurations,
+            table->num_sets());
+  for (int i = 0; i < kNumItems; ++i) {
+    const ConfigurationSet& configurations = table->Get(handles[i]);
+    EXPECT_EQ(2, configurations.count());
+    EXPECT_TRUE(configurations[i % ConfigurationSet::kNumConfigurations]);
+    EXPECT_EQ(handles[i % ConfigurationSet::kNumConfigurations], handles[i]);
+  }
+  table->Unref();
+}
+
+}  // namespace mineseeker
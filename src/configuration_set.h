@@ -0,0 +1,116 @@
+// Copyright 2012 Ondrej Sykora
+//
+// This file is part of MineSeeker.
+//
+// MineSeeker is free software: you can redistribute it and/or modify it under
+// the terms of the GNU General Public License as published by the Free
+// Software Foundation, either version 3 of the License, or (at your option)
+// any later version.
+//
+// MineSeeker is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+// more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// MineSeeker. If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef MINESEEKER_CONFIGURATION_SET_H_
+#define MINESEEKER_CONFIGURATION_SET_H_
+
+#include "common.h"
+#include "glog/logging.h"
+
+namespace mineseeker {
+
+// A set of configurations of mines around a field, stored as a bitmap of 256
+// bits in four 64-bit words. The bit of each configuration is set if the
+// configuration is in the set.
+//
+// The solver keeps the sets of the fields in a ConfigurationInternTable, where
+// they are never changed; a field is narrowed by replacing its handle. The sets
+// themselves are therefore plain values that are not safe for concurrent
+// changes.
+class ConfigurationSet {
+ public:
+  // The number of configurations in the set.
+  static const int kNumConfigurations = 256;
+  // The number of bits in a single word of the bitmap.
+  static const int kBitsPerWord = 64;
+  static const int kNumWords = kNumConfigurations / kBitsPerWord;
+
+  // Creates an empty set.
+  ConfigurationSet() { reset(); }
+
+  // Returns true if the configuration is in the set.
+  bool test(int configuration) const {
+    DCHECK_GE(configuration, 0);
+    DCHECK_LT(configuration, kNumConfigurations);
+    return (word(configuration / kBitsPerWord)
+            & BitMask(configuration)) != 0;
+  }
+  bool operator[](int configuration) const { return test(configuration); }
+  // Returns the number of configurations in the set.
+  int count() const {
+    int num_configurations = 0;
+    for (int i = 0; i < kNumWords; ++i) {
+      num_configurations += __builtin_popcountll(word(i));
+    }
+    return num_configurations;
+  }
+  // Returns the word of the bitmap with the given index.
+  uint64 word(int index) const { return words_[index]; }
+
+  // Adds all configurations to the set.
+  void set() {
+    for (int i = 0; i < kNumWords; ++i) {
+      words_[i] = ~static_cast<uint64>(0);
+    }
+  }
+  // Adds a single configuration to the set.
+  void set(int configuration) {
+    DCHECK_GE(configuration, 0);
+    DCHECK_LT(configuration, kNumConfigurations);
+    words_[configuration / kBitsPerWord] |= BitMask(configuration);
+  }
+  // Removes all configurations from the set.
+  void reset() {
+    for (int i = 0; i < kNumWords; ++i) {
+      words_[i] = 0;
+    }
+  }
+
+  // Removes the configuration from the set. Returns true if the
+  // configuration was in the set before the call, i.e. if this call changed
+  // the set.
+  bool Remove(int configuration) {
+    DCHECK_GE(configuration, 0);
+    DCHECK_LT(configuration, kNumConfigurations);
+    const uint64 mask = BitMask(configuration);
+    uint64* const word = &words_[configuration / kBitsPerWord];
+    const bool changed = (*word & mask) != 0;
+    *word &= ~mask;
+    return changed;
+  }
+  // Removes all configurations that are in 'removed' from the set. Returns true
+  // if at least one of them was in the set before the call.
+  bool RemoveAll(const ConfigurationSet& removed) {
+    bool changed = false;
+    for (int i = 0; i < kNumWords; ++i) {
+      const uint64 mask = removed.word(i);
+      changed |= (words_[i] & mask) != 0;
+      words_[i] &= ~mask;
+    }
+    return changed;
+  }
+
+ private:
+  static uint64 BitMask(int configuration) {
+    return static_cast<uint64>(1) << (configuration % kBitsPerWord);
+  }
+  uint64 words_[kNumWords];
+};
+
+}  // namespace mineseeker
+
+#endif  // MINESEEKER_CONFIGURATION_SET_H_
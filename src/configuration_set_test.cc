@@ -0,0 +1,65 @@
+// Copyright 2012 Ondrej Sykora
+//
+// This file is part of MineSeeker.
+//
+// MineSeeker is free software: you can redistribute it and/or modify it under
+// the terms of the GNU General Public License as published by the Free
+// Software Foundation, either version 3 of the License, or (at your option)
+// any later version.
+//
+// MineSeeker is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+// more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// MineSeeker. If not, see <http://www.gnu.org/licenses/>.
+
+#include "common.h"
+#include "configuration_set.h"
+#include "glog/logging.h"
+#include "gtest/gtest.h"
+
+namespace mineseeker {
+
+TEST(ConfigurationSetTest, TestSetAndRemove) {
+  ConfigurationSet configurations;
+  EXPECT_EQ(0, configurations.count());
+  configurations.set();
+  EXPECT_EQ(ConfigurationSet::kNumConfigurations, configurations.count());
+
+  EXPECT_TRUE(configurations.Remove(0));
+  EXPECT_FALSE(configurations.Remove(0));
+  EXPECT_TRUE(configurations.Remove(255));
+  EXPECT_FALSE(configurations[0]);
+  EXPECT_TRUE(configurations[1]);
+  EXPECT_FALSE(configurations[255]);
+  EXPECT_EQ(254, configurations.count());
+
+  configurations.set(0);
+  EXPECT_TRUE(configurations[0]);
+
+  ConfigurationSet copy(configurations);
+  configurations.reset();
+  EXPECT_EQ(0, configurations.count());
+  EXPECT_EQ(255, copy.count());
+}
+
+TEST(ConfigurationSetTest, TestRemoveAll) {
+  ConfigurationSet configurations;
+  configurations.set();
+  ConfigurationSet removed;
+  removed.set(3);
+  removed.set(64);
+  removed.set(200);
+  EXPECT_TRUE(configurations.RemoveAll(removed));
+  EXPECT_EQ(253, configurations.count());
+  EXPECT_FALSE(configurations.RemoveAll(removed));
+
+  removed.set(4);
+  EXPECT_TRUE(configurations.RemoveAll(removed));
+  EXPECT_EQ(252, configurations.count());
+  EXPECT_FALSE(configurations.RemoveAll(ConfigurationSet()));
+}
+
+}  // namespace mineseeker
@@ -0,0 +1,82 @@
+// Copyright 2012 Ondrej Sykora
+//
+// This file is part of MineSeeker.
+//
+// MineSeeker is free software: you can redistribute it and/or modify it under
+// the terms of the GNU General Public License as published by the Free
+// Software Foundation, either version 3 of the License, or (at your option)
+// any later version.
+//
+// MineSeeker is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+// more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// MineSeeker. If not, see <http://www.gnu.org/licenses/>.
+
+#include "field_revealer.h"
+
+#include <algorithm>
+#include <chrono>
+#include <sstream>
+
+#include "glog/logging.h"
+#include "minesweeper.h"
+
+namespace mineseeker {
+
+namespace {
+// Returns the time of the steady clock in nanoseconds.
+int64 NowNs() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+      std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+}  // namespace
+
+StreamFieldRevealer::StreamFieldRevealer(std::istream* in, std::ostream* out)
+    : in_(CHECK_NOTNULL(in)),
+      out_(CHECK_NOTNULL(out)),
+      failed_(false),
+      num_moves_(0),
+      total_move_time_ns_(0),
+      max_move_time_ns_(0),
+      last_reply_time_ns_(-1) {}
+
+int StreamFieldRevealer::RevealField(int x, int y) {
+  if (failed_) {
+    return MineSweeper::kMineInField;
+  }
+  if (last_reply_time_ns_ >= 0) {
+    const int64 move_time_ns = NowNs() - last_reply_time_ns_;
+    total_move_time_ns_ += move_time_ns;
+    max_move_time_ns_ = std::max(max_move_time_ns_, move_time_ns);
+  }
+  ++num_moves_;
+  *out_ << "uncover " << x << " " << y << std::endl;
+
+  string reply;
+  if (!std::getline(*in_, reply)) {
+    LOG(ERROR) << "The input ended while waiting for field " << x << " " << y;
+    failed_ = true;
+    return MineSweeper::kMineInField;
+  }
+  last_reply_time_ns_ = NowNs();
+  std::istringstream reply_stream(reply);
+  int reply_x = -1;
+  int reply_y = -1;
+  int num_mines = -2;
+  string rest;
+  reply_stream >> reply_x >> reply_y >> num_mines;
+  if (!reply_stream || (reply_stream >> rest) || reply_x != x
+      || reply_y != y || num_mines < MineSweeper::kMineInField
+      || num_mines > 8) {
+    LOG(ERROR) << "Invalid reply for field " << x << " " << y << ": "
+               << reply;
+    failed_ = true;
+    return MineSweeper::kMineInField;
+  }
+  return num_mines;
+}
+
+}  // namespace mineseeker
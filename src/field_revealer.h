@@ -0,0 +1,92 @@
+// Copyright 2012 Ondrej Sykora
+//
+// This file is part of MineSeeker.
+//
+// MineSeeker is free software: you can redistribute it and/or modify it under
+// the terms of the GNU General Public License as published by the Free
+// Software Foundation, either version 3 of the License, or (at your option)
+// any later version.
+//
+// MineSeeker is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+// more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// MineSeeker. If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef MINESEEKER_FIELD_REVEALER_H_
+#define MINESEEKER_FIELD_REVEALER_H_
+
+#include <istream>
+#include <ostream>
+
+#include "common.h"
+
+namespace mineseeker {
+
+// Uncovers fields in a game of minesweeper that is played outside of
+// MineSeeker, e.g. by a user or by another program. Used by the interactive
+// representation of MineSweeper.
+class FieldRevealer {
+ public:
+  virtual ~FieldRevealer() {}
+
+  // Uncovers the field (x, y) in the game. Returns the number of mines around
+  // the field, or MineSweeper::kMineInField if there was a mine in the field.
+  virtual int RevealField(int x, int y) = 0;
+};
+
+// A revealer that plays the game over a line protocol. For each uncovered
+// field, it writes the line
+// uncover {x} {y}
+// to the output and flushes it, and then reads the line
+// {x} {y} {number of mines around the field}
+// from the input; the number is -1 if there was a mine in the field. The
+// revealer only waits for the reply, so the state of the solver stays in the
+// memory between the moves.
+//
+// Typical usage:
+// StreamFieldRevealer revealer(&std::cin, &std::cout);
+// MineSweeper mine_sweeper(width, height, mines, &revealer);
+// MineSeeker mine_seeker(mine_sweeper);
+// mine_seeker.set_use_hints(false);
+// mine_seeker.Solve();
+class StreamFieldRevealer : public FieldRevealer {
+ public:
+  // Creates a revealer that reads the replies from 'in' and writes the
+  // commands to 'out'. Does not take ownership of the streams.
+  StreamFieldRevealer(std::istream* in, std::ostream* out);
+
+  // Sends the command and waits for the reply. When the reply is not valid,
+  // the revealer fails: it reports a mine in this field and in all fields
+  // that are revealed later, so that the solver stops.
+  virtual int RevealField(int x, int y);
+
+  // Returns true if the input ended or a reply was not valid.
+  bool failed() const { return failed_; }
+  // The number of commands sent.
+  int64 num_moves() const { return num_moves_; }
+  // The total and the longest time between receiving a reply and sending the
+  // next command, i.e. the time the solver needed to make a move, in
+  // nanoseconds. The first move is not included.
+  int64 total_move_time_ns() const { return total_move_time_ns_; }
+  int64 max_move_time_ns() const { return max_move_time_ns_; }
+
+ private:
+  std::istream* const in_;
+  std::ostream* const out_;
+  bool failed_;
+  int64 num_moves_;
+  int64 total_move_time_ns_;
+  int64 max_move_time_ns_;
+  // The time when the last reply was received.
+  int64 last_reply_time_ns_;
+
+  StreamFieldRevealer(const StreamFieldRevealer&);
+  void operator=(const StreamFieldRevealer&);
+};
+
+}  // namespace mineseeker
+
+#endif  // MINESEEKER_FIELD_REVEALER_H_
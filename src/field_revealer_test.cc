@@ -0,0 +1,77 @@
+// Copyright 2012 Ondrej Sykora
+//
+// This file is part of MineSeeker.
+//
+// MineSeeker is free software: you can redistribute it and/or modify it under
+// the terms of the GNU General Public License as published by the Free
+// Software Foundation, either version 3 of the License, or (at your option)
+// any later version.
+//
+// MineSeeker is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+// more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// MineSeeker. If not, see <http://www.gnu.org/licenses/>.
+
+#include "field_revealer.h"
+
+#include <sstream>
+
+#include "common.h"
+#include "glog/logging.h"
+#include "gtest/gtest.h"
+#include "minesweeper.h"
+
+namespace mineseeker {
+
+TEST(StreamFieldRevealerTest, TestRevealFields) {
+  std::istringstream in("3 4 2\n0 0 0\n5 1 -1\n");
+  std::ostringstream out;
+  StreamFieldRevealer revealer(&in, &out);
+  EXPECT_EQ(2, revealer.RevealField(3, 4));
+  EXPECT_EQ(0, revealer.RevealField(0, 0));
+  EXPECT_EQ(MineSweeper::kMineInField, revealer.RevealField(5, 1));
+  EXPECT_FALSE(revealer.failed());
+  EXPECT_EQ(3, revealer.num_moves());
+  EXPECT_LE(revealer.max_move_time_ns(), revealer.total_move_time_ns());
+  EXPECT_EQ("uncover 3 4\nuncover 0 0\nuncover 5 1\n", out.str());
+}
+
+TEST(StreamFieldRevealerTest, TestInvalidReplies) {
+  const char* const kInvalidReplies[] = {
+    "1 2\n",
+    "1 3 2\n",
+    "1 2 9\n",
+    "1 2 -2\n",
+    "1 2 3 4\n",
+    "",
+  };
+  for (int i = 0; i < ARRAYSIZE(kInvalidReplies); ++i) {
+    std::istringstream in(kInvalidReplies[i]);
+    std::ostringstream out;
+    StreamFieldRevealer revealer(&in, &out);
+    EXPECT_EQ(MineSweeper::kMineInField, revealer.RevealField(1, 2))
+        << kInvalidReplies[i];
+    EXPECT_TRUE(revealer.failed());
+    // After a failure, no more commands are sent.
+    EXPECT_EQ(MineSweeper::kMineInField, revealer.RevealField(0, 0));
+    EXPECT_EQ("uncover 1 2\n", out.str());
+  }
+}
+
+TEST(StreamFieldRevealerTest, TestInteractiveMineSweeper) {
+  std::istringstream in("1 0 1\n");
+  std::ostringstream out;
+  StreamFieldRevealer revealer(&in, &out);
+  MineSweeper mine_sweeper(3, 1, 1, &revealer);
+  EXPECT_TRUE(mine_sweeper.is_closed());
+  EXPECT_EQ(1, mine_sweeper.NumberOfMines());
+  EXPECT_FALSE(mine_sweeper.IsMine(1, 0));
+  // The number is cached; the field is uncovered in the game only once.
+  EXPECT_EQ(1, mine_sweeper.NumberOfMinesAroundField(1, 0));
+  EXPECT_EQ("uncover 1 0\n", out.str());
+}
+
+}  // namespace mineseeker
@@ -0,0 +1,298 @@
+// Copyright 2012 Ondrej Sykora
+//
+// This file is part of MineSeeker.
+//
+// MineSeeker is free software: you can redistribute it and/or modify it under
+// the terms of the GNU General Public License as published by the Free
+// Software Foundation, either version 3 of the License, or (at your option)
+// any later version.
+//
+// MineSeeker is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+// more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// MineSeeker. If not, see <http://www.gnu.org/licenses/>.
+
+#include "frontier.h"
+
+#include <algorithm>
+#include <map>
+#include <queue>
+#include <set>
+#include <utility>
+
+#include "minesweeper.h"
+
+namespace mineseeker {
+
+namespace {
+// Appends the bytes of the value to the key of a component.
+void AppendInt32ToKey(int32_t value, string* key) {
+  key->append(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+}  // namespace
+
+Frontier::Frontier(const MineSeeker& mine_seeker) {
+  // The constraint fields are visited in the order of the rows, so the
+  // variables are numbered in the same order as by a scan of the board.
+  const int width = mine_seeker.mine_sweeper().width();
+  vector<int> constraint_fields;
+  mine_seeker.GetFrontierConstraintFields(&constraint_fields);
+  std::map<std::pair<int, int>, int> variable_indices;
+  for (int field = 0; field < constraint_fields.size(); ++field) {
+    const int x = constraint_fields[field] % width;
+    const int y = constraint_fields[field] / width;
+    FrontierConstraint constraint;
+    constraint.num_mines = mine_seeker.NumberOfMinesAroundField(x, y);
+    constraint.num_variables = 0;
+    for (int j = -1; j <= 1; ++j) {
+      for (int i = -1; i <= 1; ++i) {
+        if (i == 0 && j == 0) {
+          continue;
+        }
+        const int field_x = x + i;
+        const int field_y = y + j;
+        switch (mine_seeker.StateAtPosition(field_x, field_y)) {
+          case MineSeekerField::MINE:
+            --constraint.num_mines;
+            break;
+          case MineSeekerField::HIDDEN: {
+            const std::pair<int, int> key(field_x, field_y);
+            std::map<std::pair<int, int>, int>::const_iterator variable_it =
+                variable_indices.find(key);
+            int variable = -1;
+            if (variable_it == variable_indices.end()) {
+              variable = variables_.size();
+              variable_indices[key] = variable;
+              variables_.push_back(FieldCoordinate(field_x, field_y));
+              constraints_of_variable_.push_back(vector<int>());
+            } else {
+              variable = variable_it->second;
+            }
+            constraints_of_variable_[variable].push_back(constraints_.size());
+            constraint.variables[constraint.num_variables++] = variable;
+            break;
+          }
+          case MineSeekerField::UNCOVERED:
+            break;
+        }
+      }
+    }
+    DCHECK_GT(constraint.num_variables, 0);
+    constraints_.push_back(constraint);
+  }
+}
+
+void Frontier::GetComponents(vector<vector<int> >* components) const {
+  CHECK_NOTNULL(components);
+  components->clear();
+  vector<bool> visited(variables_.size(), false);
+  for (int start = 0; start < variables_.size(); ++start) {
+    if (visited[start]) {
+      continue;
+    }
+    components->push_back(vector<int>());
+    vector<int>* const component = &components->back();
+    std::queue<int> queue;
+    queue.push(start);
+    visited[start] = true;
+    while (!queue.empty()) {
+      const int variable = queue.front();
+      queue.pop();
+      component->push_back(variable);
+      const vector<int>& constraints = constraints_of_variable_[variable];
+      for (int i = 0; i < constraints.size(); ++i) {
+        const FrontierConstraint& constraint = constraints_[constraints[i]];
+        for (int j = 0; j < constraint.num_variables; ++j) {
+          const int neighbor = constraint.variables[j];
+          if (!visited[neighbor]) {
+            visited[neighbor] = true;
+            queue.push(neighbor);
+          }
+        }
+      }
+    }
+  }
+}
+
+void Frontier::GetComponentKey(const vector<int>& component,
+                               string* key) const {
+  CHECK_NOTNULL(key);
+  key->clear();
+  // The variables of the component are numbered by their position in the
+  // component; the constraints are added in the order of their indices, which
+  // follows the order of the fields on the board.
+  std::map<int, int> positions;
+  for (int i = 0; i < component.size(); ++i) {
+    positions[component[i]] = i;
+    const FieldCoordinate& field = variables_[component[i]];
+    AppendInt32ToKey(field.x, key);
+    AppendInt32ToKey(field.y, key);
+  }
+  std::set<int> constraints;
+  for (int i = 0; i < component.size(); ++i) {
+    const vector<int>& constraints_of_variable =
+        constraints_of_variable_[component[i]];
+    constraints.insert(constraints_of_variable.begin(),
+                       constraints_of_variable.end());
+  }
+  for (std::set<int>::const_iterator it = constraints.begin();
+       it != constraints.end(); ++it) {
+    const FrontierConstraint& constraint = constraints_[*it];
+    AppendInt32ToKey(constraint.num_mines, key);
+    AppendInt32ToKey(constraint.num_variables, key);
+    for (int i = 0; i < constraint.num_variables; ++i) {
+      AppendInt32ToKey(positions[constraint.variables[i]], key);
+    }
+  }
+}
+
+namespace {
+// Implements the backtracking search used by Frontier::EnumerateComponent.
+// For each constraint, the search keeps track of the number of mines that
+// still need to be placed and the number of variables that were not assigned
+// yet; a partial assignment is pruned as soon as one of the constraints can't
+// be satisfied. The constraints of the component are numbered locally, so the
+// enumerator takes memory and time proportional to the size of the component,
+// not of the whole frontier.
+class ComponentEnumerator {
+ public:
+  ComponentEnumerator(const Frontier& frontier,
+                      const vector<int>& component,
+                      int64 max_nodes)
+      : frontier_(frontier),
+        component_(component),
+        max_nodes_(max_nodes),
+        num_nodes_(0),
+        num_solutions_(0),
+        num_mines_(component.size(), 0),
+        assignment_(component.size(), false),
+        constraints_of_position_(component.size()) {
+    vector<int> constraints;
+    for (int i = 0; i < component_.size(); ++i) {
+      const vector<int>& constraints_of_variable =
+          frontier_.constraints_of_variable(component_[i]);
+      constraints.insert(constraints.end(), constraints_of_variable.begin(),
+                         constraints_of_variable.end());
+    }
+    std::sort(constraints.begin(), constraints.end());
+    constraints.erase(std::unique(constraints.begin(), constraints.end()),
+                      constraints.end());
+    remaining_mines_.resize(constraints.size());
+    unassigned_variables_.resize(constraints.size());
+    for (int i = 0; i < constraints.size(); ++i) {
+      const FrontierConstraint& constraint =
+          frontier_.constraint(constraints[i]);
+      remaining_mines_[i] = constraint.num_mines;
+      unassigned_variables_[i] = constraint.num_variables;
+    }
+    for (int i = 0; i < component_.size(); ++i) {
+      const vector<int>& constraints_of_variable =
+          frontier_.constraints_of_variable(component_[i]);
+      for (int j = 0; j < constraints_of_variable.size(); ++j) {
+        constraints_of_position_[i].push_back(
+            std::lower_bound(constraints.begin(), constraints.end(),
+                             constraints_of_variable[j])
+            - constraints.begin());
+      }
+    }
+  }
+
+  // Runs the search. Returns false if the search was stopped because of the
+  // limit on the number of nodes.
+  bool Run() { return Search(0); }
+
+  int64 num_solutions() const { return num_solutions_; }
+  const vector<int64>& num_mines() const { return num_mines_; }
+
+ private:
+  // Assigns a value to the variable at the given position in the component.
+  // Returns true if all its constraints can still be satisfied. The variable
+  // is assigned even when this method returns false.
+  bool Assign(int position, bool is_mine) {
+    assignment_[position] = is_mine;
+    bool is_consistent = true;
+    const vector<int>& constraints = constraints_of_position_[position];
+    for (int i = 0; i < constraints.size(); ++i) {
+      const int constraint = constraints[i];
+      --unassigned_variables_[constraint];
+      if (is_mine) {
+        --remaining_mines_[constraint];
+      }
+      is_consistent &= remaining_mines_[constraint] >= 0
+          && remaining_mines_[constraint] <= unassigned_variables_[constraint];
+    }
+    return is_consistent;
+  }
+  void Unassign(int position) {
+    const bool is_mine = assignment_[position];
+    const vector<int>& constraints = constraints_of_position_[position];
+    for (int i = 0; i < constraints.size(); ++i) {
+      const int constraint = constraints[i];
+      ++unassigned_variables_[constraint];
+      if (is_mine) {
+        ++remaining_mines_[constraint];
+      }
+    }
+  }
+
+  bool Search(int position) {
+    if (++num_nodes_ > max_nodes_) {
+      return false;
+    }
+    if (position == component_.size()) {
+      ++num_solutions_;
+      for (int i = 0; i < component_.size(); ++i) {
+        if (assignment_[i]) {
+          ++num_mines_[i];
+        }
+      }
+      return true;
+    }
+    for (int value = 0; value < 2; ++value) {
+      const bool is_consistent = Assign(position, value == 1);
+      const bool finished = !is_consistent || Search(position + 1);
+      Unassign(position);
+      if (!finished) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  const Frontier& frontier_;
+  const vector<int>& component_;
+  const int64 max_nodes_;
+  int64 num_nodes_;
+
+  int64 num_solutions_;
+  vector<int64> num_mines_;
+
+  vector<bool> assignment_;
+  // The local indices of the constraints of the variable at each position of
+  // the component.
+  vector<vector<int> > constraints_of_position_;
+  // Indexed by the local indices of the constraints.
+  vector<int> remaining_mines_;
+  vector<int> unassigned_variables_;
+};
+}  // namespace
+
+bool Frontier::EnumerateComponent(const vector<int>& component,
+                                  int64 max_nodes,
+                                  int64* num_solutions,
+                                  vector<int64>* num_mines) const {
+  CHECK_NOTNULL(num_solutions);
+  CHECK_NOTNULL(num_mines);
+  ComponentEnumerator enumerator(*this, component, max_nodes);
+  if (!enumerator.Run()) {
+    return false;
+  }
+  *num_solutions = enumerator.num_solutions();
+  *num_mines = enumerator.num_mines();
+  return true;
+}
+
+}  // namespace mineseeker
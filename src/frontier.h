@@ -0,0 +1,112 @@
+// Copyright 2012 Ondrej Sykora
+//
+// This file is part of MineSeeker.
+//
+// MineSeeker is free software: you can redistribute it and/or modify it under
+// the terms of the GNU General Public License as published by the Free
+// Software Foundation, either version 3 of the License, or (at your option)
+// any later version.
+//
+// MineSeeker is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+// more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// MineSeeker. If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef MINESEEKER_FRONTIER_H_
+#define MINESEEKER_FRONTIER_H_
+
+#include "common.h"
+#include "glog/logging.h"
+#include "mineseeker.h"
+
+namespace mineseeker {
+
+// A single constraint on the frontier. The constraint corresponds to an
+// uncovered field with a number, and it requires that exactly num_mines of
+// the variables contain a mine.
+struct FrontierConstraint {
+  // The maximal number of variables in a constraint (the number of neighbors
+  // of a field).
+  static const int kMaxVariables = 8;
+
+  // The number of mines around the field that were not found yet.
+  int num_mines;
+  // The indices of the variables (the hidden neighbors of the field).
+  int num_variables;
+  int variables[kMaxVariables];
+};
+
+// Contains the frontier of the mine seeker in a compact form that does not
+// depend on the size of the mine field. The frontier consists of variables -
+// the hidden fields that are neighbors of at least one uncovered field with a
+// number - and the constraints given by the numbers of the uncovered fields.
+// Fields in the interior of the hidden area are not represented at all.
+class Frontier {
+ public:
+  // Creates an empty frontier.
+  Frontier() {}
+  // Extracts the frontier from the current state of the mine seeker. Visits
+  // only the fields from MineSeeker::GetFrontierConstraintFields and their
+  // neighbors, so it takes time proportional to the size of the frontier, not
+  // of the board.
+  explicit Frontier(const MineSeeker& mine_seeker);
+
+  int num_variables() const { return variables_.size(); }
+  int num_constraints() const { return constraints_.size(); }
+
+  // Returns the coordinates of the field that corresponds to the variable.
+  const FieldCoordinate& variable(int variable) const {
+    DCHECK_GE(variable, 0);
+    DCHECK_LT(variable, variables_.size());
+    return variables_[variable];
+  }
+  const FrontierConstraint& constraint(int constraint) const {
+    DCHECK_GE(constraint, 0);
+    DCHECK_LT(constraint, constraints_.size());
+    return constraints_[constraint];
+  }
+  // Returns the list of constraints in which the variable appears.
+  const vector<int>& constraints_of_variable(int variable) const {
+    DCHECK_GE(variable, 0);
+    DCHECK_LT(variable, variables_.size());
+    return constraints_of_variable_[variable];
+  }
+
+  // Splits the variables into connected components; two variables are in the
+  // same component if they are connected by a chain of constraints. The
+  // variables in each component are sorted in the order of a breadth-first
+  // search, so that consecutive variables tend to share constraints. Erases
+  // any content that was stored in components previously.
+  void GetComponents(vector<vector<int> >* components) const;
+
+  // Computes a key of the component, that consists of the coordinates of its
+  // variables in the order of 'component' and of its constraints. Components
+  // with the same key have the same solutions, also when they come from
+  // different frontiers, so the key can be used to reuse the results of
+  // EnumerateComponent. Erases any content that was stored in key previously.
+  void GetComponentKey(const vector<int>& component, string* key) const;
+
+  // Enumerates all assignments of mines to the variables of the component
+  // that satisfy all constraints of these variables. Stores the number of
+  // satisfying assignments to num_solutions and for each variable of the
+  // component, the number of satisfying assignments with a mine on that
+  // variable to num_mines (in the order of the variables in component).
+  // Returns false if the enumeration needed more than max_nodes search nodes;
+  // the outputs are not valid in such case.
+  bool EnumerateComponent(const vector<int>& component,
+                          int64 max_nodes,
+                          int64* num_solutions,
+                          vector<int64>* num_mines) const;
+
+ private:
+  vector<FieldCoordinate> variables_;
+  vector<FrontierConstraint> constraints_;
+  vector<vector<int> > constraints_of_variable_;
+};
+
+}  // namespace mineseeker
+
+#endif  // MINESEEKER_FRONTIER_H_
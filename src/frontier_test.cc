@@ -0,0 +1,175 @@
+// Copyright 2012 Ondrej Sykora
+//
+// This file is part of MineSeeker.
+//
+// MineSeeker is free software: you can redistribute it and/or modify it under
+// the terms of the GNU General Public License as published by the Free
+// Software Foundation, either version 3 of the License, or (at your option)
+// any later version.
+//
+// MineSeeker is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+// more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// MineSeeker. If not, see <http://www.gnu.org/licenses/>.
+
+#include <algorithm>
+
+#include "common.h"
+#include "frontier.h"
+#include "glog/logging.h"
+#include "gtest/gtest.h"
+#include "mineseeker.h"
+#include "minesweeper.h"
+#include "scoped_ptr.h"
+
+namespace mineseeker {
+
+// Base class for tests of the frontier. Sets up a 5x2 minefield with mines at
+// (1, 0) and (3, 0), and uncovers the bottom row. This gives the numbers
+// 1 1 2 1 1 with the whole top row on the frontier.
+class FrontierTest : public testing::Test {
+ protected:
+  static const int kWidth = 5;
+  static const int kHeight = 2;
+
+  virtual void SetUp() {
+    mine_sweeper_.reset(new MineSweeper(kWidth, kHeight));
+    mine_sweeper_->SetMine(1, 0, true);
+    mine_sweeper_->SetMine(3, 0, true);
+    mine_sweeper_->CloseMineField();
+    mine_seeker_.reset(new MineSeeker(*mine_sweeper_));
+    for (int x = 0; x < kWidth; ++x) {
+      mine_seeker_->UncoverField(x, 1);
+    }
+  }
+
+  scoped_ptr<MineSweeper> mine_sweeper_;
+  scoped_ptr<MineSeeker> mine_seeker_;
+};
+
+const int FrontierTest::kWidth;
+const int FrontierTest::kHeight;
+
+TEST_F(FrontierTest, TestEmptyFrontier) {
+  MineSeeker mine_seeker(*mine_sweeper_);
+  Frontier frontier(mine_seeker);
+  EXPECT_EQ(0, frontier.num_variables());
+  EXPECT_EQ(0, frontier.num_constraints());
+
+  vector<vector<int> > components;
+  frontier.GetComponents(&components);
+  EXPECT_TRUE(components.empty());
+}
+
+TEST_F(FrontierTest, TestCreate) {
+  Frontier frontier(*mine_seeker_);
+  EXPECT_EQ(kWidth, frontier.num_variables());
+  EXPECT_EQ(kWidth, frontier.num_constraints());
+  for (int i = 0; i < frontier.num_variables(); ++i) {
+    EXPECT_EQ(0, frontier.variable(i).y);
+  }
+
+  const int kExpectedMines[] = { 1, 1, 2, 1, 1 };
+  const int kExpectedVariables[] = { 2, 3, 3, 3, 2 };
+  for (int i = 0; i < frontier.num_constraints(); ++i) {
+    const FrontierConstraint& constraint = frontier.constraint(i);
+    EXPECT_EQ(kExpectedMines[i], constraint.num_mines);
+    EXPECT_EQ(kExpectedVariables[i], constraint.num_variables);
+    for (int j = 0; j < constraint.num_variables; ++j) {
+      const int variable = constraint.variables[j];
+      const vector<int>& constraints =
+          frontier.constraints_of_variable(variable);
+      EXPECT_NE(constraints.end(),
+                std::find(constraints.begin(), constraints.end(), i));
+    }
+  }
+}
+
+TEST_F(FrontierTest, TestMarkedMinesAreNotVariables) {
+  mine_seeker_->MarkAsMine(1, 0);
+  Frontier frontier(*mine_seeker_);
+  EXPECT_EQ(kWidth - 1, frontier.num_variables());
+  // The first field has only one hidden neighbor, and its only mine was
+  // already found.
+  EXPECT_EQ(0, frontier.constraint(0).num_mines);
+  EXPECT_EQ(1, frontier.constraint(0).num_variables);
+}
+
+TEST_F(FrontierTest, TestEnumerateComponent) {
+  Frontier frontier(*mine_seeker_);
+  vector<vector<int> > components;
+  frontier.GetComponents(&components);
+  ASSERT_EQ(1, components.size());
+  EXPECT_EQ(kWidth, components[0].size());
+
+  int64 num_solutions = 0;
+  vector<int64> num_mines;
+  EXPECT_TRUE(frontier.EnumerateComponent(components[0], 1000,
+                                          &num_solutions, &num_mines));
+  EXPECT_EQ(1, num_solutions);
+  ASSERT_EQ(kWidth, num_mines.size());
+  for (int i = 0; i < components[0].size(); ++i) {
+    const FieldCoordinate& field = frontier.variable(components[0][i]);
+    EXPECT_EQ(mine_sweeper_->IsMine(field.x, field.y) ? 1 : 0, num_mines[i]);
+  }
+
+  // The search needs more than a single node.
+  EXPECT_FALSE(frontier.EnumerateComponent(components[0], 1,
+                                           &num_solutions, &num_mines));
+}
+
+TEST_F(FrontierTest, TestComponents) {
+  // Uncovering only the two fields on the sides gives two independent
+  // components, each with two solutions.
+  MineSeeker mine_seeker(*mine_sweeper_);
+  mine_seeker.UncoverField(0, 1);
+  mine_seeker.UncoverField(4, 1);
+  Frontier frontier(mine_seeker);
+  EXPECT_EQ(6, frontier.num_variables());
+
+  vector<vector<int> > components;
+  frontier.GetComponents(&components);
+  ASSERT_EQ(2, components.size());
+  for (int i = 0; i < components.size(); ++i) {
+    EXPECT_EQ(3, components[i].size());
+    int64 num_solutions = 0;
+    vector<int64> num_mines;
+    EXPECT_TRUE(frontier.EnumerateComponent(components[i], 1000,
+                                            &num_solutions, &num_mines));
+    EXPECT_EQ(3, num_solutions);
+  }
+}
+
+TEST_F(FrontierTest, TestComponentKey) {
+  const Frontier frontier(*mine_seeker_);
+  vector<vector<int> > components;
+  frontier.GetComponents(&components);
+  ASSERT_EQ(1, components.size());
+  string key;
+  frontier.GetComponentKey(components[0], &key);
+  EXPECT_FALSE(key.empty());
+
+  // The same state gives the same key.
+  MineSeeker same_mine_seeker(*mine_seeker_);
+  const Frontier same_frontier(same_mine_seeker);
+  same_frontier.GetComponents(&components);
+  string same_key;
+  same_frontier.GetComponentKey(components[0], &same_key);
+  EXPECT_EQ(key, same_key);
+
+  // Marking a mine changes the variables and the constraints.
+  MineSeeker changed_mine_seeker(*mine_seeker_);
+  changed_mine_seeker.MarkAsMine(1, 0);
+  const Frontier changed_frontier(changed_mine_seeker);
+  changed_frontier.GetComponents(&components);
+  for (int i = 0; i < components.size(); ++i) {
+    string changed_key;
+    changed_frontier.GetComponentKey(components[i], &changed_key);
+    EXPECT_NE(key, changed_key);
+  }
+}
+
+}  // namespace mineseeker
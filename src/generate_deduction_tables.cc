@@ -0,0 +1,113 @@
+// Copyright 2012 Ondrej Sykora
+//
+// This file is part of MineSeeker.
+//
+// MineSeeker is free software: you can redistribute it and/or modify it under
+// the terms of the GNU General Public License as published by the Free
+// Software Foundation, either version 3 of the License, or (at your option)
+// any later version.
+//
+// MineSeeker is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+// more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// MineSeeker. If not, see <http://www.gnu.org/licenses/>.
+//
+// Enumerates all windows of a pair of adjacent uncovered fields and prints a
+// C++ header with the table of their deductions to stdout. See
+// pair_deductions.h for the layout of the table. The build runs this tool to
+// generate pair_deduction_table.h.
+
+#include <iostream>
+#include "common.h"
+#include "glog/logging.h"
+#include "pair_deductions.h"
+#include "pattern_cache.h"
+
+namespace mineseeker {
+
+// Returns the index of the field of the pair window in the 5x5 window used by
+// PatternCache. The pair window is placed to the left part of the rows 1-3 of
+// the 5x5 window, so that both fields of the pair are inner fields.
+int PatternCacheCell(int along, int across) {
+  return (across + 1) * PatternCache::kWindowSize + along;
+}
+
+// Computes the entry of the table for the given window.
+int ComputePairDeduction(int hidden_fields,
+                         int remaining_mines_a,
+                         int remaining_mines_b) {
+  int cells[PatternCache::kNumCells];
+  for (int i = 0; i < PatternCache::kNumCells; ++i) {
+    cells[i] = PatternCache::kSafeCell;
+  }
+  for (int field = 0; field < kNumPairWindowFields; ++field) {
+    if (hidden_fields & (1 << field)) {
+      cells[PatternCacheCell(kPairWindowFieldAlong[field],
+                             kPairWindowFieldAcross[field])] =
+          PatternCache::kHiddenCell;
+    }
+  }
+  cells[PatternCacheCell(1, 1)] = remaining_mines_a;
+  cells[PatternCacheCell(2, 1)] = remaining_mines_b;
+
+  const PatternCache::Deductions deductions =
+      PatternCache::ComputeDeductions(cells);
+  int entry = 0;
+  for (int field = 0; field < kNumPairWindowFields; ++field) {
+    const int cell = PatternCacheCell(kPairWindowFieldAlong[field],
+                                      kPairWindowFieldAcross[field]);
+    if (deductions.mines & (1 << cell)) {
+      entry |= 1 << field;
+    }
+    if (deductions.safe & (1 << cell)) {
+      entry |= 1 << (kPairSafeShift + field);
+    }
+  }
+  return entry;
+}
+
+void PrintPairDeductionTable() {
+  const int kEntriesPerLine = 8;
+  std::cout << "// Generated by generate_deduction_tables; do not edit.\n"
+            << "\n"
+            << "#ifndef MINESEEKER_PAIR_DEDUCTION_TABLE_H_\n"
+            << "#define MINESEEKER_PAIR_DEDUCTION_TABLE_H_\n"
+            << "\n"
+            << "#include \"pair_deductions.h\"\n"
+            << "\n"
+            << "namespace mineseeker {\n"
+            << "\n"
+            << "constexpr int kPairDeductions[kNumPairDeductions] = {";
+  int num_entries = 0;
+  for (int hidden_fields = 0; hidden_fields < (1 << kNumPairWindowFields);
+       ++hidden_fields) {
+    for (int mines_a = 0; mines_a <= kMaxPairRemainingMines; ++mines_a) {
+      for (int mines_b = 0; mines_b <= kMaxPairRemainingMines; ++mines_b) {
+        DCHECK_EQ(num_entries,
+                  PairDeductionIndex(hidden_fields, mines_a, mines_b));
+        std::cout << (num_entries % kEntriesPerLine == 0 ? "\n   " : "")
+                  << " "
+                  << ComputePairDeduction(hidden_fields, mines_a, mines_b)
+                  << ",";
+        ++num_entries;
+      }
+    }
+  }
+  CHECK_EQ(kNumPairDeductions, num_entries);
+  std::cout << "\n};\n"
+            << "\n"
+            << "}  // namespace mineseeker\n"
+            << "\n"
+            << "#endif  // MINESEEKER_PAIR_DEDUCTION_TABLE_H_\n";
+}
+
+}  // namespace mineseeker
+
+int main(int argc, char* argv[]) {
+  google::InitGoogleLogging(argv[0]);
+  mineseeker::PrintPairDeductionTable();
+  return 0;
+}
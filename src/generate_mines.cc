@@ -15,20 +15,146 @@
 // You should have received a copy of the GNU General Public License along with
 // MineSeeker. If not, see <http://www.gnu.org/licenses/>.
 
-#include <stdlib.h>
+#include <stdio.h>
+#include <algorithm>
 #include <time.h>
-#include <iostream>
-#include <set>
+#include "binary_board.h"
+#include "board_generator.h"
+#include "common.h"
 #include "gflags/gflags.h"
 #include "glog/logging.h"
+#include "procedural_mine_field.h"
+#include "thread_pool.h"
 
 DEFINE_int32(width, 30, "The width of the mine field.");
 DEFINE_int32(height, 16, "The height of the mine field.");
 DEFINE_int32(mines, 99, "The number of mines on the minefield.");
 DEFINE_int32(seed, 0, "The seed for the random number generator. When set to "
                       "0, a seed based on system time is used.");
+DEFINE_int64(boards, 1, "The number of mine fields to generate. The mine "
+                        "fields are printed one after another.");
+DEFINE_int64(first_board, 0, "The index of the first generated mine field. "
+                             "The mine field with a given index is the same "
+                             "for a given seed, regardless of the number of "
+                             "generated fields and threads.");
+DEFINE_int32(threads, 1, "The number of threads used to generate the fields.");
+DEFINE_int32(first_click_x, -1, "The x coordinate of the first click. When "
+                                "set, the field and its neighbors have no "
+                                "mines, so the first click opens a region of "
+                                "the mine field.");
+DEFINE_int32(first_click_y, -1, "The y coordinate of the first click.");
+DEFINE_bool(no_guess, false, "Generate only mine fields that the solver "
+                             "solves from the first click without guessing. "
+                             "When the first click is not set, it is in the "
+                             "center of the mine field.");
+DEFINE_double(binary_density, 0.0, "When positive, generates a single mine "
+                                   "field in the binary format, where each "
+                                   "field has a mine with this probability. "
+                                   "The rows are generated one at a time, so "
+                                   "the mine field does not need to fit in "
+                                   "the memory. The number of mines is not "
+                                   "used.");
+
+namespace mineseeker {
+
+// Generates a range of boards of a batch to a string. Each item of the task
+// generates kBoardsPerItem consecutive boards.
+class GenerateBoardsTask : public ThreadPool::Task {
+ public:
+  static const int kBoardsPerItem = 256;
+
+  GenerateBoardsTask(uint64 seed, int64 first_board, int64 num_boards,
+                     vector<string>* outputs)
+      : seed_(seed),
+        first_board_(first_board),
+        num_boards_(num_boards),
+        outputs_(outputs) {}
+
+  virtual void Run(int item) {
+    string* const out = &(*outputs_)[item];
+    out->clear();
+    vector<int> positions;
+    const int64 begin = static_cast<int64>(item) * kBoardsPerItem;
+    const int64 end = std::min(num_boards_, begin + kBoardsPerItem);
+    for (int64 board = begin; board < end; ++board) {
+      if (FLAGS_no_guess) {
+        CHECK(GenerateNoGuessBoardMines(FLAGS_width, FLAGS_height, FLAGS_mines,
+                                        seed_, first_board_ + board,
+                                        FLAGS_first_click_x,
+                                        FLAGS_first_click_y, &positions))
+            << "Could not generate mine field " << first_board_ + board
+            << " without guessing";
+      } else if (FLAGS_first_click_x >= 0) {
+        GenerateFirstClickSafeBoardMines(FLAGS_width, FLAGS_height,
+                                         FLAGS_mines, seed_,
+                                         first_board_ + board,
+                                         FLAGS_first_click_x,
+                                         FLAGS_first_click_y, &positions);
+      } else {
+        GenerateBoardMines(FLAGS_width, FLAGS_height, FLAGS_mines, seed_,
+                           first_board_ + board, &positions);
+      }
+      AppendBoardToString(FLAGS_width, FLAGS_height, positions, out);
+    }
+  }
+
+ private:
+  const uint64 seed_;
+  const int64 first_board_;
+  const int64 num_boards_;
+  vector<string>* const outputs_;
+};
+
+const int GenerateBoardsTask::kBoardsPerItem;
+
+// Generates the boards and prints them to stdout in the order of their
+// indices. The boards are generated in batches, so that the memory used by
+// the output does not depend on the number of boards.
+void GenerateBoards(uint64 seed) {
+  const int kItemsPerBatch = 64;
+  const int64 kBoardsPerBatch =
+      kItemsPerBatch * GenerateBoardsTask::kBoardsPerItem;
+  ThreadPool thread_pool(FLAGS_threads);
+  vector<string> outputs(kItemsPerBatch);
+  for (int64 batch_start = 0; batch_start < FLAGS_boards;
+       batch_start += kBoardsPerBatch) {
+    const int64 num_boards =
+        std::min(kBoardsPerBatch, FLAGS_boards - batch_start);
+    const int num_items =
+        (num_boards + GenerateBoardsTask::kBoardsPerItem - 1)
+        / GenerateBoardsTask::kBoardsPerItem;
+    GenerateBoardsTask task(seed, FLAGS_first_board + batch_start, num_boards,
+                            &outputs);
+    thread_pool.ParallelFor(num_items, &task);
+    for (int i = 0; i < num_items; ++i) {
+      fwrite(outputs[i].data(), 1, outputs[i].size(), stdout);
+    }
+  }
+}
+
+// Generates a mine field in the binary format and prints it to stdout row by
+// row.
+void GenerateBinaryBoard(uint64 seed) {
+  const ProceduralMineField mine_field(FLAGS_width, FLAGS_height,
+                                       FLAGS_binary_density, seed);
+  string out;
+  AppendBinaryBoardHeader(FLAGS_width, FLAGS_height, &out);
+  vector<bool> mines(FLAGS_width);
+  for (int y = 0; y < FLAGS_height; ++y) {
+    for (int x = 0; x < FLAGS_width; ++x) {
+      mines[x] = mine_field.IsMine(x, y);
+    }
+    AppendBinaryBoardRow(mines, &out);
+    fwrite(out.data(), 1, out.size(), stdout);
+    out.clear();
+  }
+}
+
+}  // namespace mineseeker
 
 int main(int argc, char* argv[]) {
+  google::ParseCommandLineFlags(&argc, &argv, true);
+  google::InitGoogleLogging(argv[0]);
   if (FLAGS_width <= 0) {
     LOG(ERROR) << "Invalid width: " << FLAGS_width;
     return 1;
@@ -37,6 +163,14 @@ int main(int argc, char* argv[]) {
     LOG(ERROR) << "Invalid height: " << FLAGS_height;
     return 1;
   }
+  if (FLAGS_binary_density > 0.0) {
+    if (FLAGS_binary_density >= 1.0) {
+      LOG(ERROR) << "Invalid density: " << FLAGS_binary_density;
+      return 1;
+    }
+    mineseeker::GenerateBinaryBoard(FLAGS_seed == 0 ? time(NULL) : FLAGS_seed);
+    return 0;
+  }
   if (FLAGS_mines <= 0) {
     LOG(ERROR) << "Invalid number of mines: " << FLAGS_mines;
     return 1;
@@ -45,29 +179,30 @@ int main(int argc, char* argv[]) {
     LOG(ERROR) << "Too many mines: " << FLAGS_mines;
     return 1;
   }
+  if (FLAGS_boards < 0 || FLAGS_first_board < 0) {
+    LOG(ERROR) << "Invalid range of boards: " << FLAGS_first_board << " + "
+               << FLAGS_boards;
+    return 1;
+  }
+  if (FLAGS_threads <= 0) {
+    LOG(ERROR) << "Invalid number of threads: " << FLAGS_threads;
+    return 1;
+  }
+  if (FLAGS_no_guess && FLAGS_first_click_x < 0 && FLAGS_first_click_y < 0) {
+    FLAGS_first_click_x = FLAGS_width / 2;
+    FLAGS_first_click_y = FLAGS_height / 2;
+  }
+  if ((FLAGS_first_click_x >= 0 || FLAGS_first_click_y >= 0)
+      && (FLAGS_first_click_x < 0 || FLAGS_first_click_x >= FLAGS_width
+          || FLAGS_first_click_y < 0 || FLAGS_first_click_y >= FLAGS_height)) {
+    LOG(ERROR) << "Invalid first click: " << FLAGS_first_click_x << " "
+               << FLAGS_first_click_y;
+    return 1;
+  }
   int seed = FLAGS_seed;
   if (seed == 0) {
     seed = time(NULL);
   }
-  srand(seed);
-
-  std::cout << FLAGS_width << " " << FLAGS_height << std::endl;
-  std::cout << FLAGS_mines << std::endl;
-
-  std::set<std::pair<int, int> > used_coordinates;
-
-  for (int i = 0; i < FLAGS_mines; ++i) {
-    for (;;) {
-      const int x = rand() % FLAGS_width;
-      const int y = rand() % FLAGS_height;
-      const std::pair<int, int> coordinates = std::make_pair(x, y);
-      if (0 == used_coordinates.count(coordinates)) {
-        std::cout << x << " " << y << std::endl;
-        used_coordinates.insert(coordinates);
-        break;
-      }
-    }
-  }
-
+  mineseeker::GenerateBoards(seed);
   return 0;
 }
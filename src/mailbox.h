@@ -0,0 +1,91 @@
+// Copyright 2012 Ondrej Sykora
+//
+// This file is part of MineSeeker.
+//
+// MineSeeker is free software: you can redistribute it and/or modify it under
+// the terms of the GNU General Public License as published by the Free
+// Software Foundation, either version 3 of the License, or (at your option)
+// any later version.
+//
+// MineSeeker is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+// more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// MineSeeker. If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef MINESEEKER_MAILBOX_H_
+#define MINESEEKER_MAILBOX_H_
+
+#include <algorithm>
+#include <atomic>
+
+#include "common.h"
+
+namespace mineseeker {
+
+// A lock-free mailbox with multiple producers and a single consumer. Any
+// number of threads can post messages concurrently; the consumer takes all
+// messages posted so far at once. The messages are kept in a linked list
+// whose head is updated with compare-and-swap, so posting never blocks.
+//
+// Typical usage:
+// Mailbox<int> mailbox;
+// mailbox.Post(1);  // From any thread.
+// vector<int> messages;
+// mailbox.TakeAll(&messages);  // From the consumer thread.
+template<typename T>
+class Mailbox {
+ public:
+  Mailbox() : head_(NULL) {}
+  ~Mailbox() {
+    vector<T> messages;
+    TakeAll(&messages);
+  }
+
+  // Adds a message to the mailbox. Can be called concurrently from multiple
+  // threads.
+  void Post(const T& message) {
+    Node* const node = new Node(message);
+    node->next = head_.load(std::memory_order_relaxed);
+    while (!head_.compare_exchange_weak(node->next, node,
+                                        std::memory_order_release,
+                                        std::memory_order_relaxed)) {}
+  }
+
+  // Moves all messages from the mailbox to the end of messages, in the order
+  // in which they were posted. Must not be called concurrently with another
+  // call to TakeAll.
+  void TakeAll(vector<T>* messages) {
+    Node* node = head_.exchange(NULL, std::memory_order_acquire);
+    const int first_message = messages->size();
+    while (node != NULL) {
+      messages->push_back(node->message);
+      Node* const next = node->next;
+      delete node;
+      node = next;
+    }
+    std::reverse(messages->begin() + first_message, messages->end());
+  }
+
+  // Returns true if there are no messages in the mailbox. The result may be
+  // out of date if other threads are posting messages at the same time.
+  bool empty() const { return head_.load(std::memory_order_acquire) == NULL; }
+
+ private:
+  struct Node {
+    explicit Node(const T& node_message) : message(node_message), next(NULL) {}
+    T message;
+    Node* next;
+  };
+
+  std::atomic<Node*> head_;
+
+  Mailbox(const Mailbox&);
+  void operator=(const Mailbox&);
+};
+
+}  // namespace mineseeker
+
+#endif  // MINESEEKER_MAILBOX_H_
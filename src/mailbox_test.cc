@@ -0,0 +1,77 @@
+// Copyright 2012 Ondrej Sykora
+//
+// This file is part of MineSeeker.
+//
+// MineSeeker is free software: you can redistribute it and/or modify it under
+// the terms of the GNU General Public License as published by the Free
+// Software Foundation, either version 3 of the License, or (at your option)
+// any later version.
+//
+// MineSeeker is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+// more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// MineSeeker. If not, see <http://www.gnu.org/licenses/>.
+
+#include <algorithm>
+
+#include "common.h"
+#include "glog/logging.h"
+#include "gtest/gtest.h"
+#include "mailbox.h"
+#include "thread_pool.h"
+
+namespace mineseeker {
+
+TEST(MailboxTest, TestPostAndTakeAll) {
+  Mailbox<int> mailbox;
+  EXPECT_TRUE(mailbox.empty());
+  mailbox.Post(1);
+  mailbox.Post(2);
+  mailbox.Post(3);
+  EXPECT_FALSE(mailbox.empty());
+
+  vector<int> messages(1, 0);
+  mailbox.TakeAll(&messages);
+  ASSERT_EQ(4, messages.size());
+  for (int i = 0; i < messages.size(); ++i) {
+    EXPECT_EQ(i, messages[i]);
+  }
+  EXPECT_TRUE(mailbox.empty());
+
+  // Messages that were not taken are deleted with the mailbox.
+  mailbox.Post(4);
+}
+
+namespace {
+// Posts the index of each item to a single mailbox.
+class PostingTask : public ThreadPool::Task {
+ public:
+  explicit PostingTask(Mailbox<int>* mailbox) : mailbox_(mailbox) {}
+
+  virtual void Run(int item) { mailbox_->Post(item); }
+
+ private:
+  Mailbox<int>* mailbox_;
+};
+}  // namespace
+
+TEST(MailboxTest, TestConcurrentPost) {
+  const int kNumItems = 10000;
+  Mailbox<int> mailbox;
+  ThreadPool thread_pool(4);
+  PostingTask task(&mailbox);
+  thread_pool.ParallelFor(kNumItems, &task);
+
+  vector<int> messages;
+  mailbox.TakeAll(&messages);
+  ASSERT_EQ(kNumItems, messages.size());
+  std::sort(messages.begin(), messages.end());
+  for (int i = 0; i < kNumItems; ++i) {
+    EXPECT_EQ(i, messages[i]);
+  }
+}
+
+}  // namespace mineseeker
@@ -0,0 +1,42 @@
+// Copyright 2012 Ondrej Sykora
+//
+// This file is part of MineSeeker.
+//
+// MineSeeker is free software: you can redistribute it and/or modify it under
+// the terms of the GNU General Public License as published by the Free
+// Software Foundation, either version 3 of the License, or (at your option)
+// any later version.
+//
+// MineSeeker is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+// more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// MineSeeker. If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef MINESEEKER_MINE_SOURCE_H_
+#define MINESEEKER_MINE_SOURCE_H_
+
+namespace mineseeker {
+
+// A read-only source of the positions of the mines of a mine field that is
+// not stored as a whole, e.g. because the mines are computed from a hash or
+// because only a band of the rows is read from a file. MineSweeper can view a
+// rectangular window of a mine source (see MineSweeper::WINDOW).
+class MineSource {
+ public:
+  virtual ~MineSource() {}
+
+  // Checks if there is a mine at the position (x, y). Returns false for
+  // positions outside of the mine field.
+  virtual bool IsMine(int x, int y) const = 0;
+
+  // The size of the mine field.
+  virtual int width() const = 0;
+  virtual int height() const = 0;
+};
+
+}  // namespace mineseeker
+
+#endif  // MINESEEKER_MINE_SOURCE_H_
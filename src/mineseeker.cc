@@ -16,56 +16,874 @@
 // MineSeeker. If not, see <http://www.gnu.org/licenses/>.
 
 #include <algorithm>
+#include <chrono>
+#include <map>
+#include <tuple>
 
+#include "frontier.h"
 #include "glog/logging.h"
+#include "mailbox.h"
 #include "mineseeker.h"
 #include "minesweeper.h"
+#include "pair_deduction_table.h"
+#include "pair_deductions.h"
+#include "probing.h"
+#include "thread_pool.h"
+#include "tracer.h"
 
 namespace mineseeker {
 
-const int MineSeekerField::kNumPossibleConfigurations = 256;
+const int MineSeekerField::kNumPossibleConfigurations;
 
-MineSeekerField::MineSeekerField()
-    : temporary_status_(0),
-      state_(HIDDEN) {
-  ResetConfigurations();
+const int MineSeekerState::kTileSize;
+const int MineSeekerState::kBitsPerState;
+const uint64 MineSeekerState::kStateMask;
+const int MineSeekerState::kFieldsPerTile;
+const int MineSeekerState::kMaxTemporaryStatus;
+
+namespace {
+// The mask with the lower bit of each state in a word of the state plane.
+const uint64 kLowStateBits = 0x5555555555555555ULL;
+}  // namespace
+
+namespace {
+// Returns the mask of the neighbors of the field (x, y) that are outside of a
+// board of the given size.
+int OutsideNeighbors(int x, int y, int width, int height) {
+  int outside_neighbors = 0;
+  for (int bit = 0; bit < kNumNeighbors; ++bit) {
+    const int neighbor_x = x + kNeighborOffsetX[bit];
+    const int neighbor_y = y + kNeighborOffsetY[bit];
+    if (neighbor_x < 0 || neighbor_x >= width
+        || neighbor_y < 0 || neighbor_y >= height) {
+      outside_neighbors |= 1 << bit;
+    }
+  }
+  return outside_neighbors;
+}
+
+// Returns the handle of the set with the handle 'handle' in old_table in
+// new_table. Interns the set to new_table when it is used for the first time;
+// 'handles' maps the handles of the sets interned so far.
+int ReinternHandle(const ConfigurationInternTable& old_table,
+                   ConfigurationInternTable* new_table,
+                   std::unordered_map<int, int>* handles,
+                   int handle) {
+  const std::pair<std::unordered_map<int, int>::iterator, bool> inserted =
+      handles->insert(std::make_pair(handle, -1));
+  if (inserted.second) {
+    inserted.first->second = new_table->Intern(old_table.Get(handle));
+    CHECK_NE(ConfigurationInternTable::kNoHandle, inserted.first->second)
+        << "The sets used by the fields do not fit to an empty table";
+  }
+  return inserted.first->second;
+}
+}  // namespace
+
+MineSeekerState::Tile::Tile() : ref_count(1) {
+  for (int i = 0; i < kTileSize; ++i) {
+    states[i].store(0, std::memory_order_relaxed);
+  }
+  std::fill(temporary_statuses, temporary_statuses + kFieldsPerTile, 0);
+  for (int i = 0; i < kFieldsPerTile; ++i) {
+    configuration_handles[i].store(0, std::memory_order_relaxed);
+  }
+  std::fill(flags, flags + kFieldsPerTile, 0);
+  std::fill(interior_fields, interior_fields + kTileSize, 0);
+}
+
+MineSeekerState::Tile::Tile(const Tile& other) : ref_count(1) {
+  for (int i = 0; i < kTileSize; ++i) {
+    states[i].store(other.states[i].load(std::memory_order_relaxed),
+                    std::memory_order_relaxed);
+  }
+  std::copy(other.temporary_statuses,
+            other.temporary_statuses + kFieldsPerTile, temporary_statuses);
+  for (int i = 0; i < kFieldsPerTile; ++i) {
+    configuration_handles[i].store(
+        other.configuration_handles[i].load(std::memory_order_relaxed),
+        std::memory_order_relaxed);
+  }
+  std::copy(other.flags, other.flags + kFieldsPerTile, flags);
+  std::copy(other.interior_fields, other.interior_fields + kTileSize,
+            interior_fields);
+}
+
+MineSeekerState::MineSeekerState()
+    : width_(0),
+      height_(0),
+      width_in_tiles_(0),
+      has_concurrent_changes_(false),
+      num_hidden_fields_(0),
+      num_mine_fields_(0),
+      num_fields_without_configurations_(0),
+      num_interior_fields_(0),
+      configuration_table_(new ConfigurationInternTable()) {
+  std::fill(border_set_handles_,
+            border_set_handles_ + ARRAYSIZE(border_set_handles_), -1);
+}
+
+MineSeekerState::MineSeekerState(const MineSeekerState& other)
+    : width_(other.width_),
+      height_(other.height_),
+      width_in_tiles_(other.width_in_tiles_),
+      tiles_(other.tiles_.size()),
+      has_concurrent_changes_(false),
+      num_hidden_fields_(other.num_hidden_fields()),
+      num_mine_fields_(other.num_mine_fields()),
+      num_fields_without_configurations_(
+          other.num_fields_without_configurations()),
+      num_interior_fields_(other.num_interior_fields_),
+      num_interior_fields_in_tile_columns_(
+          other.num_interior_fields_in_tile_columns_),
+      configuration_table_(other.configuration_table_) {
+  CHECK(!other.has_concurrent_changes_);
+  std::copy(other.border_set_handles_,
+            other.border_set_handles_ + ARRAYSIZE(border_set_handles_),
+            border_set_handles_);
+  for (int i = 0; i < tiles_.size(); ++i) {
+    Tile* const tile = other.tiles_[i].load(std::memory_order_relaxed);
+    tile->Ref();
+    tiles_[i].store(tile, std::memory_order_relaxed);
+  }
+  configuration_table_->Ref();
+}
+
+MineSeekerState::~MineSeekerState() {
+  CHECK(!has_concurrent_changes_);
+  ClearTiles();
+  configuration_table_->Unref();
+}
+
+MineSeekerState& MineSeekerState::operator=(const MineSeekerState& other) {
+  if (this == &other) {
+    return *this;
+  }
+  CHECK(!has_concurrent_changes_);
+  CHECK(!other.has_concurrent_changes_);
+  vector<std::atomic<Tile*> > tiles(other.tiles_.size());
+  for (int i = 0; i < tiles.size(); ++i) {
+    Tile* const tile = other.tiles_[i].load(std::memory_order_relaxed);
+    tile->Ref();
+    tiles[i].store(tile, std::memory_order_relaxed);
+  }
+  ClearTiles();
+  tiles_.swap(tiles);
+  width_ = other.width_;
+  height_ = other.height_;
+  width_in_tiles_ = other.width_in_tiles_;
+  std::copy(other.border_set_handles_,
+            other.border_set_handles_ + ARRAYSIZE(border_set_handles_),
+            border_set_handles_);
+  num_hidden_fields_.store(other.num_hidden_fields(),
+                           std::memory_order_relaxed);
+  num_mine_fields_.store(other.num_mine_fields(), std::memory_order_relaxed);
+  num_fields_without_configurations_.store(
+      other.num_fields_without_configurations(), std::memory_order_relaxed);
+  num_interior_fields_ = other.num_interior_fields_;
+  num_interior_fields_in_tile_columns_ =
+      other.num_interior_fields_in_tile_columns_;
+  other.configuration_table_->Ref();
+  configuration_table_->Unref();
+  configuration_table_ = other.configuration_table_;
+  return *this;
+}
+
+void MineSeekerState::ClearTiles() {
+  for (int i = 0; i < tiles_.size(); ++i) {
+    tiles_[i].load(std::memory_order_relaxed)->Unref();
+  }
+  tiles_.clear();
+}
+
+void MineSeekerState::Resize(int width, int height) {
+  CHECK_GE(width, 0);
+  CHECK_GE(height, 0);
+  CHECK(!has_concurrent_changes_);
+  ClearTiles();
+  width_ = width;
+  height_ = height;
+  width_in_tiles_ = (width + kTileSize - 1) / kTileSize;
+  const int height_in_tiles = (height + kTileSize - 1) / kTileSize;
+  num_hidden_fields_.store(width * height, std::memory_order_relaxed);
+  num_mine_fields_.store(0, std::memory_order_relaxed);
+  num_fields_without_configurations_.store(0, std::memory_order_relaxed);
+  num_interior_fields_ = width * height;
+  num_interior_fields_in_tile_columns_.resize(width_in_tiles_);
+  for (int tile_x = 0; tile_x < width_in_tiles_; ++tile_x) {
+    num_interior_fields_in_tile_columns_[tile_x] =
+        std::min(kTileSize, width - tile_x * kTileSize) * height;
+  }
+
+  // The hidden fields allow all configurations that have no mines outside of
+  // the board. There are only a few distinct sets like this; they are interned
+  // when they are used for the first time. The table is kept, so that a seeker
+  // restarted on another board reuses the sets it has already interned; the
+  // table is bounded, and the seeker compacts it when it gets full.
+  std::fill(border_set_handles_,
+            border_set_handles_ + ARRAYSIZE(border_set_handles_), -1);
+
+  // The contents of a tile depend only on its distance from the sides of the
+  // board, so all tiles with the same position relative to the border share a
+  // single tile. The key is (touches left, touches top, distance to the right
+  // side, distance to the bottom side); the distances greater than the size of
+  // the tile are all the same.
+  std::map<std::tuple<bool, bool, int, int>, Tile*> prototypes;
+  vector<std::atomic<Tile*> > tiles(width_in_tiles_ * height_in_tiles);
+  tiles_.swap(tiles);
+  for (int tile_y = 0; tile_y < height_in_tiles; ++tile_y) {
+    for (int tile_x = 0; tile_x < width_in_tiles_; ++tile_x) {
+      const int left = tile_x * kTileSize;
+      const int top = tile_y * kTileSize;
+      const std::tuple<bool, bool, int, int> key(
+          tile_x == 0, tile_y == 0, std::min(kTileSize + 1, width - left),
+          std::min(kTileSize + 1, height - top));
+      Tile** const prototype = &prototypes[key];
+      if (*prototype != NULL) {
+        (*prototype)->Ref();
+        tiles_[tile_x + width_in_tiles_ * tile_y].store(
+            *prototype, std::memory_order_relaxed);
+        continue;
+      }
+      Tile* const tile = new Tile();
+      *prototype = tile;
+      tiles_[tile_x + width_in_tiles_ * tile_y].store(
+          tile, std::memory_order_relaxed);
+      for (int j = 0; j < kTileSize; ++j) {
+        const int y = top + j;
+        // The positions behind the end of the board are uncovered.
+        uint64 padding = 0;
+        for (int i = 0; i < kTileSize; ++i) {
+          const int x = left + i;
+          if (x >= width || y >= height) {
+            padding |= static_cast<uint64>(MineSeekerField::UNCOVERED)
+                << StateShift(i);
+            continue;
+          }
+          const int outside_neighbors =
+              OutsideNeighbors(x, y, width, height);
+          int* const handle = &border_set_handles_[outside_neighbors];
+          if (*handle < 0) {
+            ConfigurationSet configurations;
+            for (int configuration = 0;
+                 configuration < MineSeekerField::kNumPossibleConfigurations;
+                 ++configuration) {
+              if ((configuration & outside_neighbors) == 0) {
+                configurations.set(configuration);
+              }
+            }
+            *handle = configuration_table_->Intern(configurations);
+            CHECK_NE(ConfigurationInternTable::kNoHandle, *handle);
+          }
+          tile->configuration_handles[FieldIndexInTile(x, y)].store(
+              *handle, std::memory_order_relaxed);
+          tile->interior_fields[i] |= static_cast<uint64>(1) << j;
+        }
+        tile->states[j].store(padding, std::memory_order_relaxed);
+      }
+    }
+  }
+}
+
+int MineSeekerState::NumSharedTiles() const {
+  int num_shared_tiles = 0;
+  for (int i = 0; i < tiles_.size(); ++i) {
+    if (tiles_[i].load(std::memory_order_relaxed)->IsShared()) {
+      ++num_shared_tiles;
+    }
+  }
+  return num_shared_tiles;
+}
+
+void MineSeekerState::BeginConcurrentChanges() {
+  CHECK(!has_concurrent_changes_);
+  has_concurrent_changes_ = true;
 }
 
-bool MineSeekerField::IsBound() const {
-  // TODO(ondrasej): Optimize this (e.g. cache the number of active
-  // configurations).
-  return NumberOfActiveConfigurations() == 1;
+void MineSeekerState::EndConcurrentChanges() {
+  CHECK(has_concurrent_changes_);
+  has_concurrent_changes_ = false;
+  for (int i = 0; i < replaced_tiles_.size(); ++i) {
+    replaced_tiles_[i]->Unref();
+  }
+  replaced_tiles_.clear();
 }
 
-int MineSeekerField::NumberOfActiveConfigurations() const {
-  return std::count(configurations_.begin(), configurations_.end(), true);
+MineSeekerState::Tile* MineSeekerState::MutableTile(int x, int y) {
+  std::atomic<Tile*>* const slot = &tiles_[TileIndex(x, y)];
+  Tile* tile = slot->load(std::memory_order_acquire);
+  // The tiles that are not shared are never shared again while they are
+  // changed, so only the copying needs to be synchronized. When another thread
+  // installs its copy first, the exchange fails and loads the copy.
+  while (tile->IsShared()) {
+    Tile* const copy = new Tile(*tile);
+    if (slot->compare_exchange_strong(tile, copy,
+                                      std::memory_order_acq_rel)) {
+      ReleaseReplacedTile(tile);
+      return copy;
+    }
+    delete copy;
+  }
+  return tile;
+}
+
+void MineSeekerState::ReleaseReplacedTile(Tile* tile) {
+  if (has_concurrent_changes_) {
+    std::lock_guard<std::mutex> lock(replaced_tiles_mutex_);
+    replaced_tiles_.push_back(tile);
+  } else {
+    tile->Unref();
+  }
+}
+
+void MineSeekerState::set_state(int x, int y, State state) {
+  CheckCoordinates(x, y);
+  std::atomic<uint64>* const word =
+      &MutableTile(x, y)->states[y % kTileSize];
+  const int shift = StateShift(x);
+  const uint64 mask = kStateMask << shift;
+  uint64 old_word = word->load(std::memory_order_relaxed);
+  while (!word->compare_exchange_weak(
+             old_word,
+             (old_word & ~mask) | (static_cast<uint64>(state) << shift),
+             std::memory_order_relaxed)) {}
+  const State old_state =
+      static_cast<State>((old_word >> shift) & kStateMask);
+  if (old_state == MineSeekerField::HIDDEN
+      && state != MineSeekerField::HIDDEN) {
+    --num_hidden_fields_;
+  } else if (old_state != MineSeekerField::HIDDEN
+             && state == MineSeekerField::HIDDEN) {
+    ++num_hidden_fields_;
+  }
+  if (old_state == MineSeekerField::MINE && state != MineSeekerField::MINE) {
+    --num_mine_fields_;
+  } else if (old_state != MineSeekerField::MINE
+             && state == MineSeekerField::MINE) {
+    ++num_mine_fields_;
+  }
+}
+
+bool MineSeekerState::TransitionFromHidden(int x, int y, State state) {
+  CheckCoordinates(x, y);
+  DCHECK_NE(MineSeekerField::HIDDEN, state);
+  // A field that is not hidden does not need a private copy of its tile.
+  if (this->state(x, y) != MineSeekerField::HIDDEN) {
+    return false;
+  }
+  std::atomic<uint64>* const word =
+      &MutableTile(x, y)->states[y % kTileSize];
+  const int shift = StateShift(x);
+  uint64 old_word = word->load(std::memory_order_relaxed);
+  do {
+    if (((old_word >> shift) & kStateMask) != MineSeekerField::HIDDEN) {
+      return false;
+    }
+  } while (!word->compare_exchange_weak(
+               old_word, old_word | (static_cast<uint64>(state) << shift),
+               std::memory_order_relaxed));
+  --num_hidden_fields_;
+  if (state == MineSeekerField::MINE) {
+    ++num_mine_fields_;
+  }
+  return true;
+}
+
+void MineSeekerState::CollectHiddenFields(
+    vector<FieldCoordinate>* fields) const {
+  CHECK_NOTNULL(fields);
+  for (int y = 0; y < height_; ++y) {
+    for (int tile_x = 0; tile_x < width_in_tiles_; ++tile_x) {
+      const uint64 word =
+          tiles_[tile_x + width_in_tiles_ * (y / kTileSize)]
+              .load(std::memory_order_relaxed)
+              ->states[y % kTileSize].load(std::memory_order_relaxed);
+      // HIDDEN is zero, so the lower bit of a hidden field is set in the mask
+      // iff both bits of its state are zero.
+      uint64 hidden_mask = ~(word | (word >> 1)) & kLowStateBits;
+      while (hidden_mask != 0) {
+        const int bit = __builtin_ctzll(hidden_mask);
+        fields->push_back(
+            FieldCoordinate(tile_x * kTileSize + bit / kBitsPerState, y));
+        hidden_mask &= hidden_mask - 1;
+      }
+    }
+  }
+}
+
+void MineSeekerState::set_is_interior(int x, int y, bool is_interior) {
+  CheckCoordinates(x, y);
+  DCHECK(!has_concurrent_changes_);
+  if (this->is_interior(x, y) == is_interior) {
+    return;
+  }
+  Tile* const tile = MutableTile(x, y);
+  tile->interior_fields[x % kTileSize] ^= static_cast<uint64>(1)
+      << (y % kTileSize);
+  const int delta = is_interior ? 1 : -1;
+  num_interior_fields_ += delta;
+  num_interior_fields_in_tile_columns_[x / kTileSize] += delta;
+}
+
+void MineSeekerState::CollectInteriorFields(
+    int max_fields,
+    vector<FieldCoordinate>* fields) const {
+  CHECK_NOTNULL(fields);
+  if (max_fields <= 0) {
+    return;
+  }
+  const int height_in_tiles = (height_ + kTileSize - 1) / kTileSize;
+  int num_fields = 0;
+  for (int tile_x = 0; tile_x < width_in_tiles_; ++tile_x) {
+    if (num_interior_fields_in_tile_columns_[tile_x] == 0) {
+      continue;
+    }
+    for (int i = 0; i < kTileSize; ++i) {
+      for (int tile_y = 0; tile_y < height_in_tiles; ++tile_y) {
+        const Tile* const tile = tiles_[tile_x + width_in_tiles_ * tile_y].load(
+            std::memory_order_relaxed);
+        for (uint64 column = tile->interior_fields[i]; column != 0;
+             column &= column - 1) {
+          fields->push_back(
+              FieldCoordinate(tile_x * kTileSize + i,
+                              tile_y * kTileSize + __builtin_ctzll(column)));
+          if (++num_fields == max_fields) {
+            return;
+          }
+        }
+      }
+    }
+  }
+}
+
+namespace {
+// The narrowing operations of ConfigurationInternTable, as functors for
+// MineSeekerState::NarrowConfigurations.
+class RemoveNarrowing {
+ public:
+  explicit RemoveNarrowing(int configuration) : configuration_(configuration) {}
+  int operator()(ConfigurationInternTable* table, int handle) const {
+    return table->Remove(handle, configuration_);
+  }
+
+ private:
+  const int configuration_;
+};
+
+class RemoveAllNarrowing {
+ public:
+  explicit RemoveAllNarrowing(const ConfigurationSet& removed)
+      : removed_(removed) {}
+  int operator()(ConfigurationInternTable* table, int handle) const {
+    return table->RemoveAll(handle, removed_);
+  }
+
+ private:
+  const ConfigurationSet& removed_;
+};
+
+class FilterByNeighborsNarrowing {
+ public:
+  FilterByNeighborsNarrowing(int known_neighbors,
+                             int mine_neighbors,
+                             int num_mines)
+      : known_neighbors_(known_neighbors),
+        mine_neighbors_(mine_neighbors),
+        num_mines_(num_mines) {}
+  int operator()(ConfigurationInternTable* table, int handle) const {
+    return table->FilterByNeighbors(handle, known_neighbors_,
+                                    mine_neighbors_, num_mines_);
+  }
+
+ private:
+  const int known_neighbors_;
+  const int mine_neighbors_;
+  const int num_mines_;
+};
+}  // namespace
+
+template<typename Narrowing>
+bool MineSeekerState::NarrowConfigurations(int x,
+                                           int y,
+                                           const Narrowing& narrowing,
+                                           int* old_handle) {
+  CHECK_NOTNULL(old_handle);
+  CheckCoordinates(x, y);
+  *old_handle = configuration_handle(x, y);
+  int new_handle = narrowing(configuration_table_, *old_handle);
+  // A narrowing that does not change the set does not need a private copy of
+  // the tile.
+  if (new_handle == *old_handle) {
+    return false;
+  }
+  std::atomic<int>* const handle =
+      &MutableTile(x, y)->configuration_handles[FieldIndexInTile(x, y)];
+  while (!handle->compare_exchange_weak(*old_handle, new_handle,
+                                        std::memory_order_relaxed)) {
+    // Another thread narrowed the set first; the narrowing is repeated on its
+    // result.
+    new_handle = narrowing(configuration_table_, *old_handle);
+    if (new_handle == *old_handle) {
+      return false;
+    }
+  }
+  CountFieldsWithoutConfigurations(*old_handle, new_handle);
+  return true;
 }
 
-void MineSeekerField::RemoveConfiguration(int configuration) {
+bool MineSeekerState::RemoveConfiguration(int x,
+                                          int y,
+                                          int configuration,
+                                          int* old_handle) {
   CHECK_GE(configuration, 0);
-  CHECK_LT(configuration, kNumPossibleConfigurations);
-  configurations_[configuration] = false;
+  CHECK_LT(configuration, MineSeekerField::kNumPossibleConfigurations);
+  return NarrowConfigurations(x, y, RemoveNarrowing(configuration),
+                              old_handle);
+}
+
+bool MineSeekerState::RemoveConfigurations(int x,
+                                           int y,
+                                           const ConfigurationSet& removed,
+                                           int* old_handle) {
+  return NarrowConfigurations(x, y, RemoveAllNarrowing(removed), old_handle);
 }
 
-void MineSeekerField::ResetConfigurations() {
-  configurations_.clear();
-  configurations_.resize(256, true);
+bool MineSeekerState::FilterConfigurationsByNeighbors(int x,
+                                                      int y,
+                                                      int known_neighbors,
+                                                      int mine_neighbors,
+                                                      int num_mines,
+                                                      int* old_handle) {
+  return NarrowConfigurations(
+      x, y,
+      FilterByNeighborsNarrowing(known_neighbors, mine_neighbors, num_mines),
+      old_handle);
 }
 
-void MineSeekerField::SetConfiguration(int configuration) {
+void MineSeekerState::SetConfiguration(int x, int y, int configuration) {
   CHECK_GE(configuration, 0);
-  CHECK_LT(configuration, kNumPossibleConfigurations);
-  CHECK(configurations_[configuration]);
-  std::fill(configurations_.begin(), configurations_.end(), false);
-  configurations_[configuration] = true;
+  CHECK_LT(configuration, MineSeekerField::kNumPossibleConfigurations);
+  CHECK(configurations(x, y)[configuration]);
+  ConfigurationSet bound_configurations;
+  bound_configurations.set(configuration);
+  set_configuration_handle(x, y,
+                           configuration_table_->Intern(bound_configurations));
+}
+
+int MineSeekerState::InitialConfigurationHandle(int x, int y) const {
+  CheckCoordinates(x, y);
+  const int handle =
+      border_set_handles_[OutsideNeighbors(x, y, width_, height_)];
+  DCHECK_GE(handle, 0);
+  return handle;
+}
+
+void MineSeekerState::CompactConfigurationTable() {
+  CHECK(!has_concurrent_changes_);
+  ConfigurationInternTable* const table =
+      new ConfigurationInternTable(configuration_table_->max_sets());
+  std::unordered_map<int, int> handles;
+  for (int i = 0; i < ARRAYSIZE(border_set_handles_); ++i) {
+    if (border_set_handles_[i] >= 0) {
+      border_set_handles_[i] = ReinternHandle(*configuration_table_, table,
+                                              &handles, border_set_handles_[i]);
+    }
+  }
+  // The old tiles are released only at the end, so that the address of a
+  // released tile is not reused by a copy while it is still in 'copies'.
+  std::unordered_map<const Tile*, Tile*> copies;
+  vector<Tile*> old_tiles;
+  old_tiles.reserve(tiles_.size());
+  for (int i = 0; i < tiles_.size(); ++i) {
+    Tile* const tile = tiles_[i].load(std::memory_order_relaxed);
+    Tile** const copy = &copies[tile];
+    if (*copy == NULL) {
+      *copy = new Tile(*tile);
+      for (int j = 0; j < kFieldsPerTile; ++j) {
+        std::atomic<int>* const handle = &(*copy)->configuration_handles[j];
+        handle->store(ReinternHandle(*configuration_table_, table, &handles,
+                                     handle->load(std::memory_order_relaxed)),
+                      std::memory_order_relaxed);
+      }
+    } else {
+      (*copy)->Ref();
+    }
+    tiles_[i].store(*copy, std::memory_order_relaxed);
+    old_tiles.push_back(tile);
+  }
+  for (int i = 0; i < old_tiles.size(); ++i) {
+    old_tiles[i]->Unref();
+  }
+  configuration_table_->Unref();
+  configuration_table_ = table;
+}
+
+void MineSeekerState::ResetTemporaryStatuses() {
+  for (int i = 0; i < tiles_.size(); ++i) {
+    const int8* const statuses =
+        tiles_[i].load(std::memory_order_relaxed)->temporary_statuses;
+    if (std::count(statuses, statuses + kFieldsPerTile, 0) == kFieldsPerTile) {
+      continue;
+    }
+    Tile* const tile = MutableTile((i % width_in_tiles_) * kTileSize,
+                                   (i / width_in_tiles_) * kTileSize);
+    std::fill(tile->temporary_statuses,
+              tile->temporary_statuses + kFieldsPerTile, 0);
+  }
+}
+
+const int64 MineSeeker::kMaxEnumerationNodes = 1 << 20;
+
+// Processing a work item reads and changes fields up to five fields away from
+// the field of the item (e.g. the subset rule marks a mine three fields away
+// and queues the neighbors of this mine for update). The tiles of the same
+// color are separated by a whole tile, so the tiles must be at least twice as
+// large as this reach.
+const int MineSeeker::kPropagationTileSize = 32;
+const int MineSeeker::kFrontierConstraintFlag = 1;
+const int MineSeeker::kProvenSafeFlag = 2;
+
+thread_local MineSeeker::PropagationTile*
+    MineSeeker::current_propagation_tile_ = NULL;
+
+// A square tile of the board for parallel propagation. The tile has its own
+// queues with the work items whose (first) field lies in the tile. Work items
+// for fields in other tiles are posted to the mailboxes of these tiles, and
+// they are moved to the queues when the tile is processed the next time.
+//
+// The tiles are colored with four colors by the parity of their coordinates,
+// and only tiles of the same color are processed at the same time. Processing
+// a work item reaches at most a few fields from the tile, so the tiles that run
+// concurrently never touch the same fields; the fields at the borders of the
+// neighboring tiles serve as ghost margins that are changed directly.
+struct MineSeeker::PropagationTile {
+  PropagationTile(int tile_index, int tile_color)
+      : index(tile_index), color(tile_color) {}
+
+  bool HasWork() const {
+    return !uncover_queue.empty() || !update_queue.empty()
+        || !subset_update_queue.empty() || !pair_update_queue.empty()
+        || !mailbox.empty();
+  }
+
+  const int index;
+  const int color;
+  std::deque<FieldCoordinate> uncover_queue;
+  std::deque<FieldCoordinate> update_queue;
+  std::deque<FieldCoordinate> subset_update_queue;
+  std::deque<CoordinatePair> pair_update_queue;
+  Mailbox<TrailEntry> mailbox;
+  // The fields whose state was changed by the tile. Their neighbors may lie in
+  // other tiles, so the frontier constraint fields are updated around them
+  // after the parallel step.
+  vector<FieldCoordinate> changed_fields;
+  // The counters collected while processing the tile.
+  SolverStatistics statistics;
+};
+
+inline SolverStatistics* MineSeeker::mutable_statistics() {
+  return current_propagation_tile_ != NULL
+      ? &current_propagation_tile_->statistics : &statistics_;
 }
 
+// Processes a list of tiles of the same color in parallel.
+class MineSeeker::PropagationTileTask : public ThreadPool::Task {
+ public:
+  PropagationTileTask(MineSeeker* mine_seeker,
+                      const vector<PropagationTile*>& tiles)
+      : mine_seeker_(mine_seeker), tiles_(tiles) {}
+
+  virtual void Run(int item) {
+    mine_seeker_->ProcessPropagationTile(tiles_[item]);
+  }
+
+ private:
+  MineSeeker* const mine_seeker_;
+  const vector<PropagationTile*>& tiles_;
+};
+
 MineSeeker::MineSeeker(const MineSweeper& mine_sweeper)
     : mine_sweeper_(mine_sweeper),
+      mine_sweeper_version_(mine_sweeper.version()),
+      num_sets_after_compaction_(0),
       is_dead_(false),
-      safe_field_requests_(-1) {
+      safe_field_requests_(-1),
+      guesses_(0),
+      use_hints_(mine_sweeper.representation() != MineSweeper::INTERACTIVE
+                 && mine_sweeper.representation() != MineSweeper::OBSERVED),
+      use_pattern_cache_(true),
+      use_deduction_tables_(true),
+      frontier_version_(0),
+      probed_frontier_version_(0),
+      enumerated_frontier_version_(0),
+      uses_local_tiers_as_fallback_(false),
+      has_incomplete_enumeration_(false),
+      collects_proven_safe_fields_(false),
+      propagation_width_in_tiles_(0),
+      kernels_(SelectNeighborhoodKernels(mine_sweeper.width(),
+                                         mine_sweeper.height())) {
+  CHECK(mine_sweeper_.is_closed());
+  ResetState();
+  AddPropagationTiers();
+  if (mine_sweeper_.representation() == MineSweeper::OBSERVED) {
+    LoadObservedFields();
+  }
+}
+
+MineSeeker::MineSeeker(const MineSeeker& other)
+    : uncover_queue_(other.uncover_queue_),
+      update_queue_(other.update_queue_),
+      subset_update_queue_(other.subset_update_queue_),
+      pair_update_queue_(other.pair_update_queue_),
+      mine_sweeper_(other.mine_sweeper_),
+      mine_sweeper_version_(other.mine_sweeper_version_),
+      state_(other.state_),
+      num_sets_after_compaction_(other.num_sets_after_compaction_),
+      is_dead_(other.is_dead_.load()),
+      safe_field_requests_(other.safe_field_requests_),
+      guesses_(other.guesses_),
+      use_hints_(other.use_hints_),
+      use_pattern_cache_(other.use_pattern_cache_),
+      use_deduction_tables_(other.use_deduction_tables_),
+      frontier_version_(other.frontier_version_.load()),
+      probed_frontier_version_(other.probed_frontier_version_),
+      enumerated_frontier_version_(other.enumerated_frontier_version_),
+      frontier_constraint_fields_(other.frontier_constraint_fields_),
+      enumerated_components_(other.enumerated_components_),
+      uses_local_tiers_as_fallback_(other.uses_local_tiers_as_fallback_),
+      has_incomplete_enumeration_(other.has_incomplete_enumeration_),
+      proven_safe_fields_(other.proven_safe_fields_),
+      collects_proven_safe_fields_(other.collects_proven_safe_fields_),
+      proven_mines_(other.proven_mines_),
+      propagation_width_in_tiles_(0),
+      kernels_(other.kernels_),
+      statistics_(other.statistics_) {
+  AddPropagationTiers();
+  for (int tier = 0; tier < scheduler_.num_tiers(); ++tier) {
+    scheduler_.set_tier_budget(tier, other.scheduler_.tier_budget(tier));
+  }
+}
+
+MineSeeker::~MineSeeker() {
+  for (int i = 0; i < propagation_tiles_.size(); ++i) {
+    delete propagation_tiles_[i];
+  }
+}
+
+void MineSeeker::Restart() {
   CHECK(mine_sweeper_.is_closed());
+  CHECK(checkpoints_.empty());
+  uncover_queue_.clear();
+  update_queue_.clear();
+  subset_update_queue_.clear();
+  pair_update_queue_.clear();
+  mine_sweeper_version_ = mine_sweeper_.version();
+  is_dead_ = false;
+  safe_field_requests_ = -1;
+  guesses_ = 0;
+  // The probing and the enumeration tiers run again after a change of the
+  // version of the frontier.
+  ++frontier_version_;
+  enumerated_components_.clear();
+  has_incomplete_enumeration_ = false;
+  proven_safe_fields_.clear();
+  collects_proven_safe_fields_ = false;
+  proven_mines_.clear();
+  trail_.clear();
+  // The propagation tiles are created again for the new size of the board on
+  // the first parallel step.
+  for (int i = 0; i < propagation_tiles_.size(); ++i) {
+    delete propagation_tiles_[i];
+  }
+  propagation_tiles_.clear();
+  propagation_width_in_tiles_ = 0;
+  kernels_ = SelectNeighborhoodKernels(mine_sweeper_.width(),
+                                       mine_sweeper_.height());
   ResetState();
+  if (mine_sweeper_.representation() == MineSweeper::OBSERVED) {
+    LoadObservedFields();
+  }
+}
+
+void MineSeeker::AddPropagationTiers() {
+  typedef MethodPropagationTier<MineSeeker> Tier;
+  const int64 kUnlimited = PropagationScheduler::kUnlimitedBudget;
+  CHECK_EQ(PARALLEL_PROPAGATION_TIER, scheduler_.AddTier(
+      "parallel",
+      new Tier(this, &MineSeeker::HasPendingParallelPropagation,
+               &MineSeeker::RunParallelPropagationStep),
+      kUnlimited));
+  CHECK_EQ(REVEAL_TIER, scheduler_.AddTier(
+      "reveal",
+      new Tier(this, &MineSeeker::HasPendingUncovers,
+               &MineSeeker::RunRevealStep),
+      kUnlimited));
+  CHECK_EQ(FILTER_TIER, scheduler_.AddTier(
+      "filter",
+      new Tier(this, &MineSeeker::HasPendingUpdates,
+               &MineSeeker::RunFilterStep),
+      kUnlimited));
+  CHECK_EQ(SUBSET_TIER, scheduler_.AddTier(
+      "subset",
+      new Tier(this, &MineSeeker::HasPendingSubsetUpdates,
+               &MineSeeker::RunSubsetStep),
+      kUnlimited));
+  CHECK_EQ(PAIR_TIER, scheduler_.AddTier(
+      "pair",
+      new Tier(this, &MineSeeker::HasPendingPairUpdates,
+               &MineSeeker::RunPairStep),
+      kUnlimited));
+  CHECK_EQ(PROBING_TIER, scheduler_.AddTier(
+      "probing",
+      new Tier(this, &MineSeeker::HasPendingProbing,
+               &MineSeeker::RunProbingStep),
+      kUnlimited));
+  CHECK_EQ(ENUMERATION_TIER, scheduler_.AddTier(
+      "enumeration",
+      new Tier(this, &MineSeeker::HasPendingEnumeration,
+               &MineSeeker::RunEnumerationStep),
+      kUnlimited));
+  CHECK_EQ(GUESS_TIER, scheduler_.AddTier(
+      "guess",
+      new Tier(this, &MineSeeker::HasPendingGuess,
+               &MineSeeker::RunGuessStep),
+      kUnlimited));
+  if (statistics_.phases.empty()) {
+    statistics_.phases.resize(scheduler_.num_tiers());
+    for (int tier = 0; tier < scheduler_.num_tiers(); ++tier) {
+      statistics_.phases[tier].name = scheduler_.tier_name(tier);
+    }
+  }
+}
+
+void MineSeeker::UseEnumerationInsteadOfLocalTiers() {
+  uses_local_tiers_as_fallback_ = true;
+}
+
+void MineSeeker::GetStatistics(SolverStatistics* statistics) const {
+  CHECK_NOTNULL(statistics);
+  *statistics = statistics_;
+  statistics->safe_field_requests = safe_field_requests_;
+  statistics->guesses = guesses_;
+  for (int tier = 0; tier < scheduler_.num_tiers(); ++tier) {
+    const PropagationTierStatistics& tier_statistics =
+        scheduler_.tier_statistics(tier);
+    SolverStatistics::Phase* const phase = &statistics->phases[tier];
+    phase->num_steps = tier_statistics.num_steps;
+    phase->time_ns = tier_statistics.total_time_ns;
+  }
+}
+
+void MineSeeker::CountConfigurationRemovals(int x, int y, int old_handle) {
+  const ConfigurationInternTable* const table = state_.configuration_table();
+  mutable_statistics()->num_configuration_removals +=
+      table->Get(old_handle).count() - state_.configurations(x, y).count();
+}
+
+void MineSeeker::CountResolvedField() {
+  const int tier = scheduler_.current_tier();
+  ++mutable_statistics()->phases[tier >= 0 ? tier : GUESS_TIER]
+      .num_resolved_fields;
 }
 
 void MineSeeker::CheckCoordinatesAreValid(int x, int y) const {
@@ -150,11 +968,11 @@ bool MineSeeker::ConfigurationFitsAt(int configuration, int x, int y) const {
 
 void MineSeeker::DebugString(string* out) const {
   std::stringstream out_stream;
-  out_stream << "Is dead: " << is_dead_ << std::endl;
+  out_stream << "Is dead: " << is_dead() << std::endl;
   out_stream << "Safe spots: " << safe_field_requests_ << std::endl;
   for (int y = 0; y < mine_sweeper_.height(); ++y) {
     for (int x = 0; x < mine_sweeper_.width(); ++x) {
-      switch (StateAtPosition(x, y)) {
+      switch (state_.state(x, y)) {
         case MineSeekerField::HIDDEN:
           out_stream << '.';
           break;
@@ -162,7 +980,7 @@ void MineSeeker::DebugString(string* out) const {
           out_stream << '*';
           break;
         case MineSeekerField::UNCOVERED:
-          const int num_mines = NumberOfMinesAroundField(x, y);
+          const int num_mines = mine_sweeper_.NumberOfMinesAroundField(x, y);
           if (num_mines == 0) {
             out_stream << ' ';
           } else {
@@ -173,244 +991,1193 @@ void MineSeeker::DebugString(string* out) const {
     }
     out_stream << std::endl;
   }
-  *out = out_stream.str();
+  *out = out_stream.str();
+}
+
+MineSeekerField MineSeeker::FieldAtPosition(int x, int y) const {
+  CheckCoordinatesAreValid(x, y);
+  return state_.Field(x, y);
+}
+
+int MineSeeker::HiddenNeighborMask(int x,
+                                   int y,
+                                   int anchor_x,
+                                   int anchor_y,
+                                   int* remaining_mines) const {
+  CHECK_NOTNULL(remaining_mines);
+  int mask = 0;
+  int num_mines = NumberOfMinesAroundField(x, y);
+  for (int i = -1; i <= 1; ++i) {
+    for (int j = -1; j <= 1; ++j) {
+      if (i == 0 && j == 0) {
+        continue;
+      }
+      const int neighbor_x = x + i;
+      const int neighbor_y = y + j;
+      switch (StateAtPosition(neighbor_x, neighbor_y)) {
+        case MineSeekerField::HIDDEN: {
+          const int window_x = neighbor_x - anchor_x;
+          const int window_y = neighbor_y - anchor_y;
+          DCHECK_GE(window_x, 0);
+          DCHECK_LT(window_x, 5);
+          DCHECK_GE(window_y, 0);
+          DCHECK_LT(window_y, 5);
+          mask |= 1 << (window_x + 5 * window_y);
+          break;
+        }
+        case MineSeekerField::MINE:
+          --num_mines;
+          break;
+        case MineSeekerField::UNCOVERED:
+          break;
+      }
+    }
+  }
+  *remaining_mines = num_mines;
+  return mask;
+}
+
+double MineSeeker::ComputeMineProbabilities(
+    int max_interior_fields,
+    vector<FieldGuess>* guesses) const {
+  CHECK_NOTNULL(guesses);
+  guesses->clear();
+  const Frontier frontier(*this);
+  vector<vector<int> > components;
+  frontier.GetComponents(&components);
+
+  // Compute the probabilities of the fields on the frontier, and estimate the
+  // number of mines on the frontier.
+  double expected_frontier_mines = 0.0;
+  // The frontier usually did not change since the last enumeration step, so
+  // the results are taken from its cache.
+  ComponentEnumerationCache cache;
+  for (int i = 0; i < components.size(); ++i) {
+    const vector<int>& component = components[i];
+    const ComponentEnumeration& enumeration =
+        EnumerateFrontierComponent(frontier, component, &cache);
+    const int64 num_solutions = enumeration.num_solutions;
+    const vector<int64>& num_mines = enumeration.num_mines;
+    if (!enumeration.is_complete || num_solutions == 0) {
+      continue;
+    }
+    for (int j = 0; j < component.size(); ++j) {
+      const double probability =
+          static_cast<double>(num_mines[j]) / num_solutions;
+      expected_frontier_mines += probability;
+      guesses->push_back(
+          FieldGuess(frontier.variable(component[j]), probability));
+    }
+  }
+
+  // The remaining mines are distributed uniformly among the hidden fields that
+  // are not on the frontier. The mines and the interior fields are counted by
+  // the state, and the interior fields are collected from its bitmaps.
+  const int num_found_mines = state_.num_mine_fields();
+  const int num_interior_fields = state_.num_interior_fields();
+  DCHECK_EQ(state_.num_hidden_fields() - frontier.num_variables(),
+            num_interior_fields);
+  if (num_interior_fields <= 0) {
+    return 0.0;
+  }
+  const double interior_mines = std::max(
+      0.0,
+      mine_sweeper_.NumberOfMines() - num_found_mines
+          - expected_frontier_mines);
+  const double interior_probability = interior_mines / num_interior_fields;
+  vector<FieldCoordinate> interior_fields;
+  state_.CollectInteriorFields(max_interior_fields, &interior_fields);
+  for (int i = 0; i < interior_fields.size(); ++i) {
+    guesses->push_back(FieldGuess(interior_fields[i], interior_probability));
+  }
+  return interior_probability;
+}
+
+bool MineSeeker::GetGuessFieldCoordinates(
+    FieldCoordinate* coordinates) const {
+  CHECK_NOTNULL(coordinates);
+  // All interior fields have the same probability, so only the first one is
+  // considered.
+  vector<FieldGuess> guesses;
+  ComputeMineProbabilities(1, &guesses);
+  double best_probability = 2.0;
+  for (int i = 0; i < guesses.size(); ++i) {
+    if (guesses[i].mine_probability < best_probability) {
+      best_probability = guesses[i].mine_probability;
+      *coordinates = guesses[i].field;
+    }
+  }
+  if (best_probability > 1.0) {
+    return false;
+  }
+  LOG(INFO) << "Guessing " << coordinates->x << " " << coordinates->y
+            << " with mine probability " << best_probability;
+  return true;
+}
+
+bool MineSeeker::GetSafeFieldCoordinates(FieldCoordinate* coordinates) {
+  CHECK_NOTNULL(coordinates);
+  // The hints look at the mines of the hidden fields, which would uncover
+  // them in an interactive game.
+  CHECK_NE(MineSweeper::INTERACTIVE, mine_sweeper_.representation())
+      << "Hints are not available in an interactive game";
+  CHECK_NE(MineSweeper::OBSERVED, mine_sweeper_.representation())
+      << "Hints are not available in an observed game";
+  VLOG(1) << "Asking for a hint";
+  ++safe_field_requests_;
+  // The hidden fields are collected from the state plane by rows, but the hints
+  // are given by columns: the hint is the first safe field in the order of
+  // (x, y), preferring fields with no mines around.
+  vector<FieldCoordinate> hidden_fields;
+  state_.CollectHiddenFields(&hidden_fields);
+  const FieldCoordinate* best_hint = NULL;
+  bool best_hint_is_empty = false;
+  for (int i = 0; i < hidden_fields.size(); ++i) {
+    const FieldCoordinate& field = hidden_fields[i];
+    if (mine_sweeper_.IsMine(field.x, field.y)) {
+      continue;
+    }
+    const bool is_empty =
+        0 == mine_sweeper_.NumberOfMinesAroundField(field.x, field.y);
+    if (best_hint == NULL
+        || (is_empty && !best_hint_is_empty)
+        || (is_empty == best_hint_is_empty
+            && (field.x < best_hint->x
+                || (field.x == best_hint->x && field.y < best_hint->y)))) {
+      best_hint = &field;
+      best_hint_is_empty = is_empty;
+    }
+  }
+  if (best_hint == NULL) {
+    LOG(INFO) << "No hint :(";
+    return false;
+  }
+  *coordinates = *best_hint;
+  VLOG(1) << "Got hint: " << coordinates->x << " " << coordinates->y;
+  Tracer::RecordInstant(Tracer::HINT, coordinates->x, coordinates->y);
+  return true;
+}
+
+MineSeekerField::State MineSeeker::StateAtPosition(int x, int y) const {
+  if (x < 0
+      || y < 0
+      || x >= mine_sweeper_.width()
+      || y >= mine_sweeper_.height()) {
+    return MineSeekerField::UNCOVERED;
+  }
+  return state_.state(x, y);
+}
+
+bool MineSeeker::IsPossibleMineAt(int x, int y) const {
+  if (x < 0
+      || y < 0
+      || x >= mine_sweeper_.width()
+      || y >= mine_sweeper_.height()) {
+    return false;
+  }
+  return state_.state(x, y) != MineSeekerField::UNCOVERED;
+}
+
+bool MineSeeker::IsSolved() const {
+  return is_dead_ || state_.num_hidden_fields() == 0;
+}
+
+void MineSeeker::MarkAsMine(int x, int y) {
+  if (x < 0
+      || y < 0
+      || x >= mine_sweeper_.width()
+      || y >= mine_sweeper_.height()) {
+    return;
+  }
+  VLOG(1) << "Found mine at " << x << " " << y;
+  const MineSeekerField::State state = StateAtPosition(x, y);
+  switch (state) {
+    case MineSeekerField::HIDDEN:
+      // Another thread may mark the field at the same time; only the one that
+      // changed the state updates the neighbors.
+      if (TransitionFieldFromHidden(x, y, MineSeekerField::MINE)) {
+        ++frontier_version_;
+        CountResolvedField();
+        if (collects_proven_safe_fields_) {
+          proven_mines_.push_back(FieldCoordinate(x, y));
+        }
+        Tracer::RecordInstant(Tracer::MARK_MINE, x, y);
+        QueueNeighborsForUpdate(x, y);
+      }
+    case MineSeekerField::MINE:
+      break;
+    default:
+      LOG(FATAL) << "Invalid field state: " << state;
+  }
+
+  if (VLOG_IS_ON(1)) {
+    string debug_output;
+    DebugString(&debug_output);
+    VLOG(1) << debug_output;
+  }
+}
+
+int MineSeeker::NumberOfMinesAroundField(int x, int y) const {
+  if (StateAtPosition(x, y) == MineSeekerField::UNCOVERED) {
+    return mine_sweeper_.NumberOfMinesAroundField(x, y);
+  } else {
+    return -1;
+  }
+}
+
+void MineSeeker::GetFrontierConstraintFields(vector<int>* fields) const {
+  CHECK_NOTNULL(fields);
+  fields->assign(frontier_constraint_fields_.begin(),
+                 frontier_constraint_fields_.end());
+  std::sort(fields->begin(), fields->end());
+}
+
+bool MineSeeker::IsFrontierConstraintField(int x, int y) const {
+  if (state_.state(x, y) != MineSeekerField::UNCOVERED) {
+    return false;
+  }
+  // The number is looked up last, because it may be more expensive than the
+  // states of the neighbors (e.g. for a window of a procedural mine field).
+  for (int bit = 0; bit < kNumNeighbors; ++bit) {
+    if (StateAtPosition(x + kNeighborOffsetX[bit], y + kNeighborOffsetY[bit])
+        == MineSeekerField::HIDDEN) {
+      return mine_sweeper_.NumberOfMinesAroundField(x, y) > 0;
+    }
+  }
+  return false;
+}
+
+void MineSeeker::UpdateFrontierConstraintFieldsAround(int x, int y) {
+  if (current_propagation_tile_ != NULL) {
+    current_propagation_tile_->changed_fields.push_back(
+        FieldCoordinate(x, y));
+    return;
+  }
+  int changed_constraints_x[9];
+  int changed_constraints_y[9];
+  int num_changed_constraints = 0;
+  for (int j = -1; j <= 1; ++j) {
+    for (int i = -1; i <= 1; ++i) {
+      const int field_x = x + i;
+      const int field_y = y + j;
+      if (field_x < 0 || field_x >= mine_sweeper_.width()
+          || field_y < 0 || field_y >= mine_sweeper_.height()) {
+        continue;
+      }
+      const int flags = state_.flags(field_x, field_y);
+      const bool was_constraint = (flags & kFrontierConstraintFlag) != 0;
+      const bool is_constraint = IsFrontierConstraintField(field_x, field_y);
+      if (is_constraint == was_constraint) {
+        continue;
+      }
+      const int index = field_y * mine_sweeper_.width() + field_x;
+      if (is_constraint) {
+        frontier_constraint_fields_.insert(index);
+      } else {
+        frontier_constraint_fields_.erase(index);
+      }
+      state_.set_flags(field_x, field_y, flags ^ kFrontierConstraintFlag);
+      changed_constraints_x[num_changed_constraints] = field_x;
+      changed_constraints_y[num_changed_constraints] = field_y;
+      ++num_changed_constraints;
+    }
+  }
+  // The field itself may stop being hidden, and the neighbors of the changed
+  // constraint fields may move between the frontier and the interior.
+  UpdateInteriorField(x, y);
+  for (int k = 0; k < num_changed_constraints; ++k) {
+    for (int bit = 0; bit < kNumNeighbors; ++bit) {
+      UpdateInteriorField(changed_constraints_x[k] + kNeighborOffsetX[bit],
+                          changed_constraints_y[k] + kNeighborOffsetY[bit]);
+    }
+  }
+}
+
+void MineSeeker::UpdateInteriorField(int x, int y) {
+  if (x < 0 || x >= mine_sweeper_.width()
+      || y < 0 || y >= mine_sweeper_.height()) {
+    return;
+  }
+  bool is_interior = state_.state(x, y) == MineSeekerField::HIDDEN;
+  for (int bit = 0; bit < kNumNeighbors && is_interior; ++bit) {
+    const int neighbor_x = x + kNeighborOffsetX[bit];
+    const int neighbor_y = y + kNeighborOffsetY[bit];
+    if (neighbor_x >= 0 && neighbor_x < mine_sweeper_.width()
+        && neighbor_y >= 0 && neighbor_y < mine_sweeper_.height()
+        && (state_.flags(neighbor_x, neighbor_y)
+            & kFrontierConstraintFlag) != 0) {
+      is_interior = false;
+    }
+  }
+  state_.set_is_interior(x, y, is_interior);
+}
+
+void MineSeeker::QueueFieldForUncover(int x, int y) {
+  // The numbers of the fields on the border of a window of a larger mine field
+  // count also the mines outside of the window, which the configurations of
+  // the seeker do not know about; such fields are never uncovered, but they may
+  // still be marked as mines.
+  if (StateAtPosition(x, y) == MineSeekerField::HIDDEN
+      && !mine_sweeper_.IsOnWindowBorder(x, y)) {
+    // The numbers of the hidden fields of an observed game are not known, so
+    // the safe fields are reported instead of uncovered.
+    if (collects_proven_safe_fields_) {
+      const int flags = state_.flags(x, y);
+      if ((flags & kProvenSafeFlag) == 0) {
+        state_.set_flags(x, y, flags | kProvenSafeFlag);
+        proven_safe_fields_.push_back(FieldCoordinate(x, y));
+      }
+      return;
+    }
+    ++mutable_statistics()->num_queue_pushes[SolverStatistics::UNCOVER_QUEUE];
+    if (current_propagation_tile_ != NULL) {
+      PostWorkItem(TrailEntry(TrailEntry::PUSH_UNCOVER, x, y, 0));
+      return;
+    }
+    uncover_queue_.push_back(FieldCoordinate(x, y));
+    RecordTrailEntry(TrailEntry(TrailEntry::PUSH_UNCOVER, x, y, 0));
+  }
+}
+
+void MineSeeker::QueueFieldForUpdate(int x, int y) {
+  if (StateAtPosition(x, y) == MineSeekerField::UNCOVERED
+      && x >= 0 && x < mine_sweeper_.width()
+      && y >= 0 && y < mine_sweeper_.height()
+      && NumberOfMinesAroundField(x, y) > 0) {
+    ++mutable_statistics()->num_queue_pushes[SolverStatistics::UPDATE_QUEUE];
+    if (current_propagation_tile_ != NULL) {
+      PostWorkItem(TrailEntry(TrailEntry::PUSH_UPDATE, x, y, 0));
+      return;
+    }
+    update_queue_.push_back(FieldCoordinate(x, y));
+    RecordTrailEntry(TrailEntry(TrailEntry::PUSH_UPDATE, x, y, 0));
+  }
+}
+
+void MineSeeker::QueueFieldForSubsetUpdate(int x, int y) {
+  if (StateAtPosition(x, y) == MineSeekerField::UNCOVERED
+      && x >= 0 && x < mine_sweeper_.width()
+      && y >= 0 && y < mine_sweeper_.height()
+      && NumberOfMinesAroundField(x, y) > 0) {
+    ++mutable_statistics()->num_queue_pushes[
+        SolverStatistics::SUBSET_UPDATE_QUEUE];
+    if (current_propagation_tile_ != NULL) {
+      PostWorkItem(TrailEntry(TrailEntry::PUSH_SUBSET_UPDATE, x, y, 0));
+      return;
+    }
+    subset_update_queue_.push_back(FieldCoordinate(x, y));
+    RecordTrailEntry(TrailEntry(TrailEntry::PUSH_SUBSET_UPDATE, x, y, 0));
+  }
+}
+
+void MineSeeker::QueueFieldPairForUpdate(int x1, int y1, int x2, int y2) {
+  ++mutable_statistics()->num_queue_pushes[
+      SolverStatistics::PAIR_UPDATE_QUEUE];
+  if (current_propagation_tile_ != NULL) {
+    TrailEntry item(TrailEntry::PUSH_PAIR_UPDATE, x1, y1, 0);
+    item.x2 = x2;
+    item.y2 = y2;
+    PostWorkItem(item);
+    return;
+  }
+  pair_update_queue_.push_back(std::make_pair(FieldCoordinate(x1, y1),
+                                              FieldCoordinate(x2, y2)));
+  if (!checkpoints_.empty()) {
+    TrailEntry entry(TrailEntry::PUSH_PAIR_UPDATE, x1, y1, 0);
+    entry.x2 = x2;
+    entry.y2 = y2;
+    trail_.push_back(entry);
+  }
+}
+
+void MineSeeker::QueueNeighborsForUpdate(int x, int y) {
+  for (int i = -1; i <= 1; ++i) {
+    for (int j = -1; j <= 1; ++j) {
+      if (i != 0 || j != 0) {
+        QueueFieldForUpdate(x + i, y + j);
+        QueueFieldForSubsetUpdate(x + i, y + j);
+      }
+    }
+  }
+  for (int i = -2; i <= 2; ++i) {
+    for (int j = -2; j <= 2; ++j) {
+      if (i != 0 || j != 0) {
+        QueueFieldPairForUpdate(x, y, x + i, y + j);
+        QueueFieldPairForUpdate(x + i, y + j, x, y);
+      }
+    }
+  }
+}
+
+void MineSeeker::ResetTemporaryStatuses() {
+  state_.ResetTemporaryStatuses();
+}
+
+void MineSeeker::ResetState() {
+  // The hidden fields use shared sets of configurations that already exclude
+  // the mines outside of the board.
+  state_.Resize(mine_sweeper_.width(), mine_sweeper_.height());
+  num_sets_after_compaction_ = 0;
+  frontier_constraint_fields_.clear();
+}
+
+bool MineSeeker::Solve() {
+  const std::chrono::steady_clock::time_point start_time =
+      std::chrono::steady_clock::now();
+  if (use_hints_) {
+    FieldCoordinate start_coordinates(-1, -1);
+    if (!GetSafeFieldCoordinates(&start_coordinates)) {
+      LOG(INFO) << "There is no safe start field";
+      return false;
+    }
+
+    UncoverField(start_coordinates.x, start_coordinates.y);
+  } else {
+    // Without hints, the first field is uncovered by the guess tier.
+    safe_field_requests_ = 0;
+  }
+  statistics_.solve_time_ns +=
+      std::chrono::duration_cast<std::chrono::nanoseconds>(
+          std::chrono::steady_clock::now() - start_time).count();
+  return ContinueSolving();
+}
+
+bool MineSeeker::ContinueSolving() {
+  CHECK_EQ(mine_sweeper_version_, mine_sweeper_.version())
+      << "The mine field was changed without calling HandleChangedMine";
+  const std::chrono::steady_clock::time_point start_time =
+      std::chrono::steady_clock::now();
+  while (!IsSolved()) {
+    if (!SolveStep()) {
+      break;
+    }
+  }
+  statistics_.solve_time_ns +=
+      std::chrono::duration_cast<std::chrono::nanoseconds>(
+          std::chrono::steady_clock::now() - start_time).count();
+  return IsSolved() && !is_dead();
+}
+
+void MineSeeker::LoadObservedFields() {
+  CHECK_EQ(MineSweeper::OBSERVED, mine_sweeper_.representation());
+  const int width = mine_sweeper_.width();
+  const int height = mine_sweeper_.height();
+  collects_proven_safe_fields_ = true;
+  // The advice must be fast, and the seeker can't uncover fields by itself.
+  UseEnumerationInsteadOfLocalTiers();
+  scheduler_.set_tier_budget(GUESS_TIER, 0);
+
+  // The filtering of the configurations looks only at the states of the
+  // neighbors, so with all states in place, the configurations of each
+  // uncovered field are final after a single update.
+  for (int y = 0; y < height; ++y) {
+    for (int x = 0; x < width; ++x) {
+      if (mine_sweeper_.IsKnown(x, y)) {
+        LoadObservedField(x, y);
+      }
+    }
+  }
+  ++frontier_version_;
+  for (int y = 0; y < height; ++y) {
+    for (int x = 0; x < width; ++x) {
+      if (state_.state(x, y) == MineSeekerField::UNCOVERED) {
+        UpdateConfigurationsAtPosition(x, y);
+        QueueFieldForSubsetUpdate(x, y);
+      }
+    }
+  }
+}
+
+void MineSeeker::LoadObservedField(int x, int y) {
+  const bool is_flagged = mine_sweeper_.IsMine(x, y);
+  const MineSeekerField::State state = state_.state(x, y);
+  switch (state) {
+    case MineSeekerField::HIDDEN:
+      // A field proven to be safe keeps its flag when it is observed as
+      // flagged, and Advise reports the conflict.
+      TransitionFieldFromHidden(x, y,
+                                is_flagged ? MineSeekerField::MINE
+                                           : MineSeekerField::UNCOVERED);
+      break;
+    case MineSeekerField::MINE:
+      // The field was marked as a mine by the propagation, and it is in
+      // proven_mines_; Advise reports the conflict if it was uncovered.
+      break;
+    default:
+      LOG(FATAL) << "The field " << x << " " << y << " was observed twice";
+  }
+}
+
+void MineSeeker::HandleObservedFields(const vector<FieldCoordinate>& fields) {
+  CHECK_EQ(MineSweeper::OBSERVED, mine_sweeper_.representation());
+  CHECK(collects_proven_safe_fields_);
+  mine_sweeper_version_ += fields.size();
+  for (int i = 0; i < fields.size(); ++i) {
+    CheckCoordinatesAreValid(fields[i].x, fields[i].y);
+    LoadObservedField(fields[i].x, fields[i].y);
+  }
+  ++frontier_version_;
+  // As in LoadObservedFields, the configurations are updated once all states
+  // are in place; only the uncovered fields among the observed fields and
+  // their neighbors can lose configurations, and each of them is updated
+  // once.
+  const int width = mine_sweeper_.width();
+  const int height = mine_sweeper_.height();
+  vector<int> updated_fields;
+  for (int i = 0; i < fields.size(); ++i) {
+    for (int y = std::max(0, fields[i].y - 1);
+         y <= std::min(height - 1, fields[i].y + 1); ++y) {
+      for (int x = std::max(0, fields[i].x - 1);
+           x <= std::min(width - 1, fields[i].x + 1); ++x) {
+        if (state_.state(x, y) == MineSeekerField::UNCOVERED) {
+          updated_fields.push_back(y * width + x);
+        }
+      }
+    }
+  }
+  std::sort(updated_fields.begin(), updated_fields.end());
+  updated_fields.erase(
+      std::unique(updated_fields.begin(), updated_fields.end()),
+      updated_fields.end());
+  for (int i = 0; i < updated_fields.size(); ++i) {
+    const int x = updated_fields[i] % width;
+    const int y = updated_fields[i] / width;
+    UpdateConfigurationsAtPosition(x, y);
+    QueueFieldForSubsetUpdate(x, y);
+  }
+}
+
+namespace {
+// Orders the guesses by the increasing probability of a mine.
+bool HasLowerMineProbability(const MineSeeker::FieldGuess& first,
+                             const MineSeeker::FieldGuess& second) {
+  return first.mine_probability < second.mine_probability;
+}
+}  // namespace
+
+bool MineSeeker::Advise(Advice* advice) {
+  CHECK_NOTNULL(advice);
+  CHECK_EQ(MineSweeper::OBSERVED, mine_sweeper_.representation());
+  ContinueSolving();
+  // The seeker keeps the fields it proved, so the advice visits only them and
+  // the frontier. A number that does not match its neighbors leaves the field
+  // without configurations, which is counted by the state.
+  bool is_consistent = state_.num_fields_without_configurations() == 0;
+  int num_safe_fields = 0;
+  for (int i = 0; i < proven_safe_fields_.size(); ++i) {
+    const FieldCoordinate& field = proven_safe_fields_[i];
+    const bool is_mine =
+        state_.state(field.x, field.y) == MineSeekerField::MINE;
+    if (is_mine) {
+      is_consistent = false;
+    }
+    if (is_mine || !mine_sweeper_.IsKnown(field.x, field.y)) {
+      proven_safe_fields_[num_safe_fields++] = field;
+    }
+  }
+  proven_safe_fields_.resize(num_safe_fields, FieldCoordinate(-1, -1));
+  advice->safe_fields = proven_safe_fields_;
+  advice->mines.clear();
+  int num_mines = 0;
+  for (int i = 0; i < proven_mines_.size(); ++i) {
+    const FieldCoordinate& field = proven_mines_[i];
+    if (!mine_sweeper_.IsKnown(field.x, field.y)) {
+      advice->mines.push_back(field);
+    } else if (!mine_sweeper_.IsMine(field.x, field.y)) {
+      is_consistent = false;
+    } else {
+      continue;
+    }
+    proven_mines_[num_mines++] = field;
+  }
+  proven_mines_.resize(num_mines, FieldCoordinate(-1, -1));
+  // The cache contains the enumerations of the current frontier; a component
+  // without solutions can't be completed by any placement of the mines.
+  for (ComponentEnumerationCache::const_iterator it =
+           enumerated_components_.begin();
+       it != enumerated_components_.end(); ++it) {
+    if (it->second.is_complete && it->second.num_solutions == 0) {
+      is_consistent = false;
+    }
+  }
+
+  // All interior fields have the same probability, so only the first one is
+  // listed.
+  vector<FieldGuess> guesses;
+  advice->interior_mine_probability = ComputeMineProbabilities(1, &guesses);
+  advice->num_interior_fields = state_.num_interior_fields();
+  advice->guesses.clear();
+  for (int i = 0; i < guesses.size(); ++i) {
+    const FieldCoordinate& field = guesses[i].field;
+    if ((state_.flags(field.x, field.y) & kProvenSafeFlag) == 0) {
+      advice->guesses.push_back(guesses[i]);
+    }
+  }
+  std::stable_sort(advice->guesses.begin(), advice->guesses.end(),
+                   HasLowerMineProbability);
+  return is_consistent;
+}
+
+void MineSeeker::HandleChangedMine(int x, int y) {
+  CheckCoordinatesAreValid(x, y);
+  CHECK_EQ(MineSeekerField::HIDDEN, state_.state(x, y));
+  ++mine_sweeper_version_;
+  ++frontier_version_;
+  // The numbers of the neighbors changed, and some of them may become zero.
+  UpdateFrontierConstraintFieldsAround(x, y);
+  for (int bit = 0; bit < kNumNeighbors; ++bit) {
+    const int neighbor_x = x + kNeighborOffsetX[bit];
+    const int neighbor_y = y + kNeighborOffsetY[bit];
+    if (StateAtPosition(neighbor_x, neighbor_y) != MineSeekerField::UNCOVERED
+        || neighbor_x < 0 || neighbor_x >= mine_sweeper_.width()
+        || neighbor_y < 0 || neighbor_y >= mine_sweeper_.height()) {
+      continue;
+    }
+    // The configurations that were removed using the old number may include
+    // the actual configuration of the field, so the field starts again from
+    // all configurations that have no mines outside of the board.
+    SetFieldConfigurationHandle(
+        neighbor_x, neighbor_y,
+        state_.InitialConfigurationHandle(neighbor_x, neighbor_y));
+    // The field is updated directly, because the update queue skips fields
+    // with no mines around them.
+    UpdateConfigurationsAtPosition(neighbor_x, neighbor_y);
+    QueueFieldForSubsetUpdate(neighbor_x, neighbor_y);
+  }
+}
+
+int MineSeeker::PushCheckpoint() {
+  Checkpoint checkpoint;
+  checkpoint.trail_size = trail_.size();
+  checkpoint.is_dead = is_dead_;
+  checkpoint.safe_field_requests = safe_field_requests_;
+  checkpoint.guesses = guesses_;
+  checkpoints_.push_back(checkpoint);
+  return checkpoints_.size();
+}
+
+void MineSeeker::CommitCheckpoint() {
+  CHECK(!checkpoints_.empty());
+  checkpoints_.pop_back();
+  if (checkpoints_.empty()) {
+    trail_.clear();
+  }
+}
+
+void MineSeeker::RollbackToCheckpoint() {
+  CHECK(!checkpoints_.empty());
+  const Checkpoint& checkpoint = checkpoints_.back();
+  while (static_cast<int>(trail_.size()) > checkpoint.trail_size) {
+    UndoTrailEntry(trail_.back());
+    trail_.pop_back();
+  }
+  is_dead_ = checkpoint.is_dead;
+  safe_field_requests_ = checkpoint.safe_field_requests;
+  guesses_ = checkpoint.guesses;
+  checkpoints_.pop_back();
+  // The frontier is different from the one seen by the tiers.
+  ++frontier_version_;
+}
+
+void MineSeeker::UndoTrailEntry(const TrailEntry& entry) {
+  switch (entry.type) {
+    case TrailEntry::SET_CONFIGURATIONS:
+      state_.set_configuration_handle(entry.x, entry.y, entry.value);
+      break;
+    case TrailEntry::SET_STATE:
+      state_.set_state(entry.x, entry.y,
+                       static_cast<MineSeekerField::State>(entry.value));
+      UpdateFrontierConstraintFieldsAround(entry.x, entry.y);
+      break;
+    case TrailEntry::PUSH_UNCOVER:
+      uncover_queue_.pop_back();
+      break;
+    case TrailEntry::PUSH_UPDATE:
+      update_queue_.pop_back();
+      break;
+    case TrailEntry::PUSH_SUBSET_UPDATE:
+      subset_update_queue_.pop_back();
+      break;
+    case TrailEntry::PUSH_PAIR_UPDATE:
+      pair_update_queue_.pop_back();
+      break;
+    case TrailEntry::POP_UNCOVER:
+      uncover_queue_.push_front(FieldCoordinate(entry.x, entry.y));
+      break;
+    case TrailEntry::POP_UPDATE:
+      update_queue_.push_front(FieldCoordinate(entry.x, entry.y));
+      break;
+    case TrailEntry::POP_SUBSET_UPDATE:
+      subset_update_queue_.push_front(FieldCoordinate(entry.x, entry.y));
+      break;
+    case TrailEntry::POP_PAIR_UPDATE:
+      pair_update_queue_.push_front(
+          std::make_pair(FieldCoordinate(entry.x, entry.y),
+                         FieldCoordinate(entry.x2, entry.y2)));
+      break;
+  }
 }
 
-const MineSeekerField& MineSeeker::FieldAtPosition(int x, int y) const {
-  CheckCoordinatesAreValid(x, y);
-  return state_[x][y];
+bool MineSeeker::TransitionFieldFromHidden(int x,
+                                           int y,
+                                           MineSeekerField::State state) {
+  if (!state_.TransitionFromHidden(x, y, state)) {
+    return false;
+  }
+  RecordTrailEntry(
+      TrailEntry(TrailEntry::SET_STATE, x, y, MineSeekerField::HIDDEN));
+  UpdateFrontierConstraintFieldsAround(x, y);
+  return true;
 }
 
-bool MineSeeker::GetSafeFieldCoordinates(FieldCoordinate* coordinates) {
-  CHECK_NOTNULL(coordinates);
-  LOG(INFO) << "Asking for a hint";
-  ++safe_field_requests_;
-  for (int x = 0; x < mine_sweeper_.width(); ++x) {
-    for (int y = 0; y < mine_sweeper_.height(); ++y) {
-      if (MineSeekerField::HIDDEN == StateAtPosition(x, y)
-          && !mine_sweeper_.IsMine(x, y)
-          && 0 == mine_sweeper_.NumberOfMinesAroundField(x, y)) {
-        coordinates->x = x;
-        coordinates->y = y;
-        LOG(INFO) << "Got hint: " << x << " " << y;
-        return true;
-      }
-    }
+bool MineSeeker::RemoveFieldConfiguration(int x, int y, int configuration) {
+  int old_handle = -1;
+  if (!state_.RemoveConfiguration(x, y, configuration, &old_handle)) {
+    return false;
   }
-  for (int x = 0; x < mine_sweeper_.width(); ++x) {
-    for (int y = 0; y < mine_sweeper_.height(); ++y) {
-      if (MineSeekerField::HIDDEN == StateAtPosition(x, y)
-          && !mine_sweeper_.IsMine(x, y)) {
-        coordinates->x = x;
-        coordinates->y = y;
-        LOG(INFO) << "Got hint: " << x << " " << y;
-        return true;
-      }
-    }
+  ++mutable_statistics()->num_configuration_removals;
+  RecordTrailEntry(
+      TrailEntry(TrailEntry::SET_CONFIGURATIONS, x, y, old_handle));
+  return true;
+}
+
+bool MineSeeker::RemoveFieldConfigurations(int x,
+                                           int y,
+                                           const ConfigurationSet& removed) {
+  int old_handle = -1;
+  if (!state_.RemoveConfigurations(x, y, removed, &old_handle)) {
+    return false;
   }
-  LOG(INFO) << "No hint :(";
-  return false;
+  CountConfigurationRemovals(x, y, old_handle);
+  RecordTrailEntry(
+      TrailEntry(TrailEntry::SET_CONFIGURATIONS, x, y, old_handle));
+  return true;
 }
 
-MineSeekerField::State MineSeeker::StateAtPosition(int x, int y) const {
-  if (x < 0
-      || y < 0
-      || x >= mine_sweeper_.width()
-      || y >= mine_sweeper_.height()) {
-    return MineSeekerField::UNCOVERED;
+void MineSeeker::SetFieldConfiguration(int x, int y, int configuration) {
+  const int old_handle = state_.configuration_handle(x, y);
+  state_.SetConfiguration(x, y, configuration);
+  if (state_.configuration_handle(x, y) != old_handle) {
+    CountConfigurationRemovals(x, y, old_handle);
+    RecordTrailEntry(
+        TrailEntry(TrailEntry::SET_CONFIGURATIONS, x, y, old_handle));
   }
-  return state_[x][y].state();
 }
 
-bool MineSeeker::IsPossibleMineAt(int x, int y) const {
-  if (x < 0
-      || y < 0
-      || x >= mine_sweeper_.width()
-      || y >= mine_sweeper_.height()) {
+bool MineSeeker::SetFieldConfigurationHandle(int x, int y, int handle) {
+  const int old_handle = state_.configuration_handle(x, y);
+  if (handle == old_handle) {
     return false;
   }
-  return state_[x][y].IsPossibleMine();
+  state_.set_configuration_handle(x, y, handle);
+  CountConfigurationRemovals(x, y, old_handle);
+  RecordTrailEntry(
+      TrailEntry(TrailEntry::SET_CONFIGURATIONS, x, y, old_handle));
+  return true;
 }
 
-bool MineSeeker::IsSolved() const {
-  if (is_dead_) {
-    return true;
+int MineSeeker::probing_threads() const {
+  return probing_thread_pool_.get() == NULL
+      ? 0 : probing_thread_pool_->num_threads();
+}
+
+void MineSeeker::set_probing_threads(int num_threads) {
+  CHECK_GE(num_threads, 0);
+  probing_thread_pool_.reset(num_threads > 0 ? new ThreadPool(num_threads)
+                                             : NULL);
+}
+
+int MineSeeker::propagation_threads() const {
+  return propagation_thread_pool_.get() == NULL
+      ? 0 : propagation_thread_pool_->num_threads();
+}
+
+void MineSeeker::set_propagation_threads(int num_threads) {
+  CHECK_GE(num_threads, 0);
+  propagation_thread_pool_.reset(num_threads > 0 ? new ThreadPool(num_threads)
+                                                 : NULL);
+}
+
+void MineSeeker::CreatePropagationTiles() {
+  if (!propagation_tiles_.empty()) {
+    return;
   }
-  for (int x = 0; x < mine_sweeper_.width(); ++x) {
-    for (int y = 0; y < mine_sweeper_.height(); ++y) {
-      if (MineSeekerField::HIDDEN == StateAtPosition(x, y)) {
-        return false;
-      }
+  propagation_width_in_tiles_ =
+      (mine_sweeper_.width() + kPropagationTileSize - 1) / kPropagationTileSize;
+  const int height_in_tiles =
+      (mine_sweeper_.height() + kPropagationTileSize - 1)
+      / kPropagationTileSize;
+  for (int tile_y = 0; tile_y < height_in_tiles; ++tile_y) {
+    for (int tile_x = 0; tile_x < propagation_width_in_tiles_; ++tile_x) {
+      const int color = (tile_x % 2) + 2 * (tile_y % 2);
+      PropagationTile* const tile =
+          new PropagationTile(propagation_tiles_.size(), color);
+      tile->statistics.phases.resize(scheduler_.num_tiers());
+      propagation_tiles_.push_back(tile);
     }
   }
-  return true;
 }
 
-void MineSeeker::MarkAsMine(int x, int y) {
-  if (x < 0
-      || y < 0
-      || x >= mine_sweeper_.width()
-      || y >= mine_sweeper_.height()) {
+int MineSeeker::PropagationTileIndex(int x, int y) const {
+  return x / kPropagationTileSize
+      + propagation_width_in_tiles_ * (y / kPropagationTileSize);
+}
+
+void MineSeeker::PostWorkItem(const TrailEntry& item) {
+  // Pairs whose first field is outside of the board are ignored by
+  // UpdatePairConsistency, so they can be dropped right away. The other items
+  // are always inside the board.
+  if (item.x < 0 || item.x >= mine_sweeper_.width()
+      || item.y < 0 || item.y >= mine_sweeper_.height()) {
+    DCHECK_EQ(TrailEntry::PUSH_PAIR_UPDATE, item.type);
     return;
   }
-  LOG(INFO) << "Found mine at " << x << " " << y;
-  const MineSeekerField::State state = StateAtPosition(x, y);
-  switch (state) {
-    case MineSeekerField::HIDDEN:
-      state_[x][y].set_state(MineSeekerField::MINE);
-      QueueNeighborsForUpdate(x, y);
-    case MineSeekerField::MINE:
+  PropagationTile* const tile =
+      propagation_tiles_[PropagationTileIndex(item.x, item.y)];
+  if (current_propagation_tile_ != NULL && current_propagation_tile_ != tile) {
+    tile->mailbox.Post(item);
+    return;
+  }
+  const FieldCoordinate field(item.x, item.y);
+  switch (item.type) {
+    case TrailEntry::PUSH_UNCOVER:
+      tile->uncover_queue.push_back(field);
+      break;
+    case TrailEntry::PUSH_UPDATE:
+      tile->update_queue.push_back(field);
+      break;
+    case TrailEntry::PUSH_SUBSET_UPDATE:
+      tile->subset_update_queue.push_back(field);
+      break;
+    case TrailEntry::PUSH_PAIR_UPDATE:
+      tile->pair_update_queue.push_back(
+          std::make_pair(field, FieldCoordinate(item.x2, item.y2)));
       break;
     default:
-      LOG(FATAL) << "Invalid field state: " << state;
+      LOG(FATAL) << "Invalid work item type: " << item.type;
   }
-
-  string debug_output;
-  DebugString(&debug_output);
-  LOG(INFO) << debug_output;
 }
 
-int MineSeeker::NumberOfMinesAroundField(int x, int y) const {
-  if (StateAtPosition(x, y) == MineSeekerField::UNCOVERED) {
-    return mine_sweeper_.NumberOfMinesAroundField(x, y);
-  } else {
-    return -1;
+void MineSeeker::ProcessPropagationTile(PropagationTile* tile) {
+  CHECK_NOTNULL(tile);
+  current_propagation_tile_ = tile;
+  vector<TrailEntry> messages;
+  tile->mailbox.TakeAll(&messages);
+  for (int i = 0; i < messages.size(); ++i) {
+    PostWorkItem(messages[i]);
   }
-}
-
-void MineSeeker::QueueFieldForUncover(int x, int y) {
-  if (StateAtPosition(x, y) == MineSeekerField::HIDDEN) {
-    uncover_queue_.push(FieldCoordinate(x, y));
+  // The work items are processed with the same priorities as in the
+  // sequential propagation.
+  for (;;) {
+    if (!tile->uncover_queue.empty()) {
+      const FieldCoordinate field = tile->uncover_queue.front();
+      tile->uncover_queue.pop_front();
+      ++tile->statistics.num_queue_pops[SolverStatistics::UNCOVER_QUEUE];
+      if (MineSeekerField::HIDDEN == StateAtPosition(field.x, field.y)) {
+        UncoverField(field.x, field.y);
+      }
+    } else if (!tile->update_queue.empty()) {
+      const FieldCoordinate field = tile->update_queue.front();
+      tile->update_queue.pop_front();
+      ++tile->statistics.num_queue_pops[SolverStatistics::UPDATE_QUEUE];
+      UpdateConfigurationsAtPosition(field.x, field.y);
+    } else if (!tile->subset_update_queue.empty()) {
+      const FieldCoordinate field = tile->subset_update_queue.front();
+      tile->subset_update_queue.pop_front();
+      ++tile->statistics.num_queue_pops[
+          SolverStatistics::SUBSET_UPDATE_QUEUE];
+      UpdateSubsetConsistency(field.x, field.y);
+    } else if (!tile->pair_update_queue.empty()) {
+      const CoordinatePair pair = tile->pair_update_queue.front();
+      tile->pair_update_queue.pop_front();
+      ++tile->statistics.num_queue_pops[SolverStatistics::PAIR_UPDATE_QUEUE];
+      UpdatePairConsistency(pair.first.x, pair.first.y,
+                            pair.second.x, pair.second.y);
+    } else {
+      break;
+    }
   }
+  current_propagation_tile_ = NULL;
 }
 
-void MineSeeker::QueueFieldForUpdate(int x, int y) {
-  if (StateAtPosition(x, y) == MineSeekerField::UNCOVERED
-      && x >= 0 && x < mine_sweeper_.width()
-      && y >= 0 && y < mine_sweeper_.height()
-      && NumberOfMinesAroundField(x, y) > 0) {
-    update_queue_.push(FieldCoordinate(x, y));
-  }
-}
+bool MineSeeker::RunParallelPropagationStep() {
+  CHECK(checkpoints_.empty());
+  CreatePropagationTiles();
+  state_.BeginConcurrentChanges();
 
-void MineSeeker::QueueFieldPairForUpdate(int x1, int y1, int x2, int y2) {
-  pair_update_queue_.push(std::make_pair(FieldCoordinate(x1, y1),
-                                         FieldCoordinate(x2, y2)));
-}
+  // Move the work from the global queues to the tiles.
+  for (int i = 0; i < uncover_queue_.size(); ++i) {
+    const FieldCoordinate& field = uncover_queue_[i];
+    PostWorkItem(TrailEntry(TrailEntry::PUSH_UNCOVER, field.x, field.y, 0));
+  }
+  for (int i = 0; i < update_queue_.size(); ++i) {
+    const FieldCoordinate& field = update_queue_[i];
+    PostWorkItem(TrailEntry(TrailEntry::PUSH_UPDATE, field.x, field.y, 0));
+  }
+  for (int i = 0; i < subset_update_queue_.size(); ++i) {
+    const FieldCoordinate& field = subset_update_queue_[i];
+    PostWorkItem(
+        TrailEntry(TrailEntry::PUSH_SUBSET_UPDATE, field.x, field.y, 0));
+  }
+  for (int i = 0; i < pair_update_queue_.size(); ++i) {
+    const CoordinatePair& pair = pair_update_queue_[i];
+    TrailEntry item(TrailEntry::PUSH_PAIR_UPDATE, pair.first.x, pair.first.y,
+                    0);
+    item.x2 = pair.second.x;
+    item.y2 = pair.second.y;
+    PostWorkItem(item);
+  }
+  uncover_queue_.clear();
+  update_queue_.clear();
+  subset_update_queue_.clear();
+  pair_update_queue_.clear();
 
-void MineSeeker::QueueNeighborsForUpdate(int x, int y) {
-  for (int i = -1; i <= 1; ++i) {
-    for (int j = -1; j <= 1; ++j) {
-      if (i != 0 || j != 0) {
-        QueueFieldForUpdate(x + i, y + j);
+  // Process the tiles color by color, until there is no work left. Each pass
+  // processes the tiles of all four colors.
+  const int kNumColors = 4;
+  vector<PropagationTile*> active_tiles;
+  bool found_work = true;
+  while (found_work) {
+    found_work = false;
+    for (int color = 0; color < kNumColors; ++color) {
+      active_tiles.clear();
+      for (int i = 0; i < propagation_tiles_.size(); ++i) {
+        PropagationTile* const tile = propagation_tiles_[i];
+        if (tile->color == color && tile->HasWork()) {
+          active_tiles.push_back(tile);
+        }
+      }
+      if (!active_tiles.empty()) {
+        found_work = true;
+        PropagationTileTask task(this, active_tiles);
+        propagation_thread_pool_->ParallelFor(active_tiles.size(), &task);
       }
     }
   }
-  for (int i = -2; i <= 2; ++i) {
-    for (int j = -2; j <= 2; ++j) {
-      if (i != 0 || j != 0) {
-        QueueFieldPairForUpdate(x, y, x + i, y + j);
-        QueueFieldPairForUpdate(x + i, y + j, x, y);
-      }
+  state_.EndConcurrentChanges();
+  for (int i = 0; i < propagation_tiles_.size(); ++i) {
+    PropagationTile* const tile = propagation_tiles_[i];
+    for (int j = 0; j < tile->changed_fields.size(); ++j) {
+      const FieldCoordinate& field = tile->changed_fields[j];
+      UpdateFrontierConstraintFieldsAround(field.x, field.y);
     }
+    tile->changed_fields.clear();
+    statistics_.Add(tile->statistics);
+    tile->statistics.Reset();
   }
+  return true;
 }
 
-void MineSeeker::ResetTemporaryStatuses() {
-  for (int x = 0; x < mine_sweeper_.width(); ++x) {
-    for (int y = 0; y < mine_sweeper_.height(); ++y) {
-      state_[x][y].ResetTemporaryStatus();
-    }
-  }
+bool MineSeeker::SolveStep() {
+  MaybeCompactConfigurationTable();
+  return scheduler_.RunStep();
 }
 
-void MineSeeker::ResetState() {
-  state_.clear();
-  state_.resize(mine_sweeper_.width());
-  for (int i = 0; i < state_.size(); ++i) {
-    state_[i].resize(mine_sweeper_.height());
+void MineSeeker::MaybeCompactConfigurationTable() {
+  // The trail refers to the handles of the configurations, so the table can be
+  // compacted only when there are no checkpoints. The table is compacted only
+  // after a quarter of its capacity was filled since the last compaction, so
+  // that the cost of the compaction is amortized even when most of the sets
+  // are still in use.
+  const ConfigurationInternTable* const table = state_.configuration_table();
+  if (!checkpoints_.empty()
+      || table->num_sets() < table->max_sets() / 4 * 3
+      || table->num_sets() - num_sets_after_compaction_
+          < table->max_sets() / 4) {
+    return;
   }
+  const int num_sets = table->num_sets();
+  state_.CompactConfigurationTable();
+  num_sets_after_compaction_ = state_.configuration_table()->num_sets();
+  VLOG(1) << "Compacted the configuration table from " << num_sets << " to "
+          << num_sets_after_compaction_ << " sets";
+}
 
-  // Filter possible configurations for the border.
-  for (int x = 0; x < mine_sweeper_.width(); ++x) {
-    UpdateConfigurationsAtPosition(x, 0);
-    UpdateConfigurationsAtPosition(x, mine_sweeper_.height() - 1);
+FieldCoordinate MineSeeker::PopFieldFromQueue(
+    std::deque<FieldCoordinate>* queue,
+    TrailEntry::Type pop_type) {
+  CHECK_NOTNULL(queue);
+  const FieldCoordinate coordinates = queue->front();
+  queue->pop_front();
+  RecordTrailEntry(TrailEntry(pop_type, coordinates.x, coordinates.y, 0));
+  return coordinates;
+}
+
+bool MineSeeker::RunRevealStep() {
+  const FieldCoordinate coordinates =
+      PopFieldFromQueue(&uncover_queue_, TrailEntry::POP_UNCOVER);
+  ++statistics_.num_queue_pops[SolverStatistics::UNCOVER_QUEUE];
+  if (MineSeekerField::HIDDEN == StateAtPosition(coordinates.x,
+                                                 coordinates.y)) {
+    UncoverField(coordinates.x, coordinates.y);
   }
-  for (int y = 1; y < mine_sweeper_.height() - 1; ++y) {
-    UpdateConfigurationsAtPosition(0, y);
-    UpdateConfigurationsAtPosition(mine_sweeper_.width() - 1, y);
+  return true;
+}
+
+bool MineSeeker::RunFilterStep() {
+  const FieldCoordinate coordinates =
+      PopFieldFromQueue(&update_queue_, TrailEntry::POP_UPDATE);
+  ++statistics_.num_queue_pops[SolverStatistics::UPDATE_QUEUE];
+  UpdateConfigurationsAtPosition(coordinates.x, coordinates.y);
+  return true;
+}
+
+bool MineSeeker::RunSubsetStep() {
+  const FieldCoordinate coordinates =
+      PopFieldFromQueue(&subset_update_queue_, TrailEntry::POP_SUBSET_UPDATE);
+  ++statistics_.num_queue_pops[SolverStatistics::SUBSET_UPDATE_QUEUE];
+  UpdateSubsetConsistency(coordinates.x, coordinates.y);
+  return true;
+}
+
+bool MineSeeker::RunPairStep() {
+  const CoordinatePair pair = pair_update_queue_.front();
+  pair_update_queue_.pop_front();
+  ++statistics_.num_queue_pops[SolverStatistics::PAIR_UPDATE_QUEUE];
+  if (!checkpoints_.empty()) {
+    TrailEntry entry(TrailEntry::POP_PAIR_UPDATE, pair.first.x, pair.first.y,
+                     0);
+    entry.x2 = pair.second.x;
+    entry.y2 = pair.second.y;
+    trail_.push_back(entry);
   }
+  UpdatePairConsistency(pair.first.x, pair.first.y,
+                        pair.second.x, pair.second.y);
+  return true;
 }
 
-bool MineSeeker::Solve() {
-  FieldCoordinate start_coordinates(-1, -1);
-  if (!GetSafeFieldCoordinates(&start_coordinates)) {
-    LOG(INFO) << "There is no safe start field";
-    return false;
+bool MineSeeker::RunProbingStep() {
+  probed_frontier_version_ = frontier_version_;
+  const Frontier frontier(*this);
+  const FailedLiteralProber prober(frontier);
+  vector<FailedLiteralProber::Value> values;
+  if (!prober.ProbeAll(probing_thread_pool_.get(), &values)) {
+    LOG(WARNING) << "Probing found an inconsistent frontier";
+    return true;
+  }
+  for (int i = 0; i < values.size(); ++i) {
+    const FieldCoordinate& field = frontier.variable(i);
+    switch (values[i]) {
+      case FailedLiteralProber::EMPTY:
+        QueueFieldForUncover(field.x, field.y);
+        break;
+      case FailedLiteralProber::MINE:
+        MarkAsMine(field.x, field.y);
+        break;
+      case FailedLiteralProber::UNKNOWN:
+        break;
+    }
   }
+  return true;
+}
 
-  UncoverField(start_coordinates.x, start_coordinates.y);
+const MineSeeker::ComponentEnumeration&
+MineSeeker::EnumerateFrontierComponent(
+    const Frontier& frontier,
+    const vector<int>& component,
+    ComponentEnumerationCache* cache) const {
+  CHECK_NOTNULL(cache);
+  string key;
+  frontier.GetComponentKey(component, &key);
+  ComponentEnumeration* const enumeration = &(*cache)[key];
+  const ComponentEnumerationCache::const_iterator previous =
+      enumerated_components_.find(key);
+  if (previous != enumerated_components_.end()) {
+    *enumeration = previous->second;
+    return *enumeration;
+  }
+  enumeration->is_complete = frontier.EnumerateComponent(
+      component, kMaxEnumerationNodes, &enumeration->num_solutions,
+      &enumeration->num_mines);
+  if (!enumeration->is_complete) {
+    LOG(INFO) << "Enumeration of a component with " << component.size()
+              << " fields exceeded the node limit";
+  }
+  return *enumeration;
+}
 
-  while (!IsSolved()) {
-    if (!SolveStep()) {
-      break;
+bool MineSeeker::RunEnumerationStep() {
+  enumerated_frontier_version_ = frontier_version_;
+  const Frontier frontier(*this);
+  vector<vector<int> > components;
+  frontier.GetComponents(&components);
+  // Only the results for the current frontier are kept, so the size of the
+  // cache is proportional to the size of the frontier.
+  ComponentEnumerationCache cache;
+  // A component that can't be enumerated lets the subset and the pair tiers
+  // run when they are used as a fallback.
+  has_incomplete_enumeration_ = false;
+  for (int i = 0; i < components.size(); ++i) {
+    const vector<int>& component = components[i];
+    const ComponentEnumeration& enumeration =
+        EnumerateFrontierComponent(frontier, component, &cache);
+    const int64 num_solutions = enumeration.num_solutions;
+    const vector<int64>& num_mines = enumeration.num_mines;
+    if (!enumeration.is_complete) {
+      has_incomplete_enumeration_ = true;
+      continue;
+    }
+    if (num_solutions == 0) {
+      LOG(WARNING) << "A component of the frontier has no solution";
+      continue;
+    }
+    for (int j = 0; j < component.size(); ++j) {
+      const FieldCoordinate& field = frontier.variable(component[j]);
+      if (num_mines[j] == 0) {
+        QueueFieldForUncover(field.x, field.y);
+      } else if (num_mines[j] == num_solutions) {
+        MarkAsMine(field.x, field.y);
+      }
     }
   }
-  return IsSolved() && !is_dead();
+  enumerated_components_.swap(cache);
+  return true;
 }
 
-bool MineSeeker::SolveStep() {
-  if (!uncover_queue_.empty()) {
-    const FieldCoordinate& coordinates = uncover_queue_.front();
-    if (MineSeekerField::HIDDEN == StateAtPosition(coordinates.x,
-                                                   coordinates.y)) {
-      UncoverField(coordinates.x, coordinates.y);
+bool MineSeeker::RunGuessStep() {
+  FieldCoordinate field(-1, -1);
+  if (use_hints_) {
+    if (!GetSafeFieldCoordinates(&field)) {
+      return false;
     }
-    uncover_queue_.pop();
-    return true;
-  } else if (!update_queue_.empty()) {
-    const FieldCoordinate& coordinates = update_queue_.front();
-    UpdateConfigurationsAtPosition(coordinates.x, coordinates.y);
-    update_queue_.pop();
-    return true;
-  } else if (!pair_update_queue_.empty()) {
-    const FieldCoordinate& first = pair_update_queue_.front().first;
-    const FieldCoordinate& second = pair_update_queue_.front().second;
-    UpdatePairConsistency(first.x, first.y, second.x, second.y);
-    pair_update_queue_.pop();
-    return true;
   } else {
-    FieldCoordinate safe_spot(-1, -1);
-    if (!GetSafeFieldCoordinates(&safe_spot)) {
+    if (!GetGuessFieldCoordinates(&field)) {
       return false;
     }
-    UncoverField(safe_spot.x, safe_spot.y);
-    return true;
+    ++guesses_;
   }
-  return false;
+  UncoverField(field.x, field.y);
+  return true;
 }
 
 bool MineSeeker::UncoverField(int x, int y) {
   CheckCoordinatesAreValid(x, y);
-  LOG(INFO) << "Uncovering field " << x << " " << y;
+  TraceScope trace(Tracer::UNCOVER, x, y, -1, -1);
+  VLOG(1) << "Uncovering field " << x << " " << y;
 
-  MineSeekerField* const field = &state_[x][y];
-  CHECK_EQ(MineSeekerField::HIDDEN, field->state());
+  CHECK_NE(MineSeekerField::MINE, state_.state(x, y));
 
   if (mine_sweeper_.IsMine(x, y)) {
     // The seeker stepped on a mine and is dead. Kaboom!
     LOG(INFO) << "Death on the position " << x << " " << y;
-    field->set_state(MineSeekerField::MINE);
+    TransitionFieldFromHidden(x, y, MineSeekerField::MINE);
     is_dead_ = true;
     return false;
   }
   
-  field->set_state(MineSeekerField::UNCOVERED);
+  // The transition fails only if the field was already uncovered, possibly by
+  // another thread; the neighbors were updated by the thread that uncovered
+  // it.
+  if (!TransitionFieldFromHidden(x, y, MineSeekerField::UNCOVERED)) {
+    return true;
+  }
+  ++frontier_version_;
+  CountResolvedField();
   int num_mines_around = mine_sweeper_.NumberOfMinesAroundField(x, y);
 
   if (num_mines_around == 0) {
     // TODO(ondrasej): Refactor this code.
-    field->SetConfiguration(0);
+    SetFieldConfiguration(x, y, 0);
     for (int i = -1; i <= 1; ++i) {
       for (int j = -1; j <= 1; ++j) {
         if (i != 0 || j != 0) {
@@ -420,31 +2187,32 @@ bool MineSeeker::UncoverField(int x, int y) {
     }
   } else {
     UpdateConfigurationsAtPosition(x, y);
+    QueueFieldForSubsetUpdate(x, y);
   }
   QueueNeighborsForUpdate(x, y);
 
-  string state;
-  DebugString(&state);
-  LOG(INFO) << state;
+  if (VLOG_IS_ON(1)) {
+    string debug_output;
+    DebugString(&debug_output);
+    VLOG(1) << debug_output;
+  }
 
   return true;
 }
 
 void MineSeeker::UpdateConfigurationsAtPosition(int x, int y) {
   CheckCoordinatesAreValid(x, y);
+  TraceScope trace(Tracer::CONFIGURATION_UPDATE, x, y, -1, -1);
 
-  bool changed_configurations = false;
-  MineSeekerField* const field = &state_[x][y];
-  for (int configuration = 0;
-       configuration < MineSeekerField::kNumPossibleConfigurations;
-       ++configuration) {
-    if (field->IsPossibleConfiguration(configuration)) {
-      if (!ConfigurationFitsAt(configuration, x, y)) {
-        field->RemoveConfiguration(configuration);
-        changed_configurations = true;
-      }
-    }
-  }
+  // The configurations that fit are computed at once, and the interned set is
+  // then replaced by the filtered one with a compare-and-swap, so that the
+  // removals made concurrently by other threads are kept. The result does not
+  // depend on the order, because ConfigurationFitsAt does not look at the
+  // configurations of the field itself.
+  const bool changed_configurations =
+      (this->*kernels_->filter_configurations)(x, y);
+  mutable_statistics()->AddConfigurationCount(
+      state_.configurations(x, y).count());
 
   for (int i = -2; i <= 2; ++i) {
     for (int j = -2; j <= 2; ++j) {
@@ -463,13 +2231,6 @@ void MineSeeker::UpdateConfigurationsAtPosition(int x, int y) {
   }
 }
 
-namespace {
-// Coordinates for converting bits in the ID of a configuration to the relative
-// coordinates of the field to which the bit refers.
-const int kMineRelativePositionX[] = { -1, 0, 1, -1, 1, -1, 0, 1 };
-const int kMineRelativePositionY[] = { -1, -1, -1, 0, 0, 1, 1, 1 };
-}
-
 void MineSeeker::UpdateNeighborsAtPosition(int x, int y) {
   CheckCoordinatesAreValid(x, y);
 
@@ -482,20 +2243,25 @@ void MineSeeker::UpdateNeighborsAtPosition(int x, int y) {
   // mines_in_neighborhood the same way.
   int empty_fields_in_neighborhood = 0xFF;
   int mines_in_neighborhood = 0xFF;
-  const MineSeekerField& field = state_[x][y];
-  for (int configuration = 1;
+  const ConfigurationSet& configurations = state_.configurations(x, y);
+  // No configuration fits only when the numbers contradict each other, e.g. in
+  // an observed game with wrong flags; nothing follows from the field then.
+  if (configurations.count() == 0) {
+    return;
+  }
+  for (int configuration = 0;
        configuration < MineSeekerField::kNumPossibleConfigurations;
        ++configuration) {
-    if (field.IsPossibleConfiguration(configuration)) {
+    if (configurations[configuration]) {
       mines_in_neighborhood &= configuration;
       empty_fields_in_neighborhood &= (0xFF & ~configuration);
     }
   }
   // Uncover the fields that are certain not to contain a mine, mark fields with
   // mines as such.
-  for (int bit = 0; bit < 8; ++bit) {
-    const int updated_field_x = x + kMineRelativePositionX[bit];
-    const int updated_field_y = y + kMineRelativePositionY[bit];
+  for (int bit = 0; bit < kNumNeighbors; ++bit) {
+    const int updated_field_x = x + kNeighborOffsetX[bit];
+    const int updated_field_y = y + kNeighborOffsetY[bit];
     if (IsBitSet(empty_fields_in_neighborhood, bit)) {
       QueueFieldForUncover(updated_field_x, updated_field_y);
     }
@@ -506,37 +2272,44 @@ void MineSeeker::UpdateNeighborsAtPosition(int x, int y) {
 }
 
 void MineSeeker::PopConfigurationAt(int configuration, int x, int y) {
-  for (int bit = 0; bit < 8; ++bit) {
-    const int field_x = x + kMineRelativePositionX[bit];
-    const int field_y = y + kMineRelativePositionY[bit];
-    if (field_x >= 0 && field_y >= 0
-        && field_x < mine_sweeper_.width()
-        && field_y < mine_sweeper_.height()) {
+  (this->*kernels_->pop_configuration)(configuration, x, y);
+}
+
+bool MineSeeker::PushConfigurationAt(int configuration, int x, int y) {
+  return (this->*kernels_->push_configuration)(configuration, x, y);
+}
+
+template<typename Geometry>
+void MineSeeker::PopConfigurationAtImpl(int configuration, int x, int y) {
+  const Geometry geometry(mine_sweeper_.width(), mine_sweeper_.height());
+  for (int bit = 0; bit < kNumNeighbors; ++bit) {
+    const int field_x = x + kNeighborOffsetX[bit];
+    const int field_y = y + kNeighborOffsetY[bit];
+    if (geometry.IsInside(field_x, field_y)) {
       const bool configuration_has_a_mine = IsBitSet(configuration, bit);
-      MineSeekerField* const field = &state_[field_x][field_y];
       if (configuration_has_a_mine) {
-        field->PopTemporaryMine();
+        state_.PopTemporaryMine(field_x, field_y);
       } else {
-        field->PopTemporaryClearArea();
+        state_.PopTemporaryClearArea(field_x, field_y);
       }
     }
   }
 }
 
-bool MineSeeker::PushConfigurationAt(int configuration, int x, int y) {
+template<typename Geometry>
+bool MineSeeker::PushConfigurationAtImpl(int configuration, int x, int y) {
+  const Geometry geometry(mine_sweeper_.width(), mine_sweeper_.height());
   bool configuration_was_ok = true;
-  for (int bit = 0; bit < 8; ++bit) {
-    const int field_x = x + kMineRelativePositionX[bit];
-    const int field_y = y + kMineRelativePositionY[bit];
-    if (field_x >= 0 && field_y >= 0
-        && field_x < mine_sweeper_.width()
-        && field_y < mine_sweeper_.height()) {
+  for (int bit = 0; bit < kNumNeighbors; ++bit) {
+    const int field_x = x + kNeighborOffsetX[bit];
+    const int field_y = y + kNeighborOffsetY[bit];
+    if (geometry.IsInside(field_x, field_y)) {
       const bool configuration_has_a_mine = IsBitSet(configuration, bit);
-      MineSeekerField* const field = &state_[field_x][field_y];
       if (configuration_has_a_mine) {
-        configuration_was_ok &= field->PushTemporaryMine();
+        configuration_was_ok &= state_.PushTemporaryMine(field_x, field_y);
       } else {
-        configuration_was_ok &= field->PushTemporaryClearArea();
+        configuration_was_ok &=
+            state_.PushTemporaryClearArea(field_x, field_y);
       }
     }
   }
@@ -544,24 +2317,186 @@ bool MineSeeker::PushConfigurationAt(int configuration, int x, int y) {
   return configuration_was_ok;
 }
 
+template<typename Geometry>
+bool MineSeeker::FilterConfigurations(int x, int y) {
+  const Geometry geometry(mine_sweeper_.width(), mine_sweeper_.height());
+  // A configuration fits if it has mines exactly at the neighbors that are
+  // known to contain a mine, and no mines at the other neighbors that are not
+  // hidden. The fields outside of the board behave as uncovered fields.
+  int known_neighbors = 0;
+  int mine_neighbors = 0;
+  for (int bit = 0; bit < kNumNeighbors; ++bit) {
+    const int field_x = x + kNeighborOffsetX[bit];
+    const int field_y = y + kNeighborOffsetY[bit];
+    if (!geometry.IsInside(field_x, field_y)) {
+      known_neighbors |= 1 << bit;
+      continue;
+    }
+    switch (state_.state(field_x, field_y)) {
+      case MineSeekerField::MINE:
+        mine_neighbors |= 1 << bit;
+        known_neighbors |= 1 << bit;
+        break;
+      case MineSeekerField::UNCOVERED:
+        known_neighbors |= 1 << bit;
+        break;
+      case MineSeekerField::HIDDEN:
+        break;
+    }
+  }
+  int old_handle = -1;
+  if (!state_.FilterConfigurationsByNeighbors(x, y, known_neighbors,
+                                              mine_neighbors,
+                                              NumberOfMinesAroundField(x, y),
+                                              &old_handle)) {
+    return false;
+  }
+  CountConfigurationRemovals(x, y, old_handle);
+  RecordTrailEntry(
+      TrailEntry(TrailEntry::SET_CONFIGURATIONS, x, y, old_handle));
+  return true;
+}
+
+template<typename Geometry>
+MineSeeker::NeighborhoodKernels MineSeeker::MakeNeighborhoodKernels(
+    const char* name) {
+  NeighborhoodKernels kernels;
+  kernels.name = name;
+  kernels.filter_configurations = &MineSeeker::FilterConfigurations<Geometry>;
+  kernels.push_configuration = &MineSeeker::PushConfigurationAtImpl<Geometry>;
+  kernels.pop_configuration = &MineSeeker::PopConfigurationAtImpl<Geometry>;
+  return kernels;
+}
+
+const MineSeeker::NeighborhoodKernels* MineSeeker::SelectNeighborhoodKernels(
+    int width,
+    int height) {
+  static const NeighborhoodKernels kBeginnerKernels =
+      MakeNeighborhoodKernels<BeginnerBoardGeometry>("9x9");
+  static const NeighborhoodKernels kIntermediateKernels =
+      MakeNeighborhoodKernels<IntermediateBoardGeometry>("16x16");
+  static const NeighborhoodKernels kExpertKernels =
+      MakeNeighborhoodKernels<ExpertBoardGeometry>("30x16");
+  static const NeighborhoodKernels kGenericKernels =
+      MakeNeighborhoodKernels<DynamicBoardGeometry>("generic");
+  if (BeginnerBoardGeometry::Matches(width, height)) {
+    return &kBeginnerKernels;
+  } else if (IntermediateBoardGeometry::Matches(width, height)) {
+    return &kIntermediateKernels;
+  } else if (ExpertBoardGeometry::Matches(width, height)) {
+    return &kExpertKernels;
+  }
+  return &kGenericKernels;
+}
+
+void MineSeeker::UpdateSubsetConsistency(int x, int y) {
+  CheckCoordinatesAreValid(x, y);
+  if (NumberOfMinesAroundField(x, y) <= 0) {
+    return;
+  }
+
+  for (int i = -2; i <= 2; ++i) {
+    for (int j = -2; j <= 2; ++j) {
+      const int other_x = x + i;
+      const int other_y = y + j;
+      if ((i == 0 && j == 0)
+          || other_x < 0 || other_x >= mine_sweeper_.width()
+          || other_y < 0 || other_y >= mine_sweeper_.height()
+          || NumberOfMinesAroundField(other_x, other_y) <= 0) {
+        continue;
+      }
+      // The neighborhoods of both fields fit into a 5x5 window, whose top-left
+      // corner is used as the shared anchor of the masks.
+      const int anchor_x = std::min(x, other_x) - 1;
+      const int anchor_y = std::min(y, other_y) - 1;
+      int remaining_mines = 0;
+      const int mask = HiddenNeighborMask(x, y, anchor_x, anchor_y,
+                                          &remaining_mines);
+      int other_remaining_mines = 0;
+      const int other_mask = HiddenNeighborMask(other_x, other_y,
+                                                anchor_x, anchor_y,
+                                                &other_remaining_mines);
+
+      // Find which of the two sets is the subset of the other one; the
+      // remaining fields of the superset then contain exactly the difference
+      // of the numbers of remaining mines.
+      int difference = 0;
+      int difference_mines = 0;
+      if ((mask & ~other_mask) == 0) {
+        difference = other_mask & ~mask;
+        difference_mines = other_remaining_mines - remaining_mines;
+      } else if ((other_mask & ~mask) == 0) {
+        difference = mask & ~other_mask;
+        difference_mines = remaining_mines - other_remaining_mines;
+      }
+      if (difference == 0) {
+        continue;
+      }
+      const int difference_size = __builtin_popcount(difference);
+      if (difference_mines != 0 && difference_mines != difference_size) {
+        continue;
+      }
+      for (int bit = 0; bit < 25; ++bit) {
+        if (IsBitSet(difference, bit)) {
+          const int field_x = anchor_x + bit % 5;
+          const int field_y = anchor_y + bit / 5;
+          if (difference_mines == 0) {
+            QueueFieldForUncover(field_x, field_y);
+          } else {
+            MarkAsMine(field_x, field_y);
+          }
+        }
+      }
+    }
+  }
+}
+
 void MineSeeker::UpdatePairConsistency(int x1, int y1, int x2, int y2) {
   CHECK_GE(x1 - x2, -2);
   CHECK_LE(x1 - x2, 2);
   CHECK_GE(y1 - y2, -2);
   CHECK_LE(y1 - y2, 2);
 
+  SolverStatistics* const statistics = mutable_statistics();
+  ++statistics->num_pair_checks;
   if (x1 < 0 || x1 >= mine_sweeper_.width()
       || y1 < 0 || y1 >= mine_sweeper_.height()
       || MineSeekerField::UNCOVERED != StateAtPosition(x1, y1)
-      || state_[x1][y1].IsBound()
+      || state_.configurations(x1, y1).count() == 1
       || x2 < 0 || x2 >= mine_sweeper_.width()
       || y2 < 0 || y2 >= mine_sweeper_.height()
       || MineSeekerField::UNCOVERED != StateAtPosition(x2, y2)) {
+    ++statistics->num_redundant_pair_checks;
+    return;
+  }
+  TraceScope trace(Tracer::PAIR_UPDATE, x1, y1, x2, y2);
+  // The deductions from the window are cheaper than the search over pairs of
+  // configurations. When they change a neighbor of (x1, y1), the field is
+  // updated and the pair is queued again after the change, so the search can
+  // be skipped now. Otherwise, the search still runs, because the window does
+  // not see the configurations that were narrowed by other fields.
+  if (use_deduction_tables_ && ApplyPairDeductionTable(x1, y1, x2, y2)) {
     return;
   }
+  int deduced_fields = 0;
+  if (use_pattern_cache_) {
+    const int anchor_x = std::min(x1, x2) - 1;
+    const int anchor_y = std::min(y1, y2) - 1;
+    deduced_fields = ApplyPatternDeductions(anchor_x, anchor_y);
+    for (int bit = 0; bit < kNumNeighbors; ++bit) {
+      const int window_x = x1 - anchor_x + kNeighborOffsetX[bit];
+      const int window_y = y1 - anchor_y + kNeighborOffsetY[bit];
+      if (IsBitSet(deduced_fields,
+                   window_y * PatternCache::kWindowSize + window_x)) {
+        return;
+      }
+    }
+  }
 
-  const vector<bool>& configurations1 = state_[x1][y1].configurations();
-  const vector<bool>& configurations2 = state_[x2][y2].configurations();
+  // The interned sets are immutable, so the references stay valid when the
+  // configurations of the fields are replaced below.
+  const ConfigurationSet& configurations1 = state_.configurations(x1, y1);
+  const ConfigurationSet& configurations2 = state_.configurations(x2, y2);
   bool configurations_were_updated = false;
   for (int configuration1 = 0;
        configuration1 < MineSeekerField::kNumPossibleConfigurations;
@@ -587,16 +2522,134 @@ void MineSeeker::UpdatePairConsistency(int x1, int y1, int x2, int y2) {
     }
     PopConfigurationAt(configuration1, x1, y1);
     if (!found_matching_configuration) {
-      LOG(INFO) << "Removing configuration " << configuration1 << " at " << x1
+      VLOG(1) << "Removing configuration " << configuration1 << " at " << x1
           << " " << y1;
-      state_[x1][y1].RemoveConfiguration(configuration1);
-      configurations_were_updated = true;
+      // The removal may fail when the configuration table is full.
+      if (RemoveFieldConfiguration(x1, y1, configuration1)) {
+        configurations_were_updated = true;
+      }
     }
   }
   if (configurations_were_updated) {
     UpdateConfigurationsAtPosition(x1, y1);
     UpdateNeighborsAtPosition(x1, y1);
+  } else if (deduced_fields == 0) {
+    ++statistics->num_redundant_pair_checks;
+  }
+}
+
+PatternCache* MineSeeker::pattern_cache() {
+  static PatternCache cache(PatternCache::kDefaultMaxEntries);
+  return &cache;
+}
+
+int MineSeeker::ApplyPatternDeductions(int anchor_x, int anchor_y) {
+  const int size = PatternCache::kWindowSize;
+  int cells[PatternCache::kNumCells];
+  for (int dy = 0; dy < size; ++dy) {
+    for (int dx = 0; dx < size; ++dx) {
+      const int x = anchor_x + dx;
+      const int y = anchor_y + dy;
+      int* const cell = &cells[dy * size + dx];
+      *cell = PatternCache::kSafeCell;
+      if (x < 0 || x >= mine_sweeper_.width()
+          || y < 0 || y >= mine_sweeper_.height()) {
+        continue;
+      }
+      switch (StateAtPosition(x, y)) {
+        case MineSeekerField::HIDDEN:
+          *cell = PatternCache::kHiddenCell;
+          break;
+        case MineSeekerField::MINE:
+          *cell = PatternCache::kMineCell;
+          break;
+        case MineSeekerField::UNCOVERED:
+          // Only the numbers of the inner fields constrain the window.
+          if (dx > 0 && dx < size - 1 && dy > 0 && dy < size - 1) {
+            *cell = NumberOfMinesAroundField(x, y);
+          }
+          break;
+      }
+    }
+  }
+
+  const PatternCache::Deductions deductions = pattern_cache()->Lookup(cells);
+  for (int bit = 0; bit < PatternCache::kNumCells; ++bit) {
+    const int x = anchor_x + bit % size;
+    const int y = anchor_y + bit / size;
+    if (IsBitSet(deductions.mines, bit)) {
+      MarkAsMine(x, y);
+    } else if (IsBitSet(deductions.safe, bit)) {
+      QueueFieldForUncover(x, y);
+    }
+  }
+  return deductions.mines | deductions.safe;
+}
+
+bool MineSeeker::ApplyPairDeductionTable(int x1, int y1, int x2, int y2) {
+  const bool horizontal = y1 == y2 && (x1 - x2 == 1 || x2 - x1 == 1);
+  const bool vertical = x1 == x2 && (y1 - y2 == 1 || y2 - y1 == 1);
+  if (!horizontal && !vertical) {
+    return false;
+  }
+  // A is the top or the left field of the pair, B is the other one.
+  const int a_x = std::min(x1, x2);
+  const int a_y = std::min(y1, y2);
+  const bool first_is_a = x1 == a_x && y1 == a_y;
+  int remaining_mines_a = NumberOfMinesAroundField(a_x, a_y);
+  int remaining_mines_b = NumberOfMinesAroundField(a_x + horizontal,
+                                                   a_y + vertical);
+  int hidden_fields = 0;
+  int field_x[kNumPairWindowFields];
+  int field_y[kNumPairWindowFields];
+  for (int field = 0; field < kNumPairWindowFields; ++field) {
+    const int along = kPairWindowFieldAlong[field];
+    const int across = kPairWindowFieldAcross[field];
+    field_x[field] = a_x - 1 + (horizontal ? along : across);
+    field_y[field] = a_y - 1 + (horizontal ? across : along);
+    if (field_x[field] < 0 || field_x[field] >= mine_sweeper_.width()
+        || field_y[field] < 0 || field_y[field] >= mine_sweeper_.height()) {
+      continue;
+    }
+    switch (StateAtPosition(field_x[field], field_y[field])) {
+      case MineSeekerField::HIDDEN:
+        hidden_fields |= 1 << field;
+        break;
+      case MineSeekerField::MINE:
+        // The fields at along = 0 are neighbors only of A, the fields at
+        // along = 3 only of B.
+        remaining_mines_a -= along < kPairWindowLength - 1;
+        remaining_mines_b -= along > 0;
+        break;
+      case MineSeekerField::UNCOVERED:
+        break;
+    }
+  }
+  if (remaining_mines_a < 0 || remaining_mines_a > kMaxPairRemainingMines
+      || remaining_mines_b < 0 || remaining_mines_b > kMaxPairRemainingMines) {
+    return false;
+  }
+
+  const int deductions = kPairDeductions[PairDeductionIndex(
+      hidden_fields, remaining_mines_a, remaining_mines_b)];
+  bool deduced_neighbor_of_first = false;
+  for (int field = 0; field < kNumPairWindowFields; ++field) {
+    const bool is_mine = IsBitSet(deductions, field);
+    const bool is_safe = IsBitSet(deductions, kPairSafeShift + field);
+    if (!is_mine && !is_safe) {
+      continue;
+    }
+    if (is_mine) {
+      MarkAsMine(field_x[field], field_y[field]);
+    } else {
+      QueueFieldForUncover(field_x[field], field_y[field]);
+    }
+    const int along = kPairWindowFieldAlong[field];
+    if (first_is_a ? along < kPairWindowLength - 1 : along > 0) {
+      deduced_neighbor_of_first = true;
+    }
   }
+  return deduced_neighbor_of_first;
 }
 
 }  // namespace mineseeker
@@ -18,17 +18,34 @@
 #ifndef MINESEEKER_MINESEEKER_H_
 #define MINESEEKER_MINESEEKER_H_
 
-#include <queue>
+#include <atomic>
+#include <deque>
+#include <mutex>
+#include <unordered_map>
+#include <unordered_set>
+#include "board_geometry.h"
 #include "common.h"
+#include "configuration_intern_table.h"
+#include "configuration_set.h"
 #include "gtest/gtest.h"
+#include "pattern_cache.h"
+#include "propagation_scheduler.h"
+#include "scoped_ptr.h"
+#include "solver_statistics.h"
 
 namespace mineseeker {
 
+class Frontier;
 class MineSweeper;
+class ThreadPool;
 
 // Contains information about the state of a single field in the mine seeker.
 // Keeps track whether the field was already uncovered and the number of
 // possible configurations of mines in the neighborhood of the field.
+//
+// The mine seeker does not store the fields as objects (see MineSeekerState);
+// a MineSeekerField is a copy of the state of a single field at the time it was
+// created, and it does not change with the state of the mine seeker.
 class MineSeekerField {
  public:
   // The state of a mine field from the viewpoint of the mine seeker.
@@ -43,11 +60,15 @@ class MineSeekerField {
 
   // The number of all possible configurations. This is equal to the number of
   // combinations of mines that can be around a given field.
-  static const int kNumPossibleConfigurations;
+  static const int kNumPossibleConfigurations =
+      ConfigurationSet::kNumConfigurations;
 
-  // Initializes a new mine seeker field. Marks the field as uncovered and
-  // allows all configurations for the field.
-  MineSeekerField();
+  MineSeekerField(State state,
+                  int temporary_status,
+                  const ConfigurationSet& configurations)
+      : state_(state),
+        temporary_status_(temporary_status),
+        configurations_(configurations) {}
 
   // Returns true if the configuration can be assigned to this field.
   bool IsPossibleConfiguration(int configuration) const {
@@ -60,52 +81,28 @@ class MineSeekerField {
   bool IsPossibleMine() const { return state_ != UNCOVERED; }
   // Returns true if this field is bound, i.e. a single configuration is
   // assigned to it.
-  bool IsBound() const;
+  bool IsBound() const { return NumberOfActiveConfigurations() == 1; }
 
   // Returns the number of configuration that can be assigned to this field
   // (given its neighborhood).
-  int NumberOfActiveConfigurations() const;
-  // Disables the specified configuration.
-  void RemoveConfiguration(int configuration);
-  // Binds the field to a given configuration.
-  void SetConfiguration(int configuration);
+  int NumberOfActiveConfigurations() const {
+    return configurations_.count();
+  }
 
   // Returns the state of the field.
   State state() const { return state_; }
-  // Changes the state of the field (but only updates the state, calling this
-  // method does not run propagation to other fields).
-  void set_state(State state) { state_ = state; }
+  // Returns the temporary status of the field; see
+  // MineSeekerState::PushTemporaryMine.
+  int temporary_status() const { return temporary_status_; }
   // Returns a bitmap with the possible configurations. For each configuration
   // ID, this bitmap contains true if the configuration can be assigned to this
   // field and false otherwise.
-  const vector<bool>& configurations() const { return configurations_; }
+  const ConfigurationSet& configurations() const { return configurations_; }
 
-  // Methods for manipulating the temporary status of the field used by
-  // MineSeeker::PushConfigurationAt and MineSeeker::PopConfigurationAt. See the
-  // description of these methods for more detail.
-  int temporary_status() const { return temporary_status_; }
-  void PopTemporaryMine() { --temporary_status_; }
-  bool PushTemporaryMine() {
-    bool result = temporary_status_ >= 0;
-    ++temporary_status_;
-    return result;
-  }
-  void PopTemporaryClearArea() { ++temporary_status_; }
-  bool PushTemporaryClearArea() {
-    bool result = temporary_status_ <= 0;
-    --temporary_status_;
-    return result;
-  }
-  void ResetTemporaryStatus() { temporary_status_ = 0; }
-  
  private:
-  // Resets the configurations - enables all configurations.
-  void ResetConfigurations();
-
-  int temporary_status_;
-
   State state_;
-  vector<bool> configurations_;
+  int temporary_status_;
+  ConfigurationSet configurations_;
 };
 
 // Contains coordinates of a field.
@@ -117,6 +114,351 @@ struct FieldCoordinate {
       : x(x_coord), y(y_coord) {}
 };
 
+// The state of all fields of the mine seeker, stored as a structure of arrays
+// in square tiles. Each tile contains separate dense planes for its fields, so
+// that a pass over the board touches only the data it needs:
+// - the states use two bits per field, packed to one 64-bit word per row of
+//   the tile; the scans for hidden fields test 32 fields at a time,
+// - the temporary statuses use a single byte per field,
+// - the sets of possible configurations are interned in a
+//   ConfigurationInternTable, and each field has only a 32-bit handle of its
+//   set. Most fields share a small number of distinct sets (e.g. all hidden
+//   fields away from the border, or all fields bound to the same
+//   configuration), so the memory used by the sets depends on the number of
+//   distinct sets, not on the size of the board. Changing the configurations
+//   of a field replaces its handle, and the narrowing operations used by the
+//   solver are memoized by the table,
+// - the flags use a single byte per field; their meaning is defined by the
+//   mine seeker.
+// The tiles are reference counted and shared by the copies of the state and
+// by the untouched parts of the board; a tile is copied only when one of its
+// fields is changed through a slot that shares it (copy-on-write). A freshly
+// resized board uses one tile for each distinct position relative to the
+// border of the board, so the memory used by the fields grows with the number
+// of tiles the solver actually changed (i.e. with the frontier), and only the
+// pointers to the tiles are proportional to the area of the board. Copying the
+// state copies only these pointers. The table is append-only and it is shared
+// with the copies, too. The state also keeps the number of hidden fields and
+// of the mines, so that checking if the board is solved and counting the
+// remaining mines take constant time.
+//
+// The states of hidden fields can be changed concurrently from multiple
+// threads without locks (see TransitionFromHidden), and the configurations and
+// the flags of different fields can be changed concurrently between
+// BeginConcurrentChanges and EndConcurrentChanges; the other methods that
+// change the state are not thread-safe.
+class MineSeekerState {
+ public:
+  typedef MineSeekerField::State State;
+
+  // The width and the height of a tile.
+  static const int kTileSize = 32;
+
+  MineSeekerState();
+  MineSeekerState(const MineSeekerState& other);
+  ~MineSeekerState();
+  MineSeekerState& operator=(const MineSeekerState& other);
+
+  // Changes the size of the board. All fields become hidden, with all
+  // configurations possible, with no temporary status and with no flags. The
+  // table of the interned configuration sets is kept.
+  void Resize(int width, int height);
+
+  int width() const { return width_; }
+  int height() const { return height_; }
+
+  // Returns the number of tiles, and the number of tiles that are shared with
+  // another state or with another position on the board.
+  int num_tiles() const { return tiles_.size(); }
+  int NumSharedTiles() const;
+  // Start and end a phase in which the fields may be changed concurrently.
+  // During the phase, the copies of the shared tiles are installed atomically,
+  // and the replaced tiles are released only by EndConcurrentChanges, because
+  // other threads may still be reading them.
+  void BeginConcurrentChanges();
+  void EndConcurrentChanges();
+
+  // Returns a copy of the field at (x, y).
+  MineSeekerField Field(int x, int y) const {
+    return MineSeekerField(state(x, y), temporary_status(x, y),
+                           configurations(x, y));
+  }
+
+  // Methods for working with the states of the fields.
+  //
+  // Returns the state of the field at (x, y).
+  State state(int x, int y) const {
+    CheckCoordinates(x, y);
+    const uint64 word = GetTile(x, y)->states[y % kTileSize].load(
+        std::memory_order_relaxed);
+    return static_cast<State>((word >> StateShift(x)) & kStateMask);
+  }
+  // Changes the state of the field at (x, y).
+  void set_state(int x, int y, State state);
+  // Atomically changes the state of the field at (x, y) from HIDDEN to the
+  // given state. Returns true if the state was changed, and false if the field
+  // was not hidden (e.g. because another thread changed its state first).
+  bool TransitionFromHidden(int x, int y, State state);
+  // Returns the number of hidden fields.
+  int num_hidden_fields() const {
+    return num_hidden_fields_.load(std::memory_order_relaxed);
+  }
+  // Returns the number of fields marked as mines.
+  int num_mine_fields() const {
+    return num_mine_fields_.load(std::memory_order_relaxed);
+  }
+  // Adds the coordinates of all hidden fields to fields, row by row.
+  void CollectHiddenFields(vector<FieldCoordinate>* fields) const;
+
+  // Methods for working with the interior fields: the hidden fields that are
+  // not next to the frontier, as maintained by MineSeeker. All fields are
+  // interior after Resize. The interior fields are kept in bitmaps in the
+  // tiles and counted by columns of tiles, so that they are found without
+  // scanning the states of the board.
+  bool is_interior(int x, int y) const {
+    CheckCoordinates(x, y);
+    return (GetTile(x, y)->interior_fields[x % kTileSize] >> (y % kTileSize))
+        & 1;
+  }
+  // Marks the field at (x, y) as interior or not. Not thread-safe.
+  void set_is_interior(int x, int y, bool is_interior);
+  // Returns the number of interior fields.
+  int num_interior_fields() const { return num_interior_fields_; }
+  // Adds the coordinates of the first max_fields interior fields in the order
+  // of the columns, i.e. ordered by x and then by y, to fields. Skips the
+  // columns of tiles without interior fields.
+  void CollectInteriorFields(int max_fields,
+                             vector<FieldCoordinate>* fields) const;
+
+  // Methods for working with the configurations of the fields.
+  //
+  // Returns the possible configurations of the field at (x, y). The reference
+  // is valid until the next change of the configurations.
+  const ConfigurationSet& configurations(int x, int y) const {
+    return configuration_table_->Get(configuration_handle(x, y));
+  }
+  // Returns the handle of the possible configurations of the field at (x, y)
+  // in configuration_table().
+  int configuration_handle(int x, int y) const {
+    CheckCoordinates(x, y);
+    return GetTile(x, y)->configuration_handles[FieldIndexInTile(x, y)].load(
+        std::memory_order_relaxed);
+  }
+  // Replaces the configurations of the field at (x, y) with the set with the
+  // given handle. Not thread-safe.
+  void set_configuration_handle(int x, int y, int handle) {
+    CheckCoordinates(x, y);
+    const int old_handle = configuration_handle(x, y);
+    if (old_handle != handle) {
+      MutableTile(x, y)->configuration_handles[FieldIndexInTile(x, y)].store(
+          handle, std::memory_order_relaxed);
+      CountFieldsWithoutConfigurations(old_handle, handle);
+    }
+  }
+  // Returns the number of fields with no possible configuration. Such fields
+  // exist only when the numbers contradict each other, e.g. in an observed
+  // game with wrong flags.
+  int num_fields_without_configurations() const {
+    return num_fields_without_configurations_.load(std::memory_order_relaxed);
+  }
+  // The narrowing methods below remove configurations from the field at
+  // (x, y). Each of them returns true if the call changed the configurations,
+  // and stores the handle of the set it replaced to old_handle. They can be
+  // called concurrently for the same field: the handle is replaced by a
+  // compare-and-swap, and when another thread changes the handle first, the
+  // narrowing is applied again to the new handle, so that no removal is lost.
+  //
+  // Disables the specified configuration.
+  bool RemoveConfiguration(int x, int y, int configuration, int* old_handle);
+  // Disables all configurations from the set.
+  bool RemoveConfigurations(int x,
+                            int y,
+                            const ConfigurationSet& removed,
+                            int* old_handle);
+  // Keeps only the configurations that fit with the neighbors of the field;
+  // see ConfigurationInternTable::FilterByNeighbors.
+  bool FilterConfigurationsByNeighbors(int x,
+                                       int y,
+                                       int known_neighbors,
+                                       int mine_neighbors,
+                                       int num_mines,
+                                       int* old_handle);
+  // Binds the field to a given configuration. Not thread-safe.
+  void SetConfiguration(int x, int y, int configuration);
+  // Returns the handle of the configurations of the field (x, y) after Resize:
+  // all configurations that have no mines outside of the board.
+  int InitialConfigurationHandle(int x, int y) const;
+  // The table of the interned sets of configurations. The table is shared by
+  // the copies of the state.
+  ConfigurationInternTable* configuration_table() const {
+    return configuration_table_;
+  }
+  // Replaces the table by a new table of the same capacity that contains only
+  // the sets used by the fields of this state, and updates the handles of all
+  // fields. Copies each distinct tile once, so the tiles shared by multiple
+  // positions on the board remain shared; the copies of the state keep the old
+  // table and tiles. Invalidates all handles obtained before the call. Not
+  // thread-safe.
+  void CompactConfigurationTable();
+
+  // Methods for manipulating the temporary status of the fields used by
+  // MineSeeker::PushConfigurationAt and MineSeeker::PopConfigurationAt. See the
+  // description of these methods for more detail.
+  int temporary_status(int x, int y) const {
+    CheckCoordinates(x, y);
+    return GetTile(x, y)->temporary_statuses[FieldIndexInTile(x, y)];
+  }
+  void PopTemporaryMine(int x, int y) {
+    CheckCoordinates(x, y);
+    --MutableTile(x, y)->temporary_statuses[FieldIndexInTile(x, y)];
+  }
+  bool PushTemporaryMine(int x, int y) {
+    CheckCoordinates(x, y);
+    int8* const status =
+        &MutableTile(x, y)->temporary_statuses[FieldIndexInTile(x, y)];
+    DCHECK_LT(*status, kMaxTemporaryStatus);
+    const bool result = *status >= 0;
+    ++*status;
+    return result;
+  }
+  void PopTemporaryClearArea(int x, int y) {
+    CheckCoordinates(x, y);
+    ++MutableTile(x, y)->temporary_statuses[FieldIndexInTile(x, y)];
+  }
+  bool PushTemporaryClearArea(int x, int y) {
+    CheckCoordinates(x, y);
+    int8* const status =
+        &MutableTile(x, y)->temporary_statuses[FieldIndexInTile(x, y)];
+    DCHECK_GT(*status, -kMaxTemporaryStatus);
+    const bool result = *status <= 0;
+    --*status;
+    return result;
+  }
+  // Resets the temporary statuses of all fields. Copies only the tiles that
+  // contain a non-zero status.
+  void ResetTemporaryStatuses();
+
+  // Methods for working with the flags of the fields.
+  int flags(int x, int y) const {
+    CheckCoordinates(x, y);
+    return GetTile(x, y)->flags[FieldIndexInTile(x, y)];
+  }
+  void set_flags(int x, int y, int flags) {
+    CheckCoordinates(x, y);
+    if (this->flags(x, y) != flags) {
+      MutableTile(x, y)->flags[FieldIndexInTile(x, y)] = flags;
+    }
+  }
+
+ private:
+  // The number of bits used by the state of a single field.
+  static const int kBitsPerState = 2;
+  static const uint64 kStateMask = (1 << kBitsPerState) - 1;
+  // The number of fields in a tile.
+  static const int kFieldsPerTile = kTileSize * kTileSize;
+  // The maximal absolute value of a temporary status.
+  static const int kMaxTemporaryStatus = 127;
+
+  // A tile of the board. The states in a single word and the configurations of
+  // a single field can be changed concurrently, so they are atomic.
+  struct Tile {
+    Tile();
+    // Creates a copy of the fields of 'other'; the copy is not shared.
+    Tile(const Tile& other);
+
+    // Methods for reference counting. The tile is deleted when the last
+    // reference is released.
+    void Ref() { ref_count.fetch_add(1); }
+    void Unref() {
+      if (ref_count.fetch_sub(1) == 1) {
+        delete this;
+      }
+    }
+    bool IsShared() const { return ref_count.load() > 1; }
+
+    std::atomic<int> ref_count;
+    std::atomic<uint64> states[kTileSize];
+    int8 temporary_statuses[kFieldsPerTile];
+    std::atomic<int> configuration_handles[kFieldsPerTile];
+    int8 flags[kFieldsPerTile];
+    // The interior fields, by columns: the bit y % kTileSize of the word
+    // x % kTileSize is set iff the field (x, y) is interior. Stored by columns,
+    // because the interior fields are collected by columns.
+    uint64 interior_fields[kTileSize];
+
+   private:
+    void operator=(const Tile&);
+  };
+
+  void CheckCoordinates(int x, int y) const {
+    DCHECK_GE(x, 0);
+    DCHECK_LT(x, width_);
+    DCHECK_GE(y, 0);
+    DCHECK_LT(y, height_);
+  }
+  int TileIndex(int x, int y) const {
+    return x / kTileSize + width_in_tiles_ * (y / kTileSize);
+  }
+  static int FieldIndexInTile(int x, int y) {
+    return x % kTileSize + kTileSize * (y % kTileSize);
+  }
+  static int StateShift(int x) { return kBitsPerState * (x % kTileSize); }
+
+  // Returns the tile that contains the field (x, y).
+  const Tile* GetTile(int x, int y) const {
+    return tiles_[TileIndex(x, y)].load(std::memory_order_acquire);
+  }
+  // Returns the tile that contains the field (x, y) for a change of the field.
+  // Copies the tile first if it is shared.
+  Tile* MutableTile(int x, int y);
+  // Replaces the handle of the configurations of the field (x, y) by
+  // narrowing(configuration_table_, handle) using a compare-and-swap loop.
+  // Implements the narrowing methods; see RemoveConfiguration.
+  template<typename Narrowing>
+  bool NarrowConfigurations(int x,
+                            int y,
+                            const Narrowing& narrowing,
+                            int* old_handle);
+  // Updates num_fields_without_configurations_ after the handle of a field was
+  // replaced.
+  void CountFieldsWithoutConfigurations(int old_handle, int new_handle) {
+    if (new_handle == ConfigurationInternTable::kEmptySetHandle) {
+      ++num_fields_without_configurations_;
+    } else if (old_handle == ConfigurationInternTable::kEmptySetHandle) {
+      --num_fields_without_configurations_;
+    }
+  }
+  // Releases a tile replaced by its copy; see BeginConcurrentChanges.
+  void ReleaseReplacedTile(Tile* tile);
+  // Releases all tiles.
+  void ClearTiles();
+
+  int width_;
+  int height_;
+  int width_in_tiles_;
+  // The handles of the initial sets of configurations of the fields, indexed
+  // by the mask of the neighbors of the field that are outside of the board,
+  // or -1 if there is no such field on the board.
+  int border_set_handles_[1 << kNumNeighbors];
+  // The tiles of the board, by rows. The states at the positions behind the
+  // end of the board are UNCOVERED, so that the scans for hidden fields do not
+  // need to mask them.
+  vector<std::atomic<Tile*> > tiles_;
+  // True between BeginConcurrentChanges and EndConcurrentChanges, and the
+  // tiles replaced by their copies during this time.
+  bool has_concurrent_changes_;
+  std::mutex replaced_tiles_mutex_;
+  vector<Tile*> replaced_tiles_;
+  std::atomic<int> num_hidden_fields_;
+  std::atomic<int> num_mine_fields_;
+  std::atomic<int> num_fields_without_configurations_;
+  // The number of interior fields, and the numbers of interior fields in each
+  // column of tiles.
+  int num_interior_fields_;
+  vector<int> num_interior_fields_in_tile_columns_;
+  ConfigurationInternTable* configuration_table_;
+};
+
 // Implements the mine seeking algorithm. Uses propagation and tree search to
 // prove the fields contain mines or not.
 //
@@ -130,15 +472,27 @@ struct FieldCoordinate {
 // certain position, than the field at this position is proven to contain a mine
 // (or be empty).
 //
-// Currently, two types of filtering of compatible configurations are availabe.
+// Currently, three types of filtering of compatible configurations are
+// availabe.
 // 1. "node consistency" for removing configurations based on fields around,
-// 2. "pairwise consistency" in this case, the solver check that for a pair of
+// 2. "subset rule" if the hidden neighbors of a field f1 are a subset of the
+//    hidden neighbors of a field f2, then the remaining hidden neighbors of f2
+//    contain exactly the difference of the numbers of remaining mines of f2
+//    and f1. This is a special case of pairwise consistency, but it can be
+//    checked with a few bit operations,
+// 3. "pairwise consistency" in this case, the solver check that for a pair of
 //    fields f1 and f2, each configuration of f1 is consistent with at least
 //    one possible configuration of f2.
+// When these techniques are exhausted, the solver can optionally run
+// failed-literal probing on the frontier (see FailedLiteralProber), and then it
+// enumerates all assignments of mines to the hidden fields on the frontier, one
+// connected component at a time; fields that contain a mine (or are empty) in
+// all solutions are proven.
 // If the solver does can't discover any more empty fields or mines using these
-// strategies, it asks for a safe spot.
-// Though the two techniques are not strong enough for all situations, they can
-// be used to solve most of them.
+// strategies, it asks for a safe spot, or when hints are disabled, it guesses
+// the field with the lowest probability of containing a mine.
+// Though the techniques are not strong enough for all situations, they can be
+// used to solve most of them.
 // However, even with global consistency (using backtracking), there are
 // ambiguous situations which cannot be decided without guessing. In such
 // situations, the solver asks the game for uncovering a single "empty" field
@@ -148,22 +502,101 @@ struct FieldCoordinate {
 // The solver works asynchronously, by performing a single elimination step at a
 // time. To avoid problems with cycles and stack overflow, the solver uses
 // queues with different priorities for uncovering fields and updating the
-// allowed configurations. Uncovering fields and marking them with mines has the
-// highest prioirity, followed by updating single fields and updating pairs of
-// fields.
+// allowed configurations. The steps are scheduled by a PropagationScheduler,
+// which always runs the cheapest tier that has pending work. Uncovering fields
+// and marking them with mines has the highest prioirity, followed by updating
+// single fields, checking the subset rule, updating pairs of fields, probing,
+// enumerating the frontier and finally guessing.
+//
+// When the mine sweeper is a window of a larger mine source, the fields on
+// the border of the window (see MineSweeper::IsOnWindowBorder) are never
+// uncovered, because their numbers count mines that the seeker does not see;
+// the fields inside the window are solved as usual. ProceduralBoardSolver uses
+// this to solve an unbounded board window by window, and StreamingBoardSolver
+// to solve a board streamed from a file band by band.
+//
+// When the mine sweeper is interactive (see MineSweeper::INTERACTIVE), each
+// call of UncoverField is a move in a game played elsewhere, and the seeker
+// guesses instead of asking for hints. The propagation between two moves is
+// incremental, so the seeker answers quickly; the revealer is not
+// thread-safe, so parallel propagation must not be used. The seeker does not
+// scan the whole board on a move: the constraints of the frontier are kept
+// up to date around the fields that change their state (see
+// GetFrontierConstraintFields), and the hidden fields and the mines are
+// counted by the state. The hidden fields outside of the frontier are kept in
+// per-tile bitmaps and counted per tile column, so a guess outside of the
+// frontier only visits the tiles that still have an interior field.
+//
+// When the mine sweeper is observed (see MineSweeper::OBSERVED), the
+// constructor loads the uncovered and the flagged fields in bulk: it sets all
+// their states first, and then computes the configurations of each uncovered
+// field once. Advise runs the propagation from this state. The numbers of the
+// hidden fields are not known, so the fields proven to be safe are reported
+// instead of uncovered. The later frames of the game are loaded by
+// HandleObservedFields, which takes only the fields that changed; the seeker
+// keeps the fields proven to be safe or mines, and counts the uncovered fields
+// without configurations, so an advice does not scan the board either.
 //
 // TODO(ondrasej): Full backtracking.
 // TODO(ondrasej): Take the number of remaining mines into account.
 class MineSeeker {
  public:
+  // The tiers of propagation, ordered by the cost of their steps. The values
+  // are the indices of the tiers in scheduler().
+  enum Tier {
+    // Runs the four tiers below in parallel on spatial tiles of the board until
+    // none of them has pending work (only when enabled).
+    PARALLEL_PROPAGATION_TIER = 0,
+    // Uncovers fields from uncover_queue_.
+    REVEAL_TIER,
+    // Filters the configurations of single fields from update_queue_.
+    FILTER_TIER,
+    // Applies the subset rule to fields from subset_update_queue_.
+    SUBSET_TIER,
+    // Runs pairwise consistency on pairs from pair_update_queue_.
+    PAIR_TIER,
+    // Runs failed-literal probing on the frontier (only when enabled).
+    PROBING_TIER,
+    // Enumerates the connected components of the frontier.
+    ENUMERATION_TIER,
+    // Asks for a safe field or guesses a field to uncover.
+    GUESS_TIER,
+  };
+
+  // The maximal number of search nodes used to enumerate a single connected
+  // component of the frontier. Components that need more nodes are skipped.
+  static const int64 kMaxEnumerationNodes;
+
   explicit MineSeeker(const MineSweeper& mine_sweeper);
+  // Creates a fork of the mine seeker, that continues from the current state
+  // of 'other', but can be changed independently. The fork shares the tiles of
+  // the state with 'other' and copies only the pointers to them, the queues and
+  // the fields of the frontier, so it takes time proportional to the number of
+  // tiles and to the size of the frontier; a tile is copied when either seeker
+  // changes it for the first time. The interned configuration sets are
+  // immutable and the table that contains them is shared by both seekers.
+  // The fork uses the same mine sweeper and the same budgets of the
+  // propagation tiers, but it does not inherit the checkpoints, the statistics
+  // of the scheduler and the probing and propagation threads.
+  MineSeeker(const MineSeeker& other);
+  ~MineSeeker();
+
+  // Forgets the state of the fields and the results of the solver, and starts
+  // again on the current contents of the mine sweeper, e.g. after its window
+  // was moved by MineSweeper::MoveWindow. The size of the mine field may
+  // change. Keeps the budgets of the tiers, the options, the threads and the
+  // table of the interned configuration sets, so restarting a seeker is much
+  // cheaper than creating a new one. Must not be called with active
+  // checkpoints.
+  void Restart();
 
   // Tests if configuration can be placed at the position (x, y) with respect to
   // the knowledge about the other fields.
   bool ConfigurationFitsAt(int configuration, int x, int y) const;
 
-  // Quick access to the state of the field at the given position.
-  const MineSeekerField& FieldAtPosition(int x, int y) const;
+  // Quick access to the state of the field at the given position. The field is
+  // a copy, and it does not change with the state of the seeker.
+  MineSeekerField FieldAtPosition(int x, int y) const;
   MineSeekerField::State StateAtPosition(int x, int y) const;
 
   // Tests if the current state of the seeker allows for a mine at the position
@@ -181,24 +614,189 @@ class MineSeeker {
   // mines or hidden fields, this method returns -1.
   int NumberOfMinesAroundField(int x, int y) const;
 
+  // Stores the uncovered fields with a positive number and at least one
+  // hidden neighbor, i.e. the fields that give the constraints of the
+  // frontier, to fields as indices y * width + x in the order of the rows.
+  // The fields are kept up to date around each field that changes its state,
+  // so this takes time proportional to their number, not to the size of the
+  // board. Erases any content that was stored in fields previously.
+  void GetFrontierConstraintFields(vector<int>* fields) const;
+
   // Runs the solver. Returns true if the game was successfully solved;
   // otherwise, returns false.
   bool Solve();
+  // Continues solving from the current state of the seeker, e.g. after the
+  // first field was uncovered by UncoverField. Unlike Solve, it does not ask
+  // for a start field. Returns true if the game was successfully solved;
+  // otherwise, returns false, e.g. when the seeker got stuck and the budget of
+  // GUESS_TIER was exhausted.
+  bool ContinueSolving();
+
+  // Notifies the seeker that a mine was added to or removed from the hidden
+  // field (x, y) in the mine sweeper, e.g. by MineSweeper::MoveMine. Only the
+  // numbers of the uncovered neighbors of the field change, so the knowledge
+  // of the seeker about all other fields remains valid. The configurations of
+  // the uncovered neighbors are computed again from their new numbers, and the
+  // propagation from them continues in the next call of ContinueSolving.
+  // ContinueSolving fails when the mine field has changes that were not
+  // handled, as detected from MineSweeper::version.
+  void HandleChangedMine(int x, int y);
+  // Notifies the seeker that the given fields of an observed mine sweeper were
+  // recorded by MineSweeper::ObserveField in a new frame of the game. Only the
+  // observed fields are loaded, in bulk as by the constructor, and only their
+  // uncovered neighbors are queued for update, so the cost depends on the
+  // changes and not on the size of the board. The propagation continues in
+  // the next call of Advise.
+  void HandleObservedFields(const vector<FieldCoordinate>& fields);
 
   // Marks the given field as a field with mine. Runs propagation on its
   // neighbors.
   void MarkAsMine(int x, int y);
   // Uncovers the given field. If the field did not contain a mine, returns true
   // and runs propagation on its neighbors. Otherwise, returns false and sets
-  // is_dead to true.
+  // is_dead to true. The field must not be marked as a mine; if it was already
+  // uncovered (e.g. by another thread), the method returns true and does
+  // nothing.
   bool UncoverField(int x, int y);
 
+  // A hidden field and the estimated probability that it contains a mine.
+  struct FieldGuess {
+    FieldGuess(const FieldCoordinate& guess_field, double probability)
+        : field(guess_field), mine_probability(probability) {}
+
+    FieldCoordinate field;
+    double mine_probability;
+  };
+  // The advice for the next moves of an observed game.
+  struct Advice {
+    // The hidden fields that are proven to contain no mine.
+    vector<FieldCoordinate> safe_fields;
+    // The hidden fields that are proven to contain a mine and that were not
+    // flagged.
+    vector<FieldCoordinate> mines;
+    // The remaining hidden fields on the frontier, from the least likely to
+    // contain a mine, and the first interior field by columns, which stands for
+    // all the interior fields. The fields of the components of the frontier
+    // that are too large to enumerate are not included.
+    vector<FieldGuess> guesses;
+    // The number of the hidden fields that are not on the frontier, and the
+    // probability of a mine in each of them.
+    int num_interior_fields;
+    double interior_mine_probability;
+  };
+  // Runs the propagation on an observed mine sweeper and stores the advice to
+  // 'advice'. Returns false if the observed fields are not consistent, e.g.
+  // when a number does not match its neighbors. Erases any content that was
+  // stored in advice previously. The propagation continues from the last
+  // advice, and the enumerations of the components of the frontier that did
+  // not change are taken from the cache, so the cost of an advice after
+  // HandleObservedFields depends on the changes and on the size of the
+  // frontier, not on the size of the board.
+  bool Advise(Advice* advice);
+
   // Returns true if the mine seeker stepped on a mine.
   bool is_dead() const { return is_dead_; }
   // Returns the MineSweeper instance on which the game is played.
   const MineSweeper& mine_sweeper() const { return mine_sweeper_; }
   // Returns the number of times the solver requested a safe field.
   int safe_field_requests() const { return safe_field_requests_; }
+  // Returns the number of times the solver had to guess a field.
+  int guesses() const { return guesses_; }
+
+  // Methods for backtracking. After a checkpoint is created, the mine seeker
+  // records all changes of its state (removed configurations, changes of the
+  // states of fields and pushes to and pops from the queues) to a trail.
+  // Rolling back to the checkpoint undoes the changes in the reverse order, in
+  // time proportional to the number of changes, so that search-based
+  // techniques can work with the state in place instead of copying it. The
+  // checkpoints can be nested. When there is no checkpoint, no changes are
+  // recorded.
+  //
+  // Note that the mine sweeper can't be rolled back; uncovering a mine after a
+  // checkpoint and rolling back makes the seeker alive again, but it does not
+  // hide the knowledge obtained by uncovering the fields.
+  //
+  // Creates a new checkpoint. Returns the number of checkpoints, including the
+  // new one.
+  int PushCheckpoint();
+  // Undoes all changes made after the last checkpoint and removes the
+  // checkpoint.
+  void RollbackToCheckpoint();
+  // Removes the last checkpoint, but keeps the changes made after it. If there
+  // is an enclosing checkpoint, the changes will be undone when rolling back
+  // to that checkpoint.
+  void CommitCheckpoint();
+  // Returns the number of active checkpoints.
+  int num_checkpoints() const { return checkpoints_.size(); }
+  // Returns the number of changes recorded on the trail.
+  int trail_size() const { return trail_.size(); }
+
+  // If true (the default), the solver asks the mine sweeper for a safe field
+  // when it gets stuck. Otherwise, it guesses the field that is the least
+  // likely to contain a mine. Hints are not available in the interactive
+  // representation of the mine sweeper, where the default is false.
+  bool use_hints() const { return use_hints_; }
+  void set_use_hints(bool use_hints) { use_hints_ = use_hints; }
+
+  // If true (the default), the pairwise consistency step first looks up the
+  // deductions for the 5x5 window around the pair in the pattern cache, which
+  // is shared by all mine seekers in the process.
+  bool use_pattern_cache() const { return use_pattern_cache_; }
+  void set_use_pattern_cache(bool use_pattern_cache) {
+    use_pattern_cache_ = use_pattern_cache;
+  }
+  // Returns the pattern cache shared by all mine seekers, e.g. to read its
+  // hit and miss statistics.
+  static PatternCache* pattern_cache();
+
+  // If true (the default), the pairwise consistency step for two adjacent
+  // fields first looks up their deductions in the table that is generated at
+  // build time (see pair_deductions.h).
+  bool use_deduction_tables() const { return use_deduction_tables_; }
+  void set_use_deduction_tables(bool use_deduction_tables) {
+    use_deduction_tables_ = use_deduction_tables;
+  }
+
+  // The number of threads used for failed-literal probing. When set to zero
+  // (the default), probing is disabled.
+  int probing_threads() const;
+  void set_probing_threads(int num_threads);
+
+  // The number of threads used for parallel propagation. When set to a
+  // positive number, uncovering, node consistency, the subset rule and
+  // pairwise consistency run in parallel on square tiles of the board, and
+  // they stop only when no tile has pending work. Since all these filters only
+  // remove configurations and uncover or mark proven fields, the result is the
+  // same as with the sequential propagation. When set to zero (the default),
+  // the filters run sequentially, one step at a time. Parallel propagation is
+  // not used while there are active checkpoints.
+  int propagation_threads() const;
+  void set_propagation_threads(int num_threads);
+
+  // Returns the name of the implementation of the operations on neighborhoods
+  // of fields used by the seeker. The operations are specialized for the board
+  // sizes of the standard difficulty presets ("9x9", "16x16" and "30x16"); the
+  // other boards use "generic".
+  const char* board_specialization() const { return kernels_->name; }
+
+  // The scheduler of the propagation tiers. The mutable version can be used to
+  // change the budgets of the tiers; see the Tier enum for their indices.
+  const PropagationScheduler& scheduler() const { return scheduler_; }
+  PropagationScheduler* mutable_scheduler() { return &scheduler_; }
+  // Leaves the deductions of the subset and the pair tiers to the enumeration
+  // of the frontier, which reuses its results for the components that did not
+  // change and avoids the long chains of pair steps after each change. The
+  // enumeration finds all deductions of the two tiers only in the components
+  // it can enumerate, so the two tiers are kept as a fallback: they run only
+  // while the last enumeration step left a component that needed more than
+  // kMaxEnumerationNodes search nodes.
+  void UseEnumerationInsteadOfLocalTiers();
+
+  // Returns the statistics of the solver: the counters collected since the
+  // mine seeker was created (or copied from the forked mine seeker), and the
+  // statistics of the propagation tiers from scheduler(). Erases any content
+  // that was stored in statistics previously.
+  void GetStatistics(SolverStatistics* statistics) const;
 
   // Exports the state of the solver to a string that can be printed to stdout.
   // The state is printed as a matrix with dots for hidden fields, stars for
@@ -207,10 +805,97 @@ class MineSeeker {
   void DebugString(string* out) const;
 
  private:
-  typedef vector<vector<MineSeekerField> > MineSeekerState;
   typedef vector<vector<int> > IntMatrix;
   typedef std::pair<FieldCoordinate, FieldCoordinate> CoordinatePair;
 
+  // A tile of the board used by parallel propagation; see
+  // RunParallelPropagationStep.
+  struct PropagationTile;
+  class PropagationTileTask;
+
+  // The width and the height of the tiles used by parallel propagation.
+  static const int kPropagationTileSize;
+
+  // The flags of the fields in state_. kFrontierConstraintFlag marks the
+  // fields in frontier_constraint_fields_, kProvenSafeFlag marks the fields in
+  // proven_safe_fields_.
+  static const int kFrontierConstraintFlag;
+  static const int kProvenSafeFlag;
+
+  // A single change of the state recorded on the trail. The meaning of the
+  // fields depends on the type of the change.
+  struct TrailEntry {
+    enum Type {
+      // The configurations of the field (x, y) were changed; 'value' is the
+      // handle of the old set of configurations.
+      SET_CONFIGURATIONS,
+      // The state of the field (x, y) was changed; 'value' is the old state.
+      SET_STATE,
+      // Coordinates (x, y) were added to the back of a queue.
+      PUSH_UNCOVER,
+      PUSH_UPDATE,
+      PUSH_SUBSET_UPDATE,
+      // Coordinates (x, y) and (x2, y2) were added to pair_update_queue_.
+      PUSH_PAIR_UPDATE,
+      // Coordinates (x, y) were removed from the front of a queue.
+      POP_UNCOVER,
+      POP_UPDATE,
+      POP_SUBSET_UPDATE,
+      // Coordinates (x, y) and (x2, y2) were removed from pair_update_queue_.
+      POP_PAIR_UPDATE,
+    };
+
+    TrailEntry(Type entry_type, int x_coord, int y_coord, int entry_value)
+        : type(entry_type), x(x_coord), y(y_coord), x2(0), y2(0),
+          value(entry_value) {}
+
+    Type type;
+    int x;
+    int y;
+    int x2;
+    int y2;
+    int value;
+  };
+
+  // The state of the mine seeker that is not recorded on the trail, but
+  // restored directly when rolling back to a checkpoint.
+  struct Checkpoint {
+    int trail_size;
+    bool is_dead;
+    int safe_field_requests;
+    int guesses;
+  };
+
+  // The operations on the neighborhood of a field that are specialized for the
+  // size of the board. The loops over the neighbors in the specialized
+  // versions have compile-time bounds and neighbor offsets, so the compiler can
+  // unroll them and fold the bounds checks. The implementation is selected
+  // once, in the constructor.
+  struct NeighborhoodKernels {
+    const char* name;
+    bool (MineSeeker::*filter_configurations)(int x, int y);
+    bool (MineSeeker::*push_configuration)(int configuration, int x, int y);
+    void (MineSeeker::*pop_configuration)(int configuration, int x, int y);
+  };
+  // Returns the kernels for the given size of the board.
+  static const NeighborhoodKernels* SelectNeighborhoodKernels(int width,
+                                                              int height);
+  template<typename Geometry>
+  static NeighborhoodKernels MakeNeighborhoodKernels(const char* name);
+
+  // Keeps only the possible configurations of the field (x, y) that fit with
+  // the states of its neighbors, and returns true if the configurations
+  // changed. This is equivalent to calling ConfigurationFitsAt for all
+  // possible configurations, but the neighbors are visited only once, and the
+  // filtering itself is memoized by the configuration table.
+  template<typename Geometry>
+  bool FilterConfigurations(int x, int y);
+  // The implementations of PushConfigurationAt and PopConfigurationAt.
+  template<typename Geometry>
+  bool PushConfigurationAtImpl(int configuration, int x, int y);
+  template<typename Geometry>
+  void PopConfigurationAtImpl(int configuration, int x, int y);
+
   // Checks that the given coordinates are valid. Uses CHECK_GE and CHECK_LT on
   // them.
   void CheckCoordinatesAreValid(int x, int y) const;
@@ -219,23 +904,148 @@ class MineSeeker {
   // (x, y) with respect to its neighbor with relative coordinates (cx, cy).
   bool ConfigurationFitsWithSingleField(int configuration,
                                         int x,
-                                        int x,
+                                        int y,
                                         int cx,
                                         int cy) const;
 
   // Selects a field with no mine that was not uncovered yet (for cases where
   // the solver gets stuck).
   bool GetSafeFieldCoordinates(FieldCoordinate* coordinates);
+  // Selects the hidden field with the lowest estimated probability of
+  // containing a mine. The probabilities of fields on the frontier are
+  // computed by enumerating the frontier, the remaining fields get the average
+  // probability of the mines that are not on the frontier.
+  bool GetGuessFieldCoordinates(FieldCoordinate* coordinates) const;
+  // Computes the estimated probabilities of a mine in the hidden fields: the
+  // probabilities of the fields on the frontier from the enumeration of its
+  // components, and the average probability of the remaining mines for the
+  // other fields, of which only the first max_interior_fields are stored. The
+  // fields of a component are stored in the order of the component, followed
+  // by the interior fields by columns. The interior fields are counted and
+  // collected by the state, so the board is not scanned. Erases any content
+  // that was stored in guesses previously. Returns the probability of a mine
+  // in an interior field, or zero if there are no interior fields.
+  double ComputeMineProbabilities(int max_interior_fields,
+                                  vector<FieldGuess>* guesses) const;
+  // Initializes the state from the known fields of an observed mine sweeper.
+  void LoadObservedFields();
+  // Changes the state of the known field (x, y) of an observed mine sweeper
+  // to the observed state. Does not update the configurations of the
+  // uncovered fields; see LoadObservedFields and HandleObservedFields.
+  void LoadObservedField(int x, int y);
+
+  // The result of the enumeration of a connected component of the frontier.
+  struct ComponentEnumeration {
+    // False if the enumeration exceeded kMaxEnumerationNodes; the other
+    // members are not valid in such case.
+    bool is_complete;
+    int64 num_solutions;
+    vector<int64> num_mines;
+  };
+  // The results of the enumeration indexed by Frontier::GetComponentKey.
+  typedef std::unordered_map<string, ComponentEnumeration>
+      ComponentEnumerationCache;
+  // Enumerates the component of the frontier, or takes the result from the
+  // last enumeration step when the component did not change since then; a
+  // move in one part of the board then does not enumerate the other parts
+  // again. Stores the result to 'cache' and returns a reference to it.
+  const ComponentEnumeration& EnumerateFrontierComponent(
+      const Frontier& frontier,
+      const vector<int>& component,
+      ComponentEnumerationCache* cache) const;
+
+  // Computes the set of hidden neighbors of the field at (x, y) as a bitmask
+  // relative to the anchor (anchor_x, anchor_y). The anchor is the top-left
+  // corner of a 5x5 window that must contain the whole neighborhood of the
+  // field; the neighbor at (nx, ny) is represented by the bit
+  // (nx - anchor_x) + 5 * (ny - anchor_y). Stores the number of mines around
+  // the field that were not found yet to remaining_mines.
+  int HiddenNeighborMask(int x,
+                         int y,
+                         int anchor_x,
+                         int anchor_y,
+                         int* remaining_mines) const;
+
+  // Methods that change the state of the fields and record the changes on the
+  // trail. All changes of the state of the fields must go through these
+  // methods.
+  void RecordTrailEntry(const TrailEntry& entry) {
+    if (!checkpoints_.empty()) {
+      trail_.push_back(entry);
+    }
+  }
+  //
+  // Atomically changes the state of a hidden field. Returns false if the field
+  // was not hidden.
+  bool TransitionFieldFromHidden(int x, int y, MineSeekerField::State state);
+  // Removes one or more configurations from the field. Returns true if the
+  // configurations of the field changed.
+  bool RemoveFieldConfiguration(int x, int y, int configuration);
+  bool RemoveFieldConfigurations(int x, int y,
+                                 const ConfigurationSet& removed);
+  void SetFieldConfiguration(int x, int y, int configuration);
+  // Replaces the configurations of the field by the interned set with the
+  // given handle. Returns true if the configurations of the field changed.
+  bool SetFieldConfigurationHandle(int x, int y, int handle);
+  // Removes the first element from the queue and records the change on the
+  // trail.
+  FieldCoordinate PopFieldFromQueue(std::deque<FieldCoordinate>* queue,
+                                    TrailEntry::Type pop_type);
+  // Undoes a single change recorded on the trail.
+  void UndoTrailEntry(const TrailEntry& entry);
+
+  // Methods for collecting the statistics of the solver. The statistics are
+  // collected in the tile processed by the current thread during parallel
+  // propagation, and merged to statistics_ after the parallel step.
+  //
+  // Returns the statistics to which the current thread adds its counters.
+  SolverStatistics* mutable_statistics();
+  // Counts the configurations removed from the field (x, y), when its set of
+  // configurations was replaced by a subset of the set with old_handle.
+  void CountConfigurationRemovals(int x, int y, int old_handle);
+  // Counts a field that was uncovered or marked as a mine by the propagation
+  // tier that is running, or by the guess tier outside of the scheduler.
+  void CountResolvedField();
+
+  // Methods for parallel propagation. The work items are represented by the
+  // PUSH_* trail entries for the corresponding queues.
+  //
+  // Creates the tiles for parallel propagation (if they do not exist yet).
+  void CreatePropagationTiles();
+  // Returns the index of the tile that contains the field (x, y).
+  int PropagationTileIndex(int x, int y) const;
+  // Adds a work item to the queues of the tile that contains its (first)
+  // field. When called from a tile task, items for other tiles are posted to
+  // their mailboxes.
+  void PostWorkItem(const TrailEntry& item);
+  // Processes all work items of the tile, including the items in its mailbox.
+  // Called from the tile tasks.
+  void ProcessPropagationTile(PropagationTile* tile);
 
   // Methods for adding fields to the queue to be processed.
   void QueueFieldForUncover(int x, int y);
   void QueueNeighborsForUpdate(int x, int y);
   void QueueFieldForUpdate(int x, int y);
+  void QueueFieldForSubsetUpdate(int x, int y);
   void QueueFieldPairForUpdate(int x1, int y1, int x2, int y2);
 
   // Resets the state of the mine seeker.
   void ResetState();
 
+  // Returns true if the field (x, y) is one of the frontier constraint fields;
+  // see GetFrontierConstraintFields.
+  bool IsFrontierConstraintField(int x, int y) const;
+  // Updates the frontier constraint fields for the field (x, y) and its
+  // neighbors, after the state of the field changed, and the interior fields
+  // that depend on them. When called from a tile task, the field is only
+  // recorded by the tile, and the update is done after the parallel
+  // propagation step.
+  void UpdateFrontierConstraintFieldsAround(int x, int y);
+  // Updates the interior flag of the field (x, y) in the state: the field is
+  // interior if it is hidden and none of its neighbors is a frontier
+  // constraint field. Does nothing for fields outside of the board.
+  void UpdateInteriorField(int x, int y);
+
   // Methods for working with temporary configurations for backtracking and
   // pairwise consistency. These methods keep track of mines and clear fields of
   // the temporary configurations. For each field, these methods keep track of
@@ -257,6 +1067,50 @@ class MineSeeker {
 
   // Performs a single step of the solution 
   bool SolveStep();
+  // Compacts the table of the configuration sets when it is getting full; see
+  // MineSeekerState::CompactConfigurationTable.
+  void MaybeCompactConfigurationTable();
+
+  // Registers the propagation tiers with the scheduler.
+  void AddPropagationTiers();
+
+  // Returns true if the subset and the pair tiers wait for the enumeration of
+  // the frontier; see UseEnumerationInsteadOfLocalTiers. Their queues are
+  // kept, so that they can run when the enumeration falls short.
+  bool DefersLocalTiers() const {
+    return uses_local_tiers_as_fallback_ && !has_incomplete_enumeration_;
+  }
+  // Methods implementing the propagation tiers; see the Tier enum for their
+  // description.
+  bool HasPendingParallelPropagation() const {
+    return propagation_thread_pool_.get() != NULL && checkpoints_.empty()
+        && (HasPendingUncovers() || HasPendingUpdates()
+            || HasPendingSubsetUpdates() || HasPendingPairUpdates());
+  }
+  bool RunParallelPropagationStep();
+  bool HasPendingUncovers() const { return !uncover_queue_.empty(); }
+  bool RunRevealStep();
+  bool HasPendingUpdates() const { return !update_queue_.empty(); }
+  bool RunFilterStep();
+  bool HasPendingSubsetUpdates() const {
+    return !subset_update_queue_.empty() && !DefersLocalTiers();
+  }
+  bool RunSubsetStep();
+  bool HasPendingPairUpdates() const {
+    return !pair_update_queue_.empty() && !DefersLocalTiers();
+  }
+  bool RunPairStep();
+  bool HasPendingProbing() const {
+    return probing_thread_pool_.get() != NULL
+        && probed_frontier_version_ != frontier_version_;
+  }
+  bool RunProbingStep();
+  bool HasPendingEnumeration() const {
+    return enumerated_frontier_version_ != frontier_version_;
+  }
+  bool RunEnumerationStep();
+  bool HasPendingGuess() const { return !IsSolved(); }
+  bool RunGuessStep();
 
   // Updates the available configurations at the given position based on the
   // fields around the position.
@@ -268,33 +1122,139 @@ class MineSeeker {
   // neighbors for update.
   void UpdateNeighborsAtPosition(int x, int y);
 
+  // Applies the subset rule to the field at (x, y) and all uncovered fields in
+  // its 5x5 neighborhood (in both directions). Uncovers the fields and marks
+  // mines that are proven by the rule.
+  void UpdateSubsetConsistency(int x, int y);
+
   // Removes non-compatible configurations for a pair of neighboring fields.
   void UpdatePairConsistency(int x1, int y1, int x2, int y2);
+  // Queues the fields for uncovering and marks the mines that are proven by
+  // the contents of the 5x5 window whose top-left corner is (anchor_x,
+  // anchor_y); the deductions are looked up in the pattern cache. Returns the
+  // mask of the deduced fields, with the bit dy * 5 + dx for the field
+  // (anchor_x + dx, anchor_y + dy).
+  int ApplyPatternDeductions(int anchor_x, int anchor_y);
+  // Queues the fields for uncovering and marks the mines that are proven by
+  // the pair of adjacent uncovered fields (x1, y1) and (x2, y2), using the
+  // precomputed deduction table. Returns true if one of the deduced fields is
+  // a neighbor of (x1, y1). Does nothing and returns false if the fields are
+  // not adjacent.
+  bool ApplyPairDeductionTable(int x1, int y1, int x2, int y2);
 
   // The queues for fields that should be uncovered by the algorithm and fields
   // that should be updated (after something in their neighborhood changed). The
   // algorithm processes them asynchronously to avoid too deep recursion and to
   // give uncovering a higher priority.
-  std::queue<FieldCoordinate> uncover_queue_;
-  std::queue<FieldCoordinate> update_queue_;
-  std::queue<CoordinatePair> pair_update_queue_;
+  std::deque<FieldCoordinate> uncover_queue_;
+  std::deque<FieldCoordinate> update_queue_;
+  std::deque<FieldCoordinate> subset_update_queue_;
+  std::deque<CoordinatePair> pair_update_queue_;
 
   // Reference to the mine field on which the mine seeker works.
   const MineSweeper& mine_sweeper_;
-  // The state of the mine seeker.
+  // The version of the mine field that is known to the seeker. Each call of
+  // HandleChangedMine and each observed field passed to HandleObservedFields
+  // account for one change of the mine field.
+  int64 mine_sweeper_version_;
+  // The state of the fields. The tiles of the state and the table of the
+  // interned configuration sets are shared with the forks of the mine seeker.
   MineSeekerState state_;
+  // The number of sets in the configuration table after it was last compacted.
+  int num_sets_after_compaction_;
   // Keeps trace of whether the mineseeker stepped on a mine when uncovering a
   // new field.
-  bool is_dead_;
+  // This variable and frontier_version_ are atomic, because they may be
+  // changed concurrently by parallel propagation.
+  std::atomic<bool> is_dead_;
   // The number of calls to GetSafeFieldCoordinates used while solving the
   // puzzle.
   int safe_field_requests_;
+  // The number of fields uncovered by guessing.
+  int guesses_;
+  // Set to true when the solver should ask for safe fields instead of
+  // guessing.
+  bool use_hints_;
+  // Set to true when the pairwise consistency uses the pattern cache.
+  bool use_pattern_cache_;
+  // Set to true when the pairwise consistency uses the deduction table.
+  bool use_deduction_tables_;
+  // The version of the frontier is incremented each time a field changes its
+  // state. The probing and enumeration tiers remember the version of the
+  // frontier they processed the last time, so that they only run again after
+  // a change.
+  std::atomic<int64> frontier_version_;
+  int64 probed_frontier_version_;
+  int64 enumerated_frontier_version_;
+  // The uncovered fields that give the constraints of the frontier (see
+  // GetFrontierConstraintFields), indexed by y * width + x. The fields in the
+  // set have kFrontierConstraintFlag in the state, so that the membership test
+  // does not need a lookup in the set.
+  std::unordered_set<int> frontier_constraint_fields_;
+  // The results of the last enumeration step, for all components of the
+  // frontier at that time.
+  ComponentEnumerationCache enumerated_components_;
+  // True if the subset and the pair tiers run only as a fallback for the
+  // enumeration (see UseEnumerationInsteadOfLocalTiers), and true if the last
+  // enumeration step did not complete some component of the frontier.
+  bool uses_local_tiers_as_fallback_;
+  bool has_incomplete_enumeration_;
+  // The hidden fields proven to be safe in an observed game, in the order in
+  // which they were found; the fields in the list have kProvenSafeFlag in the
+  // state. The safe fields are collected instead of uncovered only after
+  // LoadObservedFields was called.
+  vector<FieldCoordinate> proven_safe_fields_;
+  bool collects_proven_safe_fields_;
+  // The hidden fields marked as mines by the propagation in an observed game,
+  // in the order in which they were found. The fields observed since then are
+  // removed by Advise, except for the fields observed as uncovered, which
+  // contradict the propagation.
+  vector<FieldCoordinate> proven_mines_;
+  // The threads used for probing, or NULL if probing is disabled.
+  scoped_ptr<ThreadPool> probing_thread_pool_;
+
+  // The thread pool and the tiles for parallel propagation. The tiles are
+  // owned by the mine seeker and they are created on the first parallel step.
+  scoped_ptr<ThreadPool> propagation_thread_pool_;
+  vector<PropagationTile*> propagation_tiles_;
+  int propagation_width_in_tiles_;
+  // The tile processed by the current thread, or NULL if the current thread is
+  // not running a tile task.
+  static thread_local PropagationTile* current_propagation_tile_;
+
+  // The operations on neighborhoods specialized for the size of the board.
+  const NeighborhoodKernels* kernels_;
+
+  // Schedules the steps of the propagation tiers.
+  PropagationScheduler scheduler_;
+  // The counters of the solver; see GetStatistics.
+  SolverStatistics statistics_;
+
+  // The trail of changes made after the first checkpoint, and the stack of the
+  // active checkpoints.
+  vector<TrailEntry> trail_;
+  vector<Checkpoint> checkpoints_;
 
   FRIEND_TEST(MineSeekerTest, TestTemporaryStatus);
   FRIEND_TEST(MineSeekerTest, TestUpdateConfigurationsAtPoint);
   FRIEND_TEST(MineSeekerTest, TestUpdateNeighborsAtPoint);
   FRIEND_TEST(MineSeekerTest, TestUpdatePairConsistency);
+  FRIEND_TEST(MineSeekerTest, TestApplyPatternDeductions);
+  FRIEND_TEST(MineSeekerTest, TestApplyPairDeductionTable);
+  FRIEND_TEST(MineSeekerTest, TestUpdateSubsetConsistency);
+  FRIEND_TEST(MineSeekerEnumerationTest, TestEnumerationTier);
+  FRIEND_TEST(MineSeekerEnumerationTest, TestProbingTier);
+  FRIEND_TEST(MineSeekerEnumerationTest, TestLocalTiersAsFallback);
+  FRIEND_TEST(MineSeekerParallelTest, TestFrontierConstraintFields);
   FRIEND_TEST(MineSeekerTest, TestUncoverFieldWithNoMine);
+  FRIEND_TEST(MineSeekerTest, TestRollbackToCheckpoint);
+  FRIEND_TEST(MineSeekerTest, TestFork);
+  FRIEND_TEST(MineSeekerWindowTest, TestRestart);
+  FRIEND_TEST(MineSeekerBoardSpecializationTest, TestKernelsMatch);
+  // The micro-benchmarks in mineseeker_bench.cc measure the private methods.
+  friend class MineSeekerMicroBenchmark;
+
+  void operator=(const MineSeeker&);
 };
 
 }  // namespace mineseeker
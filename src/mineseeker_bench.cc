@@ -0,0 +1,625 @@
+// Copyright 2012 Ondrej Sykora
+//
+// This file is part of MineSeeker.
+//
+// MineSeeker is free software: you can redistribute it and/or modify it under
+// the terms of the GNU General Public License as published by the Free
+// Software Foundation, either version 3 of the License, or (at your option)
+// any later version.
+//
+// MineSeeker is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+// more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// MineSeeker. If not, see <http://www.gnu.org/licenses/>.
+//
+// Micro-benchmarks of the basic operations of the solver and macro-benchmarks
+// that solve boards of the standard sizes. Each benchmark is first calibrated
+// (which also warms up the caches), then it runs a number of warmup
+// repetitions that are not reported, and then the measured repetitions. The
+// report contains the mean time per operation with the standard deviation
+// over the repetitions and, for the macro-benchmarks, the number of solved
+// boards and cells per second.
+//
+// When the hardware performance counters are available (see PerfCounters),
+// the report also contains their values per operation, and with
+// --perf_counters_per_tier, the values per board for each propagation tier of
+// the solver. Without the counters, only the times are reported.
+//
+// Example use:
+//  > ./build/mineseeker_bench --benchmarks=Solve --repetitions=10
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <algorithm>
+#include <chrono>
+#include <random>
+#include <set>
+#include <sstream>
+#include "common.h"
+#include "gflags/gflags.h"
+#include "glog/logging.h"
+#include "minesweeper.h"
+#include "mineseeker.h"
+#include "perf_counters.h"
+#include "procedural_board_solver.h"
+#include "procedural_mine_field.h"
+#include "propagation_scheduler.h"
+#include "scoped_ptr.h"
+
+DEFINE_string(benchmarks, "",
+              "A comma-separated list of substrings of the names of the "
+              "benchmarks to run. When empty, all benchmarks are run.");
+DEFINE_int32(repetitions, 5, "The number of measured repetitions.");
+DEFINE_int32(warmup_repetitions, 1,
+             "The number of repetitions that are run before the measured "
+             "ones and that are not reported.");
+DEFINE_double(min_time, 0.2,
+              "The minimal duration of a single repetition in seconds.");
+DEFINE_int32(seed, 1, "The seed of the generator of the boards.");
+DEFINE_bool(perf_counters, true,
+            "Read the hardware performance counters around the benchmarks.");
+DEFINE_bool(perf_counters_per_tier, false,
+            "Read the hardware performance counters around each step of the "
+            "propagation tiers in the solve benchmarks, and report them per "
+            "tier. Reading the counters slows down the cheap tiers.");
+
+namespace mineseeker {
+
+// Creates a closed mine field of the given size with randomly placed mines.
+// The caller is responsible for deleting the returned object.
+MineSweeper* GenerateMineField(int width, int height, int mines, int seed) {
+  CHECK_LE(mines, width * height);
+  std::mt19937 generator(seed);
+  std::set<std::pair<int, int> > used_coordinates;
+  scoped_ptr<MineSweeper> mine_sweeper(new MineSweeper(width, height));
+  while (used_coordinates.size() < mines) {
+    const int x = generator() % width;
+    const int y = generator() % height;
+    if (used_coordinates.insert(std::make_pair(x, y)).second) {
+      mine_sweeper->SetMine(x, y, true);
+    }
+  }
+  mine_sweeper->CloseMineField();
+  return mine_sweeper.release();
+}
+
+// Returns the input format of the mine field, as read by
+// MineSweeper::LoadFromString.
+string MineFieldToString(const MineSweeper& mine_sweeper) {
+  std::ostringstream out;
+  out << mine_sweeper.width() << " " << mine_sweeper.height() << "\n"
+      << mine_sweeper.NumberOfMines() << "\n";
+  for (int y = 0; y < mine_sweeper.height(); ++y) {
+    for (int x = 0; x < mine_sweeper.width(); ++x) {
+      if (mine_sweeper.IsMine(x, y)) {
+        out << x << " " << y << "\n";
+      }
+    }
+  }
+  return out.str();
+}
+
+// The base class for the benchmarks. A benchmark measures the time of a
+// single operation; Run runs the operation the given number of times.
+class Benchmark {
+ public:
+  explicit Benchmark(const string& name) : name_(name) {}
+  virtual ~Benchmark() {}
+
+  const string& name() const { return name_; }
+
+  // Runs the measured operation 'iterations' times.
+  virtual void Run(int64 iterations) = 0;
+  // The number of boards and cells solved by a single operation. Only the
+  // macro-benchmarks solve boards.
+  virtual double boards_per_operation() const { return 0.0; }
+  virtual double cells_per_operation() const { return 0.0; }
+
+  // Resets the statistics of the propagation tiers collected by the
+  // benchmark, and prints them divided by the given number of operations. Only
+  // the macro-benchmarks collect the statistics.
+  virtual void ResetTierStatistics() {}
+  virtual void PrintTierStatistics(double operations) const {}
+
+ private:
+  const string name_;
+};
+
+// Fixtures for the micro-benchmarks of the private methods of MineSeeker. The
+// seeker works on an expert board with a part of the board uncovered.
+class MineSeekerMicroBenchmark : public Benchmark {
+ public:
+  explicit MineSeekerMicroBenchmark(const string& name)
+      : Benchmark(name),
+        mine_sweeper_(GenerateMineField(30, 16, 99, FLAGS_seed)),
+        mine_seeker_(new MineSeeker(*mine_sweeper_)) {
+    // Run a few steps of the solver, so that the board has some uncovered
+    // fields and a frontier.
+    for (int i = 0; i < 2000 && mine_seeker_->SolveStep(); ++i) {}
+    for (int y = 0; y < mine_sweeper_->height(); ++y) {
+      for (int x = 0; x < mine_sweeper_->width(); ++x) {
+        if (mine_seeker_->StateAtPosition(x, y) == MineSeekerField::UNCOVERED) {
+          uncovered_fields_.push_back(FieldCoordinate(x, y));
+        }
+      }
+    }
+    CHECK(!uncovered_fields_.empty());
+  }
+
+ protected:
+  // Drops the work queued by the measured operations, so that the queues do
+  // not grow without bounds.
+  void ClearQueues() {
+    mine_seeker_->uncover_queue_.clear();
+    mine_seeker_->update_queue_.clear();
+    mine_seeker_->subset_update_queue_.clear();
+    mine_seeker_->pair_update_queue_.clear();
+  }
+
+  bool ConfigurationFitsAt(int configuration, int x, int y) const {
+    return mine_seeker_->ConfigurationFitsAt(configuration, x, y);
+  }
+  void UpdateConfigurationsAtPosition(int x, int y) {
+    mine_seeker_->UpdateConfigurationsAtPosition(x, y);
+  }
+  void UpdatePairConsistency(int x1, int y1, int x2, int y2) {
+    mine_seeker_->UpdatePairConsistency(x1, y1, x2, y2);
+  }
+
+  scoped_ptr<MineSweeper> mine_sweeper_;
+  scoped_ptr<MineSeeker> mine_seeker_;
+  vector<FieldCoordinate> uncovered_fields_;
+};
+
+class ConfigurationFitsAtBenchmark : public MineSeekerMicroBenchmark {
+ public:
+  ConfigurationFitsAtBenchmark()
+      : MineSeekerMicroBenchmark("ConfigurationFitsAt"), num_fits_(0) {}
+
+  virtual void Run(int64 iterations) {
+    int field = 0;
+    for (int64 i = 0; i < iterations; ++i) {
+      const int configuration =
+          i % MineSeekerField::kNumPossibleConfigurations;
+      if (configuration == 0) {
+        field = (field + 1) % uncovered_fields_.size();
+      }
+      const FieldCoordinate& coordinates = uncovered_fields_[field];
+      num_fits_ += ConfigurationFitsAt(configuration, coordinates.x,
+                                       coordinates.y);
+    }
+  }
+
+ private:
+  // Keeps the compiler from optimizing the calls away.
+  int64 num_fits_;
+};
+
+class UpdateConfigurationsAtPositionBenchmark
+    : public MineSeekerMicroBenchmark {
+ public:
+  UpdateConfigurationsAtPositionBenchmark()
+      : MineSeekerMicroBenchmark("UpdateConfigurationsAtPosition") {}
+
+  virtual void Run(int64 iterations) {
+    for (int64 i = 0; i < iterations; ++i) {
+      const FieldCoordinate& coordinates =
+          uncovered_fields_[i % uncovered_fields_.size()];
+      UpdateConfigurationsAtPosition(coordinates.x, coordinates.y);
+      if (i % 256 == 255) {
+        ClearQueues();
+      }
+    }
+    ClearQueues();
+  }
+};
+
+class UpdatePairConsistencyBenchmark : public MineSeekerMicroBenchmark {
+ public:
+  UpdatePairConsistencyBenchmark()
+      : MineSeekerMicroBenchmark("UpdatePairConsistency") {
+    for (int i = 0; i < uncovered_fields_.size(); ++i) {
+      const FieldCoordinate& first = uncovered_fields_[i];
+      for (int j = 0; j < uncovered_fields_.size(); ++j) {
+        const FieldCoordinate& second = uncovered_fields_[j];
+        if (i != j && abs(first.x - second.x) <= 2
+            && abs(first.y - second.y) <= 2) {
+          pairs_.push_back(std::make_pair(first, second));
+        }
+      }
+    }
+    CHECK(!pairs_.empty());
+  }
+
+  virtual void Run(int64 iterations) {
+    for (int64 i = 0; i < iterations; ++i) {
+      const std::pair<FieldCoordinate, FieldCoordinate>& pair =
+          pairs_[i % pairs_.size()];
+      UpdatePairConsistency(pair.first.x, pair.first.y,
+                            pair.second.x, pair.second.y);
+      if (i % 256 == 255) {
+        ClearQueues();
+      }
+    }
+    ClearQueues();
+  }
+
+ private:
+  vector<std::pair<FieldCoordinate, FieldCoordinate> > pairs_;
+};
+
+// Creates an expert board and closes it. The operation includes the
+// allocation of the board and the placement of the mines.
+class CloseMineFieldBenchmark : public Benchmark {
+ public:
+  CloseMineFieldBenchmark() : Benchmark("CloseMineField/30x16") {
+    scoped_ptr<MineSweeper> mine_sweeper(
+        GenerateMineField(30, 16, 99, FLAGS_seed));
+    for (int y = 0; y < mine_sweeper->height(); ++y) {
+      for (int x = 0; x < mine_sweeper->width(); ++x) {
+        if (mine_sweeper->IsMine(x, y)) {
+          mines_.push_back(FieldCoordinate(x, y));
+        }
+      }
+    }
+  }
+
+  virtual void Run(int64 iterations) {
+    for (int64 i = 0; i < iterations; ++i) {
+      MineSweeper mine_sweeper(30, 16);
+      for (int j = 0; j < mines_.size(); ++j) {
+        mine_sweeper.SetMine(mines_[j].x, mines_[j].y, true);
+      }
+      mine_sweeper.CloseMineField();
+    }
+  }
+
+ private:
+  vector<FieldCoordinate> mines_;
+};
+
+class LoadFromStringBenchmark : public Benchmark {
+ public:
+  LoadFromStringBenchmark() : Benchmark("LoadFromString/30x16") {
+    scoped_ptr<MineSweeper> mine_sweeper(
+        GenerateMineField(30, 16, 99, FLAGS_seed));
+    input_ = MineFieldToString(*mine_sweeper);
+  }
+
+  virtual void Run(int64 iterations) {
+    for (int64 i = 0; i < iterations; ++i) {
+      scoped_ptr<MineSweeper> mine_sweeper(
+          MineSweeper::LoadFromString(input_));
+      CHECK(mine_sweeper.get() != NULL);
+    }
+  }
+
+ private:
+  string input_;
+};
+
+// Solves boards of the given size. The boards are generated in advance with
+// fixed seeds; each operation solves the next board from the set.
+class SolveBenchmark : public Benchmark {
+ public:
+  // When perf_counters is not NULL, the benchmark collects the values of the
+  // counters for the propagation tiers. Does not take ownership of the
+  // counters.
+  SolveBenchmark(const string& name, int width, int height, int mines,
+                 int num_boards, const PerfCounters* perf_counters)
+      : Benchmark(name),
+        width_(width),
+        height_(height),
+        perf_counters_(perf_counters) {
+    for (int i = 0; i < num_boards; ++i) {
+      boards_.push_back(
+          GenerateMineField(width, height, mines, FLAGS_seed + i));
+    }
+    next_board_ = 0;
+  }
+  virtual ~SolveBenchmark() {
+    for (int i = 0; i < boards_.size(); ++i) {
+      delete boards_[i];
+    }
+  }
+
+  virtual void Run(int64 iterations) {
+    for (int64 i = 0; i < iterations; ++i) {
+      MineSeeker mine_seeker(*boards_[next_board_]);
+      mine_seeker.mutable_scheduler()->set_perf_counters(perf_counters_);
+      mine_seeker.Solve();
+      next_board_ = (next_board_ + 1) % boards_.size();
+      AddTierStatistics(mine_seeker.scheduler());
+    }
+  }
+
+  virtual void ResetTierStatistics() {
+    tier_names_.clear();
+    tier_statistics_.clear();
+  }
+  virtual void PrintTierStatistics(double operations) const {
+    for (int i = 0; i < tier_statistics_.size(); ++i) {
+      const PropagationTierStatistics& statistics = tier_statistics_[i];
+      printf("  %-34s %14.1f ns/board %10.1f steps/board",
+             tier_names_[i].c_str(), statistics.total_time_ns / operations,
+             statistics.num_steps / operations);
+      if (perf_counters_ != NULL) {
+        for (int counter = 0; counter < PerfCounterValues::kNumCounters;
+             ++counter) {
+          if (perf_counters_->IsAvailable(counter)) {
+            printf(" %s=%.0f", PerfCounterValues::CounterName(counter),
+                   statistics.perf_counters.values[counter] / operations);
+          }
+        }
+      }
+      printf("\n");
+    }
+  }
+
+  virtual double boards_per_operation() const { return 1.0; }
+  virtual double cells_per_operation() const {
+    return static_cast<double>(width_) * height_;
+  }
+
+ private:
+  const int width_;
+  const int height_;
+  // Adds the statistics of the tiers of the scheduler to tier_statistics_.
+  void AddTierStatistics(const PropagationScheduler& scheduler) {
+    if (tier_statistics_.empty()) {
+      for (int i = 0; i < scheduler.num_tiers(); ++i) {
+        tier_names_.push_back(scheduler.tier_name(i));
+      }
+      tier_statistics_.resize(scheduler.num_tiers());
+    }
+    CHECK_EQ(tier_statistics_.size(), scheduler.num_tiers());
+    for (int i = 0; i < scheduler.num_tiers(); ++i) {
+      const PropagationTierStatistics& statistics =
+          scheduler.tier_statistics(i);
+      PropagationTierStatistics* const total = &tier_statistics_[i];
+      total->num_steps += statistics.num_steps;
+      total->num_failed_steps += statistics.num_failed_steps;
+      total->num_skipped_for_budget += statistics.num_skipped_for_budget;
+      total->total_time_ns += statistics.total_time_ns;
+      total->perf_counters.Add(statistics.perf_counters);
+    }
+  }
+
+  vector<MineSweeper*> boards_;
+  int next_board_;
+  const PerfCounters* perf_counters_;
+  vector<string> tier_names_;
+  vector<PropagationTierStatistics> tier_statistics_;
+};
+
+// Solves an unbounded procedural board with ProceduralBoardSolver, until a
+// fixed number of fields is uncovered. Each operation solves a board with a
+// different seed from the start; the number of cells per operation is the
+// number of uncovered fields requested from the solver, which the solver may
+// slightly exceed.
+class ProceduralSolveBenchmark : public Benchmark {
+ public:
+  ProceduralSolveBenchmark(const string& name, double density,
+                           int64 num_fields, int max_resident_chunks)
+      : Benchmark(name),
+        density_(density),
+        num_fields_(num_fields),
+        max_resident_chunks_(max_resident_chunks),
+        next_seed_(FLAGS_seed) {}
+
+  virtual void Run(int64 iterations) {
+    const int kMaxSize = 2000000000;
+    for (int64 i = 0; i < iterations; ++i) {
+      const ProceduralMineField mine_field(kMaxSize, kMaxSize, density_,
+                                           next_seed_++);
+      ProceduralBoardSolver solver(&mine_field, max_resident_chunks_);
+      CHECK(solver.Solve(kMaxSize / 2, kMaxSize / 2, num_fields_));
+    }
+  }
+
+  virtual double boards_per_operation() const { return 1.0; }
+  virtual double cells_per_operation() const { return num_fields_; }
+
+ private:
+  const double density_;
+  const int64 num_fields_;
+  const int max_resident_chunks_;
+  uint64 next_seed_;
+};
+
+// Returns true if the benchmark was selected by --benchmarks.
+bool IsSelected(const string& name) {
+  if (FLAGS_benchmarks.empty()) {
+    return true;
+  }
+  std::istringstream filters(FLAGS_benchmarks);
+  string filter;
+  while (std::getline(filters, filter, ',')) {
+    if (!filter.empty() && name.find(filter) != string::npos) {
+      return true;
+    }
+  }
+  return false;
+}
+
+// Returns the duration of running the benchmark 'iterations' times in
+// seconds. When perf_counters is not NULL, adds the values of the counters
+// during the run to 'counter_values'.
+double TimeRun(Benchmark* benchmark, int64 iterations,
+               const PerfCounters* perf_counters,
+               PerfCounterValues* counter_values) {
+  PerfCounterValues start_counters;
+  if (perf_counters != NULL) {
+    perf_counters->Read(&start_counters);
+  }
+  const std::chrono::steady_clock::time_point start =
+      std::chrono::steady_clock::now();
+  benchmark->Run(iterations);
+  const double seconds = std::chrono::duration<double>(
+      std::chrono::steady_clock::now() - start).count();
+  if (perf_counters != NULL) {
+    PerfCounterValues end_counters;
+    perf_counters->Read(&end_counters);
+    end_counters.Subtract(start_counters);
+    counter_values->Add(end_counters);
+  }
+  return seconds;
+}
+
+double TimeRun(Benchmark* benchmark, int64 iterations) {
+  return TimeRun(benchmark, iterations, NULL, NULL);
+}
+
+// Runs the benchmark and prints its results. When perf_counters is not NULL,
+// prints also the values of the counters per operation.
+void RunBenchmark(Benchmark* benchmark, const PerfCounters* perf_counters) {
+  CHECK_NOTNULL(benchmark);
+  // Find the number of iterations that takes at least --min_time.
+  int64 iterations = 1;
+  for (;;) {
+    const double seconds = TimeRun(benchmark, iterations);
+    if (seconds >= FLAGS_min_time) {
+      break;
+    }
+    const double factor = seconds > 0.0 ? FLAGS_min_time / seconds : 100.0;
+    iterations = static_cast<int64>(
+        iterations * std::min(100.0, std::max(2.0, 1.2 * factor)));
+  }
+  for (int i = 0; i < FLAGS_warmup_repetitions; ++i) {
+    TimeRun(benchmark, iterations);
+  }
+
+  benchmark->ResetTierStatistics();
+  vector<double> nanoseconds_per_operation;
+  PerfCounterValues counter_values;
+  for (int i = 0; i < FLAGS_repetitions; ++i) {
+    nanoseconds_per_operation.push_back(
+        1e9 * TimeRun(benchmark, iterations, perf_counters, &counter_values)
+        / iterations);
+  }
+  const double num_operations =
+      static_cast<double>(iterations) * FLAGS_repetitions;
+  double mean = 0.0;
+  for (int i = 0; i < nanoseconds_per_operation.size(); ++i) {
+    mean += nanoseconds_per_operation[i];
+  }
+  mean /= nanoseconds_per_operation.size();
+  double variance = 0.0;
+  for (int i = 0; i < nanoseconds_per_operation.size(); ++i) {
+    const double difference = nanoseconds_per_operation[i] - mean;
+    variance += difference * difference;
+  }
+  if (nanoseconds_per_operation.size() > 1) {
+    variance /= nanoseconds_per_operation.size() - 1;
+  }
+  const double standard_deviation = sqrt(variance);
+
+  printf("%-36s %14.1f ns/op +- %5.1f%% %10lld iters",
+         benchmark->name().c_str(), mean,
+         mean > 0.0 ? 100.0 * standard_deviation / mean : 0.0,
+         static_cast<long long>(iterations));
+  if (benchmark->boards_per_operation() > 0.0) {
+    const double operations_per_second = 1e9 / mean;
+    printf(" %10.1f boards/s %12.0f cells/s",
+           operations_per_second * benchmark->boards_per_operation(),
+           operations_per_second * benchmark->cells_per_operation());
+  }
+  printf("\n");
+  if (perf_counters != NULL) {
+    printf("  %-34s", "counters/op");
+    for (int counter = 0; counter < PerfCounterValues::kNumCounters;
+         ++counter) {
+      if (perf_counters->IsAvailable(counter)) {
+        printf(" %s=%.1f", PerfCounterValues::CounterName(counter),
+               counter_values.values[counter] / num_operations);
+      }
+    }
+    const int64 cycles = counter_values.values[PerfCounterValues::CYCLES];
+    if (cycles > 0) {
+      printf(" IPC=%.2f",
+             static_cast<double>(
+                 counter_values.values[PerfCounterValues::INSTRUCTIONS])
+             / cycles);
+    }
+    printf("\n");
+  }
+  benchmark->PrintTierStatistics(num_operations);
+  fflush(stdout);
+}
+
+void RunAllBenchmarks() {
+  CHECK_GT(FLAGS_repetitions, 0);
+  CHECK_GE(FLAGS_warmup_repetitions, 0);
+  CHECK_GT(FLAGS_min_time, 0.0);
+  scoped_ptr<PerfCounters> perf_counters;
+  if (FLAGS_perf_counters) {
+    perf_counters.reset(new PerfCounters());
+    if (!perf_counters->IsAnyAvailable()) {
+      printf("Performance counters are not available, reporting only times."
+             "\n");
+      perf_counters.reset(NULL);
+    }
+  }
+  const PerfCounters* const tier_perf_counters =
+      FLAGS_perf_counters_per_tier ? perf_counters.get() : NULL;
+  // The benchmarks are created only when they are selected, because setting up
+  // the macro-benchmarks takes some time.
+  vector<Benchmark*> benchmarks;
+  if (IsSelected("ConfigurationFitsAt")) {
+    benchmarks.push_back(new ConfigurationFitsAtBenchmark());
+  }
+  if (IsSelected("UpdateConfigurationsAtPosition")) {
+    benchmarks.push_back(new UpdateConfigurationsAtPositionBenchmark());
+  }
+  if (IsSelected("UpdatePairConsistency")) {
+    benchmarks.push_back(new UpdatePairConsistencyBenchmark());
+  }
+  if (IsSelected("CloseMineField/30x16")) {
+    benchmarks.push_back(new CloseMineFieldBenchmark());
+  }
+  if (IsSelected("LoadFromString/30x16")) {
+    benchmarks.push_back(new LoadFromStringBenchmark());
+  }
+  if (IsSelected("Solve/Beginner")) {
+    benchmarks.push_back(
+        new SolveBenchmark("Solve/Beginner", 9, 9, 10, 100,
+                           tier_perf_counters));
+  }
+  if (IsSelected("Solve/Intermediate")) {
+    benchmarks.push_back(
+        new SolveBenchmark("Solve/Intermediate", 16, 16, 40, 50,
+                           tier_perf_counters));
+  }
+  if (IsSelected("Solve/Expert")) {
+    benchmarks.push_back(
+        new SolveBenchmark("Solve/Expert", 30, 16, 99, 50,
+                           tier_perf_counters));
+  }
+  if (IsSelected("Solve/Huge")) {
+    benchmarks.push_back(
+        new SolveBenchmark("Solve/Huge", 100, 100, 1600, 5,
+                           tier_perf_counters));
+  }
+  if (IsSelected("ProceduralSolve/Unbounded")) {
+    benchmarks.push_back(
+        new ProceduralSolveBenchmark("ProceduralSolve/Unbounded", 0.15, 100000,
+                                     64));
+  }
+  for (int i = 0; i < benchmarks.size(); ++i) {
+    RunBenchmark(benchmarks[i], perf_counters.get());
+    delete benchmarks[i];
+  }
+}
+
+}  // namespace mineseeker
+
+int main(int argc, char* argv[]) {
+  google::ParseCommandLineFlags(&argc, &argv, true);
+  google::InitGoogleLogging(argv[0]);
+  mineseeker::RunAllBenchmarks();
+  return 0;
+}
@@ -15,12 +15,56 @@
 // You should have received a copy of the GNU General Public License along with
 // MineSeeker. If not, see <http://www.gnu.org/licenses/>.
 
+#include <fstream>
 #include <iostream>
+#include <sstream>
 #include "common.h"
+#include "field_revealer.h"
+#include "gflags/gflags.h"
 #include "glog/logging.h"
 #include "minesweeper.h"
 #include "mineseeker.h"
 #include "scoped_ptr.h"
+#include "solver_statistics.h"
+#include "streaming_board_solver.h"
+#include "tracer.h"
+
+DEFINE_string(statistics_json, "",
+              "When not empty, the statistics of the solve are written as a "
+              "JSON object to the file with this name.");
+DEFINE_string(trace_json, "",
+              "When not empty, the events of the solver are traced and "
+              "written in the Chrome trace-event format to the file with "
+              "this name.");
+DEFINE_int32(trace_events_per_thread,
+             mineseeker::Tracer::kDefaultEventsPerThread,
+             "The maximal number of traced events kept for each thread; the "
+             "older events are dropped.");
+DEFINE_string(streaming_output, "",
+              "When not empty, the mine field on stdin is in the binary "
+              "format, and it is solved in bands of rows by the streaming "
+              "solver. The states of the fields are written to the file with "
+              "this name, one byte per field.");
+DEFINE_bool(interactive, false,
+            "When true, the game is played over a line protocol. The first "
+            "line of stdin is '{width} {height} {number of mines}'; then the "
+            "solver writes 'uncover {x} {y}' for each field it uncovers and "
+            "reads the reply '{x} {y} {number of mines around the field}', "
+            "with -1 when there was a mine. The last line of the output is "
+            "'solved', 'stuck' or 'dead'.");
+DEFINE_bool(observed, false,
+            "When true, stdin contains a partially uncovered game in the "
+            "format of MineSweeper::LoadObservedFromString. The solver "
+            "writes 'safe {x} {y}' for each hidden field without a mine, "
+            "'mine {x} {y}' for each hidden field with a mine that was not "
+            "flagged, and 'guess {x} {y} {probability}' for the other hidden "
+            "fields on the frontier and for the first field away from it, "
+            "from the least likely to contain a mine. The last line of the "
+            "output is 'consistent' or 'inconsistent'.");
+DEFINE_int32(max_guesses, 10,
+             "The maximal number of guesses written in the observed mode.");
+DEFINE_int32(streaming_window_rows, 64,
+             "The number of rows in a band of the streaming solver.");
 
 namespace mineseeker {
 
@@ -45,11 +89,46 @@ bool RunSolverOnStdin() {
   }
 
   scoped_ptr<MineSeeker> mine_seeker(new MineSeeker(*mine_sweeper));
+  LOG(INFO) << "Using the " << mine_seeker->board_specialization()
+            << " board specialization";
+  scoped_ptr<Tracer> tracer;
+  if (!FLAGS_trace_json.empty()) {
+    tracer.reset(new Tracer(FLAGS_trace_events_per_thread));
+    tracer->Start();
+  }
   if (mine_seeker->Solve()) {
     LOG(INFO) << "Hooray!";
   } else {
     LOG(INFO) << "Did not finish, booo!";
   }
+  if (tracer.get() != NULL) {
+    tracer->Stop();
+    LOG(INFO) << "Traced " << tracer->num_events() << " events, dropped "
+              << tracer->num_dropped_events();
+    string json;
+    tracer->ToChromeTraceJson(&json);
+    std::ofstream trace_file(FLAGS_trace_json.c_str());
+    trace_file << json;
+    if (!trace_file) {
+      LOG(ERROR) << "Could not write the trace to " << FLAGS_trace_json;
+    }
+  }
+  const PatternCache* const pattern_cache = MineSeeker::pattern_cache();
+  LOG(INFO) << "Pattern cache: " << pattern_cache->num_hits() << " hits, "
+            << pattern_cache->num_misses() << " misses";
+
+  if (!FLAGS_statistics_json.empty()) {
+    SolverStatistics statistics;
+    mine_seeker->GetStatistics(&statistics);
+    string json;
+    statistics.ToJson(&json);
+    std::ofstream statistics_file(FLAGS_statistics_json.c_str());
+    statistics_file << json << std::endl;
+    if (!statistics_file) {
+      LOG(ERROR) << "Could not write the statistics to "
+                 << FLAGS_statistics_json;
+    }
+  }
   
   string output;
   mine_seeker->DebugString(&output);
@@ -57,10 +136,101 @@ bool RunSolverOnStdin() {
 
   return true;
 }
+bool RunInteractiveSolver() {
+  string header;
+  std::getline(std::cin, header);
+  std::istringstream header_stream(header);
+  int width = 0;
+  int height = 0;
+  int num_mines = -1;
+  header_stream >> width >> height >> num_mines;
+  if (!header_stream || width <= 0 || height <= 0 || num_mines < 0) {
+    LOG(ERROR) << "Invalid header of the game: " << header;
+    return false;
+  }
+  StreamFieldRevealer revealer(&std::cin, &std::cout);
+  MineSweeper mine_sweeper(width, height, num_mines, &revealer);
+  MineSeeker mine_seeker(mine_sweeper);
+  // Keeps the time between the moves short.
+  mine_seeker.UseEnumerationInsteadOfLocalTiers();
+  const bool solved = mine_seeker.Solve();
+  if (revealer.failed()) {
+    return false;
+  }
+  if (solved) {
+    std::cout << "solved" << std::endl;
+  } else {
+    std::cout << (mine_seeker.is_dead() ? "dead" : "stuck") << std::endl;
+  }
+  if (revealer.num_moves() > 1) {
+    LOG(INFO) << revealer.num_moves() << " moves, "
+              << revealer.total_move_time_ns()
+                     / (revealer.num_moves() - 1)
+              << " ns per move on average, at most "
+              << revealer.max_move_time_ns() << " ns";
+  }
+  return true;
+}
+
+bool RunObservedSolverOnStdin() {
+  string input;
+  ReadStdinToString(&input);
+  scoped_ptr<MineSweeper> mine_sweeper(
+      MineSweeper::LoadObservedFromString(input));
+  if (!mine_sweeper.get()) {
+    return false;
+  }
+  const int64 start_ns = Tracer::NowNs();
+  MineSeeker mine_seeker(*mine_sweeper);
+  MineSeeker::Advice advice;
+  const bool consistent = mine_seeker.Advise(&advice);
+  LOG(INFO) << "Advised in " << Tracer::NowNs() - start_ns << " ns";
+  for (int i = 0; i < advice.safe_fields.size(); ++i) {
+    const FieldCoordinate& field = advice.safe_fields[i];
+    std::cout << "safe " << field.x << " " << field.y << "\n";
+  }
+  for (int i = 0; i < advice.mines.size(); ++i) {
+    const FieldCoordinate& field = advice.mines[i];
+    std::cout << "mine " << field.x << " " << field.y << "\n";
+  }
+  for (int i = 0; i < advice.guesses.size() && i < FLAGS_max_guesses; ++i) {
+    const MineSeeker::FieldGuess& guess = advice.guesses[i];
+    std::cout << "guess " << guess.field.x << " " << guess.field.y << " "
+              << guess.mine_probability << "\n";
+  }
+  std::cout << (consistent ? "consistent" : "inconsistent") << std::endl;
+  return true;
+}
+
+bool RunStreamingSolverOnStdin() {
+  std::ofstream output(FLAGS_streaming_output.c_str(),
+                       std::ios::out | std::ios::binary);
+  StreamingBoardSolver solver(FLAGS_streaming_window_rows);
+  const bool solved = solver.Solve(&std::cin, &output);
+  LOG(INFO) << "Uncovered " << solver.num_uncovered_fields() << " fields in "
+            << solver.num_band_solves() << " bands with "
+            << solver.safe_field_requests() << " safe field requests; at "
+            << "most " << solver.peak_resident_rows() << " rows in memory";
+  if (!solved) {
+    LOG(ERROR) << "Could not solve the mine field or write the states to "
+               << FLAGS_streaming_output;
+  }
+  return solved;
+}
 }  // namespace mineseeker
 
 int main(int argc, char* argv[]) {
+  google::ParseCommandLineFlags(&argc, &argv, true);
   google::InitGoogleLogging("MineSeeker");
+  if (FLAGS_interactive) {
+    return mineseeker::RunInteractiveSolver() ? 0 : 1;
+  }
+  if (FLAGS_observed) {
+    return mineseeker::RunObservedSolverOnStdin() ? 0 : 1;
+  }
+  if (!FLAGS_streaming_output.empty()) {
+    return mineseeker::RunStreamingSolverOnStdin() ? 0 : 1;
+  }
   if (mineseeker::RunSolverOnStdin()) {
     return 0;
   } else {
@@ -15,66 +15,400 @@
 // You should have received a copy of the GNU General Public License along with
 // MineSeeker. If not, see <http://www.gnu.org/licenses/>.
 
+#include <algorithm>
+#include <atomic>
+#include <sstream>
+
+#include "board_generator.h"
 #include "common.h"
+#include "field_revealer.h"
 #include "glog/logging.h"
 #include "gtest/gtest.h"
 #include "minesweeper.h"
 #include "mineseeker.h"
+#include "procedural_mine_field.h"
 #include "scoped_ptr.h"
+#include "thread_pool.h"
 
 namespace mineseeker {
 
 
-TEST(MineSeekerFieldTest, TestPushTemporaryMine) {
-  MineSeekerField field;
+TEST(MineSeekerStateTest, TestResize) {
+  MineSeekerState state;
+  state.Resize(40, 3);
+  EXPECT_EQ(40, state.width());
+  EXPECT_EQ(3, state.height());
+  EXPECT_EQ(120, state.num_hidden_fields());
+  for (int x = 0; x < 40; ++x) {
+    for (int y = 0; y < 3; ++y) {
+      EXPECT_EQ(MineSeekerField::HIDDEN, state.state(x, y));
+      EXPECT_EQ(0, state.temporary_status(x, y));
+    }
+  }
+  for (int x = 1; x < 39; ++x) {
+    EXPECT_EQ(MineSeekerField::kNumPossibleConfigurations,
+              state.configurations(x, 1).count());
+  }
+}
+
+TEST(MineSeekerStateTest, TestTransitionFromHidden) {
+  MineSeekerState state;
+  state.Resize(40, 3);
+  EXPECT_TRUE(state.TransitionFromHidden(33, 1, MineSeekerField::UNCOVERED));
+  EXPECT_EQ(MineSeekerField::UNCOVERED, state.state(33, 1));
+  EXPECT_FALSE(state.TransitionFromHidden(33, 1, MineSeekerField::MINE));
+  EXPECT_EQ(MineSeekerField::UNCOVERED, state.state(33, 1));
+  EXPECT_TRUE(state.TransitionFromHidden(32, 1, MineSeekerField::MINE));
+  EXPECT_EQ(MineSeekerField::MINE, state.state(32, 1));
+  EXPECT_EQ(MineSeekerField::HIDDEN, state.state(34, 1));
+  EXPECT_EQ(118, state.num_hidden_fields());
+  EXPECT_EQ(1, state.num_mine_fields());
+
+  state.set_state(33, 1, MineSeekerField::HIDDEN);
+  EXPECT_EQ(MineSeekerField::HIDDEN, state.state(33, 1));
+  EXPECT_EQ(MineSeekerField::MINE, state.state(32, 1));
+  EXPECT_EQ(119, state.num_hidden_fields());
+
+  MineSeekerState copy(state);
+  EXPECT_EQ(MineSeekerField::MINE, copy.state(32, 1));
+  EXPECT_EQ(119, copy.num_hidden_fields());
+  EXPECT_EQ(1, copy.num_mine_fields());
+  copy.set_state(32, 1, MineSeekerField::UNCOVERED);
+  EXPECT_EQ(0, copy.num_mine_fields());
+  EXPECT_EQ(1, state.num_mine_fields());
+  int replaced_handle = -1;
+  EXPECT_TRUE(copy.RemoveConfiguration(32, 1, 1, &replaced_handle));
+  EXPECT_EQ(state.configuration_handle(32, 1), replaced_handle);
+  EXPECT_FALSE(copy.RemoveConfiguration(32, 1, 1, &replaced_handle));
+  EXPECT_TRUE(state.configurations(32, 1)[1]);
+}
+
+TEST(MineSeekerStateTest, TestInternedConfigurations) {
+  MineSeekerState state;
+  state.Resize(10, 10);
+  // The hidden fields exclude the configurations with mines outside of the
+  // board; there are only nine distinct sets like this. The table always
+  // contains the empty set and the sets with a single configuration.
+  const int kNumBasicSets = ConfigurationInternTable::kNumBasicSets;
+  EXPECT_EQ(kNumBasicSets + 9, state.configuration_table()->num_sets());
+  EXPECT_EQ(MineSeekerField::kNumPossibleConfigurations,
+            state.configurations(5, 5).count());
+  EXPECT_EQ(32, state.configurations(5, 0).count());
+  EXPECT_EQ(8, state.configurations(9, 9).count());
+  EXPECT_EQ(state.configuration_handle(5, 5),
+            state.configuration_handle(4, 4));
+  EXPECT_EQ(state.configuration_handle(5, 0),
+            state.configuration_handle(4, 0));
+
+  // Removing a configuration that is not in the set keeps the handle.
+  const int old_handle = state.configuration_handle(9, 9);
+  int replaced_handle = -1;
+  EXPECT_FALSE(state.RemoveConfiguration(9, 9, 4, &replaced_handle));
+  EXPECT_EQ(old_handle, replaced_handle);
+  EXPECT_EQ(old_handle, state.configuration_handle(9, 9));
+
+  // Equal sets share the handle, regardless of how they were created.
+  EXPECT_TRUE(state.RemoveConfiguration(5, 5, 1, &replaced_handle));
+  ConfigurationSet removed;
+  removed.set(1);
+  EXPECT_TRUE(state.RemoveConfigurations(4, 4, removed, &replaced_handle));
+  EXPECT_EQ(MineSeekerField::kNumPossibleConfigurations - 1,
+            state.configurations(5, 5).count());
+  EXPECT_EQ(state.configuration_handle(5, 5),
+            state.configuration_handle(4, 4));
+  EXPECT_EQ(kNumBasicSets + 10, state.configuration_table()->num_sets());
+
+  state.SetConfiguration(5, 5, 3);
+  removed.set();
+  removed.Remove(3);
+  EXPECT_TRUE(state.RemoveConfigurations(4, 4, removed, &replaced_handle));
+  EXPECT_EQ(1, state.configurations(5, 5).count());
+  EXPECT_TRUE(state.configurations(5, 5)[3]);
+  EXPECT_EQ(state.configuration_handle(5, 5),
+            state.configuration_handle(4, 4));
+
+  // The old handles remain valid; this is used by the trail.
+  state.set_configuration_handle(5, 5, old_handle);
+  EXPECT_EQ(8, state.configurations(5, 5).count());
+}
+
+TEST(MineSeekerStateTest, TestCollectHiddenFields) {
+  MineSeekerState state;
+  state.Resize(70, 2);
+  for (int x = 0; x < 70; ++x) {
+    if (x != 3 && x != 64 && x != 69) {
+      state.TransitionFromHidden(x, 0, MineSeekerField::UNCOVERED);
+    }
+    if (x != 31) {
+      state.TransitionFromHidden(x, 1, MineSeekerField::MINE);
+    }
+  }
+  EXPECT_EQ(4, state.num_hidden_fields());
+
+  vector<FieldCoordinate> hidden_fields;
+  state.CollectHiddenFields(&hidden_fields);
+  ASSERT_EQ(4, hidden_fields.size());
+  const int kHiddenX[] = { 3, 64, 69, 31 };
+  const int kHiddenY[] = { 0, 0, 0, 1 };
+  for (int i = 0; i < hidden_fields.size(); ++i) {
+    EXPECT_EQ(kHiddenX[i], hidden_fields[i].x);
+    EXPECT_EQ(kHiddenY[i], hidden_fields[i].y);
+  }
+}
+
+TEST(MineSeekerStateTest, TestInteriorFields) {
+  MineSeekerState state;
+  state.Resize(70, 40);
+  EXPECT_EQ(70 * 40, state.num_interior_fields());
+  EXPECT_TRUE(state.is_interior(69, 39));
+  vector<FieldCoordinate> fields;
+  state.CollectInteriorFields(3, &fields);
+  ASSERT_EQ(3, fields.size());
+  EXPECT_EQ(0, fields[2].x);
+  EXPECT_EQ(2, fields[2].y);
+
+  // The first column spans two tiles; without it, the interior fields start
+  // in the second column.
+  for (int y = 0; y < 40; ++y) {
+    state.set_is_interior(0, y, false);
+  }
+  state.set_is_interior(1, 0, false);
+  EXPECT_FALSE(state.is_interior(0, 35));
+  EXPECT_EQ(70 * 40 - 41, state.num_interior_fields());
+  fields.clear();
+  state.CollectInteriorFields(2, &fields);
+  ASSERT_EQ(2, fields.size());
+  EXPECT_EQ(1, fields[0].x);
+  EXPECT_EQ(1, fields[0].y);
+  EXPECT_EQ(1, fields[1].x);
+  EXPECT_EQ(2, fields[1].y);
+
+  // The copies of the state have their own interior fields.
+  MineSeekerState copy(state);
+  copy.set_is_interior(0, 0, true);
+  EXPECT_TRUE(copy.is_interior(0, 0));
+  EXPECT_FALSE(state.is_interior(0, 0));
+  EXPECT_EQ(70 * 40 - 40, copy.num_interior_fields());
+  fields.clear();
+  copy.CollectInteriorFields(1, &fields);
+  ASSERT_EQ(1, fields.size());
+  EXPECT_EQ(0, fields[0].x);
+  EXPECT_EQ(0, fields[0].y);
+
+  // All fields of the last column of tiles are collected.
+  for (int x = 0; x < 64; ++x) {
+    for (int y = 0; y < 40; ++y) {
+      state.set_is_interior(x, y, false);
+    }
+  }
+  fields.clear();
+  state.CollectInteriorFields(1000, &fields);
+  EXPECT_EQ(6 * 40, fields.size());
+  EXPECT_EQ(69, fields.back().x);
+  EXPECT_EQ(39, fields.back().y);
+}
+
+TEST(MineSeekerStateTest, TestCopyOnWriteTiles) {
+  MineSeekerState state;
+  state.Resize(100, 40);
+  ASSERT_EQ(8, state.num_tiles());
+  // The two middle tiles of each row have the same position relative to the
+  // border.
+  EXPECT_EQ(4, state.NumSharedTiles());
+  state.TransitionFromHidden(3, 3, MineSeekerField::UNCOVERED);
+  EXPECT_EQ(4, state.NumSharedTiles());
+
+  // The copy shares all tiles with the original state.
+  MineSeekerState copy(state);
+  EXPECT_EQ(8, state.NumSharedTiles());
+  EXPECT_EQ(8, copy.NumSharedTiles());
+  EXPECT_EQ(MineSeekerField::UNCOVERED, copy.state(3, 3));
+
+  // Changing a field copies only its tile.
+  EXPECT_TRUE(copy.TransitionFromHidden(70, 35, MineSeekerField::MINE));
+  EXPECT_EQ(8, state.NumSharedTiles());
+  EXPECT_EQ(7, copy.NumSharedTiles());
+  EXPECT_EQ(MineSeekerField::HIDDEN, state.state(70, 35));
+  EXPECT_EQ(MineSeekerField::MINE, copy.state(70, 35));
+  EXPECT_EQ(MineSeekerField::HIDDEN, copy.state(38, 35));
+  EXPECT_EQ(1, copy.num_mine_fields());
+  EXPECT_EQ(0, state.num_mine_fields());
+
+  // Reading the fields or failed changes do not copy the tiles.
+  EXPECT_FALSE(copy.TransitionFromHidden(3, 3, MineSeekerField::MINE));
+  EXPECT_EQ(0, copy.temporary_status(99, 39));
+  copy.ResetTemporaryStatuses();
+  EXPECT_EQ(7, copy.NumSharedTiles());
+
+  copy.set_flags(99, 39, 1);
+  EXPECT_EQ(1, copy.flags(99, 39));
+  EXPECT_EQ(0, state.flags(99, 39));
+  EXPECT_EQ(6, copy.NumSharedTiles());
+  EXPECT_EQ(7, state.NumSharedTiles());
+}
+
+TEST(MineSeekerStateTest, TestUntouchedTilesAreShared) {
+  MineSeekerState state;
+  state.Resize(3200, 3200);
+  ASSERT_EQ(10000, state.num_tiles());
+  // Only the corners are unique.
+  EXPECT_EQ(9996, state.NumSharedTiles());
+  EXPECT_EQ(256, state.configurations(1600, 1600).count());
+  EXPECT_EQ(32, state.configurations(3199, 1600).count());
+
+  state.TransitionFromHidden(1600, 1600, MineSeekerField::UNCOVERED);
+  int replaced_handle = -1;
+  EXPECT_TRUE(state.RemoveConfiguration(1601, 1600, 0, &replaced_handle));
+  EXPECT_EQ(9995, state.NumSharedTiles());
+  EXPECT_EQ(MineSeekerField::HIDDEN, state.state(1700, 1600));
+  EXPECT_TRUE(state.configurations(1700, 1600)[0]);
+  EXPECT_FALSE(state.configurations(1601, 1600)[0]);
+}
+
+TEST(MineSeekerStateTest, TestCompactConfigurationTable) {
+  MineSeekerState state;
+  state.Resize(100, 40);
+  int replaced_handle = -1;
+  for (int configuration = 0; configuration < 10; ++configuration) {
+    state.RemoveConfiguration(40, 5, configuration, &replaced_handle);
+  }
+  state.RemoveConfiguration(40, 6, 0, &replaced_handle);
+  const int num_sets = state.configuration_table()->num_sets();
+  const int num_shared_tiles = state.NumSharedTiles();
+  EXPECT_EQ(state.InitialConfigurationHandle(50, 20),
+            state.configuration_handle(50, 20));
+
+  MineSeekerState copy(state);
+  state.CompactConfigurationTable();
+  EXPECT_NE(copy.configuration_table(), state.configuration_table());
+  // Only the sets of the fields (40, 5) and (40, 6) remain from the narrowing.
+  EXPECT_EQ(num_sets - 8, state.configuration_table()->num_sets());
+  for (int y = 0; y < 40; ++y) {
+    for (int x = 0; x < 100; ++x) {
+      for (int i = 0; i < ConfigurationSet::kNumWords; ++i) {
+        ASSERT_EQ(copy.configurations(x, y).word(i),
+                  state.configurations(x, y).word(i));
+      }
+    }
+  }
+  // The tiles shared by multiple positions remain shared.
+  EXPECT_EQ(num_shared_tiles, state.NumSharedTiles());
+  EXPECT_EQ(num_shared_tiles, copy.NumSharedTiles());
+  EXPECT_EQ(state.InitialConfigurationHandle(50, 20),
+            state.configuration_handle(50, 20));
+  EXPECT_EQ(state.InitialConfigurationHandle(99, 39),
+            state.configuration_handle(99, 39));
+}
+
+namespace {
+// Removes the configuration item % 256 from the field (item / 256 % width, 0)
+// of a shared state and counts the removals that changed the configurations.
+class RemovingTask : public ThreadPool::Task {
+ public:
+  explicit RemovingTask(MineSeekerState* state)
+      : state_(state), num_changes_(0) {}
+
+  virtual void Run(int item) {
+    const int configuration =
+        item % MineSeekerField::kNumPossibleConfigurations;
+    const int x =
+        item / MineSeekerField::kNumPossibleConfigurations % state_->width();
+    int old_handle = -1;
+    if (state_->RemoveConfiguration(x, 0, configuration, &old_handle)) {
+      ++num_changes_;
+    }
+  }
+
+  int num_changes() const { return num_changes_.load(); }
+
+ private:
+  MineSeekerState* const state_;
+  std::atomic<int> num_changes_;
+};
+}  // namespace
+
+// Tests that each configuration is removed exactly once and no removal is
+// lost, even when multiple threads narrow the configurations of the same field
+// at the same time, and that the shared tiles are copied only once.
+TEST(MineSeekerStateTest, TestConcurrentRemoveConfiguration) {
+  const int kNumFields = 4;
+  const int kNumRepetitions = 8;
+  MineSeekerState state;
+  state.Resize(kNumFields, 3);
+  MineSeekerState copy(state);
+  ThreadPool thread_pool(4);
+  RemovingTask task(&state);
+  state.BeginConcurrentChanges();
+  thread_pool.ParallelFor(
+      kNumRepetitions * kNumFields
+          * MineSeekerField::kNumPossibleConfigurations,
+      &task);
+  state.EndConcurrentChanges();
+
+  int num_configurations = 0;
+  for (int x = 0; x < kNumFields; ++x) {
+    EXPECT_EQ(0, state.configurations(x, 0).count());
+    num_configurations += copy.configurations(x, 0).count();
+  }
+  EXPECT_EQ(num_configurations, task.num_changes());
+  EXPECT_EQ(0, state.NumSharedTiles());
+  EXPECT_EQ(0, copy.NumSharedTiles());
+}
+
+TEST(MineSeekerStateTest, TestPushTemporaryMine) {
+  MineSeekerState state;
+  state.Resize(1, 1);
 
   const int kNumIterations = 10;
   for (int i = 0; i < kNumIterations; ++i) {
-    EXPECT_EQ(i, field.temporary_status());
-    EXPECT_TRUE(field.PushTemporaryMine());
-    EXPECT_EQ(i + 1, field.temporary_status());
+    EXPECT_EQ(i, state.temporary_status(0, 0));
+    EXPECT_TRUE(state.PushTemporaryMine(0, 0));
+    EXPECT_EQ(i + 1, state.temporary_status(0, 0));
   }
 
   for (int i = kNumIterations; i > 0; --i) {
-    EXPECT_EQ(i, field.temporary_status());
-    field.PopTemporaryMine();
-    EXPECT_EQ(i - 1, field.temporary_status());
+    EXPECT_EQ(i, state.temporary_status(0, 0));
+    state.PopTemporaryMine(0, 0);
+    EXPECT_EQ(i - 1, state.temporary_status(0, 0));
   }
 }
 
-TEST(MineSeekerFieldTest, TestPushTemporaryClearArea) {
-  MineSeekerField field;
+TEST(MineSeekerStateTest, TestPushTemporaryClearArea) {
+  MineSeekerState state;
+  state.Resize(1, 1);
 
   const int kNumIterations = 10;
   for (int i = 0; i < kNumIterations; ++i) {
-    EXPECT_EQ(-i, field.temporary_status());
-    EXPECT_TRUE(field.PushTemporaryClearArea());
-    EXPECT_EQ(-i - 1, field.temporary_status());
+    EXPECT_EQ(-i, state.temporary_status(0, 0));
+    EXPECT_TRUE(state.PushTemporaryClearArea(0, 0));
+    EXPECT_EQ(-i - 1, state.temporary_status(0, 0));
   }
 
   for (int i = kNumIterations; i > 0; --i) {
-    EXPECT_EQ(-i, field.temporary_status());
-    field.PopTemporaryClearArea();
-    EXPECT_EQ(-i + 1, field.temporary_status());
+    EXPECT_EQ(-i, state.temporary_status(0, 0));
+    state.PopTemporaryClearArea(0, 0);
+    EXPECT_EQ(-i + 1, state.temporary_status(0, 0));
   }
 }
 
-TEST(MineSeekerFieldTest, TestPushTemporaryMineOnTemporaryClearArea) {
-  MineSeekerField field;
+TEST(MineSeekerStateTest, TestPushTemporaryMineOnTemporaryClearArea) {
+  MineSeekerState state;
+  state.Resize(1, 1);
 
-  EXPECT_TRUE(field.PushTemporaryClearArea());
-  EXPECT_EQ(-1, field.temporary_status());
-  EXPECT_FALSE(field.PushTemporaryMine());
-  EXPECT_EQ(0, field.temporary_status());
+  EXPECT_TRUE(state.PushTemporaryClearArea(0, 0));
+  EXPECT_EQ(-1, state.temporary_status(0, 0));
+  EXPECT_FALSE(state.PushTemporaryMine(0, 0));
+  EXPECT_EQ(0, state.temporary_status(0, 0));
 }
 
-TEST(MineSeekerFieldTest, TestPushTemporaryClearAreaOnTemporaryMine) {
-  MineSeekerField field;
+TEST(MineSeekerStateTest, TestPushTemporaryClearAreaOnTemporaryMine) {
+  MineSeekerState state;
+  state.Resize(1, 1);
 
-  EXPECT_TRUE(field.PushTemporaryMine());
-  EXPECT_EQ(1, field.temporary_status());
-  EXPECT_FALSE(field.PushTemporaryClearArea());
-  EXPECT_EQ(0, field.temporary_status());
+  EXPECT_TRUE(state.PushTemporaryMine(0, 0));
+  EXPECT_EQ(1, state.temporary_status(0, 0));
+  EXPECT_FALSE(state.PushTemporaryClearArea(0, 0));
+  EXPECT_EQ(0, state.temporary_status(0, 0));
 }
 
 // Base class for tests of the MineSeeker clas. Sets up a 30x20 minefield with
@@ -258,6 +592,33 @@ TEST_F(MineSeekerTest, TestSolve) {
   mine_seeker.DebugString(&debug_output);
 }
 
+// Tests that the seeker solves the mine field the same way in both of its
+// representations.
+TEST_F(MineSeekerTest, TestSolveSparseMineField) {
+  MineSweeper sparse_mine_sweeper(mine_sweeper_->width(),
+                                  mine_sweeper_->height(),
+                                  MineSweeper::SPARSE);
+  for (int x = 0; x < mine_sweeper_->width(); ++x) {
+    for (int y = 0; y < mine_sweeper_->height(); ++y) {
+      sparse_mine_sweeper.SetMine(x, y, mine_sweeper_->IsMine(x, y));
+    }
+  }
+  sparse_mine_sweeper.CloseMineField();
+
+  MineSeeker mine_seeker(*mine_sweeper_);
+  MineSeeker sparse_mine_seeker(sparse_mine_sweeper);
+  EXPECT_TRUE(mine_seeker.Solve());
+  EXPECT_TRUE(sparse_mine_seeker.Solve());
+  EXPECT_EQ(mine_seeker.safe_field_requests(),
+            sparse_mine_seeker.safe_field_requests());
+  for (int x = 0; x < mine_sweeper_->width(); ++x) {
+    for (int y = 0; y < mine_sweeper_->height(); ++y) {
+      EXPECT_EQ(mine_seeker.StateAtPosition(x, y),
+                sparse_mine_seeker.StateAtPosition(x, y));
+    }
+  }
+}
+
 TEST_F(MineSeekerTest, TestUncoverFieldWithMine) {
   MineSeeker mine_seeker(*mine_sweeper_);
   
@@ -297,6 +658,114 @@ TEST_F(MineSeekerTest, TestUncoverFieldWithNoMine) {
   EXPECT_EQ(8, mine_seeker.uncover_queue_.size());
 }
 
+string DebugStringOf(const MineSeeker& mine_seeker) {
+  string out;
+  mine_seeker.DebugString(&out);
+  return out;
+}
+
+// Checks that MineSeeker::GetFrontierConstraintFields returns exactly the
+// uncovered fields with a positive number and a hidden neighbor, by scanning
+// the whole board.
+void ExpectFrontierConstraintFieldsAreUpToDate(const MineSeeker& mine_seeker) {
+  const int width = mine_seeker.mine_sweeper().width();
+  const int height = mine_seeker.mine_sweeper().height();
+  vector<int> expected_fields;
+  for (int y = 0; y < height; ++y) {
+    for (int x = 0; x < width; ++x) {
+      if (mine_seeker.NumberOfMinesAroundField(x, y) <= 0) {
+        continue;
+      }
+      for (int bit = 0; bit < kNumNeighbors; ++bit) {
+        if (mine_seeker.StateAtPosition(x + kNeighborOffsetX[bit],
+                                        y + kNeighborOffsetY[bit])
+            == MineSeekerField::HIDDEN) {
+          expected_fields.push_back(y * width + x);
+          break;
+        }
+      }
+    }
+  }
+  vector<int> fields;
+  mine_seeker.GetFrontierConstraintFields(&fields);
+  EXPECT_TRUE(expected_fields == fields);
+}
+
+// Tests that rolling back to a checkpoint restores the state of the fields and
+// the queues.
+TEST_F(MineSeekerTest, TestRollbackToCheckpoint) {
+  MineSeeker mine_seeker(*mine_sweeper_);
+  EXPECT_TRUE(mine_seeker.UncoverField(2, 0));
+  EXPECT_EQ(0, mine_seeker.num_checkpoints());
+  EXPECT_EQ(0, mine_seeker.trail_size());
+
+  const string original_state = DebugStringOf(mine_seeker);
+  const int original_num_configurations =
+      mine_seeker.FieldAtPosition(2, 0).NumberOfActiveConfigurations();
+  const int original_update_queue_size = mine_seeker.update_queue_.size();
+  const int original_subset_queue_size =
+      mine_seeker.subset_update_queue_.size();
+
+  EXPECT_EQ(1, mine_seeker.PushCheckpoint());
+  EXPECT_TRUE(mine_seeker.UncoverField(10, 10));
+  for (int i = 0; i < 20 && mine_seeker.SolveStep(); ++i) {}
+  EXPECT_NE(original_state, DebugStringOf(mine_seeker));
+  EXPECT_LT(0, mine_seeker.trail_size());
+  ExpectFrontierConstraintFieldsAreUpToDate(mine_seeker);
+
+  mine_seeker.RollbackToCheckpoint();
+  EXPECT_EQ(0, mine_seeker.num_checkpoints());
+  EXPECT_EQ(original_state, DebugStringOf(mine_seeker));
+  ExpectFrontierConstraintFieldsAreUpToDate(mine_seeker);
+  EXPECT_EQ(original_num_configurations,
+            mine_seeker.FieldAtPosition(2, 0).NumberOfActiveConfigurations());
+  EXPECT_EQ(original_update_queue_size, mine_seeker.update_queue_.size());
+  EXPECT_EQ(original_subset_queue_size,
+            mine_seeker.subset_update_queue_.size());
+  EXPECT_EQ(0, mine_seeker.uncover_queue_.size());
+  EXPECT_FALSE(mine_seeker.is_dead());
+
+  // Nested checkpoints: committing the inner checkpoint keeps the changes
+  // until the outer checkpoint is rolled back.
+  mine_seeker.PushCheckpoint();
+  EXPECT_EQ(2, mine_seeker.PushCheckpoint());
+  EXPECT_TRUE(mine_seeker.UncoverField(10, 10));
+  mine_seeker.CommitCheckpoint();
+  EXPECT_EQ(MineSeekerField::UNCOVERED, mine_seeker.StateAtPosition(10, 10));
+  mine_seeker.RollbackToCheckpoint();
+  EXPECT_EQ(MineSeekerField::HIDDEN, mine_seeker.StateAtPosition(10, 10));
+  EXPECT_EQ(original_state, DebugStringOf(mine_seeker));
+  EXPECT_EQ(0, mine_seeker.trail_size());
+}
+
+// Tests that a fork of the mine seeker shares the configuration table with the
+// original seeker and that the changes of the fork are not visible in the
+// original.
+TEST_F(MineSeekerTest, TestFork) {
+  MineSeeker mine_seeker(*mine_sweeper_);
+  EXPECT_TRUE(mine_seeker.UncoverField(2, 0));
+  const string original_state = DebugStringOf(mine_seeker);
+
+  MineSeeker fork(mine_seeker);
+  EXPECT_EQ(original_state, DebugStringOf(fork));
+  EXPECT_EQ(mine_seeker.state_.configuration_table(),
+            fork.state_.configuration_table());
+  EXPECT_EQ(mine_seeker.update_queue_.size(), fork.update_queue_.size());
+  EXPECT_EQ(mine_seeker.state_.num_tiles(), fork.state_.NumSharedTiles());
+
+  EXPECT_TRUE(fork.UncoverField(21, 18));
+  EXPECT_EQ(MineSeekerField::UNCOVERED, fork.StateAtPosition(21, 18));
+  EXPECT_EQ(MineSeekerField::HIDDEN, mine_seeker.StateAtPosition(21, 18));
+  EXPECT_EQ(original_state, DebugStringOf(mine_seeker));
+  EXPECT_EQ(mine_seeker.state_.configuration_table(),
+            fork.state_.configuration_table());
+
+  // Running the solver on the fork changes only the fork.
+  for (int i = 0; i < 100 && fork.SolveStep(); ++i) {}
+  EXPECT_EQ(original_state, DebugStringOf(mine_seeker));
+  EXPECT_NE(original_state, DebugStringOf(fork));
+}
+
 // Tests updating the available configurations at the given point after marking
 // one of its neighbors as a mine.
 TEST_F(MineSeekerTest, TestUpdateConfigurationsAtPoint) {
@@ -332,13 +801,14 @@ TEST_F(MineSeekerTest, TestUpdateConfigurationsAtPoint) {
       kPossibleConfigurationsWithMarkedMine,
       kPossibleConfigurationsWithMarkedMine +
       kNumPossibleConfigurationsWithMarkedMine);
+  const MineSeekerField& updated_field = mine_seeker.FieldAtPosition(1, 0);
   for (int configuration = 0;
        configuration < MineSeekerField::kNumPossibleConfigurations;
        ++configuration) {
     bool expected_is_possible_configuration =
         possible_configurations_with_marked_mine.count(configuration) > 0;
     EXPECT_EQ(expected_is_possible_configuration,
-              field.IsPossibleConfiguration(configuration));
+              updated_field.IsPossibleConfiguration(configuration));
   }
 }
 
@@ -347,13 +817,13 @@ TEST_F(MineSeekerTest, TestUpdateConfigurationsAtPoint) {
 TEST_F(MineSeekerTest, TestUpdateNeighborsAtPoint) {
   MineSeeker mine_seeker(*mine_sweeper_);
 
-  const MineSeekerField& field = mine_seeker.FieldAtPosition(1, 0);
   EXPECT_TRUE(mine_seeker.UncoverField(1, 0));
   EXPECT_TRUE(mine_seeker.UncoverField(2, 0));
   EXPECT_TRUE(mine_seeker.UncoverField(2, 1));
   EXPECT_TRUE(mine_seeker.UncoverField(2, 2));
   EXPECT_TRUE(mine_seeker.UncoverField(0, 1));
   mine_seeker.UpdateConfigurationsAtPosition(1, 0);
+  const MineSeekerField& field = mine_seeker.FieldAtPosition(1, 0);
   EXPECT_EQ(1, field.NumberOfActiveConfigurations());
   EXPECT_TRUE(field.IsBound());
 }
@@ -397,6 +867,10 @@ TEST_F(MineSeekerTest, TestTemporaryStatus) {
 
 TEST_F(MineSeekerTest, TestUpdatePairConsistency) {
   MineSeeker mine_seeker(*mine_sweeper_);
+  // The pattern cache and the deduction table would queue the same fields for
+  // uncovering before the pairwise consistency does.
+  mine_seeker.set_use_pattern_cache(false);
+  mine_seeker.set_use_deduction_tables(false);
 
   mine_seeker.UncoverField(0, 2);
   mine_seeker.UncoverField(1, 2);
@@ -449,4 +923,805 @@ TEST_F(MineSeekerTest, TestUpdatePairConsistency) {
   }
 }
 
+TEST_F(MineSeekerTest, TestApplyPatternDeductions) {
+  MineSeeker mine_seeker(*mine_sweeper_);
+  mine_seeker.UncoverField(0, 2);
+  mine_seeker.UncoverField(1, 2);
+  mine_seeker.uncover_queue_.clear();
+
+  const int64 num_lookups = MineSeeker::pattern_cache()->num_hits()
+      + MineSeeker::pattern_cache()->num_misses();
+  const int deduced_fields = mine_seeker.ApplyPatternDeductions(-1, 1);
+  EXPECT_EQ(num_lookups + 1, MineSeeker::pattern_cache()->num_hits()
+                                 + MineSeeker::pattern_cache()->num_misses());
+  // Both fields have one mine around, so it must be in one of the hidden
+  // fields they share; the other hidden neighbors of (1, 2) are safe.
+  EXPECT_EQ(3, mine_seeker.uncover_queue_.size());
+  EXPECT_EQ((1 << 3) | (1 << 8) | (1 << 13), deduced_fields);
+  for (int i = 0; i < mine_seeker.uncover_queue_.size(); ++i) {
+    const FieldCoordinate& field = mine_seeker.uncover_queue_[i];
+    EXPECT_FALSE(mine_sweeper_->IsMine(field.x, field.y));
+    EXPECT_EQ(2, field.x);
+  }
+}
+
+TEST_F(MineSeekerTest, TestApplyPairDeductionTable) {
+  MineSeeker mine_seeker(*mine_sweeper_);
+  mine_seeker.UncoverField(0, 2);
+  mine_seeker.UncoverField(1, 2);
+  mine_seeker.uncover_queue_.clear();
+
+  // The fields are not adjacent.
+  EXPECT_FALSE(mine_seeker.ApplyPairDeductionTable(0, 2, 2, 2));
+  EXPECT_TRUE(mine_seeker.uncover_queue_.empty());
+
+  // The same deduction as in TestApplyPatternDeductions: the fields at x = 2
+  // are neighbors only of (1, 2), and they are safe.
+  EXPECT_TRUE(mine_seeker.ApplyPairDeductionTable(1, 2, 0, 2));
+  EXPECT_EQ(3, mine_seeker.uncover_queue_.size());
+  for (int i = 0; i < mine_seeker.uncover_queue_.size(); ++i) {
+    EXPECT_EQ(2, mine_seeker.uncover_queue_[i].x);
+  }
+  // None of them is a neighbor of (0, 2).
+  mine_seeker.uncover_queue_.clear();
+  EXPECT_FALSE(mine_seeker.ApplyPairDeductionTable(0, 2, 1, 2));
+  EXPECT_EQ(3, mine_seeker.uncover_queue_.size());
+}
+
+TEST_F(MineSeekerTest, TestUpdateSubsetConsistency) {
+  MineSeeker mine_seeker(*mine_sweeper_);
+
+  // The hidden neighbors of (0, 2) are a subset of the hidden neighbors of
+  // (1, 2), and both fields have a single mine around them. The three fields
+  // to the right of (1, 2) are thus proven to be empty.
+  mine_seeker.UncoverField(0, 2);
+  mine_seeker.UncoverField(1, 2);
+  EXPECT_EQ(0, mine_seeker.uncover_queue_.size());
+  mine_seeker.UpdateSubsetConsistency(0, 2);
+  EXPECT_EQ(3, mine_seeker.uncover_queue_.size());
+
+  // The hidden neighbors of (10, 19) are a subset of the hidden neighbors of
+  // (10, 18). The three fields above (10, 18) contain the three remaining
+  // mines of (10, 18).
+  mine_seeker.UncoverField(10, 19);
+  mine_seeker.UncoverField(10, 18);
+  for (int x = 9; x <= 11; ++x) {
+    EXPECT_EQ(MineSeekerField::HIDDEN, mine_seeker.StateAtPosition(x, 17));
+  }
+  mine_seeker.UpdateSubsetConsistency(10, 18);
+  for (int x = 9; x <= 11; ++x) {
+    EXPECT_EQ(MineSeekerField::MINE, mine_seeker.StateAtPosition(x, 17));
+  }
+}
+
+// Tests the enumeration tier on the pattern 1 1 2 1 1, which can't be solved
+// by looking at single fields.
+TEST(MineSeekerEnumerationTest, TestEnumerationTier) {
+  MineSweeper mine_sweeper(5, 2);
+  mine_sweeper.SetMine(1, 0, true);
+  mine_sweeper.SetMine(3, 0, true);
+  mine_sweeper.CloseMineField();
+
+  MineSeeker mine_seeker(mine_sweeper);
+  EXPECT_FALSE(mine_seeker.HasPendingEnumeration());
+  for (int x = 0; x < 5; ++x) {
+    mine_seeker.UncoverField(x, 1);
+  }
+  EXPECT_TRUE(mine_seeker.HasPendingEnumeration());
+  EXPECT_EQ(0, mine_seeker.uncover_queue_.size());
+
+  EXPECT_TRUE(mine_seeker.RunEnumerationStep());
+  EXPECT_EQ(MineSeekerField::MINE, mine_seeker.StateAtPosition(1, 0));
+  EXPECT_EQ(MineSeekerField::MINE, mine_seeker.StateAtPosition(3, 0));
+  EXPECT_EQ(3, mine_seeker.uncover_queue_.size());
+}
+
+TEST(MineSeekerEnumerationTest, TestLocalTiersAsFallback) {
+  MineSweeper mine_sweeper(5, 2);
+  mine_sweeper.SetMine(1, 0, true);
+  mine_sweeper.SetMine(3, 0, true);
+  mine_sweeper.CloseMineField();
+
+  MineSeeker mine_seeker(mine_sweeper);
+  mine_seeker.UseEnumerationInsteadOfLocalTiers();
+  for (int x = 0; x < 5; ++x) {
+    mine_seeker.UncoverField(x, 1);
+  }
+  // The subset and the pair tiers keep their queues, but they wait for the
+  // enumeration.
+  EXPECT_FALSE(mine_seeker.subset_update_queue_.empty());
+  EXPECT_FALSE(mine_seeker.pair_update_queue_.empty());
+  EXPECT_FALSE(mine_seeker.HasPendingSubsetUpdates());
+  EXPECT_FALSE(mine_seeker.HasPendingPairUpdates());
+
+  // They run when the enumeration could not complete a component, until the
+  // next enumeration step completes all of them.
+  mine_seeker.has_incomplete_enumeration_ = true;
+  EXPECT_TRUE(mine_seeker.HasPendingSubsetUpdates());
+  EXPECT_TRUE(mine_seeker.HasPendingPairUpdates());
+  EXPECT_TRUE(mine_seeker.RunEnumerationStep());
+  EXPECT_FALSE(mine_seeker.HasPendingSubsetUpdates());
+  EXPECT_FALSE(mine_seeker.HasPendingPairUpdates());
+}
+
+// Tests that the scheduler runs the tiers in the order of their cost and that
+// the solver can finish without hints by guessing.
+TEST_F(MineSeekerTest, TestSolveWithScheduler) {
+  MineSeeker mine_seeker(*mine_sweeper_);
+  const PropagationScheduler& scheduler = mine_seeker.scheduler();
+  EXPECT_EQ(8, scheduler.num_tiers());
+  EXPECT_EQ("parallel",
+            scheduler.tier_name(MineSeeker::PARALLEL_PROPAGATION_TIER));
+  EXPECT_EQ("reveal", scheduler.tier_name(MineSeeker::REVEAL_TIER));
+  EXPECT_EQ("guess", scheduler.tier_name(MineSeeker::GUESS_TIER));
+
+  EXPECT_TRUE(mine_seeker.Solve());
+  EXPECT_EQ(0, mine_seeker.guesses());
+  EXPECT_GT(scheduler.tier_statistics(MineSeeker::REVEAL_TIER).num_steps, 0);
+  EXPECT_EQ(mine_seeker.safe_field_requests(),
+            scheduler.tier_statistics(MineSeeker::GUESS_TIER).num_steps);
+
+  // With no budget for the tiers other than uncovering, the solver only
+  // uncovers the empty area around the first field and then stops.
+  MineSeeker limited_mine_seeker(*mine_sweeper_);
+  for (int tier = MineSeeker::FILTER_TIER; tier <= MineSeeker::GUESS_TIER;
+       ++tier) {
+    limited_mine_seeker.mutable_scheduler()->set_tier_budget(tier, 0);
+  }
+  EXPECT_FALSE(limited_mine_seeker.Solve());
+  EXPECT_FALSE(limited_mine_seeker.is_dead());
+  EXPECT_FALSE(limited_mine_seeker.IsSolved());
+  EXPECT_EQ(0, limited_mine_seeker.scheduler().tier_statistics(
+      MineSeeker::PAIR_TIER).num_steps);
+  EXPECT_GT(limited_mine_seeker.scheduler().tier_statistics(
+      MineSeeker::PAIR_TIER).num_skipped_for_budget, 0);
+}
+
+TEST_F(MineSeekerTest, TestSolveWithoutHints) {
+  MineSeeker mine_seeker(*mine_sweeper_);
+  mine_seeker.set_use_hints(false);
+  EXPECT_FALSE(mine_seeker.use_hints());
+  mine_seeker.Solve();
+  EXPECT_TRUE(mine_seeker.IsSolved());
+  EXPECT_GT(mine_seeker.guesses(), 0);
+  EXPECT_EQ(0, mine_seeker.safe_field_requests());
+}
+
+// Tests that the seeker continues from its state after a mine was moved next
+// to an uncovered field.
+TEST(MineSeekerChangedMineTest, TestHandleChangedMine) {
+  MineSweeper mine_sweeper(5, 1);
+  mine_sweeper.SetMine(0, 0, true);
+  mine_sweeper.CloseMineField();
+
+  MineSeeker mine_seeker(mine_sweeper);
+  mine_seeker.mutable_scheduler()->set_tier_budget(MineSeeker::GUESS_TIER, 0);
+  EXPECT_TRUE(mine_seeker.UncoverField(1, 0));
+  EXPECT_EQ(2,
+            mine_seeker.FieldAtPosition(1, 0).NumberOfActiveConfigurations());
+
+  // The number of the uncovered field drops to zero, so both its neighbors
+  // are safe; without updating its configurations, none of them would fit.
+  mine_sweeper.MoveMine(0, 0, 4, 0);
+  mine_seeker.HandleChangedMine(0, 0);
+  mine_seeker.HandleChangedMine(4, 0);
+  EXPECT_EQ(1,
+            mine_seeker.FieldAtPosition(1, 0).NumberOfActiveConfigurations());
+  vector<int> frontier_constraint_fields;
+  mine_seeker.GetFrontierConstraintFields(&frontier_constraint_fields);
+  EXPECT_TRUE(frontier_constraint_fields.empty());
+
+  EXPECT_TRUE(mine_seeker.ContinueSolving());
+  EXPECT_FALSE(mine_seeker.is_dead());
+  EXPECT_EQ(MineSeekerField::UNCOVERED, mine_seeker.StateAtPosition(0, 0));
+  EXPECT_EQ(MineSeekerField::UNCOVERED, mine_seeker.StateAtPosition(3, 0));
+  EXPECT_EQ(MineSeekerField::MINE, mine_seeker.StateAtPosition(4, 0));
+  EXPECT_EQ(0, mine_seeker.guesses());
+}
+
+TEST(MineSeekerWindowTest, TestWindowBorderIsNotUncovered) {
+  const int kWidth = 8;
+  const int kHeight = 6;
+  ProceduralMineField mine_field(100, 100, 0.0, 1);
+  MineSweeper window(&mine_field, 10, 10, kWidth, kHeight);
+  MineSeeker mine_seeker(window);
+  mine_seeker.mutable_scheduler()->set_tier_budget(MineSeeker::GUESS_TIER, 0);
+  EXPECT_TRUE(mine_seeker.UncoverField(3, 3));
+  EXPECT_FALSE(mine_seeker.ContinueSolving());
+  EXPECT_FALSE(mine_seeker.is_dead());
+  for (int x = 0; x < kWidth; ++x) {
+    for (int y = 0; y < kHeight; ++y) {
+      const bool is_border =
+          x == 0 || y == 0 || x == kWidth - 1 || y == kHeight - 1;
+      EXPECT_EQ(is_border ? MineSeekerField::HIDDEN
+                          : MineSeekerField::UNCOVERED,
+                mine_seeker.StateAtPosition(x, y)) << x << " " << y;
+    }
+  }
+
+  // The fields on the border of the procedural mine field are uncovered.
+  MineSweeper corner(&mine_field, 0, 0, kWidth, kHeight);
+  MineSeeker corner_mine_seeker(corner);
+  corner_mine_seeker.mutable_scheduler()->set_tier_budget(
+      MineSeeker::GUESS_TIER, 0);
+  EXPECT_TRUE(corner_mine_seeker.UncoverField(3, 3));
+  corner_mine_seeker.ContinueSolving();
+  EXPECT_EQ(MineSeekerField::UNCOVERED,
+            corner_mine_seeker.StateAtPosition(0, 0));
+  EXPECT_EQ(MineSeekerField::HIDDEN,
+            corner_mine_seeker.StateAtPosition(kWidth - 1, 0));
+}
+
+// A seeker restarted after its window was moved finds the same fields as a
+// new seeker on the window, and it keeps its table of configuration sets.
+TEST(MineSeekerWindowTest, TestRestart) {
+  ProceduralMineField mine_field(200, 200, 0.15, 3);
+  MineSweeper window(&mine_field, 10, 10, 40, 30);
+  MineSeeker mine_seeker(window);
+  mine_seeker.mutable_scheduler()->set_tier_budget(MineSeeker::GUESS_TIER, 0);
+  // The fields on the border of the window are never uncovered, so the
+  // window is not solved.
+  EXPECT_FALSE(mine_seeker.Solve());
+  EXPECT_LT(ConfigurationInternTable::kNumBasicSets,
+            mine_seeker.state_.configuration_table()->num_sets());
+  const ConfigurationInternTable* const table =
+      mine_seeker.state_.configuration_table();
+
+  window.MoveWindow(&mine_field, 100, 150, 50, 50);
+  mine_seeker.Restart();
+  EXPECT_EQ(table, mine_seeker.state_.configuration_table());
+  EXPECT_FALSE(mine_seeker.is_dead());
+  EXPECT_EQ(0, mine_seeker.guesses());
+  MineSweeper expected_window(&mine_field, 100, 150, 50, 50);
+  MineSeeker expected(expected_window);
+  expected.mutable_scheduler()->set_tier_budget(MineSeeker::GUESS_TIER, 0);
+  EXPECT_EQ(expected.Solve(), mine_seeker.Solve());
+  for (int x = 0; x < 50; ++x) {
+    for (int y = 0; y < 50; ++y) {
+      EXPECT_EQ(expected.StateAtPosition(x, y),
+                mine_seeker.StateAtPosition(x, y)) << x << " " << y;
+    }
+  }
+}
+
+// A revealer that plays the game on a mine sweeper, and checks that each
+// field is revealed only once.
+class MineSweeperRevealer : public FieldRevealer {
+ public:
+  explicit MineSweeperRevealer(const MineSweeper* mine_sweeper)
+      : mine_sweeper_(*CHECK_NOTNULL(mine_sweeper)),
+        is_revealed_(mine_sweeper->width() * mine_sweeper->height(), false),
+        num_revealed_fields_(0) {}
+
+  virtual int RevealField(int x, int y) {
+    const int position = y * mine_sweeper_.width() + x;
+    EXPECT_FALSE(is_revealed_[position]) << x << " " << y;
+    is_revealed_[position] = true;
+    ++num_revealed_fields_;
+    return mine_sweeper_.NumberOfMinesAroundField(x, y);
+  }
+
+  int num_revealed_fields() const { return num_revealed_fields_; }
+
+ private:
+  const MineSweeper& mine_sweeper_;
+  vector<bool> is_revealed_;
+  int num_revealed_fields_;
+};
+
+TEST(MineSeekerInteractiveTest, TestSameAsGuessingSolver) {
+  const int kWidth = 30;
+  const int kHeight = 16;
+  const int kMines = 99;
+  for (int board = 0; board < 20; ++board) {
+    vector<int> positions;
+    GenerateFirstClickSafeBoardMines(kWidth, kHeight, kMines, 5, board,
+                                     0, 0, &positions);
+    string input;
+    AppendBoardToString(kWidth, kHeight, positions, &input);
+    scoped_ptr<MineSweeper> mine_sweeper(MineSweeper::LoadFromString(input));
+    ASSERT_TRUE(mine_sweeper.get() != NULL);
+    MineSeeker guessing_mine_seeker(*mine_sweeper);
+    guessing_mine_seeker.set_use_hints(false);
+    const bool solved = guessing_mine_seeker.Solve();
+
+    MineSweeperRevealer revealer(mine_sweeper.get());
+    MineSweeper interactive(kWidth, kHeight, kMines, &revealer);
+    EXPECT_EQ(MineSweeper::INTERACTIVE, interactive.representation());
+    MineSeeker mine_seeker(interactive);
+    EXPECT_FALSE(mine_seeker.use_hints());
+    EXPECT_EQ(solved, mine_seeker.Solve()) << board;
+    EXPECT_EQ(guessing_mine_seeker.is_dead(), mine_seeker.is_dead());
+    EXPECT_EQ(guessing_mine_seeker.guesses(), mine_seeker.guesses());
+    int num_uncovered_fields = 0;
+    for (int x = 0; x < kWidth; ++x) {
+      for (int y = 0; y < kHeight; ++y) {
+        EXPECT_EQ(guessing_mine_seeker.StateAtPosition(x, y),
+                  mine_seeker.StateAtPosition(x, y)) << x << " " << y;
+        if (mine_seeker.StateAtPosition(x, y)
+            == MineSeekerField::UNCOVERED) {
+          ++num_uncovered_fields;
+        }
+      }
+    }
+    // Only the uncovered fields and the mine that killed the seeker were
+    // revealed.
+    EXPECT_EQ(num_uncovered_fields + (mine_seeker.is_dead() ? 1 : 0),
+              revealer.num_revealed_fields());
+  }
+}
+
+TEST(MineSeekerObservedTest, TestAdvise) {
+  // The number in the middle of the column allows only a single mine next to
+  // the three numbers, and the numbers at its ends place it in the middle.
+  scoped_ptr<MineSweeper> mine_sweeper(
+      MineSweeper::LoadObservedFromString("3 3 1\n01.\n01.\n01.\n"));
+  ASSERT_TRUE(mine_sweeper.get() != NULL);
+  MineSeeker mine_seeker(*mine_sweeper);
+  EXPECT_FALSE(mine_seeker.use_hints());
+  EXPECT_EQ(MineSeekerField::UNCOVERED, mine_seeker.StateAtPosition(1, 1));
+  EXPECT_EQ(MineSeekerField::HIDDEN, mine_seeker.StateAtPosition(2, 1));
+  MineSeeker::Advice advice;
+  EXPECT_TRUE(mine_seeker.Advise(&advice));
+  ASSERT_EQ(2, advice.safe_fields.size());
+  EXPECT_EQ(2, advice.safe_fields[0].x);
+  EXPECT_EQ(2, advice.safe_fields[1].x);
+  EXPECT_EQ(2, advice.safe_fields[0].y + advice.safe_fields[1].y);
+  ASSERT_EQ(1, advice.mines.size());
+  EXPECT_EQ(2, advice.mines[0].x);
+  EXPECT_EQ(1, advice.mines[0].y);
+  EXPECT_TRUE(advice.guesses.empty());
+
+  // A flagged mine is not reported again.
+  scoped_ptr<MineSweeper> flagged_mine_sweeper(
+      MineSweeper::LoadObservedFromString("3 3 1\n01.\n01*\n01.\n"));
+  ASSERT_TRUE(flagged_mine_sweeper.get() != NULL);
+  MineSeeker flagged_mine_seeker(*flagged_mine_sweeper);
+  EXPECT_TRUE(flagged_mine_seeker.Advise(&advice));
+  EXPECT_EQ(2, advice.safe_fields.size());
+  EXPECT_TRUE(advice.mines.empty());
+
+  // The number at (1, 0) sees two flagged mines.
+  scoped_ptr<MineSweeper> invalid_mine_sweeper(
+      MineSweeper::LoadObservedFromString("3 3 2\n01*\n01*\n01.\n"));
+  ASSERT_TRUE(invalid_mine_sweeper.get() != NULL);
+  MineSeeker invalid_mine_seeker(*invalid_mine_sweeper);
+  EXPECT_FALSE(invalid_mine_seeker.Advise(&advice));
+}
+
+TEST(MineSeekerObservedTest, TestAdviseIsSound) {
+  const int kWidth = 30;
+  const int kHeight = 16;
+  const int kMines = 99;
+  for (int board = 0; board < 20; ++board) {
+    vector<int> positions;
+    GenerateFirstClickSafeBoardMines(kWidth, kHeight, kMines, 7, board,
+                                     0, 0, &positions);
+    string input;
+    AppendBoardToString(kWidth, kHeight, positions, &input);
+    scoped_ptr<MineSweeper> mine_sweeper(MineSweeper::LoadFromString(input));
+    ASSERT_TRUE(mine_sweeper.get() != NULL);
+    MineSeeker guessing_mine_seeker(*mine_sweeper);
+    guessing_mine_seeker.set_use_hints(false);
+    guessing_mine_seeker.Solve();
+
+    // Observes the game where the guessing seeker stopped; only some of the
+    // mines it found are flagged.
+    std::stringstream observed;
+    observed << kWidth << " " << kHeight << " " << kMines << "\n";
+    for (int y = 0; y < kHeight; ++y) {
+      for (int x = 0; x < kWidth; ++x) {
+        switch (guessing_mine_seeker.StateAtPosition(x, y)) {
+          case MineSeekerField::UNCOVERED:
+            observed << mine_sweeper->NumberOfMinesAroundField(x, y);
+            break;
+          case MineSeekerField::MINE:
+            observed << ((x + y) % 2 == 0 ? '*' : '.');
+            break;
+          case MineSeekerField::HIDDEN:
+            observed << '.';
+            break;
+        }
+      }
+      observed << "\n";
+    }
+    scoped_ptr<MineSweeper> observed_mine_sweeper(
+        MineSweeper::LoadObservedFromString(observed.str()));
+    ASSERT_TRUE(observed_mine_sweeper.get() != NULL);
+    MineSeeker mine_seeker(*observed_mine_sweeper);
+    MineSeeker::Advice advice;
+    EXPECT_TRUE(mine_seeker.Advise(&advice)) << board;
+    for (int i = 0; i < advice.safe_fields.size(); ++i) {
+      const FieldCoordinate& field = advice.safe_fields[i];
+      EXPECT_FALSE(observed_mine_sweeper->IsKnown(field.x, field.y));
+      EXPECT_FALSE(mine_sweeper->IsMine(field.x, field.y))
+          << field.x << " " << field.y;
+    }
+    for (int i = 0; i < advice.mines.size(); ++i) {
+      const FieldCoordinate& field = advice.mines[i];
+      EXPECT_FALSE(observed_mine_sweeper->IsKnown(field.x, field.y));
+      EXPECT_TRUE(mine_sweeper->IsMine(field.x, field.y))
+          << field.x << " " << field.y;
+    }
+    for (int i = 0; i < advice.guesses.size(); ++i) {
+      const MineSeeker::FieldGuess& guess = advice.guesses[i];
+      EXPECT_EQ(MineSeekerField::HIDDEN,
+                mine_seeker.StateAtPosition(guess.field.x, guess.field.y));
+      EXPECT_LE(0.0, guess.mine_probability);
+      EXPECT_GE(1.0, guess.mine_probability);
+      if (i > 0) {
+        EXPECT_LE(advice.guesses[i - 1].mine_probability,
+                  guess.mine_probability);
+      }
+    }
+  }
+}
+
+TEST(MineSeekerObservedTest, TestHandleObservedFields) {
+  scoped_ptr<MineSweeper> mine_sweeper(
+      MineSweeper::LoadObservedFromString("3 3 1\n01.\n01.\n01.\n"));
+  ASSERT_TRUE(mine_sweeper.get() != NULL);
+  MineSeeker mine_seeker(*mine_sweeper);
+  MineSeeker::Advice advice;
+  EXPECT_TRUE(mine_seeker.Advise(&advice));
+  EXPECT_EQ(2, advice.safe_fields.size());
+  EXPECT_EQ(1, advice.mines.size());
+
+  // In the next frame, the mine is flagged and one of the safe fields is
+  // uncovered.
+  mine_sweeper->ObserveField(2, 1, MineSweeper::kMineInField);
+  mine_sweeper->ObserveField(2, 0, 1);
+  vector<FieldCoordinate> fields;
+  fields.push_back(FieldCoordinate(2, 1));
+  fields.push_back(FieldCoordinate(2, 0));
+  mine_seeker.HandleObservedFields(fields);
+  EXPECT_TRUE(mine_seeker.Advise(&advice));
+  EXPECT_EQ(MineSeekerField::MINE, mine_seeker.StateAtPosition(2, 1));
+  EXPECT_EQ(MineSeekerField::UNCOVERED, mine_seeker.StateAtPosition(2, 0));
+  ASSERT_EQ(1, advice.safe_fields.size());
+  EXPECT_EQ(2, advice.safe_fields[0].x);
+  EXPECT_EQ(2, advice.safe_fields[0].y);
+  EXPECT_TRUE(advice.mines.empty());
+  EXPECT_TRUE(advice.guesses.empty());
+  EXPECT_EQ(0, advice.num_interior_fields);
+
+  // A flag on the remaining safe field contradicts the number at (1, 1).
+  mine_sweeper->ObserveField(2, 2, MineSweeper::kMineInField);
+  fields.clear();
+  fields.push_back(FieldCoordinate(2, 2));
+  mine_seeker.HandleObservedFields(fields);
+  EXPECT_FALSE(mine_seeker.Advise(&advice));
+}
+
+// Stores the indices y * width + x of the fields to indices, in the
+// increasing order.
+void GetSortedFieldIndices(const vector<FieldCoordinate>& fields,
+                           int width,
+                           vector<int>* indices) {
+  indices->clear();
+  for (int i = 0; i < fields.size(); ++i) {
+    indices->push_back(fields[i].y * width + fields[i].x);
+  }
+  std::sort(indices->begin(), indices->end());
+}
+
+TEST(MineSeekerObservedTest, TestHandleObservedFieldsMatchesNewSeeker) {
+  const int kWidth = 30;
+  const int kHeight = 16;
+  const int kMines = 99;
+  for (int board = 0; board < 10; ++board) {
+    vector<int> positions;
+    GenerateFirstClickSafeBoardMines(kWidth, kHeight, kMines, 7, board,
+                                     0, 0, &positions);
+    string input;
+    AppendBoardToString(kWidth, kHeight, positions, &input);
+    scoped_ptr<MineSweeper> mine_sweeper(MineSweeper::LoadFromString(input));
+    ASSERT_TRUE(mine_sweeper.get() != NULL);
+    MineSeeker guessing_mine_seeker(*mine_sweeper);
+    guessing_mine_seeker.set_use_hints(false);
+    guessing_mine_seeker.Solve();
+
+    // The first frame shows only the left half of the final frame.
+    std::stringstream first_frame;
+    std::stringstream final_frame;
+    first_frame << kWidth << " " << kHeight << " " << kMines << "\n";
+    final_frame << kWidth << " " << kHeight << " " << kMines << "\n";
+    vector<FieldCoordinate> changed_fields;
+    for (int y = 0; y < kHeight; ++y) {
+      for (int x = 0; x < kWidth; ++x) {
+        char field = '.';
+        switch (guessing_mine_seeker.StateAtPosition(x, y)) {
+          case MineSeekerField::UNCOVERED:
+            field = '0' + mine_sweeper->NumberOfMinesAroundField(x, y);
+            break;
+          case MineSeekerField::MINE:
+            field = (x + y) % 2 == 0 ? '*' : '.';
+            break;
+          case MineSeekerField::HIDDEN:
+            break;
+        }
+        final_frame << field;
+        if (x < kWidth / 2) {
+          first_frame << field;
+        } else {
+          first_frame << '.';
+          if (field != '.') {
+            changed_fields.push_back(FieldCoordinate(x, y));
+          }
+        }
+      }
+      first_frame << "\n";
+      final_frame << "\n";
+    }
+
+    scoped_ptr<MineSweeper> observed_mine_sweeper(
+        MineSweeper::LoadObservedFromString(first_frame.str()));
+    ASSERT_TRUE(observed_mine_sweeper.get() != NULL);
+    MineSeeker mine_seeker(*observed_mine_sweeper);
+    MineSeeker::Advice advice;
+    EXPECT_TRUE(mine_seeker.Advise(&advice)) << board;
+    for (int i = 0; i < changed_fields.size(); ++i) {
+      const FieldCoordinate& field = changed_fields[i];
+      observed_mine_sweeper->ObserveField(
+          field.x, field.y,
+          mine_sweeper->NumberOfMinesAroundField(field.x, field.y));
+    }
+    mine_seeker.HandleObservedFields(changed_fields);
+    EXPECT_TRUE(mine_seeker.Advise(&advice)) << board;
+
+    scoped_ptr<MineSweeper> final_mine_sweeper(
+        MineSweeper::LoadObservedFromString(final_frame.str()));
+    ASSERT_TRUE(final_mine_sweeper.get() != NULL);
+    MineSeeker final_mine_seeker(*final_mine_sweeper);
+    MineSeeker::Advice final_advice;
+    EXPECT_TRUE(final_mine_seeker.Advise(&final_advice)) << board;
+
+    vector<int> fields;
+    vector<int> final_fields;
+    GetSortedFieldIndices(advice.safe_fields, kWidth, &fields);
+    GetSortedFieldIndices(final_advice.safe_fields, kWidth, &final_fields);
+    EXPECT_TRUE(fields == final_fields) << board;
+    GetSortedFieldIndices(advice.mines, kWidth, &fields);
+    GetSortedFieldIndices(final_advice.mines, kWidth, &final_fields);
+    EXPECT_TRUE(fields == final_fields) << board;
+    EXPECT_EQ(final_advice.guesses.size(), advice.guesses.size()) << board;
+    EXPECT_EQ(final_advice.num_interior_fields, advice.num_interior_fields);
+    EXPECT_NEAR(final_advice.interior_mine_probability,
+                advice.interior_mine_probability, 1e-9);
+  }
+}
+
+TEST_F(MineSeekerTest, TestStatistics) {
+  MineSeeker mine_seeker(*mine_sweeper_);
+  EXPECT_TRUE(mine_seeker.Solve());
+
+  SolverStatistics statistics;
+  mine_seeker.GetStatistics(&statistics);
+  EXPECT_GT(statistics.solve_time_ns, 0);
+  EXPECT_EQ(mine_seeker.safe_field_requests(),
+            statistics.safe_field_requests);
+  EXPECT_EQ(0, statistics.guesses);
+  EXPECT_GT(statistics.num_configuration_removals, 0);
+  // The board is solved before the subset and pair updates are processed, so
+  // only the uncover and update queues are guaranteed to be popped.
+  EXPECT_GT(statistics.num_queue_pops[SolverStatistics::UNCOVER_QUEUE], 0);
+  EXPECT_GT(statistics.num_queue_pops[SolverStatistics::UPDATE_QUEUE], 0);
+  for (int queue = 0; queue < SolverStatistics::kNumQueues; ++queue) {
+    EXPECT_GT(statistics.num_queue_pushes[queue], 0);
+    EXPECT_LE(statistics.num_queue_pops[queue],
+              statistics.num_queue_pushes[queue]);
+  }
+  EXPECT_EQ(statistics.num_queue_pops[SolverStatistics::PAIR_UPDATE_QUEUE],
+            statistics.num_pair_checks);
+  EXPECT_LE(statistics.num_redundant_pair_checks, statistics.num_pair_checks);
+
+  // Each field was resolved exactly once; the first field was uncovered by the
+  // guess tier.
+  const PropagationScheduler& scheduler = mine_seeker.scheduler();
+  ASSERT_EQ(scheduler.num_tiers(), statistics.phases.size());
+  int64 num_resolved_fields = 0;
+  for (int tier = 0; tier < scheduler.num_tiers(); ++tier) {
+    const SolverStatistics::Phase& phase = statistics.phases[tier];
+    EXPECT_EQ(scheduler.tier_name(tier), phase.name);
+    EXPECT_EQ(scheduler.tier_statistics(tier).num_steps, phase.num_steps);
+    num_resolved_fields += phase.num_resolved_fields;
+  }
+  EXPECT_EQ(kWidth * kHeight, num_resolved_fields);
+  EXPECT_GT(statistics.phases[MineSeeker::GUESS_TIER].num_resolved_fields, 0);
+  EXPECT_GT(statistics.phases[MineSeeker::REVEAL_TIER].num_resolved_fields, 0);
+
+  int64 num_samples = 0;
+  for (int i = 0; i < SolverStatistics::kNumConfigurationCountBuckets; ++i) {
+    num_samples += statistics.configuration_count_histogram[i];
+  }
+  EXPECT_GE(num_samples,
+            statistics.num_queue_pops[SolverStatistics::UPDATE_QUEUE]);
+
+  string json;
+  statistics.ToJson(&json);
+  EXPECT_NE(string::npos, json.find("\"name\": \"reveal\""));
+}
+
+// Tests that the probing tier runs only when enabled and that it proves the
+// fields of the pattern 1 1 2 1 1 before the enumeration tier is used.
+TEST(MineSeekerEnumerationTest, TestProbingTier) {
+  MineSweeper mine_sweeper(5, 2);
+  mine_sweeper.SetMine(1, 0, true);
+  mine_sweeper.SetMine(3, 0, true);
+  mine_sweeper.CloseMineField();
+
+  MineSeeker mine_seeker(mine_sweeper);
+  EXPECT_EQ(0, mine_seeker.probing_threads());
+  for (int x = 0; x < 5; ++x) {
+    mine_seeker.UncoverField(x, 1);
+  }
+  EXPECT_FALSE(mine_seeker.HasPendingProbing());
+  mine_seeker.set_probing_threads(2);
+  EXPECT_EQ(2, mine_seeker.probing_threads());
+  EXPECT_TRUE(mine_seeker.HasPendingProbing());
+
+  EXPECT_TRUE(mine_seeker.RunProbingStep());
+  EXPECT_EQ(MineSeekerField::MINE, mine_seeker.StateAtPosition(1, 0));
+  EXPECT_EQ(MineSeekerField::MINE, mine_seeker.StateAtPosition(3, 0));
+  EXPECT_EQ(3, mine_seeker.uncover_queue_.size());
+  // Marking the mines changed the frontier.
+  EXPECT_TRUE(mine_seeker.HasPendingProbing());
+
+  mine_seeker.set_probing_threads(0);
+  EXPECT_FALSE(mine_seeker.HasPendingProbing());
+}
+
+// Tests that parallel propagation on a board with many tiles gives the same
+// result as the sequential propagation.
+TEST(MineSeekerParallelTest, TestParallelPropagation) {
+  const int kWidth = 80;
+  const int kHeight = 40;
+  MineSweeper mine_sweeper(kWidth, kHeight);
+  // A simple linear congruential generator, so that the board is the same on
+  // all platforms.
+  unsigned int random_state = 12345;
+  for (int y = 0; y < kHeight; ++y) {
+    for (int x = 0; x < kWidth; ++x) {
+      random_state = random_state * 1103515245 + 12345;
+      if ((random_state >> 16) % 100 < 10) {
+        mine_sweeper.SetMine(x, y, true);
+      }
+    }
+  }
+  mine_sweeper.CloseMineField();
+
+  MineSeeker sequential_mine_seeker(mine_sweeper);
+  EXPECT_EQ(0, sequential_mine_seeker.propagation_threads());
+  sequential_mine_seeker.Solve();
+
+  MineSeeker parallel_mine_seeker(mine_sweeper);
+  parallel_mine_seeker.set_propagation_threads(4);
+  EXPECT_EQ(4, parallel_mine_seeker.propagation_threads());
+  parallel_mine_seeker.Solve();
+
+  EXPECT_EQ(DebugStringOf(sequential_mine_seeker),
+            DebugStringOf(parallel_mine_seeker));
+  EXPECT_EQ(sequential_mine_seeker.safe_field_requests(),
+            parallel_mine_seeker.safe_field_requests());
+  EXPECT_EQ(sequential_mine_seeker.guesses(), parallel_mine_seeker.guesses());
+
+  const PropagationScheduler& scheduler = parallel_mine_seeker.scheduler();
+  EXPECT_GT(scheduler.tier_statistics(
+      MineSeeker::PARALLEL_PROPAGATION_TIER).num_steps, 0);
+  EXPECT_EQ(0, scheduler.tier_statistics(MineSeeker::REVEAL_TIER).num_steps);
+  EXPECT_EQ(0, scheduler.tier_statistics(MineSeeker::PAIR_TIER).num_steps);
+
+  // The counters collected in the tiles are merged to the statistics of the
+  // mine seeker.
+  SolverStatistics sequential_statistics;
+  sequential_mine_seeker.GetStatistics(&sequential_statistics);
+  SolverStatistics parallel_statistics;
+  parallel_mine_seeker.GetStatistics(&parallel_statistics);
+  EXPECT_GT(parallel_statistics.phases[
+      MineSeeker::PARALLEL_PROPAGATION_TIER].num_resolved_fields, 0);
+  EXPECT_GT(parallel_statistics.num_pair_checks, 0);
+  int64 sequential_resolved_fields = 0;
+  int64 parallel_resolved_fields = 0;
+  for (int tier = 0; tier < scheduler.num_tiers(); ++tier) {
+    sequential_resolved_fields +=
+        sequential_statistics.phases[tier].num_resolved_fields;
+    parallel_resolved_fields +=
+        parallel_statistics.phases[tier].num_resolved_fields;
+  }
+  EXPECT_EQ(sequential_resolved_fields, parallel_resolved_fields);
+
+}
+
+// Tests that the fields changed by the tiles update the constraints of the
+// frontier after the parallel step.
+TEST(MineSeekerParallelTest, TestFrontierConstraintFields) {
+  const int kWidth = 80;
+  const int kHeight = 40;
+  MineSweeper mine_sweeper(kWidth, kHeight);
+  unsigned int random_state = 12345;
+  for (int y = 0; y < kHeight; ++y) {
+    for (int x = 0; x < kWidth; ++x) {
+      random_state = random_state * 1103515245 + 12345;
+      if ((random_state >> 16) % 100 < 20) {
+        mine_sweeper.SetMine(x, y, true);
+      }
+    }
+  }
+  mine_sweeper.CloseMineField();
+
+  MineSeeker mine_seeker(mine_sweeper);
+  mine_seeker.set_propagation_threads(4);
+  FieldCoordinate start(-1, -1);
+  ASSERT_TRUE(mine_seeker.GetSafeFieldCoordinates(&start));
+  EXPECT_TRUE(mine_seeker.UncoverField(start.x, start.y));
+  EXPECT_TRUE(mine_seeker.SolveStep());
+  EXPECT_FALSE(mine_seeker.IsSolved());
+  vector<int> frontier_constraint_fields;
+  mine_seeker.GetFrontierConstraintFields(&frontier_constraint_fields);
+  EXPECT_FALSE(frontier_constraint_fields.empty());
+  ExpectFrontierConstraintFieldsAreUpToDate(mine_seeker);
+}
+
+TEST(MineSeekerBoardSpecializationTest, TestSelection) {
+  MineSweeper beginner(9, 9);
+  beginner.CloseMineField();
+  EXPECT_STREQ("9x9", MineSeeker(beginner).board_specialization());
+  MineSweeper intermediate(16, 16);
+  intermediate.CloseMineField();
+  EXPECT_STREQ("16x16", MineSeeker(intermediate).board_specialization());
+  MineSweeper expert(30, 16);
+  expert.CloseMineField();
+  EXPECT_STREQ("30x16", MineSeeker(expert).board_specialization());
+  MineSweeper other(16, 30);
+  other.CloseMineField();
+  EXPECT_STREQ("generic", MineSeeker(other).board_specialization());
+}
+
+// Tests that the specialized and the generic kernels remove the same
+// configurations as ConfigurationFitsAt.
+TEST(MineSeekerBoardSpecializationTest, TestKernelsMatch) {
+  MineSweeper mine_sweeper(9, 9);
+  const int kMineX[] = { 0, 2, 4, 8, 1, 6, 3, 7, 5, 8 };
+  const int kMineY[] = { 0, 1, 2, 2, 4, 4, 6, 6, 8, 8 };
+  for (int i = 0; i < ARRAYSIZE(kMineX); ++i) {
+    mine_sweeper.SetMine(kMineX[i], kMineY[i], true);
+  }
+  mine_sweeper.CloseMineField();
+  MineSeeker mine_seeker(mine_sweeper);
+  mine_seeker.UncoverField(4, 4);
+  mine_seeker.UncoverField(0, 8);
+  mine_seeker.UncoverField(8, 0);
+  mine_seeker.MarkAsMine(4, 2);
+  for (int i = 0; i < 10 && mine_seeker.SolveStep(); ++i) {}
+
+  for (int y = 0; y < 9; ++y) {
+    for (int x = 0; x < 9; ++x) {
+      ConfigurationSet expected;
+      for (int configuration = 0;
+           configuration < MineSeekerField::kNumPossibleConfigurations;
+           ++configuration) {
+        if (mine_seeker.FieldAtPosition(x, y)
+                .IsPossibleConfiguration(configuration)
+            && mine_seeker.ConfigurationFitsAt(configuration, x, y)) {
+          expected.set(configuration);
+        }
+      }
+      // The kernels filter the configurations in place, so each of them runs
+      // on its own fork.
+      MineSeeker generic_seeker(mine_seeker);
+      generic_seeker.FilterConfigurations<DynamicBoardGeometry>(x, y);
+      const ConfigurationSet& generic =
+          generic_seeker.state_.configurations(x, y);
+      MineSeeker specialized_seeker(mine_seeker);
+      specialized_seeker.FilterConfigurations<BeginnerBoardGeometry>(x, y);
+      const ConfigurationSet& specialized =
+          specialized_seeker.state_.configurations(x, y);
+      for (int i = 0; i < ConfigurationSet::kNumWords; ++i) {
+        EXPECT_EQ(expected.word(i), generic.word(i));
+        EXPECT_EQ(expected.word(i), specialized.word(i));
+      }
+    }
+  }
+}
+
 }  // namespace mineseeker
@@ -27,16 +27,107 @@
 namespace mineseeker {
 
 const int MineSweeper::kMineInField = -1;
+const int64 MineSweeper::kMaxDenseFields = 1 << 26;
+
+namespace {
+// The value of known_mine_counts_ for the fields that were not revealed or
+// observed.
+const int8 kNotRevealed = -2;
+}  // namespace
 
 MineSweeper::MineSweeper(int width, int height)
     : width_(width),
       height_(height),
+      is_window_(false),
+      has_fields_left_(false),
+      has_fields_above_(false),
+      has_fields_right_(false),
+      has_fields_below_(false),
+      revealer_(NULL),
+      is_observed_(false),
+      num_mines_(0),
+      num_empty_fields_(0),
+      version_(0),
+      is_closed_(false) {
+  ResetMinefield(width_, height_, DENSE);
+}
+
+MineSweeper::MineSweeper(int width, int height, Representation representation)
+    : width_(width),
+      height_(height),
+      is_window_(false),
+      has_fields_left_(false),
+      has_fields_above_(false),
+      has_fields_right_(false),
+      has_fields_below_(false),
+      revealer_(NULL),
+      is_observed_(false),
+      num_mines_(0),
+      num_empty_fields_(0),
+      version_(0),
       is_closed_(false) {
-  ResetMinefield(width_, height_);
+  ResetMinefield(width_, height_, representation);
+}
+
+MineSweeper::MineSweeper(const MineSource* mine_source,
+                         int origin_x,
+                         int origin_y,
+                         int width,
+                         int height)
+    : width_(0),
+      height_(0),
+      is_window_(true),
+      has_fields_left_(false),
+      has_fields_above_(false),
+      has_fields_right_(false),
+      has_fields_below_(false),
+      revealer_(NULL),
+      is_observed_(false),
+      num_mines_(0),
+      num_empty_fields_(0),
+      version_(0),
+      is_closed_(true) {
+  LoadWindow(mine_source, origin_x, origin_y, width, height);
+}
+
+MineSweeper::MineSweeper(int width,
+                         int height,
+                         int num_mines,
+                         FieldRevealer* revealer)
+    : width_(width),
+      height_(height),
+      is_window_(false),
+      has_fields_left_(false),
+      has_fields_above_(false),
+      has_fields_right_(false),
+      has_fields_below_(false),
+      revealer_(CHECK_NOTNULL(revealer)),
+      is_observed_(false),
+      known_mine_counts_(width * height, kNotRevealed),
+      num_mines_(num_mines),
+      num_empty_fields_(0),
+      version_(0),
+      is_closed_(true) {
+  CHECK_GT(width, 0);
+  CHECK_GT(height, 0);
+  CHECK_GE(num_mines, 0);
 }
 
 void MineSweeper::CloseMineField() {
-  is_closed_ = true;
+  CHECK(!is_window_) << "The window of a mine source is always closed";
+  CHECK(revealer_ == NULL) << "The interactive mine field is always closed";
+  if (is_observed_) {
+    is_closed_ = true;
+    ++version_;
+    return;
+  }
+  if (sparse_mine_field_.get() != NULL) {
+    num_empty_fields_ = static_cast<int64>(width_) * height_
+        - sparse_mine_field_->CountFieldsNearMines();
+    is_closed_ = true;
+    ++version_;
+    return;
+  }
   for (int x = 0; x < width_; ++x) {
     for (int y = 0; y < height_; ++y) {
       if (mine_field_[x][y] == kMineInField) {
@@ -44,10 +135,19 @@ void MineSweeper::CloseMineField() {
       }
     }
   }
+  num_empty_fields_ = 0;
+  for (int x = 0; x < width_; ++x) {
+    num_empty_fields_ += std::count(mine_field_[x].begin(),
+                                    mine_field_[x].end(), 0);
+  }
+  is_closed_ = true;
+  ++version_;
 }
 
 void MineSweeper::PrintMineCountsToString(string* out) const {
   CHECK_NOTNULL(out);
+  CHECK(revealer_ == NULL) << "The interactive mine field is not known";
+  CHECK(!is_observed_) << "The observed mine field is not known";
   std::stringstream buffer(std::stringstream::out);
   for (int y = 0; y < height_; ++y) {
     for (int x = 0; x < width_; ++x) {
@@ -68,15 +168,45 @@ void MineSweeper::IncreaseNeighborMineCounts(int x, int y) {
   }
 }
 
+void MineSweeper::DecreaseNeighborMineCounts(int x, int y) {
+  for (int i = -1; i < 2; ++i) {
+    for (int j = -1; j < 2; ++j) {
+      if (i != 0 || j != 0) {
+        DecreaseMineCount(x + i, y + j);
+      }
+    }
+  }
+}
+
 void MineSweeper::IncreaseMineCount(int x, int y) {
   if (x >= 0 && y >= 0 && x < width_ && y < height_) {
-    if (mine_field_[x][y] != kMineInField) {
-      ++mine_field_[x][y];
+    int* const count = &mine_field_[x][y];
+    if (*count != kMineInField) {
+      if (*count == 0 && is_closed_) {
+        --num_empty_fields_;
+      }
+      ++*count;
+    }
+  }
+}
+
+void MineSweeper::DecreaseMineCount(int x, int y) {
+  if (x >= 0 && y >= 0 && x < width_ && y < height_) {
+    int* const count = &mine_field_[x][y];
+    if (*count != kMineInField) {
+      DCHECK_GT(*count, 0);
+      --*count;
+      if (*count == 0) {
+        ++num_empty_fields_;
+      }
     }
   }
 }
 
 bool MineSweeper::IsMine(int x, int y) const {
+  if (sparse_mine_field_.get() != NULL) {
+    return sparse_mine_field_->IsMine(x, y);
+  }
   return kMineInField == NumberOfMinesAroundField(x, y);
 }
 
@@ -94,7 +224,10 @@ MineSweeper* MineSweeper::LoadFromString(const string& input) {
     return NULL;
   }
 
-  scoped_ptr<MineSweeper> mine_sweeper(new MineSweeper(width, height));
+  const Representation representation =
+      static_cast<int64>(width) * height > kMaxDenseFields ? SPARSE : DENSE;
+  scoped_ptr<MineSweeper> mine_sweeper(
+      new MineSweeper(width, height, representation));
 
   int num_mines = 0;
   in >> num_mines;
@@ -122,15 +255,80 @@ MineSweeper* MineSweeper::LoadFromString(const string& input) {
   return mine_sweeper.release();
 }
 
-int MineSweeper::NumberOfMines() const {
-  int num_mines = 0;
-  for (int x = 0; x < width_; ++x) {
-    int mines_in_column = std::count(mine_field_[x].begin(),
-                                     mine_field_[x].end(),
-                                     kMineInField);
-    num_mines += mines_in_column;
+MineSweeper* MineSweeper::LoadObservedFromString(const string& input) {
+  std::istringstream in(input);
+  string header;
+  std::getline(in, header);
+  std::istringstream header_stream(header);
+  int width = 0;
+  int height = 0;
+  int num_mines = -1;
+  header_stream >> width >> height >> num_mines;
+  if (width <= 0) {
+    LOG(ERROR) << "Invalid width: " << width;
+    return NULL;
   }
-  return num_mines;
+  if (height <= 0) {
+    LOG(ERROR) << "Invalid height: " << height;
+    return NULL;
+  }
+  if (num_mines < 0) {
+    LOG(ERROR) << "Invalid number of mines: " << num_mines;
+    return NULL;
+  }
+
+  scoped_ptr<MineSweeper> mine_sweeper(
+      new MineSweeper(width, height, OBSERVED));
+  int num_flags = 0;
+  for (int y = 0; y < height; ++y) {
+    string row;
+    if (!std::getline(in, row)) {
+      LOG(ERROR) << "Missing row " << y;
+      return NULL;
+    }
+    if (!row.empty() && row[row.size() - 1] == '\r') {
+      row.resize(row.size() - 1);
+    }
+    if (row.size() != width) {
+      LOG(ERROR) << "Invalid length of row " << y << ": " << row.size();
+      return NULL;
+    }
+    for (int x = 0; x < width; ++x) {
+      int8* const count = &mine_sweeper->known_mine_counts_[y * width + x];
+      const char field = row[x];
+      if (field == '.') {
+        continue;
+      } else if (field == '*') {
+        *count = kMineInField;
+        ++num_flags;
+      } else if (field == ' ') {
+        *count = 0;
+      } else if (field >= '0' && field <= '8') {
+        *count = field - '0';
+      } else {
+        LOG(ERROR) << "Invalid field at " << x << " " << y << ": " << field;
+        return NULL;
+      }
+    }
+  }
+  if (num_flags > num_mines) {
+    LOG(ERROR) << "More flags than mines: " << num_flags;
+    return NULL;
+  }
+  mine_sweeper->num_mines_ = num_mines;
+  mine_sweeper->CloseMineField();
+  return mine_sweeper.release();
+}
+
+int MineSweeper::NumberOfMines() const {
+  return num_mines_;
+}
+
+int64 MineSweeper::NumberOfEmptyFields() const {
+  CHECK(is_closed_);
+  CHECK(revealer_ == NULL) << "The interactive mine field is not known";
+  CHECK(!is_observed_) << "The observed mine field is not known";
+  return num_empty_fields_;
 }
 
 int MineSweeper::NumberOfMinesAroundField(int x, int y) const {
@@ -138,19 +336,166 @@ int MineSweeper::NumberOfMinesAroundField(int x, int y) const {
   CHECK_LT(x, width_);
   CHECK_GE(y, 0);
   CHECK_LT(y, height_);
+  if (is_window_) {
+    return window_mine_counts_[y * width_ + x];
+  }
+  if (is_observed_) {
+    const int count = known_mine_counts_[y * width_ + x];
+    CHECK_NE(kNotRevealed, count)
+        << "The field " << x << " " << y << " was not observed";
+    return count;
+  }
+  if (revealer_ != NULL) {
+    int8* const count = &known_mine_counts_[y * width_ + x];
+    if (*count == kNotRevealed) {
+      const int revealed_count = revealer_->RevealField(x, y);
+      CHECK_GE(revealed_count, kMineInField);
+      CHECK_LE(revealed_count, 8);
+      *count = revealed_count;
+    }
+    return *count;
+  }
+  if (sparse_mine_field_.get() != NULL) {
+    // Before the mine field is closed, the numbers are not known, the same as
+    // in the dense representation.
+    if (!is_closed_) {
+      return sparse_mine_field_->IsMine(x, y) ? kMineInField : 0;
+    }
+    return sparse_mine_field_->NumberOfMinesAroundField(x, y);
+  }
   return mine_field_[x][y];
 }
 
-void MineSweeper::ResetMinefield(int width, int height) {
+bool MineSweeper::IsKnown(int x, int y) const {
+  CHECK_GE(x, 0);
+  CHECK_LT(x, width_);
+  CHECK_GE(y, 0);
+  CHECK_LT(y, height_);
+  return !is_observed_ || known_mine_counts_[y * width_ + x] != kNotRevealed;
+}
+
+int MineSweeper::CountEmptyFieldsAround(int x, int y) const {
+  int num_empty_fields = 0;
+  for (int j = std::max(0, y - 1); j <= std::min(height_ - 1, y + 1); ++j) {
+    for (int i = std::max(0, x - 1); i <= std::min(width_ - 1, x + 1); ++i) {
+      if (NumberOfMinesAroundField(i, j) == 0) {
+        ++num_empty_fields;
+      }
+    }
+  }
+  return num_empty_fields;
+}
+
+void MineSweeper::MoveWindow(const MineSource* mine_source,
+                             int origin_x,
+                             int origin_y,
+                             int width,
+                             int height) {
+  CHECK(is_window_);
+  LoadWindow(mine_source, origin_x, origin_y, width, height);
+  ++version_;
+}
+
+void MineSweeper::ObserveField(int x, int y, int num_mines_around) {
+  CHECK_GE(x, 0);
+  CHECK_LT(x, width_);
+  CHECK_GE(y, 0);
+  CHECK_LT(y, height_);
+  CHECK(is_observed_) << "Only the observed mine field can be observed";
+  CHECK_GE(num_mines_around, kMineInField);
+  CHECK_LE(num_mines_around, 8);
+  int8* const count = &known_mine_counts_[y * width_ + x];
+  CHECK_EQ(kNotRevealed, *count)
+      << "The field " << x << " " << y << " was already observed";
+  *count = num_mines_around;
+  ++version_;
+}
+
+void MineSweeper::LoadWindow(const MineSource* mine_source,
+                             int origin_x,
+                             int origin_y,
+                             int width,
+                             int height) {
+  CHECK_NOTNULL(mine_source);
+  CHECK_GT(width, 0);
+  CHECK_GT(height, 0);
+  CHECK_GE(origin_x, 0);
+  CHECK_GE(origin_y, 0);
+  CHECK_LE(static_cast<int64>(origin_x) + width, mine_source->width());
+  CHECK_LE(static_cast<int64>(origin_y) + height, mine_source->height());
+  width_ = width;
+  height_ = height;
+  has_fields_left_ = origin_x > 0;
+  has_fields_above_ = origin_y > 0;
+  has_fields_right_ =
+      static_cast<int64>(origin_x) + width < mine_source->width();
+  has_fields_below_ =
+      static_cast<int64>(origin_y) + height < mine_source->height();
+  num_mines_ = 0;
+  num_empty_fields_ = 0;
+  // The mines of the window and the fields around it are computed once, so
+  // that each field is hashed only once.
+  const int padded_width = width + 2;
+  vector<bool> is_mine(padded_width * (height + 2), false);
+  for (int y = -1; y <= height; ++y) {
+    for (int x = -1; x <= width; ++x) {
+      is_mine[(y + 1) * padded_width + x + 1] =
+          mine_source->IsMine(origin_x + x, origin_y + y);
+    }
+  }
+  window_mine_counts_.resize(width * height);
+  for (int y = 0; y < height; ++y) {
+    for (int x = 0; x < width; ++x) {
+      int8* const count = &window_mine_counts_[y * width + x];
+      if (is_mine[(y + 1) * padded_width + x + 1]) {
+        *count = kMineInField;
+        ++num_mines_;
+        continue;
+      }
+      *count = 0;
+      for (int j = y; j <= y + 2; ++j) {
+        for (int i = x; i <= x + 2; ++i) {
+          if (is_mine[j * padded_width + i]) {
+            ++*count;
+          }
+        }
+      }
+      if (*count == 0) {
+        ++num_empty_fields_;
+      }
+    }
+  }
+}
+
+void MineSweeper::ResetMinefield(int width,
+                                 int height,
+                                 Representation representation) {
   CHECK_GT(width, 0);
   CHECK_GT(height, 0);
   width_ = width;
   height_ = height;
-  mine_field_.resize(width);
-  for (int i = 0; i < width_; ++i) {
-    mine_field_[i].clear();
-    mine_field_[i].resize(height_, 0);
+  CHECK(representation == DENSE || representation == SPARSE
+        || representation == OBSERVED)
+      << "Invalid representation: " << representation;
+  is_observed_ = representation == OBSERVED;
+  known_mine_counts_.clear();
+  if (representation == OBSERVED) {
+    mine_field_.clear();
+    sparse_mine_field_.reset(NULL);
+    known_mine_counts_.resize(width * height, kNotRevealed);
+  } else if (representation == SPARSE) {
+    mine_field_.clear();
+    sparse_mine_field_.reset(new SparseMineField(width, height));
+  } else {
+    sparse_mine_field_.reset(NULL);
+    mine_field_.resize(width);
+    for (int i = 0; i < width_; ++i) {
+      mine_field_[i].clear();
+      mine_field_[i].resize(height_, 0);
+    }
   }
+  num_mines_ = 0;
+  num_empty_fields_ = 0;
 }
 
 void MineSweeper::SetMine(int x, int y, bool is_mine) {
@@ -158,7 +503,80 @@ void MineSweeper::SetMine(int x, int y, bool is_mine) {
   CHECK_LT(x, width_);
   CHECK_GE(y, 0);
   CHECK_LT(y, height_);
-  mine_field_[x][y] = is_mine ? kMineInField : 0;
+  CHECK(!is_window_) << "The window of a mine source can't be changed";
+  CHECK(revealer_ == NULL) << "The interactive mine field can't be changed";
+  CHECK(!is_observed_) << "The observed mine field can't be changed";
+  if (IsMine(x, y) == is_mine) {
+    return;
+  }
+  if (is_closed_) {
+    ToggleMine(x, y);
+    return;
+  }
+  if (sparse_mine_field_.get() != NULL) {
+    sparse_mine_field_->SetMine(x, y, is_mine);
+  } else {
+    mine_field_[x][y] = is_mine ? kMineInField : 0;
+  }
+  num_mines_ += is_mine ? 1 : -1;
+  ++version_;
+}
+
+void MineSweeper::ToggleMine(int x, int y) {
+  CHECK(!is_window_) << "The window of a mine source can't be changed";
+  CHECK(revealer_ == NULL) << "The interactive mine field can't be changed";
+  CHECK(!is_observed_) << "The observed mine field can't be changed";
+  if (!is_closed_) {
+    SetMine(x, y, !IsMine(x, y));
+    return;
+  }
+  if (sparse_mine_field_.get() != NULL) {
+    // Only the fields in the 3x3 square around the field can change.
+    const bool is_mine = !sparse_mine_field_->IsMine(x, y);
+    num_empty_fields_ -= CountEmptyFieldsAround(x, y);
+    sparse_mine_field_->SetMine(x, y, is_mine);
+    num_empty_fields_ += CountEmptyFieldsAround(x, y);
+    num_mines_ += is_mine ? 1 : -1;
+    ++version_;
+    return;
+  }
+  if (IsMine(x, y)) {
+    // The field gets the number of its neighboring mines.
+    int num_neighbor_mines = 0;
+    for (int i = -1; i < 2; ++i) {
+      for (int j = -1; j < 2; ++j) {
+        const int neighbor_x = x + i;
+        const int neighbor_y = y + j;
+        if ((i != 0 || j != 0)
+            && neighbor_x >= 0 && neighbor_y >= 0
+            && neighbor_x < width_ && neighbor_y < height_
+            && mine_field_[neighbor_x][neighbor_y] == kMineInField) {
+          ++num_neighbor_mines;
+        }
+      }
+    }
+    mine_field_[x][y] = num_neighbor_mines;
+    if (num_neighbor_mines == 0) {
+      ++num_empty_fields_;
+    }
+    --num_mines_;
+    DecreaseNeighborMineCounts(x, y);
+  } else {
+    if (mine_field_[x][y] == 0) {
+      --num_empty_fields_;
+    }
+    mine_field_[x][y] = kMineInField;
+    ++num_mines_;
+    IncreaseNeighborMineCounts(x, y);
+  }
+  ++version_;
+}
+
+void MineSweeper::MoveMine(int from_x, int from_y, int to_x, int to_y) {
+  CHECK(IsMine(from_x, from_y));
+  CHECK(!IsMine(to_x, to_y));
+  ToggleMine(from_x, from_y);
+  ToggleMine(to_x, to_y);
 }
 
 }  // namespace mineseeker
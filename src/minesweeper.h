@@ -19,6 +19,10 @@
 #define MINESEEKER_MINESWEEPER_H_
 
 #include "common.h"
+#include "field_revealer.h"
+#include "mine_source.h"
+#include "scoped_ptr.h"
+#include "sparse_mine_field.h"
 
 namespace mineseeker {
 
@@ -27,28 +31,131 @@ typedef vector<vector<int> > MineField;
 // Implements the minefield for the minesweeper game. Keeps track of the number
 // of mines in the neighbourhood of empty fields, and supports loading the mine
 // field from a file.
+//
+// The mine field has two representations with the same interface. The dense
+// representation stores the number of neighboring mines of every field. The
+// sparse representation stores only the positions of the mines in a
+// SparseMineField and computes the numbers on demand, so that huge mine fields
+// with few mines use memory proportional to the number of mines.
+//
+// The window representation is a read-only view of a rectangular window of a
+// MineSource, e.g. a ProceduralMineField, which may be much larger than the
+// window. The numbers of the window are computed from the mine source when the
+// view is created; the numbers of the fields on the border of the window count
+// also the mines outside of the window, see IsOnWindowBorder. The view can be
+// moved to another window of the same or another mine source by MoveWindow.
+//
+// The interactive representation does not know the mines; it stands for a
+// game played elsewhere, e.g. by a user or by another program. The number of a
+// field is obtained from a FieldRevealer when the field is queried for the
+// first time, which uncovers the field in the game, so only the fields that
+// the solver uncovers may be queried.
+//
+// The observed representation is a snapshot of a game played elsewhere: it
+// knows the numbers of the uncovered fields and the flagged fields, which are
+// assumed to contain mines, but nothing about the remaining hidden fields (see
+// IsKnown and LoadObservedFromString).
 class MineSweeper {
  public:
   // The constant used in mine_field_ for fields that contain a mine.
   static const int kMineInField;
+  // The largest number of fields of a mine field loaded by LoadFromString in
+  // the dense representation.
+  static const int64 kMaxDenseFields;
+
+  // The representations of the mine field.
+  enum Representation {
+    DENSE,
+    SPARSE,
+    WINDOW,
+    INTERACTIVE,
+    OBSERVED,
+  };
 
-  // Initializes a new mine field of the given size with no mines in it.
+  // Initializes a new mine field of the given size with no mines in it, in the
+  // dense representation.
   MineSweeper(int width, int height);
+  // Initializes a new mine field of the given size with no mines in it, in the
+  // given representation; the representation must be DENSE, SPARSE or
+  // OBSERVED. In the observed representation, all fields are hidden.
+  MineSweeper(int width, int height, Representation representation);
+  // Initializes a closed mine field in the window representation, that views
+  // the window of the given size with the top-left corner at
+  // (origin_x, origin_y) of 'mine_source'. The window must be inside the mine
+  // source. Does not take ownership of the mine source, and it does not use it
+  // after the construction; the mines can't be changed.
+  MineSweeper(const MineSource* mine_source,
+              int origin_x,
+              int origin_y,
+              int width,
+              int height);
+  // Initializes a closed mine field in the interactive representation, with
+  // the given size and number of mines. Does not take ownership of the
+  // revealer; the revealer must outlive the mine sweeper. The mines can't be
+  // changed.
+  MineSweeper(int width, int height, int num_mines, FieldRevealer* revealer);
 
-  // Places or removes mine from the given position in the mine field. This
-  // method only works before the mine field is closed for changes.
+  // Places or removes mine from the given position in the mine field. Before
+  // the mine field is closed, only the mine is placed or removed; afterwards,
+  // the numbers of neighboring mines are updated as in ToggleMine.
   void SetMine(int x, int y, bool is_mine);
-  
+  // Places a mine to the given position if there is none, or removes the mine
+  // from the position. After the mine field was closed, the numbers of
+  // neighboring mines of the field and its neighbors are updated in place, so
+  // the change takes constant time.
+  void ToggleMine(int x, int y);
+  // Moves the mine from the position (from_x, from_y) to the position
+  // (to_x, to_y), which must not contain a mine. Equivalent to toggling both
+  // positions.
+  void MoveMine(int from_x, int from_y, int to_x, int to_y);
+
+  // Moves the view of the window representation to the window of the given
+  // size with the top-left corner at (origin_x, origin_y) of 'mine_source',
+  // with the same requirements as in the constructor. Changes the version of
+  // the mine field; the mine seekers working on it must be restarted, see
+  // MineSeeker::Restart.
+  void MoveWindow(const MineSource* mine_source,
+                  int origin_x,
+                  int origin_y,
+                  int width,
+                  int height);
+  // Records the field (x, y) of the observed representation in a later frame
+  // of the game: the field was uncovered with num_mines_around mines around
+  // it, or it was flagged when num_mines_around is kMineInField. The field
+  // must not be known yet; a frame that removes a flag needs a new mine
+  // sweeper. Changes the version of the mine field; the mine seekers working
+  // on it must be notified, see MineSeeker::HandleObservedFields.
+  void ObserveField(int x, int y, int num_mines_around);
+
   // Checks if at the position (x, y) is a mine.
   bool IsMine(int x, int y) const;
   // Returns the number of mines around the given field. This method only works
   // for fields that themselves do not contain a mine. In such case, this method
-  // returns kMineInField.
+  // returns kMineInField. In the interactive representation, both methods
+  // uncover the field in the game when it is queried for the first time. In
+  // the observed representation, they may be called only for known fields.
   int NumberOfMinesAroundField(int x, int y) const;
+  // Returns true if the field (x, y) was observed as uncovered or flagged in
+  // the observed representation; the numbers of the other fields are not
+  // known. Always returns true in the other representations.
+  bool IsKnown(int x, int y) const;
+
+  // Returns true if the field (x, y) is on the border of a window of a mine
+  // source, and it has neighbors outside of the window. The number of such
+  // field counts also the mines outside of the window. Always returns false in
+  // the other representations.
+  bool IsOnWindowBorder(int x, int y) const {
+    return is_window_
+        && ((x == 0 && has_fields_left_)
+            || (y == 0 && has_fields_above_)
+            || (x == width_ - 1 && has_fields_right_)
+            || (y == height_ - 1 && has_fields_below_));
+  }
 
   // Loads the mine field from a file. Returns NULL if loading of the mine field
   // failed. Upon success, returns the minefield; the caller is responsible for
-  // deleting the returned object.
+  // deleting the returned object. Mine fields with more than kMaxDenseFields
+  // fields use the sparse representation.
   //
   // The mines are expected in the following format:
   // {width} {height}
@@ -58,21 +165,53 @@ class MineSweeper {
   // ...
   static MineSweeper* LoadFromFile(const string& file_name);
   static MineSweeper* LoadFromString(const string& input);
+  // Loads an observed game from a string. Returns NULL if loading failed;
+  // otherwise, returns the mine field in the observed representation, and the
+  // caller is responsible for deleting it.
+  //
+  // The observed game is expected in the following format:
+  // {width} {height} {num_mines}
+  // followed by {height} rows of {width} characters each, where '.' is a
+  // hidden field, '*' a flagged field, and '0' to '8' (or ' ' for zero) are
+  // the numbers of the uncovered fields.
+  static MineSweeper* LoadObservedFromString(const string& input);
 
   // Closes the mine field. Updates the numbers of neighboring mines for each
   // field.
   void CloseMineField();
 
-  // Returns the number of mines in the minefield.
+  // Returns the number of mines in the minefield. Takes constant time.
   int NumberOfMines() const;
+  // Returns the number of fields that have no mine and no mines around them,
+  // i.e. the fields that open a region when uncovered. Takes constant time;
+  // the mine field must be closed.
+  int64 NumberOfEmptyFields() const;
 
-  // If true, the mine field is closed for modifications; no mines can be added
-  // or removed from the mine field.
+  // Returns the version of the mine field. The version changes with every
+  // change of the mines and when the mine field is closed, so that objects
+  // that depend on the mine field can detect that it was changed.
+  int64 version() const { return version_; }
+
+  // If true, the mine field is closed and the numbers of neighboring mines are
+  // computed; the mines can still be changed by SetMine, ToggleMine and
+  // MoveMine, which update the numbers.
   bool is_closed() const { return is_closed_; }
 
   // The size of the mine field.
   int width() const { return width_; }
   int height() const { return height_; }
+  Representation representation() const {
+    if (is_window_) {
+      return WINDOW;
+    }
+    if (revealer_ != NULL) {
+      return INTERACTIVE;
+    }
+    if (is_observed_) {
+      return OBSERVED;
+    }
+    return sparse_mine_field_.get() == NULL ? DENSE : SPARSE;
+  }
 
   // Prints the matrix with mine counts to the string 'out'. Erases any content
   // that was stored in out previously. If this method is called before the mine
@@ -83,17 +222,63 @@ class MineSweeper {
   // Increases the number of mines reported at position x, y.
   void IncreaseMineCount(int x, int y);
   // Increases the number of mines in the neighborhood of this field.
-  void IncreaseNeighborMineCounts(int x, int x);
+  void IncreaseNeighborMineCounts(int x, int y);
+  // Decreases the number of mines reported at position x, y.
+  void DecreaseMineCount(int x, int y);
+  // Decreases the number of mines in the neighborhood of this field.
+  void DecreaseNeighborMineCounts(int x, int y);
+
+  // Counts the fields without mines and with no mines around them in the 3x3
+  // square around the field (x, y), including the field itself.
+  int CountEmptyFieldsAround(int x, int y) const;
 
   // Resizes the mine field and removes all mines.
-  void ResetMinefield(int width, int height);
+  void ResetMinefield(int width, int height, Representation representation);
+  // Computes the numbers of the fields of the window representation from the
+  // mine source; see MoveWindow.
+  void LoadWindow(const MineSource* mine_source,
+                  int origin_x,
+                  int origin_y,
+                  int width,
+                  int height);
 
   // The mine field.
   int width_;
   int height_;
+  // The numbers of neighboring mines in the dense representation; empty in the
+  // sparse representation.
   MineField mine_field_;
+  // The mines in the sparse representation, or NULL in the dense
+  // representation.
+  scoped_ptr<SparseMineField> sparse_mine_field_;
+  // True in the window representation. The numbers of the fields of the
+  // window are stored by rows in window_mine_counts_, and the flags tell on
+  // which sides of the window the mine source has more fields.
+  bool is_window_;
+  vector<int8> window_mine_counts_;
+  bool has_fields_left_;
+  bool has_fields_above_;
+  bool has_fields_right_;
+  bool has_fields_below_;
+  // The revealer of the interactive representation, or NULL in the other
+  // representations. The known numbers of the fields of the interactive and
+  // the observed representations are stored by rows in known_mine_counts_. In
+  // the interactive representation, they cache the revealed numbers, so that
+  // each field is uncovered in the game only once.
+  FieldRevealer* revealer_;
+  bool is_observed_;
+  mutable vector<int8> known_mine_counts_;
+  // The number of mines, and the number of fields with no mines around them;
+  // the latter is maintained only after the mine field is closed.
+  int num_mines_;
+  int64 num_empty_fields_;
+  // Incremented with each change of the mine field.
+  int64 version_;
   // Set to true if the mine field is closed for changes.
   bool is_closed_;
+
+  MineSweeper(const MineSweeper&);
+  void operator=(const MineSweeper&);
 };
 
 }  // namespace mineseeker
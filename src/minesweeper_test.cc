@@ -15,10 +15,13 @@
 // You should have received a copy of the GNU General Public License along with
 // MineSeeker. If not, see <http://www.gnu.org/licenses/>.
 
+#include <random>
+
 #include "common.h"
 #include "glog/logging.h"
 #include "gtest/gtest.h"
 #include "minesweeper.h"
+#include "procedural_mine_field.h"
 #include "scoped_ptr.h"
 
 namespace mineseeker {
@@ -150,4 +153,281 @@ TEST(MineSweeperTest, TestSetMine) {
   }
 }
 
+TEST(MineSweeperTest, TestMoveMine) {
+  const int kWidth = 10;
+  const int kHeight = 8;
+  // Each move is compared with a mine field that is built from scratch; the
+  // moves include moves between neighboring fields and moves to the border.
+  const int kMoveFromX[] = { 1, 2, 5, 9 };
+  const int kMoveFromY[] = { 1, 1, 5, 7 };
+  const int kMoveToX[] = { 2, 3, 9, 4 };
+  const int kMoveToY[] = { 2, 1, 7, 4 };
+  const int kNumMoves = ARRAYSIZE(kMoveFromX);
+  int mine_x[] = { 1, 2, 5, 6 };
+  int mine_y[] = { 1, 1, 5, 5 };
+  const int kNumMines = ARRAYSIZE(mine_x);
+
+  MineSweeper mine_sweeper(kWidth, kHeight);
+  for (int i = 0; i < kNumMines; ++i) {
+    mine_sweeper.SetMine(mine_x[i], mine_y[i], true);
+  }
+  mine_sweeper.CloseMineField();
+
+  for (int move = 0; move < kNumMoves; ++move) {
+    mine_sweeper.MoveMine(kMoveFromX[move], kMoveFromY[move],
+                          kMoveToX[move], kMoveToY[move]);
+    for (int i = 0; i < kNumMines; ++i) {
+      if (mine_x[i] == kMoveFromX[move] && mine_y[i] == kMoveFromY[move]) {
+        mine_x[i] = kMoveToX[move];
+        mine_y[i] = kMoveToY[move];
+      }
+    }
+    MineSweeper expected(kWidth, kHeight);
+    for (int i = 0; i < kNumMines; ++i) {
+      expected.SetMine(mine_x[i], mine_y[i], true);
+    }
+    expected.CloseMineField();
+
+    EXPECT_EQ(kNumMines, mine_sweeper.NumberOfMines());
+    string counts;
+    string expected_counts;
+    mine_sweeper.PrintMineCountsToString(&counts);
+    expected.PrintMineCountsToString(&expected_counts);
+    EXPECT_EQ(expected_counts, counts) << "Move " << move;
+    EXPECT_EQ(expected.NumberOfEmptyFields(),
+              mine_sweeper.NumberOfEmptyFields());
+  }
+}
+
+TEST(MineSweeperTest, TestToggleMine) {
+  const int kWidth = 6;
+  const int kHeight = 5;
+  MineSweeper mine_sweeper(kWidth, kHeight);
+  mine_sweeper.SetMine(2, 2, true);
+  mine_sweeper.CloseMineField();
+  EXPECT_EQ(1, mine_sweeper.NumberOfMines());
+  EXPECT_EQ(kWidth * kHeight - 9, mine_sweeper.NumberOfEmptyFields());
+  EXPECT_EQ(1, mine_sweeper.NumberOfMinesAroundField(1, 1));
+
+  const int64 version = mine_sweeper.version();
+  mine_sweeper.ToggleMine(0, 0);
+  EXPECT_NE(version, mine_sweeper.version());
+  EXPECT_TRUE(mine_sweeper.IsMine(0, 0));
+  EXPECT_EQ(2, mine_sweeper.NumberOfMines());
+  EXPECT_EQ(2, mine_sweeper.NumberOfMinesAroundField(1, 1));
+  EXPECT_EQ(1, mine_sweeper.NumberOfMinesAroundField(0, 1));
+  EXPECT_EQ(kWidth * kHeight - 12, mine_sweeper.NumberOfEmptyFields());
+
+  // Removing the mine restores the previous numbers.
+  mine_sweeper.ToggleMine(2, 2);
+  mine_sweeper.SetMine(0, 0, false);
+  EXPECT_EQ(0, mine_sweeper.NumberOfMines());
+  EXPECT_EQ(kWidth * kHeight, mine_sweeper.NumberOfEmptyFields());
+  EXPECT_EQ(0, mine_sweeper.NumberOfMinesAroundField(2, 2));
+  EXPECT_EQ(0, mine_sweeper.NumberOfMinesAroundField(1, 1));
+
+  // Setting the current state of a field is not a change.
+  const int64 unchanged_version = mine_sweeper.version();
+  mine_sweeper.SetMine(3, 3, false);
+  EXPECT_EQ(unchanged_version, mine_sweeper.version());
+}
+
+TEST(MineSweeperTest, TestSparseRepresentation) {
+  const int kWidth = 70;
+  const int kHeight = 45;
+  const int kNumMines = 300;
+  const int kNumToggles = 500;
+  std::mt19937 random(3);
+  MineSweeper dense(kWidth, kHeight);
+  MineSweeper sparse(kWidth, kHeight, MineSweeper::SPARSE);
+  EXPECT_EQ(MineSweeper::DENSE, dense.representation());
+  EXPECT_EQ(MineSweeper::SPARSE, sparse.representation());
+  for (int i = 0; i < kNumMines; ++i) {
+    const int x = random() % kWidth;
+    const int y = random() % kHeight;
+    dense.SetMine(x, y, true);
+    sparse.SetMine(x, y, true);
+  }
+  dense.CloseMineField();
+  sparse.CloseMineField();
+
+  for (int toggle = 0; toggle <= kNumToggles; ++toggle) {
+    if (toggle % 100 == 0) {
+      string dense_counts;
+      string sparse_counts;
+      dense.PrintMineCountsToString(&dense_counts);
+      sparse.PrintMineCountsToString(&sparse_counts);
+      EXPECT_EQ(dense_counts, sparse_counts) << "Toggle " << toggle;
+      EXPECT_EQ(dense.NumberOfMines(), sparse.NumberOfMines());
+      EXPECT_EQ(dense.NumberOfEmptyFields(), sparse.NumberOfEmptyFields());
+    }
+    const int x = random() % kWidth;
+    const int y = random() % kHeight;
+    dense.ToggleMine(x, y);
+    sparse.ToggleMine(x, y);
+  }
+}
+
+TEST(MineSweeperTest, TestWindowRepresentation) {
+  const int kSize = 100;
+  const int kOriginX = 30;
+  const int kOriginY = 40;
+  const int kWidth = 20;
+  const int kHeight = 50;
+  ProceduralMineField mine_field(kSize, kSize, 0.2, 11);
+  MineSweeper window(&mine_field, kOriginX, kOriginY, kWidth, kHeight);
+  EXPECT_EQ(MineSweeper::WINDOW, window.representation());
+  EXPECT_TRUE(window.is_closed());
+  EXPECT_EQ(kWidth, window.width());
+  EXPECT_EQ(kHeight, window.height());
+
+  // The numbers of the fields on the border of the window count also the
+  // mines outside of the window.
+  MineSweeper dense(kWidth, kHeight);
+  int num_mines = 0;
+  for (int x = 0; x < kWidth; ++x) {
+    for (int y = 0; y < kHeight; ++y) {
+      const bool is_mine = mine_field.IsMine(kOriginX + x, kOriginY + y);
+      dense.SetMine(x, y, is_mine);
+      EXPECT_EQ(is_mine, window.IsMine(x, y));
+      EXPECT_EQ(mine_field.NumberOfMinesAroundField(kOriginX + x,
+                                                    kOriginY + y),
+                window.NumberOfMinesAroundField(x, y));
+      if (is_mine) {
+        ++num_mines;
+      }
+    }
+  }
+  dense.CloseMineField();
+  EXPECT_EQ(num_mines, window.NumberOfMines());
+  // The fields inside the window have the same numbers as in a dense mine
+  // field with the same mines.
+  int64 num_empty_fields = 0;
+  for (int x = 1; x < kWidth - 1; ++x) {
+    for (int y = 1; y < kHeight - 1; ++y) {
+      EXPECT_EQ(dense.NumberOfMinesAroundField(x, y),
+                window.NumberOfMinesAroundField(x, y));
+    }
+  }
+  for (int x = 0; x < kWidth; ++x) {
+    for (int y = 0; y < kHeight; ++y) {
+      if (window.NumberOfMinesAroundField(x, y) == 0) {
+        ++num_empty_fields;
+      }
+    }
+  }
+  EXPECT_EQ(num_empty_fields, window.NumberOfEmptyFields());
+
+  EXPECT_TRUE(window.IsOnWindowBorder(0, 5));
+  EXPECT_TRUE(window.IsOnWindowBorder(5, kHeight - 1));
+  EXPECT_FALSE(window.IsOnWindowBorder(1, 1));
+  EXPECT_FALSE(dense.IsOnWindowBorder(0, 0));
+
+  // The window at the corner of the procedural mine field has no fields
+  // outside of it on the top and on the left.
+  MineSweeper corner(&mine_field, 0, 0, kWidth, kHeight);
+  EXPECT_FALSE(corner.IsOnWindowBorder(0, 0));
+  EXPECT_FALSE(corner.IsOnWindowBorder(5, 0));
+  EXPECT_TRUE(corner.IsOnWindowBorder(kWidth - 1, 0));
+  EXPECT_TRUE(corner.IsOnWindowBorder(0, kHeight - 1));
+}
+
+TEST(MineSweeperTest, TestMoveWindow) {
+  const int kSize = 100;
+  ProceduralMineField mine_field(kSize, kSize, 0.2, 11);
+  MineSweeper window(&mine_field, 30, 40, 20, 50);
+  const int64 version = window.version();
+  window.MoveWindow(&mine_field, 0, 70, 25, 30);
+  EXPECT_NE(version, window.version());
+  EXPECT_EQ(25, window.width());
+  EXPECT_EQ(30, window.height());
+
+  // The moved view is the same as a new view of the window.
+  MineSweeper expected(&mine_field, 0, 70, 25, 30);
+  EXPECT_EQ(expected.NumberOfMines(), window.NumberOfMines());
+  EXPECT_EQ(expected.NumberOfEmptyFields(), window.NumberOfEmptyFields());
+  for (int x = 0; x < 25; ++x) {
+    for (int y = 0; y < 30; ++y) {
+      EXPECT_EQ(expected.IsMine(x, y), window.IsMine(x, y));
+      if (!expected.IsMine(x, y)) {
+        EXPECT_EQ(expected.NumberOfMinesAroundField(x, y),
+                  window.NumberOfMinesAroundField(x, y));
+      }
+      EXPECT_EQ(expected.IsOnWindowBorder(x, y),
+                window.IsOnWindowBorder(x, y));
+    }
+  }
+}
+
+TEST(MineSweeperTest, TestLoadHugeMineField) {
+  scoped_ptr<MineSweeper> mine_sweeper(
+      MineSweeper::LoadFromString("1000000 1000000\n2\n5 7\n999999 0\n"));
+  ASSERT_TRUE(mine_sweeper.get() != NULL);
+  EXPECT_EQ(MineSweeper::SPARSE, mine_sweeper->representation());
+  EXPECT_EQ(2, mine_sweeper->NumberOfMines());
+  EXPECT_TRUE(mine_sweeper->IsMine(5, 7));
+  EXPECT_EQ(1, mine_sweeper->NumberOfMinesAroundField(999998, 1));
+  EXPECT_EQ(1000000LL * 1000000 - 13, mine_sweeper->NumberOfEmptyFields());
+
+  scoped_ptr<MineSweeper> small_mine_sweeper(
+      MineSweeper::LoadFromString("30 16\n1\n5 7\n"));
+  ASSERT_TRUE(small_mine_sweeper.get() != NULL);
+  EXPECT_EQ(MineSweeper::DENSE, small_mine_sweeper->representation());
+}
+
+TEST(MineSweeperTest, TestLoadObservedFromString) {
+  static const char kTestInput[] =
+      "4 3 2\n"
+      "01*.\n"
+      " 12.\r\n"
+      "....\n";
+  scoped_ptr<MineSweeper> mine_sweeper(
+      MineSweeper::LoadObservedFromString(kTestInput));
+  ASSERT_TRUE(mine_sweeper.get() != NULL);
+  EXPECT_EQ(MineSweeper::OBSERVED, mine_sweeper->representation());
+  EXPECT_TRUE(mine_sweeper->is_closed());
+  EXPECT_EQ(4, mine_sweeper->width());
+  EXPECT_EQ(3, mine_sweeper->height());
+  EXPECT_EQ(2, mine_sweeper->NumberOfMines());
+  EXPECT_TRUE(mine_sweeper->IsKnown(0, 0));
+  EXPECT_TRUE(mine_sweeper->IsKnown(2, 0));
+  EXPECT_FALSE(mine_sweeper->IsKnown(3, 0));
+  EXPECT_FALSE(mine_sweeper->IsKnown(0, 2));
+  EXPECT_TRUE(mine_sweeper->IsMine(2, 0));
+  EXPECT_FALSE(mine_sweeper->IsMine(1, 0));
+  EXPECT_EQ(0, mine_sweeper->NumberOfMinesAroundField(0, 1));
+  EXPECT_EQ(1, mine_sweeper->NumberOfMinesAroundField(1, 0));
+  EXPECT_EQ(2, mine_sweeper->NumberOfMinesAroundField(2, 1));
+
+  const int64 version = mine_sweeper->version();
+  mine_sweeper->ObserveField(3, 0, MineSweeper::kMineInField);
+  mine_sweeper->ObserveField(0, 2, 1);
+  EXPECT_EQ(version + 2, mine_sweeper->version());
+  EXPECT_TRUE(mine_sweeper->IsKnown(3, 0));
+  EXPECT_TRUE(mine_sweeper->IsMine(3, 0));
+  EXPECT_TRUE(mine_sweeper->IsKnown(0, 2));
+  EXPECT_EQ(1, mine_sweeper->NumberOfMinesAroundField(0, 2));
+  EXPECT_FALSE(mine_sweeper->IsKnown(1, 2));
+}
+
+TEST(MineSweeperTest, TestLoadInvalidObservedFromString) {
+  static const char* const kInvalidInputs[] = {
+    // Missing number of mines.
+    "2 2\n..\n..\n",
+    // Missing row.
+    "2 2 1\n..\n",
+    // Row too short.
+    "2 2 1\n..\n.\n",
+    // Invalid character.
+    "2 2 1\n..\n.9\n",
+    // More flags than mines.
+    "2 2 1\n**\n..\n",
+  };
+  for (int i = 0; i < ARRAYSIZE(kInvalidInputs); ++i) {
+    scoped_ptr<MineSweeper> mine_sweeper(
+        MineSweeper::LoadObservedFromString(kInvalidInputs[i]));
+    EXPECT_TRUE(mine_sweeper.get() == NULL) << kInvalidInputs[i];
+  }
+}
+
 }  // namespace mineseeker
@@ -0,0 +1,75 @@
+// Copyright 2012 Ondrej Sykora
+//
+// This file is part of MineSeeker.
+//
+// MineSeeker is free software: you can redistribute it and/or modify it under
+// the terms of the GNU General Public License as published by the Free
+// Software Foundation, either version 3 of the License, or (at your option)
+// any later version.
+//
+// MineSeeker is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+// more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// MineSeeker. If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef MINESEEKER_PAIR_DEDUCTIONS_H_
+#define MINESEEKER_PAIR_DEDUCTIONS_H_
+
+namespace mineseeker {
+
+// The layout of the precomputed deduction table for pairs of adjacent
+// uncovered fields. The table itself is generated at build time by
+// generate_deduction_tables and stored in pair_deduction_table.h.
+//
+// The neighborhoods of two adjacent fields form a window of 4x3 fields, with
+// the pair in the middle of the window:
+//
+//   0 1 2 3
+//   4 A B 5
+//   6 7 8 9
+//
+// The window is described by the mask of its hidden fields (the bit i is set
+// if the field i is hidden) and by the remaining numbers of mines around A and
+// B, i.e. the numbers of mines around the fields minus the mines that are
+// already marked. The entry of the table for such a window contains the mask
+// of the fields that must contain a mine in the lower kNumPairWindowFields
+// bits, and the mask of the fields that must be safe starting at the bit
+// kPairSafeShift. Vertical pairs use the same table with the window
+// transposed.
+
+// The size of the window along the pair and across the pair.
+const int kPairWindowLength = 4;
+const int kPairWindowWidth = 3;
+// The number of fields of the window other than the pair.
+const int kNumPairWindowFields = 10;
+// The coordinates of the fields of the window, in the order of their bits.
+// The first coordinate goes along the pair, and the second one across it; A is
+// at (1, 1) and B is at (2, 1).
+constexpr int kPairWindowFieldAlong[kNumPairWindowFields] =
+    { 0, 1, 2, 3, 0, 3, 0, 1, 2, 3 };
+constexpr int kPairWindowFieldAcross[kNumPairWindowFields] =
+    { 0, 0, 0, 0, 1, 1, 2, 2, 2, 2 };
+
+// The maximal remaining number of mines around one field of the pair; each of
+// them has seven neighbors in the window.
+const int kMaxPairRemainingMines = 7;
+// The position of the mask of safe fields in the entries of the table.
+const int kPairSafeShift = 16;
+// The number of entries of the table.
+const int kNumPairDeductions = (1 << kNumPairWindowFields)
+    * (kMaxPairRemainingMines + 1) * (kMaxPairRemainingMines + 1);
+
+// Returns the index of the entry for the given window in the table.
+inline int PairDeductionIndex(int hidden_fields,
+                              int remaining_mines_a,
+                              int remaining_mines_b) {
+  return (hidden_fields * (kMaxPairRemainingMines + 1) + remaining_mines_a)
+      * (kMaxPairRemainingMines + 1) + remaining_mines_b;
+}
+
+}  // namespace mineseeker
+
+#endif  // MINESEEKER_PAIR_DEDUCTIONS_H_
@@ -0,0 +1,84 @@
+// Copyright 2012 Ondrej Sykora
+//
+// This file is part of MineSeeker.
+//
+// MineSeeker is free software: you can redistribute it and/or modify it under
+// the terms of the GNU General Public License as published by the Free
+// Software Foundation, either version 3 of the License, or (at your option)
+// any later version.
+//
+// MineSeeker is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+// more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// MineSeeker. If not, see <http://www.gnu.org/licenses/>.
+
+#include "common.h"
+#include "glog/logging.h"
+#include "gtest/gtest.h"
+#include "pair_deduction_table.h"
+#include "pair_deductions.h"
+
+namespace mineseeker {
+
+namespace {
+// The mask of the fields 0-3 of the window, i.e. the row along the pair.
+const int kTopRow = 0xf;
+const int kAllFields = (1 << kNumPairWindowFields) - 1;
+
+int Mines(int entry) {
+  return entry & kAllFields;
+}
+
+int Safe(int entry) {
+  return (entry >> kPairSafeShift) & kAllFields;
+}
+}  // namespace
+
+TEST(PairDeductionsTest, TestIndex) {
+  EXPECT_EQ(0, PairDeductionIndex(0, 0, 0));
+  EXPECT_EQ(kNumPairDeductions - 1,
+            PairDeductionIndex(kAllFields, kMaxPairRemainingMines,
+                               kMaxPairRemainingMines));
+  EXPECT_EQ(1, PairDeductionIndex(0, 0, 1));
+  EXPECT_EQ(kMaxPairRemainingMines + 1, PairDeductionIndex(0, 1, 0));
+}
+
+// Checks that the deductions are only made for hidden fields, and that no
+// field is both a mine and safe.
+TEST(PairDeductionsTest, TestTableIsConsistent) {
+  for (int hidden = 0; hidden <= kAllFields; ++hidden) {
+    for (int mines_a = 0; mines_a <= kMaxPairRemainingMines; ++mines_a) {
+      for (int mines_b = 0; mines_b <= kMaxPairRemainingMines; ++mines_b) {
+        const int entry =
+            kPairDeductions[PairDeductionIndex(hidden, mines_a, mines_b)];
+        EXPECT_EQ(0, Mines(entry) & ~hidden);
+        EXPECT_EQ(0, Safe(entry) & ~hidden);
+        EXPECT_EQ(0, Mines(entry) & Safe(entry));
+      }
+    }
+  }
+}
+
+TEST(PairDeductionsTest, TestPatterns) {
+  // 1-1 along a wall: nothing can be deduced.
+  EXPECT_EQ(0, kPairDeductions[PairDeductionIndex(kTopRow, 1, 1)]);
+
+  // 1-2 along a wall: the field next to the two is a mine, the field next to
+  // the one is safe.
+  const int one_two = kPairDeductions[PairDeductionIndex(kTopRow, 1, 2)];
+  EXPECT_EQ(1 << 3, Mines(one_two));
+  EXPECT_EQ(1 << 0, Safe(one_two));
+
+  // A zero makes all its hidden neighbors safe.
+  const int zero_one = kPairDeductions[PairDeductionIndex(kTopRow, 0, 1)];
+  EXPECT_EQ(1 << 3, Mines(zero_one));
+  EXPECT_EQ((1 << 0) | (1 << 1) | (1 << 2), Safe(zero_one));
+
+  // The numbers are inconsistent with the hidden fields.
+  EXPECT_EQ(0, kPairDeductions[PairDeductionIndex(kTopRow, 4, 1)]);
+}
+
+}  // namespace mineseeker
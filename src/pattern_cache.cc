@@ -0,0 +1,332 @@
+// Copyright 2012 Ondrej Sykora
+//
+// This file is part of MineSeeker.
+//
+// MineSeeker is free software: you can redistribute it and/or modify it under
+// the terms of the GNU General Public License as published by the Free
+// Software Foundation, either version 3 of the License, or (at your option)
+// any later version.
+//
+// MineSeeker is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+// more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// MineSeeker. If not, see <http://www.gnu.org/licenses/>.
+
+#include "pattern_cache.h"
+
+#include <algorithm>
+
+#include "board_geometry.h"
+#include "glog/logging.h"
+
+namespace mineseeker {
+
+const int PatternCache::kWindowSize;
+const int PatternCache::kNumCells;
+const int PatternCache::kSafeCell;
+const int PatternCache::kHiddenCell;
+const int PatternCache::kMineCell;
+const int PatternCache::kDefaultMaxEntries = 1 << 16;
+const int PatternCache::kNumShards;
+
+namespace {
+// The number of symmetries of the window (rotations and reflections).
+const int kNumSymmetries = 8;
+// The number of bits used by a single cell in the key.
+const int kBitsPerCell = 4;
+// The number of cells stored in the lower word of the key.
+const int kCellsInLowWord = 64 / kBitsPerCell;
+
+// The positions of the cells after applying a symmetry: the cell with index
+// i = dy * 5 + dx moves to kSymmetricCell[symmetry][i]. Bit 0 of the symmetry
+// flips the window horizontally, bit 1 flips it vertically and bit 2
+// transposes it.
+class SymmetryTable {
+ public:
+  SymmetryTable() {
+    const int size = PatternCache::kWindowSize;
+    for (int symmetry = 0; symmetry < kNumSymmetries; ++symmetry) {
+      for (int y = 0; y < size; ++y) {
+        for (int x = 0; x < size; ++x) {
+          int new_x = (symmetry & 1) ? size - 1 - x : x;
+          int new_y = (symmetry & 2) ? size - 1 - y : y;
+          if (symmetry & 4) {
+            std::swap(new_x, new_y);
+          }
+          cells_[symmetry][y * size + x] = new_y * size + new_x;
+        }
+      }
+    }
+  }
+
+  int cell(int symmetry, int index) const { return cells_[symmetry][index]; }
+
+ private:
+  int cells_[kNumSymmetries][PatternCache::kNumCells];
+};
+
+const SymmetryTable& GetSymmetryTable() {
+  static const SymmetryTable table;
+  return table;
+}
+
+// A backtracking search for all assignments of mines to the hidden cells of a
+// window that satisfy the numbers of the inner cells.
+class DeductionSearch {
+ public:
+  explicit DeductionSearch(const int cells[PatternCache::kNumCells])
+      : num_variables_(0),
+        num_constraints_(0),
+        variable_mask_(0),
+        always_mines_(~0),
+        sometimes_mines_(0),
+        found_solution_(false),
+        consistent_(true) {
+    const int size = PatternCache::kWindowSize;
+    for (int y = 1; y < size - 1; ++y) {
+      for (int x = 1; x < size - 1; ++x) {
+        const int number = cells[y * size + x];
+        if (number >= PatternCache::kSafeCell) {
+          continue;
+        }
+        Constraint* const constraint = &constraints_[num_constraints_++];
+        constraint->remaining_mines = number;
+        constraint->remaining_hidden = 0;
+        for (int bit = 0; bit < kNumNeighbors; ++bit) {
+          const int index = (y + kNeighborOffsetY[bit]) * size
+              + x + kNeighborOffsetX[bit];
+          if (cells[index] == PatternCache::kMineCell) {
+            --constraint->remaining_mines;
+          } else if (cells[index] == PatternCache::kHiddenCell) {
+            ++constraint->remaining_hidden;
+            variable_mask_ |= 1 << index;
+          }
+        }
+        if (constraint->remaining_mines < 0
+            || constraint->remaining_mines > constraint->remaining_hidden) {
+          consistent_ = false;
+        }
+      }
+    }
+    for (int index = 0; index < PatternCache::kNumCells; ++index) {
+      if (variable_mask_ & (1 << index)) {
+        Variable* const variable = &variables_[num_variables_++];
+        variable->cell = index;
+        variable->num_constraints = 0;
+      }
+    }
+    // Link the variables to the constraints that contain them.
+    int constraint_index = 0;
+    for (int y = 1; y < size - 1; ++y) {
+      for (int x = 1; x < size - 1; ++x) {
+        if (cells[y * size + x] >= PatternCache::kSafeCell) {
+          continue;
+        }
+        for (int i = 0; i < num_variables_; ++i) {
+          const int dx = variables_[i].cell % size - x;
+          const int dy = variables_[i].cell / size - y;
+          if (dx >= -1 && dx <= 1 && dy >= -1 && dy <= 1) {
+            Variable* const variable = &variables_[i];
+            variable->constraints[variable->num_constraints++] =
+                constraint_index;
+          }
+        }
+        ++constraint_index;
+      }
+    }
+    DCHECK_EQ(num_constraints_, constraint_index);
+  }
+
+  PatternCache::Deductions Run() {
+    PatternCache::Deductions deductions;
+    if (!consistent_ || num_variables_ == 0) {
+      return deductions;
+    }
+    Search(0, 0);
+    if (found_solution_) {
+      deductions.mines = always_mines_ & variable_mask_;
+      deductions.safe = variable_mask_ & ~sometimes_mines_;
+    }
+    return deductions;
+  }
+
+ private:
+  struct Constraint {
+    int remaining_mines;
+    int remaining_hidden;
+  };
+  struct Variable {
+    int cell;
+    int num_constraints;
+    // A cell is a neighbor of at most nine inner cells.
+    int constraints[9];
+  };
+
+  // Returns true if the search can stop, because nothing can be deduced.
+  bool NothingToDeduce() const {
+    return found_solution_ && (always_mines_ & variable_mask_) == 0
+        && sometimes_mines_ == variable_mask_;
+  }
+
+  // Assigns the variables starting with 'variable'; 'mines' is the mask of
+  // mines assigned to the previous variables.
+  void Search(int variable, int mines) {
+    if (variable == num_variables_) {
+      found_solution_ = true;
+      always_mines_ &= mines;
+      sometimes_mines_ |= mines;
+      return;
+    }
+    const Variable& current = variables_[variable];
+    for (int has_mine = 0; has_mine <= 1 && !NothingToDeduce(); ++has_mine) {
+      bool feasible = true;
+      for (int i = 0; i < current.num_constraints; ++i) {
+        Constraint* const constraint = &constraints_[current.constraints[i]];
+        --constraint->remaining_hidden;
+        constraint->remaining_mines -= has_mine;
+        feasible &= constraint->remaining_mines >= 0
+            && constraint->remaining_mines <= constraint->remaining_hidden;
+      }
+      if (feasible) {
+        Search(variable + 1, mines | (has_mine << current.cell));
+      }
+      for (int i = 0; i < current.num_constraints; ++i) {
+        Constraint* const constraint = &constraints_[current.constraints[i]];
+        ++constraint->remaining_hidden;
+        constraint->remaining_mines += has_mine;
+      }
+    }
+  }
+
+  int num_variables_;
+  Variable variables_[PatternCache::kNumCells];
+  int num_constraints_;
+  Constraint constraints_[9];
+  int variable_mask_;
+  int always_mines_;
+  int sometimes_mines_;
+  bool found_solution_;
+  bool consistent_;
+};
+
+// Mixes the bits of a 64-bit value (the finalizer of MurmurHash3).
+uint64 MixBits(uint64 value) {
+  value ^= value >> 33;
+  value *= 0xff51afd7ed558ccdULL;
+  value ^= value >> 33;
+  value *= 0xc4ceb9fe1a85ec53ULL;
+  value ^= value >> 33;
+  return value;
+}
+}  // namespace
+
+size_t PatternCache::WindowKeyHash::operator()(const WindowKey& key) const {
+  return MixBits(key.low ^ MixBits(key.high));
+}
+
+PatternCache::PatternCache(int max_entries)
+    : max_entries_per_shard_(std::max(1, max_entries / kNumShards)),
+      num_hits_(0),
+      num_misses_(0) {
+  CHECK_GT(max_entries, 0);
+}
+
+PatternCache::Deductions PatternCache::Lookup(const int cells[kNumCells]) {
+  // The canonical form of the window is the one with the smallest key.
+  int canonical_symmetry = 0;
+  WindowKey key = MakeKey(cells, 0);
+  for (int symmetry = 1; symmetry < kNumSymmetries; ++symmetry) {
+    const WindowKey symmetric_key = MakeKey(cells, symmetry);
+    if (symmetric_key < key) {
+      key = symmetric_key;
+      canonical_symmetry = symmetry;
+    }
+  }
+
+  Shard* const shard = &shards_[WindowKeyHash()(key) % kNumShards];
+  Deductions canonical_deductions;
+  bool found = false;
+  {
+    std::lock_guard<std::mutex> lock(shard->mutex);
+    const std::unordered_map<WindowKey, Deductions, WindowKeyHash>
+        ::const_iterator it = shard->entries.find(key);
+    if (it != shard->entries.end()) {
+      canonical_deductions = it->second;
+      found = true;
+    }
+  }
+  if (found) {
+    ++num_hits_;
+  } else {
+    ++num_misses_;
+    // The deductions are computed outside of the lock; two threads may compute
+    // the same window, but they store the same result.
+    const SymmetryTable& symmetries = GetSymmetryTable();
+    int canonical_cells[kNumCells];
+    for (int i = 0; i < kNumCells; ++i) {
+      canonical_cells[symmetries.cell(canonical_symmetry, i)] = cells[i];
+    }
+    canonical_deductions = ComputeDeductions(canonical_cells);
+    std::lock_guard<std::mutex> lock(shard->mutex);
+    if (shard->entries.size() >= max_entries_per_shard_) {
+      shard->entries.clear();
+    }
+    shard->entries[key] = canonical_deductions;
+  }
+
+  Deductions deductions;
+  deductions.mines = FromSymmetry(canonical_deductions.mines,
+                                  canonical_symmetry);
+  deductions.safe = FromSymmetry(canonical_deductions.safe,
+                                 canonical_symmetry);
+  return deductions;
+}
+
+PatternCache::Deductions PatternCache::ComputeDeductions(
+    const int cells[kNumCells]) {
+  DeductionSearch search(cells);
+  return search.Run();
+}
+
+int PatternCache::size() const {
+  int num_entries = 0;
+  for (int i = 0; i < kNumShards; ++i) {
+    std::lock_guard<std::mutex> lock(shards_[i].mutex);
+    num_entries += shards_[i].entries.size();
+  }
+  return num_entries;
+}
+
+PatternCache::WindowKey PatternCache::MakeKey(const int cells[kNumCells],
+                                              int symmetry) {
+  const SymmetryTable& symmetries = GetSymmetryTable();
+  WindowKey key;
+  for (int i = 0; i < kNumCells; ++i) {
+    DCHECK_GE(cells[i], 0);
+    DCHECK_LE(cells[i], kMineCell);
+    const int index = symmetries.cell(symmetry, i);
+    const uint64 value = cells[i];
+    if (index < kCellsInLowWord) {
+      key.low |= value << (kBitsPerCell * index);
+    } else {
+      key.high |= value << (kBitsPerCell * (index - kCellsInLowWord));
+    }
+  }
+  return key;
+}
+
+int PatternCache::FromSymmetry(int mask, int symmetry) {
+  const SymmetryTable& symmetries = GetSymmetryTable();
+  int result = 0;
+  for (int i = 0; i < kNumCells; ++i) {
+    if (mask & (1 << symmetries.cell(symmetry, i))) {
+      result |= 1 << i;
+    }
+  }
+  return result;
+}
+
+}  // namespace mineseeker
@@ -0,0 +1,140 @@
+// Copyright 2012 Ondrej Sykora
+//
+// This file is part of MineSeeker.
+//
+// MineSeeker is free software: you can redistribute it and/or modify it under
+// the terms of the GNU General Public License as published by the Free
+// Software Foundation, either version 3 of the License, or (at your option)
+// any later version.
+//
+// MineSeeker is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+// more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// MineSeeker. If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef MINESEEKER_PATTERN_CACHE_H_
+#define MINESEEKER_PATTERN_CACHE_H_
+
+#include <atomic>
+#include <mutex>
+#include <unordered_map>
+
+#include "common.h"
+
+namespace mineseeker {
+
+// A cache of the deductions that can be made from the contents of a 5x5
+// window of the board. The window is described by the contents of its cells:
+// the numbers of the uncovered fields in the inner 3x3 part of the window,
+// the hidden fields and the fields marked as mines; all other fields (the
+// uncovered fields on the border of the window and the fields outside of the
+// board) are known to be safe and carry no constraint. The cells are indexed
+// by dy * 5 + dx, where (dx, dy) are the coordinates relative to the top-left
+// corner of the window, the same way as in MineSeeker::HiddenNeighborMask.
+//
+// The deductions are the hidden cells that contain a mine, and the hidden
+// cells that are safe, in all assignments of mines to the hidden cells that
+// satisfy the numbers of the inner cells. The deductions do not depend on the
+// rest of the board, so they are valid in any position where the window
+// appears. The windows that differ only by a rotation or a reflection share a
+// single entry of the cache.
+//
+// The cache is bounded; when a shard of the cache is full, it is cleared. All
+// methods are thread-safe.
+//
+// Typical usage:
+// PatternCache cache(PatternCache::kDefaultMaxEntries);
+// int cells[PatternCache::kNumCells];
+// ... fill the cells ...
+// const PatternCache::Deductions deductions = cache.Lookup(cells);
+class PatternCache {
+ public:
+  // The width and the height of the window, and the number of its cells.
+  static const int kWindowSize = 5;
+  static const int kNumCells = kWindowSize * kWindowSize;
+  // The values of the cells other than the numbers 0-8 of the uncovered inner
+  // cells.
+  static const int kSafeCell = 9;
+  static const int kHiddenCell = 10;
+  static const int kMineCell = 11;
+  // The default maximal number of entries of the cache.
+  static const int kDefaultMaxEntries;
+
+  // The deductions made for a window; the bit dy * 5 + dx of each mask
+  // corresponds to the cell (dx, dy) of the window.
+  struct Deductions {
+    Deductions() : mines(0), safe(0) {}
+
+    // The hidden cells that contain a mine.
+    int mines;
+    // The hidden cells that do not contain a mine.
+    int safe;
+  };
+
+  // Creates a cache with at most max_entries entries.
+  explicit PatternCache(int max_entries);
+
+  // Returns the deductions for the window with the given cells. Computes the
+  // deductions and stores them in the cache if the window (or one of its
+  // rotations and reflections) is not in the cache yet.
+  Deductions Lookup(const int cells[kNumCells]);
+
+  // Computes the deductions for the window without the cache. If the numbers
+  // in the window are inconsistent, no deductions are made.
+  static Deductions ComputeDeductions(const int cells[kNumCells]);
+
+  // Returns the number of lookups that were answered from the cache, and the
+  // number of lookups that had to compute the deductions.
+  int64 num_hits() const { return num_hits_.load(); }
+  int64 num_misses() const { return num_misses_.load(); }
+  // Returns the number of entries in the cache.
+  int size() const;
+
+ private:
+  // The number of shards of the cache.
+  static const int kNumShards = 16;
+
+  // The contents of a window packed to four bits per cell.
+  struct WindowKey {
+    WindowKey() : low(0), high(0) {}
+
+    bool operator==(const WindowKey& other) const {
+      return low == other.low && high == other.high;
+    }
+    bool operator<(const WindowKey& other) const {
+      return high < other.high || (high == other.high && low < other.low);
+    }
+
+    uint64 low;
+    uint64 high;
+  };
+  struct WindowKeyHash {
+    size_t operator()(const WindowKey& key) const;
+  };
+
+  struct Shard {
+    std::mutex mutex;
+    std::unordered_map<WindowKey, Deductions, WindowKeyHash> entries;
+  };
+
+  // Returns the key of the window after applying the given symmetry to it.
+  static WindowKey MakeKey(const int cells[kNumCells], int symmetry);
+  // Maps a mask of deductions in the orientation obtained by the symmetry back
+  // to the original orientation of the window.
+  static int FromSymmetry(int mask, int symmetry);
+
+  const int max_entries_per_shard_;
+  std::atomic<int64> num_hits_;
+  std::atomic<int64> num_misses_;
+  mutable Shard shards_[kNumShards];
+
+  PatternCache(const PatternCache&);
+  void operator=(const PatternCache&);
+};
+
+}  // namespace mineseeker
+
+#endif  // MINESEEKER_PATTERN_CACHE_H_
@@ -0,0 +1,188 @@
+// Copyright 2012 Ondrej Sykora
+//
+// This file is part of MineSeeker.
+//
+// MineSeeker is free software: you can redistribute it and/or modify it under
+// the terms of the GNU General Public License as published by the Free
+// Software Foundation, either version 3 of the License, or (at your option)
+// any later version.
+//
+// MineSeeker is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+// more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// MineSeeker. If not, see <http://www.gnu.org/licenses/>.
+
+#include "common.h"
+#include "glog/logging.h"
+#include "gtest/gtest.h"
+#include "pattern_cache.h"
+#include "thread_pool.h"
+
+namespace mineseeker {
+
+namespace {
+const int H = PatternCache::kHiddenCell;
+const int M = PatternCache::kMineCell;
+const int S = PatternCache::kSafeCell;
+
+// Returns the mask of the cell (x, y) of the window.
+int CellBit(int x, int y) {
+  return 1 << (y * PatternCache::kWindowSize + x);
+}
+
+// Copies the window to 'cells', flipped horizontally.
+void FlipWindow(const int window[PatternCache::kNumCells],
+                int cells[PatternCache::kNumCells]) {
+  const int size = PatternCache::kWindowSize;
+  for (int y = 0; y < size; ++y) {
+    for (int x = 0; x < size; ++x) {
+      cells[y * size + size - 1 - x] = window[y * size + x];
+    }
+  }
+}
+}  // namespace
+
+// The 1-2-1 pattern along a wall: the fields below the ones are mines, the
+// field below the two is safe.
+TEST(PatternCacheTest, TestComputeDeductions) {
+  const int kWindow[] = { S, S, S, S, S,
+                          S, 1, 2, 1, S,
+                          S, H, H, H, S,
+                          S, S, S, S, S,
+                          S, S, S, S, S };
+  const PatternCache::Deductions deductions =
+      PatternCache::ComputeDeductions(kWindow);
+  EXPECT_EQ(CellBit(1, 2) | CellBit(3, 2), deductions.mines);
+  EXPECT_EQ(CellBit(2, 2), deductions.safe);
+}
+
+TEST(PatternCacheTest, TestMarkedMines) {
+  // The one is already satisfied by the marked mine, so the other hidden
+  // neighbors are safe.
+  const int kWindow[] = { H, H, H, S, S,
+                          H, 1, M, S, S,
+                          H, H, H, S, S,
+                          S, S, S, S, S,
+                          S, S, S, S, S };
+  const PatternCache::Deductions deductions =
+      PatternCache::ComputeDeductions(kWindow);
+  EXPECT_EQ(0, deductions.mines);
+  EXPECT_EQ(CellBit(0, 0) | CellBit(1, 0) | CellBit(2, 0) | CellBit(0, 1)
+            | CellBit(0, 2) | CellBit(1, 2) | CellBit(2, 2),
+            deductions.safe);
+}
+
+TEST(PatternCacheTest, TestNoDeductions) {
+  // A single one with two hidden neighbors; nothing can be deduced.
+  const int kWindow[] = { S, S, S, S, S,
+                          S, H, H, S, S,
+                          S, 1, S, S, S,
+                          S, S, S, S, S,
+                          S, S, S, S, S };
+  const PatternCache::Deductions deductions =
+      PatternCache::ComputeDeductions(kWindow);
+  EXPECT_EQ(0, deductions.mines);
+  EXPECT_EQ(0, deductions.safe);
+
+  // The numbers are inconsistent.
+  const int kInconsistentWindow[] = { S, S, S, S, S,
+                                      S, 2, H, S, S,
+                                      S, S, S, S, S,
+                                      S, S, S, S, S,
+                                      S, S, S, S, S };
+  const PatternCache::Deductions inconsistent_deductions =
+      PatternCache::ComputeDeductions(kInconsistentWindow);
+  EXPECT_EQ(0, inconsistent_deductions.mines);
+  EXPECT_EQ(0, inconsistent_deductions.safe);
+}
+
+TEST(PatternCacheTest, TestLookupWithSymmetry) {
+  const int kWindow[] = { S, S, S, S, S,
+                          S, 1, 1, S, S,
+                          S, H, H, H, S,
+                          S, S, S, S, S,
+                          S, S, S, S, S };
+  PatternCache cache(100);
+  const PatternCache::Deductions deductions = cache.Lookup(kWindow);
+  EXPECT_EQ(CellBit(3, 2), deductions.safe);
+  EXPECT_EQ(0, deductions.mines);
+  EXPECT_EQ(0, cache.num_hits());
+  EXPECT_EQ(1, cache.num_misses());
+
+  // The flipped window hits the same entry, and the deductions are flipped
+  // back.
+  int flipped[PatternCache::kNumCells];
+  FlipWindow(kWindow, flipped);
+  const PatternCache::Deductions flipped_deductions = cache.Lookup(flipped);
+  EXPECT_EQ(CellBit(1, 2), flipped_deductions.safe);
+  EXPECT_EQ(0, flipped_deductions.mines);
+  EXPECT_EQ(1, cache.num_hits());
+  EXPECT_EQ(1, cache.num_misses());
+  EXPECT_EQ(1, cache.size());
+}
+
+TEST(PatternCacheTest, TestBoundedSize) {
+  PatternCache cache(16);
+  int cells[PatternCache::kNumCells];
+  for (int i = 0; i < PatternCache::kNumCells; ++i) {
+    cells[i] = S;
+  }
+  for (int number = 0; number <= 8; ++number) {
+    for (int i = 0; i < PatternCache::kNumCells; ++i) {
+      cells[i] = (i % 3 == 0) ? H : S;
+      cells[12] = number;
+      cache.Lookup(cells);
+      EXPECT_LE(cache.size(), 16);
+    }
+  }
+}
+
+namespace {
+// Looks up one of a few windows and checks the deductions.
+class LookupTask : public ThreadPool::Task {
+ public:
+  explicit LookupTask(PatternCache* cache) : cache_(cache), failures_(0) {}
+
+  virtual void Run(int item) {
+    int cells[PatternCache::kNumCells];
+    for (int i = 0; i < PatternCache::kNumCells; ++i) {
+      cells[i] = S;
+    }
+    // A number in the center with 'number' hidden neighbors: all of them are
+    // mines.
+    const int number = 1 + item % 8;
+    const int kNeighbors[] = { 6, 7, 8, 11, 13, 16, 17, 18 };
+    int expected_mines = 0;
+    cells[12] = number;
+    for (int i = 0; i < number; ++i) {
+      cells[kNeighbors[i]] = H;
+      expected_mines |= 1 << kNeighbors[i];
+    }
+    if (cache_->Lookup(cells).mines != expected_mines) {
+      ++failures_;
+    }
+  }
+
+  int failures() const { return failures_.load(); }
+
+ private:
+  PatternCache* const cache_;
+  std::atomic<int> failures_;
+};
+}  // namespace
+
+TEST(PatternCacheTest, TestConcurrentLookup) {
+  const int kNumLookups = 10000;
+  PatternCache cache(PatternCache::kDefaultMaxEntries);
+  ThreadPool thread_pool(4);
+  LookupTask task(&cache);
+  thread_pool.ParallelFor(kNumLookups, &task);
+  EXPECT_EQ(0, task.failures());
+  EXPECT_EQ(kNumLookups, cache.num_hits() + cache.num_misses());
+  EXPECT_LE(cache.size(), 8);
+}
+
+}  // namespace mineseeker
@@ -0,0 +1,165 @@
+// Copyright 2012 Ondrej Sykora
+//
+// This file is part of MineSeeker.
+//
+// MineSeeker is free software: you can redistribute it and/or modify it under
+// the terms of the GNU General Public License as published by the Free
+// Software Foundation, either version 3 of the License, or (at your option)
+// any later version.
+//
+// MineSeeker is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+// more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// MineSeeker. If not, see <http://www.gnu.org/licenses/>.
+
+#include "perf_counters.h"
+
+#include <linux/perf_event.h>
+#include <string.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include "glog/logging.h"
+
+namespace mineseeker {
+
+namespace {
+// Opens a single counter of the calling thread. Returns the file descriptor of
+// the counter, or -1 if the counter could not be opened.
+int OpenCounter(uint32_t type, uint64 config) {
+  struct perf_event_attr attributes;
+  memset(&attributes, 0, sizeof(attributes));
+  attributes.size = sizeof(attributes);
+  attributes.type = type;
+  attributes.config = config;
+  attributes.read_format =
+      PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+  attributes.exclude_kernel = 1;
+  attributes.exclude_hv = 1;
+  // Measure the calling thread on any CPU.
+  return syscall(__NR_perf_event_open, &attributes, 0, -1, -1, 0);
+}
+
+// Returns the type and the configuration of the perf event for the counter.
+void GetCounterEvent(int counter, uint32_t* type, uint64* config) {
+  switch (counter) {
+    case PerfCounterValues::CYCLES:
+      *type = PERF_TYPE_HARDWARE;
+      *config = PERF_COUNT_HW_CPU_CYCLES;
+      break;
+    case PerfCounterValues::INSTRUCTIONS:
+      *type = PERF_TYPE_HARDWARE;
+      *config = PERF_COUNT_HW_INSTRUCTIONS;
+      break;
+    case PerfCounterValues::L1D_READ_MISSES:
+      *type = PERF_TYPE_HW_CACHE;
+      *config = PERF_COUNT_HW_CACHE_L1D
+          | (PERF_COUNT_HW_CACHE_OP_READ << 8)
+          | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+      break;
+    case PerfCounterValues::LLC_MISSES:
+      *type = PERF_TYPE_HARDWARE;
+      *config = PERF_COUNT_HW_CACHE_MISSES;
+      break;
+    case PerfCounterValues::BRANCH_MISSES:
+      *type = PERF_TYPE_HARDWARE;
+      *config = PERF_COUNT_HW_BRANCH_MISSES;
+      break;
+    default:
+      LOG(FATAL) << "Invalid counter: " << counter;
+  }
+}
+}  // namespace
+
+const char* PerfCounterValues::CounterName(int counter) {
+  switch (counter) {
+    case CYCLES:
+      return "cycles";
+    case INSTRUCTIONS:
+      return "instructions";
+    case L1D_READ_MISSES:
+      return "L1d-misses";
+    case LLC_MISSES:
+      return "LLC-misses";
+    case BRANCH_MISSES:
+      return "branch-misses";
+    default:
+      LOG(FATAL) << "Invalid counter: " << counter;
+  }
+  return NULL;
+}
+
+PerfCounters::PerfCounters() {
+  for (int counter = 0; counter < PerfCounterValues::kNumCounters;
+       ++counter) {
+    uint32_t type = 0;
+    uint64 config = 0;
+    GetCounterEvent(counter, &type, &config);
+    file_descriptors_[counter] = OpenCounter(type, config);
+    if (file_descriptors_[counter] < 0) {
+      VLOG(1) << "Counter " << PerfCounterValues::CounterName(counter)
+              << " is not available";
+      file_descriptors_[counter] = -1;
+    }
+  }
+}
+
+PerfCounters::~PerfCounters() {
+  for (int counter = 0; counter < PerfCounterValues::kNumCounters;
+       ++counter) {
+    if (file_descriptors_[counter] >= 0) {
+      close(file_descriptors_[counter]);
+    }
+  }
+}
+
+bool PerfCounters::IsAvailable(int counter) const {
+  CHECK_GE(counter, 0);
+  CHECK_LT(counter, PerfCounterValues::kNumCounters);
+  return file_descriptors_[counter] >= 0;
+}
+
+bool PerfCounters::IsAnyAvailable() const {
+  for (int counter = 0; counter < PerfCounterValues::kNumCounters;
+       ++counter) {
+    if (IsAvailable(counter)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+bool PerfCounters::Read(PerfCounterValues* values) const {
+  CHECK_NOTNULL(values);
+  bool has_values = false;
+  for (int counter = 0; counter < PerfCounterValues::kNumCounters;
+       ++counter) {
+    values->values[counter] = 0;
+    if (file_descriptors_[counter] < 0) {
+      continue;
+    }
+    // The value, the time enabled and the time running.
+    uint64 data[3];
+    if (read(file_descriptors_[counter], data, sizeof(data))
+        != sizeof(data)) {
+      continue;
+    }
+    has_values = true;
+    if (data[2] == 0) {
+      // The counter was never scheduled.
+      continue;
+    }
+    if (data[1] == data[2]) {
+      values->values[counter] = data[0];
+    } else {
+      values->values[counter] = static_cast<int64>(
+          static_cast<double>(data[0]) * data[1] / data[2]);
+    }
+  }
+  return has_values;
+}
+
+}  // namespace mineseeker
@@ -0,0 +1,111 @@
+// Copyright 2012 Ondrej Sykora
+//
+// This file is part of MineSeeker.
+//
+// MineSeeker is free software: you can redistribute it and/or modify it under
+// the terms of the GNU General Public License as published by the Free
+// Software Foundation, either version 3 of the License, or (at your option)
+// any later version.
+//
+// MineSeeker is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+// more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// MineSeeker. If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef MINESEEKER_PERF_COUNTERS_H_
+#define MINESEEKER_PERF_COUNTERS_H_
+
+#include "common.h"
+
+namespace mineseeker {
+
+// Values of the hardware performance counters. The values are either the
+// absolute values of the counters or differences between two readings.
+struct PerfCounterValues {
+  // The counters; the values are used as indices to 'values'.
+  enum Counter {
+    CYCLES,
+    INSTRUCTIONS,
+    L1D_READ_MISSES,
+    LLC_MISSES,
+    BRANCH_MISSES,
+    // The number of counters; not a valid counter.
+    kNumCounters,
+  };
+
+  PerfCounterValues() {
+    for (int i = 0; i < kNumCounters; ++i) {
+      values[i] = 0;
+    }
+  }
+
+  // Adds the values of another reading to this one.
+  void Add(const PerfCounterValues& other) {
+    for (int i = 0; i < kNumCounters; ++i) {
+      values[i] += other.values[i];
+    }
+  }
+  // Subtracts the values of another reading from this one.
+  void Subtract(const PerfCounterValues& other) {
+    for (int i = 0; i < kNumCounters; ++i) {
+      values[i] -= other.values[i];
+    }
+  }
+
+  // Returns a short name of the counter, e.g. "cycles".
+  static const char* CounterName(int counter);
+
+  int64 values[kNumCounters];
+};
+
+// Reads the hardware performance counters of the calling thread through the
+// Linux perf_event_open interface. The counters are opened in the
+// constructor; the counters that could not be opened (because the kernel or the
+// CPU do not support them, or because the process does not have the
+// permission to use them) are not available, and their values are always
+// zero. When the counters are multiplexed by the kernel, the values are
+// scaled by the fraction of time the counter was running.
+//
+// The counters count only the thread that created the object, including the
+// time spent in the kernel on behalf of the thread only if the permissions
+// allow it; work done by other threads (e.g. by the parallel tiled
+// propagation) is not counted.
+//
+// Typical usage:
+// PerfCounters counters;
+// PerfCounterValues start;
+// PerfCounterValues end;
+// counters.Read(&start);
+// ... run the measured code ...
+// counters.Read(&end);
+// end.Subtract(start);
+class PerfCounters {
+ public:
+  PerfCounters();
+  ~PerfCounters();
+
+  // Returns true if the given counter could be opened.
+  bool IsAvailable(int counter) const;
+  // Returns true if at least one counter could be opened.
+  bool IsAnyAvailable() const;
+
+  // Reads the current values of the counters to 'values'. The values of the
+  // counters that are not available are set to zero. Returns false if no
+  // counter is available.
+  bool Read(PerfCounterValues* values) const;
+
+ private:
+  // The file descriptors of the counters; -1 for counters that are not
+  // available.
+  int file_descriptors_[PerfCounterValues::kNumCounters];
+
+  PerfCounters(const PerfCounters&);
+  void operator=(const PerfCounters&);
+};
+
+}  // namespace mineseeker
+
+#endif  // MINESEEKER_PERF_COUNTERS_H_
@@ -0,0 +1,70 @@
+// Copyright 2012 Ondrej Sykora
+//
+// This file is part of MineSeeker.
+//
+// MineSeeker is free software: you can redistribute it and/or modify it under
+// the terms of the GNU General Public License as published by the Free
+// Software Foundation, either version 3 of the License, or (at your option)
+// any later version.
+//
+// MineSeeker is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+// more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// MineSeeker. If not, see <http://www.gnu.org/licenses/>.
+
+#include "common.h"
+#include "glog/logging.h"
+#include "gtest/gtest.h"
+#include "perf_counters.h"
+
+namespace mineseeker {
+
+TEST(PerfCounterValuesTest, TestArithmetic) {
+  PerfCounterValues first;
+  PerfCounterValues second;
+  for (int i = 0; i < PerfCounterValues::kNumCounters; ++i) {
+    EXPECT_EQ(0, first.values[i]);
+    first.values[i] = 10 * i;
+    second.values[i] = i;
+  }
+  first.Subtract(second);
+  for (int i = 0; i < PerfCounterValues::kNumCounters; ++i) {
+    EXPECT_EQ(9 * i, first.values[i]);
+  }
+  first.Add(second);
+  first.Add(second);
+  for (int i = 0; i < PerfCounterValues::kNumCounters; ++i) {
+    EXPECT_EQ(11 * i, first.values[i]);
+  }
+  EXPECT_STREQ("cycles",
+               PerfCounterValues::CounterName(PerfCounterValues::CYCLES));
+}
+
+TEST(PerfCountersTest, TestRead) {
+  PerfCounters counters;
+  PerfCounterValues start;
+  PerfCounterValues end;
+  EXPECT_EQ(counters.IsAnyAvailable(), counters.Read(&start));
+  volatile int64 sum = 0;
+  for (int i = 0; i < 100000; ++i) {
+    sum += i;
+  }
+  EXPECT_EQ(counters.IsAnyAvailable(), counters.Read(&end));
+  end.Subtract(start);
+  for (int i = 0; i < PerfCounterValues::kNumCounters; ++i) {
+    if (counters.IsAvailable(i)) {
+      EXPECT_LE(0, end.values[i]) << PerfCounterValues::CounterName(i);
+    } else {
+      // The counters that are not available always read zero.
+      EXPECT_EQ(0, end.values[i]) << PerfCounterValues::CounterName(i);
+    }
+  }
+  if (counters.IsAvailable(PerfCounterValues::INSTRUCTIONS)) {
+    EXPECT_LT(100000, end.values[PerfCounterValues::INSTRUCTIONS]);
+  }
+}
+
+}  // namespace mineseeker
@@ -0,0 +1,244 @@
+// Copyright 2012 Ondrej Sykora
+//
+// This file is part of MineSeeker.
+//
+// MineSeeker is free software: you can redistribute it and/or modify it under
+// the terms of the GNU General Public License as published by the Free
+// Software Foundation, either version 3 of the License, or (at your option)
+// any later version.
+//
+// MineSeeker is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+// more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// MineSeeker. If not, see <http://www.gnu.org/licenses/>.
+
+#include "probing.h"
+
+#include <utility>
+
+#include "glog/logging.h"
+#include "thread_pool.h"
+
+namespace mineseeker {
+
+// The propagation state of a single probe. For each variable, it keeps the
+// value assigned to the variable; for each constraint, the number of mines
+// that still need to be placed and the number of variables that are not
+// assigned yet. The state is copied for each probe.
+class FailedLiteralProber::State {
+ public:
+  explicit State(const Frontier& frontier)
+      : frontier_(&frontier),
+        values_(frontier.num_variables(), UNKNOWN),
+        remaining_mines_(frontier.num_constraints(), 0),
+        unassigned_variables_(frontier.num_constraints(), 0) {
+    for (int i = 0; i < frontier.num_constraints(); ++i) {
+      remaining_mines_[i] = frontier.constraint(i).num_mines;
+      unassigned_variables_[i] = frontier.constraint(i).num_variables;
+    }
+  }
+
+  Value value(int variable) const { return values_[variable]; }
+
+  // Runs propagation on all constraints. Returns false if a contradiction was
+  // found.
+  bool PropagateAll() {
+    vector<int> queue;
+    for (int i = 0; i < frontier_->num_constraints(); ++i) {
+      queue.push_back(i);
+    }
+    return Propagate(&queue);
+  }
+
+  // Assigns the value to the variable and runs propagation. Returns false if
+  // a contradiction was found.
+  bool AssignAndPropagate(int variable, Value value) {
+    vector<int> queue;
+    return Assign(variable, value, &queue) && Propagate(&queue);
+  }
+
+ private:
+  // Assigns the value to the variable and adds its constraints to the queue.
+  // Returns false if the variable already has a different value or if one of
+  // the constraints can't be satisfied.
+  bool Assign(int variable, Value value, vector<int>* queue) {
+    DCHECK_NE(UNKNOWN, value);
+    if (values_[variable] != UNKNOWN) {
+      return values_[variable] == value;
+    }
+    values_[variable] = value;
+    const vector<int>& constraints =
+        frontier_->constraints_of_variable(variable);
+    for (int i = 0; i < constraints.size(); ++i) {
+      const int constraint = constraints[i];
+      --unassigned_variables_[constraint];
+      if (value == MINE) {
+        --remaining_mines_[constraint];
+      }
+      if (!IsSatisfiable(constraint)) {
+        return false;
+      }
+      queue->push_back(constraint);
+    }
+    return true;
+  }
+
+  bool IsSatisfiable(int constraint) const {
+    return remaining_mines_[constraint] >= 0
+        && remaining_mines_[constraint] <= unassigned_variables_[constraint];
+  }
+
+  // Processes the constraints in the queue. If all unassigned variables of a
+  // constraint must be empty (or must contain a mine), assigns them.
+  bool Propagate(vector<int>* queue) {
+    while (!queue->empty()) {
+      const int constraint_index = queue->back();
+      queue->pop_back();
+      if (!IsSatisfiable(constraint_index)) {
+        return false;
+      }
+      const int remaining_mines = remaining_mines_[constraint_index];
+      const int unassigned_variables = unassigned_variables_[constraint_index];
+      if (unassigned_variables == 0
+          || (remaining_mines != 0
+              && remaining_mines != unassigned_variables)) {
+        continue;
+      }
+      const Value value = remaining_mines == 0 ? EMPTY : MINE;
+      const FrontierConstraint& constraint =
+          frontier_->constraint(constraint_index);
+      for (int i = 0; i < constraint.num_variables; ++i) {
+        const int variable = constraint.variables[i];
+        if (values_[variable] == UNKNOWN && !Assign(variable, value, queue)) {
+          return false;
+        }
+      }
+    }
+    return true;
+  }
+
+  const Frontier* frontier_;
+  vector<Value> values_;
+  vector<int> remaining_mines_;
+  vector<int> unassigned_variables_;
+};
+
+// Runs both probes for a single variable. Each item of the parallel loop
+// writes only to its own slot of the results, so the items need no locking.
+class FailedLiteralProber::ProbeTask : public ThreadPool::Task {
+ public:
+  typedef vector<std::pair<int, Value> > Implications;
+
+  explicit ProbeTask(const State& base_state)
+      : base_state_(base_state),
+        implications_(0),
+        is_inconsistent_(0) {}
+
+  void Resize(int num_variables) {
+    implications_.resize(num_variables);
+    is_inconsistent_.resize(num_variables, false);
+  }
+
+  virtual void Run(int variable) {
+    if (base_state_.value(variable) != UNKNOWN) {
+      return;
+    }
+    State mine_state(base_state_);
+    const bool mine_is_consistent =
+        mine_state.AssignAndPropagate(variable, MINE);
+    State empty_state(base_state_);
+    const bool empty_is_consistent =
+        empty_state.AssignAndPropagate(variable, EMPTY);
+
+    Implications* const implications = &implications_[variable];
+    if (!mine_is_consistent && !empty_is_consistent) {
+      is_inconsistent_[variable] = true;
+    } else if (!mine_is_consistent || !empty_is_consistent) {
+      // All values derived from the consistent assumption are proven.
+      const State& state = mine_is_consistent ? mine_state : empty_state;
+      AddNewValues(state, state, implications);
+    } else {
+      AddNewValues(mine_state, empty_state, implications);
+    }
+  }
+
+  const Implications& implications(int variable) const {
+    return implications_[variable];
+  }
+  bool is_inconsistent(int variable) const {
+    return is_inconsistent_[variable];
+  }
+
+ private:
+  // Adds all variables that are not assigned in the base state and that have
+  // the same value in both states.
+  void AddNewValues(const State& first_state,
+                    const State& second_state,
+                    Implications* implications) const {
+    for (int i = 0; i < implications_.size(); ++i) {
+      const Value value = first_state.value(i);
+      if (value != UNKNOWN
+          && base_state_.value(i) == UNKNOWN
+          && second_state.value(i) == value) {
+        implications->push_back(std::make_pair(i, value));
+      }
+    }
+  }
+
+  const State& base_state_;
+  vector<Implications> implications_;
+  // Uses char instead of bool, because vector<bool> packs the values into
+  // shared words, and the threads would write to them concurrently.
+  vector<char> is_inconsistent_;
+};
+
+FailedLiteralProber::FailedLiteralProber(const Frontier& frontier)
+    : frontier_(frontier) {}
+
+bool FailedLiteralProber::ProbeAll(ThreadPool* thread_pool,
+                                   vector<Value>* values) const {
+  CHECK_NOTNULL(values);
+  const int num_variables = frontier_.num_variables();
+  values->assign(num_variables, UNKNOWN);
+
+  State base_state(frontier_);
+  if (!base_state.PropagateAll()) {
+    return false;
+  }
+
+  ProbeTask task(base_state);
+  task.Resize(num_variables);
+  if (thread_pool != NULL) {
+    thread_pool->ParallelFor(num_variables, &task);
+  } else {
+    for (int variable = 0; variable < num_variables; ++variable) {
+      task.Run(variable);
+    }
+  }
+
+  // Merge the results of the probes.
+  for (int variable = 0; variable < num_variables; ++variable) {
+    if (base_state.value(variable) != UNKNOWN) {
+      (*values)[variable] = base_state.value(variable);
+    }
+    if (task.is_inconsistent(variable)) {
+      return false;
+    }
+    const ProbeTask::Implications& implications = task.implications(variable);
+    for (int i = 0; i < implications.size(); ++i) {
+      const int implied_variable = implications[i].first;
+      const Value value = implications[i].second;
+      if ((*values)[implied_variable] != UNKNOWN
+          && (*values)[implied_variable] != value) {
+        return false;
+      }
+      (*values)[implied_variable] = value;
+    }
+  }
+  return true;
+}
+
+}  // namespace mineseeker
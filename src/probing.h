@@ -0,0 +1,69 @@
+// Copyright 2012 Ondrej Sykora
+//
+// This file is part of MineSeeker.
+//
+// MineSeeker is free software: you can redistribute it and/or modify it under
+// the terms of the GNU General Public License as published by the Free
+// Software Foundation, either version 3 of the License, or (at your option)
+// any later version.
+//
+// MineSeeker is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+// more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// MineSeeker. If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef MINESEEKER_PROBING_H_
+#define MINESEEKER_PROBING_H_
+
+#include "common.h"
+#include "frontier.h"
+
+namespace mineseeker {
+
+class ThreadPool;
+
+// Implements failed-literal probing on the frontier. For each variable of the
+// frontier, the prober tentatively assumes that the field contains a mine,
+// runs propagation on the constraints and checks for a contradiction; then it
+// does the same with the assumption that the field is empty. If one of the
+// assumptions leads to a contradiction, the field is proven to have the other
+// value. If both assumptions are consistent and both imply the same value for
+// another field, that field is proven as well.
+//
+// Each probe works on its own copy of the propagation state. The state only
+// contains the variables and the constraints of the frontier, so the cost of
+// the copy is proportional to the size of the frontier, not to the size of the
+// mine field. The probes are independent and they can run in parallel.
+class FailedLiteralProber {
+ public:
+  // The values of the variables in the results of the probing.
+  enum Value {
+    UNKNOWN = -1,
+    EMPTY = 0,
+    MINE = 1,
+  };
+
+  // Creates a prober for the given frontier. The frontier must outlive the
+  // prober.
+  explicit FailedLiteralProber(const Frontier& frontier);
+
+  // Probes all variables of the frontier. Uses the threads from the thread
+  // pool if it is not NULL, otherwise runs the probes in the calling thread.
+  // Stores the proven value of each variable (or UNKNOWN) to values; the
+  // vector is indexed by the indices of the variables in the frontier. Returns
+  // false if the frontier itself is inconsistent.
+  bool ProbeAll(ThreadPool* thread_pool, vector<Value>* values) const;
+
+ private:
+  class State;
+  class ProbeTask;
+
+  const Frontier& frontier_;
+};
+
+}  // namespace mineseeker
+
+#endif  // MINESEEKER_PROBING_H_
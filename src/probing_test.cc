@@ -0,0 +1,122 @@
+// Copyright 2012 Ondrej Sykora
+//
+// This file is part of MineSeeker.
+//
+// MineSeeker is free software: you can redistribute it and/or modify it under
+// the terms of the GNU General Public License as published by the Free
+// Software Foundation, either version 3 of the License, or (at your option)
+// any later version.
+//
+// MineSeeker is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+// more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// MineSeeker. If not, see <http://www.gnu.org/licenses/>.
+
+#include <stdlib.h>
+
+#include "common.h"
+#include "frontier.h"
+#include "glog/logging.h"
+#include "gtest/gtest.h"
+#include "mineseeker.h"
+#include "minesweeper.h"
+#include "probing.h"
+#include "scoped_ptr.h"
+#include "thread_pool.h"
+
+namespace mineseeker {
+
+// Tests probing on the pattern 1 1 2 1 1 (with the mines at (1, 0) and
+// (3, 0)). Propagation alone can't solve the pattern, but each of the fields
+// leads to a contradiction with one of the values.
+TEST(FailedLiteralProberTest, TestProbeAll) {
+  MineSweeper mine_sweeper(5, 2);
+  mine_sweeper.SetMine(1, 0, true);
+  mine_sweeper.SetMine(3, 0, true);
+  mine_sweeper.CloseMineField();
+  MineSeeker mine_seeker(mine_sweeper);
+  for (int x = 0; x < 5; ++x) {
+    mine_seeker.UncoverField(x, 1);
+  }
+
+  const Frontier frontier(mine_seeker);
+  const FailedLiteralProber prober(frontier);
+  vector<FailedLiteralProber::Value> values;
+  EXPECT_TRUE(prober.ProbeAll(NULL, &values));
+  ASSERT_EQ(5, values.size());
+  for (int i = 0; i < frontier.num_variables(); ++i) {
+    const FieldCoordinate& field = frontier.variable(i);
+    EXPECT_EQ(mine_sweeper.IsMine(field.x, field.y)
+                  ? FailedLiteralProber::MINE
+                  : FailedLiteralProber::EMPTY,
+              values[i]);
+  }
+}
+
+// Tests that the prober does not prove anything when both values are
+// possible.
+TEST(FailedLiteralProberTest, TestAmbiguousField) {
+  MineSweeper mine_sweeper(3, 1);
+  mine_sweeper.SetMine(0, 0, true);
+  mine_sweeper.CloseMineField();
+  MineSeeker mine_seeker(mine_sweeper);
+  mine_seeker.UncoverField(1, 0);
+
+  const Frontier frontier(mine_seeker);
+  ASSERT_EQ(2, frontier.num_variables());
+  const FailedLiteralProber prober(frontier);
+  vector<FailedLiteralProber::Value> values;
+  EXPECT_TRUE(prober.ProbeAll(NULL, &values));
+  EXPECT_EQ(FailedLiteralProber::UNKNOWN, values[0]);
+  EXPECT_EQ(FailedLiteralProber::UNKNOWN, values[1]);
+}
+
+// Checks that probing in parallel gives the same results as probing in a
+// single thread on random mine fields.
+TEST(FailedLiteralProberTest, TestParallelProbing) {
+  const int kWidth = 30;
+  const int kHeight = 16;
+  const int kNumMines = 99;
+  const int kNumFields = 20;
+  ThreadPool thread_pool(4);
+  srand(1);
+  for (int i = 0; i < kNumFields; ++i) {
+    MineSweeper mine_sweeper(kWidth, kHeight);
+    for (int j = 0; j < kNumMines; ++j) {
+      mine_sweeper.SetMine(rand() % kWidth, rand() % kHeight, true);
+    }
+    mine_sweeper.CloseMineField();
+    MineSeeker mine_seeker(mine_sweeper);
+    // Uncover a few fields to get a non-trivial frontier.
+    for (int j = 0; j < 40; ++j) {
+      const int x = rand() % kWidth;
+      const int y = rand() % kHeight;
+      if (mine_seeker.StateAtPosition(x, y) == MineSeekerField::HIDDEN
+          && !mine_sweeper.IsMine(x, y)) {
+        mine_seeker.UncoverField(x, y);
+      }
+    }
+
+    const Frontier frontier(mine_seeker);
+    const FailedLiteralProber prober(frontier);
+    vector<FailedLiteralProber::Value> sequential_values;
+    EXPECT_TRUE(prober.ProbeAll(NULL, &sequential_values));
+    vector<FailedLiteralProber::Value> parallel_values;
+    EXPECT_TRUE(prober.ProbeAll(&thread_pool, &parallel_values));
+    EXPECT_EQ(sequential_values, parallel_values);
+
+    // Check that the proven values are correct.
+    for (int j = 0; j < frontier.num_variables(); ++j) {
+      const FieldCoordinate& field = frontier.variable(j);
+      if (parallel_values[j] != FailedLiteralProber::UNKNOWN) {
+        EXPECT_EQ(mine_sweeper.IsMine(field.x, field.y),
+                  parallel_values[j] == FailedLiteralProber::MINE);
+      }
+    }
+  }
+}
+
+}  // namespace mineseeker
@@ -0,0 +1,648 @@
+// Copyright 2012 Ondrej Sykora
+//
+// This file is part of MineSeeker.
+//
+// MineSeeker is free software: you can redistribute it and/or modify it under
+// the terms of the GNU General Public License as published by the Free
+// Software Foundation, either version 3 of the License, or (at your option)
+// any later version.
+//
+// MineSeeker is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+// more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// MineSeeker. If not, see <http://www.gnu.org/licenses/>.
+
+#include "procedural_board_solver.h"
+
+#include <algorithm>
+
+#include "glog/logging.h"
+#include "minesweeper.h"
+#include "propagation_scheduler.h"
+
+namespace mineseeker {
+
+const int ProceduralBoardSolver::kChunkSize = 64;
+const int ProceduralBoardSolver::kWindowMargin = 8;
+const int ProceduralBoardSolver::kMaxEvictedHiddenFields = 64;
+const int ProceduralBoardSolver::kSuperRegionSize = 64;
+
+ProceduralBoardSolver::Chunk::Chunk()
+    : states(kChunkSize * kChunkSize, MineSeekerField::HIDDEN),
+      num_hidden_safe_fields(0),
+      last_used(0),
+      is_active(false) {}
+
+ProceduralBoardSolver::EvictedChunk::EvictedChunk() : is_active(false) {}
+
+bool ProceduralBoardSolver::EvictedChunk::IsHiddenSafeField(
+    int position) const {
+  if (hidden_field_bitmap.empty()) {
+    return std::binary_search(hidden_fields.begin(), hidden_fields.end(),
+                              position);
+  }
+  return (hidden_field_bitmap[position / 64] >> (position % 64)) & 1;
+}
+
+ProceduralBoardSolver::ProceduralBoardSolver(
+    const ProceduralMineField* mine_field,
+    int max_resident_chunks)
+    : mine_field_(*CHECK_NOTNULL(mine_field)),
+      max_resident_chunks_(max_resident_chunks),
+      width_in_chunks_((mine_field->width() - 1) / kChunkSize + 1),
+      height_in_chunks_((mine_field->height() - 1) / kChunkSize + 1),
+      started_(false),
+      solve_clock_(0),
+      num_uncovered_fields_(0),
+      safe_field_requests_(0),
+      num_window_solves_(0),
+      num_materialized_chunks_(0),
+      num_evicted_chunks_(0),
+      peak_resident_chunks_(0) {
+  CHECK_GT(max_resident_chunks, 0);
+  CHECK_LT(mine_field->density(), 1.0);
+}
+
+ProceduralBoardSolver::~ProceduralBoardSolver() {
+  for (std::unordered_map<int64, Chunk*>::iterator it = chunks_.begin();
+       it != chunks_.end(); ++it) {
+    delete it->second;
+  }
+}
+
+bool ProceduralBoardSolver::Solve(int start_x,
+                                  int start_y,
+                                  int64 max_uncovered_fields) {
+  if (!started_) {
+    CHECK_GE(start_x, 0);
+    CHECK_LT(start_x, mine_field_.width());
+    CHECK_GE(start_y, 0);
+    CHECK_LT(start_y, mine_field_.height());
+    started_ = true;
+    ++safe_field_requests_;
+    int x = start_x;
+    int y = start_y;
+    while (mine_field_.IsMine(x, y)) {
+      ++x;
+      if (x == mine_field_.width()) {
+        x = 0;
+        y = (y + 1) % mine_field_.height();
+      }
+    }
+    SetState(x, y, MineSeekerField::UNCOVERED);
+  }
+  while (num_uncovered_fields_ < max_uncovered_fields) {
+    if (active_chunks_.empty()) {
+      FieldCoordinate field(-1, -1);
+      if (!GetSafeFieldCoordinates(&field)) {
+        LOG(INFO) << "No safe field next to the uncovered region";
+        break;
+      }
+      ++safe_field_requests_;
+      SetState(field.x, field.y, MineSeekerField::UNCOVERED);
+      continue;
+    }
+    const std::pair<int, int> chunk = active_chunks_.front();
+    active_chunks_.pop_front();
+    // The chunk may have been evicted while it was waiting.
+    Chunk* const active_chunk = MaterializeChunk(chunk.first, chunk.second);
+    DCHECK(active_chunk->is_active);
+    active_chunk->is_active = false;
+    if (!SolveChunk(chunk.first, chunk.second)) {
+      return false;
+    }
+    EvictChunks();
+  }
+  return true;
+}
+
+MineSeekerField::State ProceduralBoardSolver::StateAtPosition(int x,
+                                                              int y) const {
+  DCHECK_GE(x, 0);
+  DCHECK_LT(x, mine_field_.width());
+  DCHECK_GE(y, 0);
+  DCHECK_LT(y, mine_field_.height());
+  const int chunk_x = x / kChunkSize;
+  const int chunk_y = y / kChunkSize;
+  const int position = (y % kChunkSize) * kChunkSize + x % kChunkSize;
+  const Chunk* const chunk = FindChunk(chunk_x, chunk_y);
+  if (chunk != NULL) {
+    return static_cast<MineSeekerField::State>(chunk->states[position]);
+  }
+  const std::map<int64, EvictedChunk>::const_iterator evicted_chunk =
+      evicted_chunks_.find(ChunkKey(chunk_x, chunk_y));
+  if (evicted_chunk != evicted_chunks_.end()) {
+    if (mine_field_.IsMine(x, y)
+        || evicted_chunk->second.IsHiddenSafeField(position)) {
+      return MineSeekerField::HIDDEN;
+    }
+    return MineSeekerField::UNCOVERED;
+  }
+  if (IsResolvedChunk(chunk_x, chunk_y)) {
+    return mine_field_.IsMine(x, y) ? MineSeekerField::HIDDEN
+                                    : MineSeekerField::UNCOVERED;
+  }
+  return MineSeekerField::HIDDEN;
+}
+
+ProceduralBoardSolver::Chunk* ProceduralBoardSolver::FindChunk(
+    int chunk_x,
+    int chunk_y) const {
+  const std::unordered_map<int64, Chunk*>::const_iterator it =
+      chunks_.find(ChunkKey(chunk_x, chunk_y));
+  return it == chunks_.end() ? NULL : it->second;
+}
+
+ProceduralBoardSolver::Chunk* ProceduralBoardSolver::MaterializeChunk(
+    int chunk_x,
+    int chunk_y) {
+  const int64 key = ChunkKey(chunk_x, chunk_y);
+  Chunk*& chunk = chunks_[key];
+  if (chunk != NULL) {
+    return chunk;
+  }
+  chunk = new Chunk();
+  resident_chunk_keys_.insert(key);
+  const std::map<int64, EvictedChunk>::iterator evicted_chunk =
+      evicted_chunks_.find(key);
+  const bool is_resolved = IsResolvedChunk(chunk_x, chunk_y);
+  const bool is_evicted = evicted_chunk != evicted_chunks_.end() || is_resolved;
+  const int max_x = std::min(kChunkSize,
+                             mine_field_.width() - chunk_x * kChunkSize);
+  const int max_y = std::min(kChunkSize,
+                             mine_field_.height() - chunk_y * kChunkSize);
+  for (int y = 0; y < kChunkSize; ++y) {
+    for (int x = 0; x < kChunkSize; ++x) {
+      int8* const state = &chunk->states[y * kChunkSize + x];
+      if (x >= max_x || y >= max_y) {
+        // The fields outside of the mine field are never uncovered.
+        *state = MineSeekerField::MINE;
+      } else if (!mine_field_.IsMine(chunk_x * kChunkSize + x,
+                                     chunk_y * kChunkSize + y)) {
+        if (is_evicted) {
+          *state = MineSeekerField::UNCOVERED;
+        } else {
+          ++chunk->num_hidden_safe_fields;
+        }
+      }
+    }
+  }
+  if (is_resolved) {
+    RemoveResolvedChunk(chunk_x, chunk_y);
+    --num_evicted_chunks_;
+  } else if (is_evicted) {
+    const EvictedChunk& evicted = evicted_chunk->second;
+    for (int i = 0; i < evicted.hidden_fields.size(); ++i) {
+      chunk->states[evicted.hidden_fields[i]] = MineSeekerField::HIDDEN;
+      ++chunk->num_hidden_safe_fields;
+    }
+    for (int i = 0; i < evicted.hidden_field_bitmap.size(); ++i) {
+      for (uint64 word = evicted.hidden_field_bitmap[i]; word != 0;
+           word &= word - 1) {
+        chunk->states[i * 64 + __builtin_ctzll(word)] =
+            MineSeekerField::HIDDEN;
+        ++chunk->num_hidden_safe_fields;
+      }
+    }
+    chunk->is_active = evicted.is_active;
+    evicted_chunks_.erase(evicted_chunk);
+    --num_evicted_chunks_;
+  } else {
+    ++num_materialized_chunks_;
+  }
+  chunk->last_used = solve_clock_;
+  peak_resident_chunks_ = std::max<int>(peak_resident_chunks_, chunks_.size());
+  return chunk;
+}
+
+bool ProceduralBoardSolver::IsMaterializedChunk(int chunk_x,
+                                                int chunk_y) const {
+  const int64 key = ChunkKey(chunk_x, chunk_y);
+  return chunks_.count(key) > 0 || evicted_chunks_.count(key) > 0
+      || IsResolvedChunk(chunk_x, chunk_y);
+}
+
+bool ProceduralBoardSolver::IsResolvedChunk(int chunk_x, int chunk_y) const {
+  const int64 super_region_key = ChunkKey(chunk_x / kSuperRegionSize,
+                                          chunk_y / kSuperRegionSize);
+  if (resolved_super_regions_.count(super_region_key) > 0) {
+    return true;
+  }
+  const std::unordered_map<int64, vector<uint64> >::const_iterator bitmap =
+      resolved_chunk_bitmaps_.find(super_region_key);
+  if (bitmap == resolved_chunk_bitmaps_.end()) {
+    return false;
+  }
+  const int bit = (chunk_y % kSuperRegionSize) * kSuperRegionSize
+      + chunk_x % kSuperRegionSize;
+  return (bitmap->second[bit / 64] >> (bit % 64)) & 1;
+}
+
+void ProceduralBoardSolver::AddResolvedChunk(int chunk_x, int chunk_y) {
+  DCHECK(!IsResolvedChunk(chunk_x, chunk_y));
+  const int super_x = chunk_x / kSuperRegionSize;
+  const int super_y = chunk_y / kSuperRegionSize;
+  const int64 super_region_key = ChunkKey(super_x, super_y);
+  vector<uint64>* const bitmap = &resolved_chunk_bitmaps_[super_region_key];
+  if (bitmap->empty()) {
+    bitmap->resize(kSuperRegionSize * kSuperRegionSize / 64, 0);
+  }
+  const int bit = (chunk_y % kSuperRegionSize) * kSuperRegionSize
+      + chunk_x % kSuperRegionSize;
+  (*bitmap)[bit / 64] |= static_cast<uint64>(1) << (bit % 64);
+  int num_resolved_chunks = 0;
+  for (int i = 0; i < bitmap->size(); ++i) {
+    num_resolved_chunks += __builtin_popcountll((*bitmap)[i]);
+  }
+  if (num_resolved_chunks == NumChunksInSuperRegion(super_x, super_y)) {
+    resolved_chunk_bitmaps_.erase(super_region_key);
+    resolved_super_regions_.insert(super_region_key);
+  }
+}
+
+void ProceduralBoardSolver::RemoveResolvedChunk(int chunk_x, int chunk_y) {
+  DCHECK(IsResolvedChunk(chunk_x, chunk_y));
+  const int super_x = chunk_x / kSuperRegionSize;
+  const int super_y = chunk_y / kSuperRegionSize;
+  const int64 super_region_key = ChunkKey(super_x, super_y);
+  vector<uint64>* const bitmap = &resolved_chunk_bitmaps_[super_region_key];
+  if (resolved_super_regions_.erase(super_region_key) > 0) {
+    // The super-region is expanded back to a bitmap of all its chunks.
+    bitmap->assign(kSuperRegionSize * kSuperRegionSize / 64, 0);
+    const int num_columns = std::min(
+        kSuperRegionSize, width_in_chunks_ - super_x * kSuperRegionSize);
+    const int num_rows = std::min(
+        kSuperRegionSize, height_in_chunks_ - super_y * kSuperRegionSize);
+    for (int y = 0; y < num_rows; ++y) {
+      for (int x = 0; x < num_columns; ++x) {
+        const int bit = y * kSuperRegionSize + x;
+        (*bitmap)[bit / 64] |= static_cast<uint64>(1) << (bit % 64);
+      }
+    }
+  }
+  const int bit = (chunk_y % kSuperRegionSize) * kSuperRegionSize
+      + chunk_x % kSuperRegionSize;
+  (*bitmap)[bit / 64] &= ~(static_cast<uint64>(1) << (bit % 64));
+}
+
+int ProceduralBoardSolver::NumChunksInSuperRegion(int super_x,
+                                                  int super_y) const {
+  return std::min(kSuperRegionSize,
+                  width_in_chunks_ - super_x * kSuperRegionSize)
+      * std::min(kSuperRegionSize,
+                 height_in_chunks_ - super_y * kSuperRegionSize);
+}
+
+void ProceduralBoardSolver::SetState(int x,
+                                     int y,
+                                     MineSeekerField::State state) {
+  const int chunk_x = x / kChunkSize;
+  const int chunk_y = y / kChunkSize;
+  const int local_x = x % kChunkSize;
+  const int local_y = y % kChunkSize;
+  Chunk* const chunk = MaterializeChunk(chunk_x, chunk_y);
+  int8* const field_state = &chunk->states[local_y * kChunkSize + local_x];
+  DCHECK_EQ(MineSeekerField::HIDDEN, *field_state);
+  *field_state = state;
+  if (state == MineSeekerField::UNCOVERED) {
+    DCHECK_GT(chunk->num_hidden_safe_fields, 0);
+    --chunk->num_hidden_safe_fields;
+    ++num_uncovered_fields_;
+  }
+  ActivateChunk(chunk_x, chunk_y);
+  // The change may allow new deductions for fields up to two fields away,
+  // which may be in the neighboring chunks.
+  for (int dy = -1; dy <= 1; ++dy) {
+    for (int dx = -1; dx <= 1; ++dx) {
+      if ((dx == -1 && local_x >= 2)
+          || (dx == 1 && local_x < kChunkSize - 2)
+          || (dy == -1 && local_y >= 2)
+          || (dy == 1 && local_y < kChunkSize - 2)
+          || (dx == 0 && dy == 0)) {
+        continue;
+      }
+      ActivateChunk(chunk_x + dx, chunk_y + dy);
+    }
+  }
+}
+
+void ProceduralBoardSolver::ActivateChunk(int chunk_x, int chunk_y) {
+  Chunk* const chunk = FindChunk(chunk_x, chunk_y);
+  if (chunk != NULL && !chunk->is_active
+      && chunk->num_hidden_safe_fields > 0) {
+    chunk->is_active = true;
+    active_chunks_.push_back(std::make_pair(chunk_x, chunk_y));
+  }
+}
+
+bool ProceduralBoardSolver::SolveChunk(int chunk_x, int chunk_y) {
+  ++num_window_solves_;
+  ++solve_clock_;
+  const int min_x = std::max(0, chunk_x * kChunkSize - kWindowMargin);
+  const int min_y = std::max(0, chunk_y * kChunkSize - kWindowMargin);
+  const int max_x = std::min<int64>(
+      mine_field_.width(),
+      static_cast<int64>(chunk_x + 1) * kChunkSize + kWindowMargin);
+  const int max_y = std::min<int64>(
+      mine_field_.height(),
+      static_cast<int64>(chunk_y + 1) * kChunkSize + kWindowMargin);
+  if (window_seeker_.get() == NULL) {
+    window_.reset(new MineSweeper(&mine_field_, min_x, min_y,
+                                  max_x - min_x, max_y - min_y));
+    window_seeker_.reset(new MineSeeker(*window_));
+    window_seeker_->UseEnumerationInsteadOfLocalTiers();
+    window_seeker_->mutable_scheduler()->set_tier_budget(
+        MineSeeker::GUESS_TIER, 0);
+  } else {
+    window_->MoveWindow(&mine_field_, min_x, min_y,
+                        max_x - min_x, max_y - min_y);
+    window_seeker_->Restart();
+  }
+  const MineSweeper& window = *window_;
+  MineSeeker* const seeker = window_seeker_.get();
+
+  // The known mines are marked before the fields are uncovered, so that the
+  // configurations of the uncovered fields are filtered with the mines in
+  // place.
+  vector<int8> states(window.width() * window.height());
+  for (int y = 0; y < window.height(); ++y) {
+    for (int x = 0; x < window.width(); ++x) {
+      states[y * window.width() + x] = StateAtPosition(min_x + x, min_y + y);
+      if (states[y * window.width() + x] == MineSeekerField::MINE) {
+        seeker->MarkAsMine(x, y);
+      }
+    }
+  }
+  for (int y = 0; y < window.height(); ++y) {
+    for (int x = 0; x < window.width(); ++x) {
+      if (states[y * window.width() + x] == MineSeekerField::UNCOVERED
+          && !window.IsOnWindowBorder(x, y)) {
+        seeker->UncoverField(x, y);
+      }
+    }
+  }
+  seeker->ContinueSolving();
+  if (seeker->is_dead()) {
+    LOG(ERROR) << "The solver stepped on a mine in the window of chunk "
+               << chunk_x << " " << chunk_y;
+    return false;
+  }
+
+  for (int y = 0; y < window.height(); ++y) {
+    for (int x = 0; x < window.width(); ++x) {
+      const MineSeekerField::State state = seeker->StateAtPosition(x, y);
+      if (state == MineSeekerField::HIDDEN
+          || states[y * window.width() + x] != MineSeekerField::HIDDEN) {
+        continue;
+      }
+      // The mines found in the evicted chunks are not stored; they will be
+      // found again from the uncovered fields around them if needed.
+      if (state == MineSeekerField::MINE
+          && FindChunk((min_x + x) / kChunkSize,
+                       (min_y + y) / kChunkSize) == NULL
+          && IsMaterializedChunk((min_x + x) / kChunkSize,
+                                 (min_y + y) / kChunkSize)) {
+        continue;
+      }
+      SetState(min_x + x, min_y + y, state);
+    }
+  }
+  for (int y = min_y / kChunkSize; y <= (max_y - 1) / kChunkSize; ++y) {
+    for (int x = min_x / kChunkSize; x <= (max_x - 1) / kChunkSize; ++x) {
+      Chunk* const chunk = FindChunk(x, y);
+      if (chunk != NULL) {
+        chunk->last_used = solve_clock_;
+      }
+    }
+  }
+  return true;
+}
+
+bool ProceduralBoardSolver::GetSafeFieldCoordinates(
+    FieldCoordinate* coordinates) const {
+  CHECK_NOTNULL(coordinates);
+  // The chunks are scanned in the order of their keys, so that the hints do
+  // not depend on the order of the hash maps; the keys of the chunks in memory
+  // and of the evicted chunks with hidden fields are merged. The other evicted
+  // chunks are behind the frontier, so they have no candidates.
+  std::set<int64>::const_iterator resident_key = resident_chunk_keys_.begin();
+  std::map<int64, EvictedChunk>::const_iterator evicted_chunk =
+      evicted_chunks_.begin();
+  bool found_field = false;
+  vector<FieldCoordinate> candidates;
+  while (resident_key != resident_chunk_keys_.end()
+         || evicted_chunk != evicted_chunks_.end()) {
+    int64 key = 0;
+    const EvictedChunk* evicted = NULL;
+    if (evicted_chunk != evicted_chunks_.end()
+        && (resident_key == resident_chunk_keys_.end()
+            || evicted_chunk->first < *resident_key)) {
+      key = evicted_chunk->first;
+      evicted = &evicted_chunk->second;
+      ++evicted_chunk;
+    } else {
+      key = *resident_key;
+      ++resident_key;
+    }
+    const int chunk_x = key & 0xffffffffLL;
+    const int chunk_y = key >> 32;
+    candidates.clear();
+    if (evicted != NULL) {
+      for (int j = 0; j < evicted->hidden_fields.size(); ++j) {
+        const int position = evicted->hidden_fields[j];
+        candidates.push_back(
+            FieldCoordinate(chunk_x * kChunkSize + position % kChunkSize,
+                            chunk_y * kChunkSize + position / kChunkSize));
+      }
+      for (int j = 0; j < evicted->hidden_field_bitmap.size(); ++j) {
+        for (uint64 word = evicted->hidden_field_bitmap[j]; word != 0;
+             word &= word - 1) {
+          const int position = j * 64 + __builtin_ctzll(word);
+          candidates.push_back(
+              FieldCoordinate(chunk_x * kChunkSize + position % kChunkSize,
+                              chunk_y * kChunkSize + position / kChunkSize));
+        }
+      }
+      // A chunk evicted from the frontier may have uncovered fields next to
+      // the chunks that were not materialized yet.
+      AddCandidatesAroundChunk(chunk_x, chunk_y, &candidates);
+    } else {
+      const Chunk* const chunk = FindChunk(chunk_x, chunk_y);
+      // The hidden fields of the chunks in memory are found directly; the
+      // hidden fields of the chunks that were not materialized yet are found
+      // from the uncovered fields next to them. The evicted chunks have no
+      // such neighbors.
+      for (int y = 0; y < kChunkSize; ++y) {
+        for (int x = 0; x < kChunkSize; ++x) {
+          const int field_x = chunk_x * kChunkSize + x;
+          const int field_y = chunk_y * kChunkSize + y;
+          const int8 state = chunk->states[y * kChunkSize + x];
+          if (state == MineSeekerField::HIDDEN
+              && chunk->num_hidden_safe_fields > 0) {
+            candidates.push_back(FieldCoordinate(field_x, field_y));
+          } else if (state == MineSeekerField::UNCOVERED
+                     && (x == 0 || y == 0
+                         || x == kChunkSize - 1 || y == kChunkSize - 1)) {
+            for (int ny = field_y - 1; ny <= field_y + 1; ++ny) {
+              for (int nx = field_x - 1; nx <= field_x + 1; ++nx) {
+                if (nx >= 0 && ny >= 0
+                    && !IsMaterializedChunk(nx / kChunkSize,
+                                            ny / kChunkSize)) {
+                  candidates.push_back(FieldCoordinate(nx, ny));
+                }
+              }
+            }
+          }
+        }
+      }
+    }
+    for (int j = 0; j < candidates.size(); ++j) {
+      const FieldCoordinate& candidate = candidates[j];
+      if (!IsHintCandidate(candidate.x, candidate.y)) {
+        continue;
+      }
+      if (mine_field_.NumberOfMinesAroundField(candidate.x,
+                                               candidate.y) == 0) {
+        *coordinates = candidate;
+        return true;
+      }
+      if (!found_field) {
+        *coordinates = candidate;
+        found_field = true;
+      }
+    }
+  }
+  return found_field;
+}
+
+void ProceduralBoardSolver::AddCandidatesAroundChunk(
+    int chunk_x,
+    int chunk_y,
+    vector<FieldCoordinate>* candidates) const {
+  bool has_new_neighbors = false;
+  for (int y = chunk_y - 1; y <= chunk_y + 1 && !has_new_neighbors; ++y) {
+    for (int x = chunk_x - 1; x <= chunk_x + 1; ++x) {
+      if (x >= 0 && x < width_in_chunks_ && y >= 0 && y < height_in_chunks_
+          && !IsMaterializedChunk(x, y)) {
+        has_new_neighbors = true;
+        break;
+      }
+    }
+  }
+  if (!has_new_neighbors) {
+    return;
+  }
+  for (int y = 0; y < kChunkSize; ++y) {
+    const bool is_side_row = y == 0 || y == kChunkSize - 1;
+    for (int x = 0; x < kChunkSize; x += is_side_row ? 1 : kChunkSize - 1) {
+      const int field_x = chunk_x * kChunkSize + x;
+      const int field_y = chunk_y * kChunkSize + y;
+      if (field_x >= mine_field_.width() || field_y >= mine_field_.height()
+          || StateAtPosition(field_x, field_y) != MineSeekerField::UNCOVERED) {
+        continue;
+      }
+      for (int ny = field_y - 1; ny <= field_y + 1; ++ny) {
+        for (int nx = field_x - 1; nx <= field_x + 1; ++nx) {
+          if (nx >= 0 && ny >= 0
+              && !IsMaterializedChunk(nx / kChunkSize, ny / kChunkSize)) {
+            candidates->push_back(FieldCoordinate(nx, ny));
+          }
+        }
+      }
+    }
+  }
+}
+
+bool ProceduralBoardSolver::IsHintCandidate(int x, int y) const {
+  if (x < 0 || x >= mine_field_.width() || y < 0 || y >= mine_field_.height()
+      || mine_field_.IsMine(x, y)
+      || StateAtPosition(x, y) != MineSeekerField::HIDDEN) {
+    return false;
+  }
+  for (int j = std::max(0, y - 1);
+       j <= std::min(mine_field_.height() - 1, y + 1); ++j) {
+    for (int i = std::max(0, x - 1);
+         i <= std::min(mine_field_.width() - 1, x + 1); ++i) {
+      if (StateAtPosition(i, j) == MineSeekerField::UNCOVERED) {
+        return true;
+      }
+    }
+  }
+  return false;
+}
+
+void ProceduralBoardSolver::EvictChunks() {
+  if (chunks_.size() <= max_resident_chunks_) {
+    return;
+  }
+  // The candidates are sorted by the cost of the evicted chunk, by the time of
+  // the last use and by the key, so that the order does not depend on the
+  // order of the hash map. The inactive chunks behind the frontier with few
+  // hidden fields are cheap; the other chunks are evicted only when these are
+  // not enough.
+  vector<std::pair<std::pair<bool, int64>, int64> > candidates;
+  candidates.reserve(chunks_.size());
+  for (std::unordered_map<int64, Chunk*>::const_iterator it = chunks_.begin();
+       it != chunks_.end(); ++it) {
+    const Chunk& chunk = *it->second;
+    const int chunk_x = it->first & 0xffffffffLL;
+    const int chunk_y = it->first >> 32;
+    // The chunk is cheap if it is behind the frontier and it has few hidden
+    // fields.
+    bool is_cheap = chunk.num_hidden_safe_fields <= kMaxEvictedHiddenFields
+        && !chunk.is_active;
+    for (int y = chunk_y - 1; y <= chunk_y + 1 && is_cheap; ++y) {
+      for (int x = chunk_x - 1; x <= chunk_x + 1; ++x) {
+        if (x >= 0 && x < width_in_chunks_ && y >= 0 && y < height_in_chunks_
+            && !IsMaterializedChunk(x, y)) {
+          is_cheap = false;
+          break;
+        }
+      }
+    }
+    candidates.push_back(std::make_pair(
+        std::make_pair(!is_cheap, chunk.last_used), it->first));
+  }
+  std::sort(candidates.begin(), candidates.end());
+  for (int i = 0;
+       i < candidates.size() && chunks_.size() > max_resident_chunks_; ++i) {
+    const bool is_cheap = !candidates[i].first.first;
+    const int64 key = candidates[i].second;
+    Chunk* const chunk = chunks_[key];
+    const int chunk_x = key & 0xffffffffLL;
+    const int chunk_y = key >> 32;
+    ++num_evicted_chunks_;
+    if (is_cheap && chunk->num_hidden_safe_fields == 0) {
+      AddResolvedChunk(chunk_x, chunk_y);
+    } else {
+      EvictedChunk* const evicted_chunk = &evicted_chunks_[key];
+      evicted_chunk->is_active = chunk->is_active;
+      if (chunk->num_hidden_safe_fields > kMaxEvictedHiddenFields) {
+        evicted_chunk->hidden_field_bitmap.resize(
+            kChunkSize * kChunkSize / 64, 0);
+      }
+      for (int position = 0; position < chunk->states.size(); ++position) {
+        const int x = chunk_x * kChunkSize + position % kChunkSize;
+        const int y = chunk_y * kChunkSize + position / kChunkSize;
+        if (chunk->states[position] != MineSeekerField::HIDDEN
+            || mine_field_.IsMine(x, y)) {
+          continue;
+        }
+        if (evicted_chunk->hidden_field_bitmap.empty()) {
+          evicted_chunk->hidden_fields.push_back(position);
+        } else {
+          evicted_chunk->hidden_field_bitmap[position / 64] |=
+              static_cast<uint64>(1) << (position % 64);
+        }
+      }
+    }
+    delete chunk;
+    chunks_.erase(key);
+    resident_chunk_keys_.erase(key);
+  }
+}
+
+}  // namespace mineseeker
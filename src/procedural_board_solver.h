@@ -0,0 +1,249 @@
+// Copyright 2012 Ondrej Sykora
+//
+// This file is part of MineSeeker.
+//
+// MineSeeker is free software: you can redistribute it and/or modify it under
+// the terms of the GNU General Public License as published by the Free
+// Software Foundation, either version 3 of the License, or (at your option)
+// any later version.
+//
+// MineSeeker is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+// more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// MineSeeker. If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef MINESEEKER_PROCEDURAL_BOARD_SOLVER_H_
+#define MINESEEKER_PROCEDURAL_BOARD_SOLVER_H_
+
+#include <deque>
+#include <map>
+#include <set>
+#include <unordered_map>
+#include <unordered_set>
+
+#include "common.h"
+#include "mineseeker.h"
+#include "minesweeper.h"
+#include "procedural_mine_field.h"
+#include "scoped_ptr.h"
+
+namespace mineseeker {
+
+// Solves a procedural mine field that is too large to be stored, e.g. an
+// unbounded board, starting from a single field and expanding the uncovered
+// region until it reaches a given size.
+//
+// The state of the solver (the states of the fields) is stored in square
+// chunks of kChunkSize x kChunkSize fields. A chunk is materialized only when
+// the solver proves the state of one of its fields; until then, all its fields
+// are hidden. The chunks are solved one at a time: the solver moves a window of
+// the procedural mine field over the chunk and kWindowMargin fields around it,
+// restarts its MineSeeker on the window and copies the known states of the
+// fields to it, runs the propagation until it gets stuck, and copies the new
+// states back. The window and the seeker are reused by all chunks, so the
+// seeker keeps its table of interned configuration sets. The chunks whose
+// fields changed are solved again, until no chunk has pending work; then the
+// solver asks for a safe field next to the uncovered region.
+//
+// After each window solve, the least recently used chunks are evicted until
+// there are at most max_resident_chunks chunks in memory. An evicted chunk
+// keeps only the positions of its hidden fields without mines, in a sorted
+// list if there are at most kMaxEvictedHiddenFields of them and in a bitmap
+// otherwise; the states of the other fields are computed from the procedural
+// mine field, with the mines being hidden. The chunk is materialized again
+// when one of its fields changes or when it is solved. The chunks behind the
+// frontier with few hidden fields, e.g. the fields of an ambiguous pattern
+// where the solver needs a safe field, are evicted first; they are the
+// cheapest to keep. A chunk is behind the frontier when it has no pending work
+// and its neighbor chunks were materialized. Such a chunk without hidden
+// fields takes a single bit in the bitmap of its super-region of
+// kSuperRegionSize x kSuperRegionSize chunks, and a super-region whose chunks
+// were all evicted this way is reduced to its key. The chunks on the frontier
+// are evicted only when they do not fit in memory; each of them takes a bitmap
+// of kChunkSize * kChunkSize bits, an eighth of a chunk in memory. The memory
+// is thus bounded by max_resident_chunks chunks and a window, plus the
+// evicted chunks, which grow with the uncovered region by a bit per chunk
+// behind the frontier and a bitmap per chunk on the frontier.
+//
+// Typical usage:
+// ProceduralMineField mine_field(kMaxSize, kMaxSize, 0.15, seed);
+// ProceduralBoardSolver solver(&mine_field, 256);
+// solver.Solve(kMaxSize / 2, kMaxSize / 2, 1000000);
+// LOG(INFO) << solver.num_uncovered_fields();
+class ProceduralBoardSolver {
+ public:
+  // The size of the side of a chunk.
+  static const int kChunkSize;
+  // The number of fields around a chunk that are solved together with the
+  // chunk.
+  static const int kWindowMargin;
+  // The largest number of hidden fields without mines of an evicted chunk.
+  static const int kMaxEvictedHiddenFields;
+  // The size of the side of a super-region, in chunks.
+  static const int kSuperRegionSize;
+
+  // Creates a solver for the given mine field that keeps at most
+  // max_resident_chunks chunks in memory between the window solves. Does not
+  // take ownership of the mine field. The density of the mine field must be
+  // less than one.
+  ProceduralBoardSolver(const ProceduralMineField* mine_field,
+                        int max_resident_chunks);
+  ~ProceduralBoardSolver();
+
+  // Solves the mine field, starting from the field (start_x, start_y), or the
+  // first field without a mine after it in the row order, until at least
+  // max_uncovered_fields fields are uncovered, or there is no hidden field
+  // without a mine next to the uncovered region. The first field and each
+  // field given when the solver gets stuck are counted as safe field requests.
+  // Can be called repeatedly with a growing limit; the start field is used
+  // only by the first call. Returns false if the solver stepped on a mine.
+  bool Solve(int start_x, int start_y, int64 max_uncovered_fields);
+
+  // Returns the state of the field (x, y).
+  MineSeekerField::State StateAtPosition(int x, int y) const;
+
+  // Statistics of the solver.
+  int64 num_uncovered_fields() const { return num_uncovered_fields_; }
+  int safe_field_requests() const { return safe_field_requests_; }
+  int64 num_window_solves() const { return num_window_solves_; }
+  int64 num_materialized_chunks() const { return num_materialized_chunks_; }
+  int64 num_evicted_chunks() const { return num_evicted_chunks_; }
+  // The number of evicted chunks that keep the positions of their hidden
+  // fields; the other evicted chunks take only a bit of memory. Includes the
+  // chunks evicted from the frontier.
+  int num_evicted_chunks_with_hidden_fields() const {
+    return evicted_chunks_.size();
+  }
+  int num_resident_chunks() const { return chunks_.size(); }
+  int peak_resident_chunks() const { return peak_resident_chunks_; }
+
+ private:
+  // The states of the fields of a single chunk.
+  struct Chunk {
+    Chunk();
+
+    // The states of the fields, stored by rows.
+    vector<int8> states;
+    // The number of hidden fields without a mine.
+    int num_hidden_safe_fields;
+    // The value of solve_clock_ when the chunk was last solved or used in the
+    // window of another chunk.
+    int64 last_used;
+    // True if the chunk is in active_chunks_.
+    bool is_active;
+  };
+
+  // An evicted chunk that keeps the positions y * kChunkSize + x of its hidden
+  // fields without mines.
+  struct EvictedChunk {
+    EvictedChunk();
+
+    // Returns true if the field at the given position is hidden and it has no
+    // mine.
+    bool IsHiddenSafeField(int position) const;
+
+    // The sorted list of the positions; empty if the chunk uses the bitmap.
+    vector<uint16_t> hidden_fields;
+    // The bitmap of the positions, for the chunks with more than
+    // kMaxEvictedHiddenFields of them; empty otherwise.
+    vector<uint64> hidden_field_bitmap;
+    // The value of Chunk::is_active when the chunk was evicted.
+    bool is_active;
+  };
+
+  // Returns the key of the chunk (chunk_x, chunk_y) in chunks_. The keys are
+  // ordered by rows.
+  static int64 ChunkKey(int chunk_x, int chunk_y) {
+    return (static_cast<int64>(chunk_y) << 32) | chunk_x;
+  }
+  // Returns the chunk with the given coordinates, or NULL if it is not in
+  // memory.
+  Chunk* FindChunk(int chunk_x, int chunk_y) const;
+  // Returns the chunk with the given coordinates; creates it if it was not
+  // materialized yet, or restores it if it was evicted.
+  Chunk* MaterializeChunk(int chunk_x, int chunk_y);
+  // Returns true if the chunk is in memory or evicted.
+  bool IsMaterializedChunk(int chunk_x, int chunk_y) const;
+  // Returns true if the chunk was evicted without hidden fields without mines.
+  bool IsResolvedChunk(int chunk_x, int chunk_y) const;
+  // Adds the chunk to or removes it from the resolved chunks.
+  void AddResolvedChunk(int chunk_x, int chunk_y);
+  void RemoveResolvedChunk(int chunk_x, int chunk_y);
+  // Returns the number of chunks of the super-region that are inside of the
+  // mine field.
+  int NumChunksInSuperRegion(int super_x, int super_y) const;
+
+  // Changes the state of the hidden field (x, y), and adds the chunks that
+  // might use the new state to active_chunks_.
+  void SetState(int x, int y, MineSeekerField::State state);
+  // Adds the chunk to active_chunks_, if it is in memory and it has hidden
+  // fields without mines.
+  void ActivateChunk(int chunk_x, int chunk_y);
+
+  // Solves the window around the given chunk, and copies the new states of
+  // the fields back to the chunks. Returns false if the seeker stepped on a
+  // mine.
+  bool SolveChunk(int chunk_x, int chunk_y);
+  // Finds a hidden field without a mine next to an uncovered field, preferring
+  // fields with no mines around. Returns false if there is no such field.
+  bool GetSafeFieldCoordinates(FieldCoordinate* coordinates) const;
+  // Adds the fields of the chunks that were not materialized yet next to the
+  // uncovered fields on the sides of the chunk (chunk_x, chunk_y) to
+  // 'candidates'. The chunk must be in memory or evicted.
+  void AddCandidatesAroundChunk(int chunk_x,
+                                int chunk_y,
+                                vector<FieldCoordinate>* candidates) const;
+  // Returns true if the field (x, y) is a hidden field without a mine next to
+  // an uncovered field.
+  bool IsHintCandidate(int x, int y) const;
+  // Evicts the least recently used chunks, the cheap chunks behind the frontier
+  // first, until there are at most max_resident_chunks_ chunks in memory.
+  void EvictChunks();
+
+  const ProceduralMineField& mine_field_;
+  const int max_resident_chunks_;
+  // The number of chunks in each direction.
+  const int width_in_chunks_;
+  const int height_in_chunks_;
+
+  // The chunks in memory, by their keys. Owns the chunks. The keys are also
+  // kept in an ordered set, so that the safe fields are searched in the order
+  // of the keys without sorting them.
+  std::unordered_map<int64, Chunk*> chunks_;
+  std::set<int64> resident_chunk_keys_;
+  // The evicted chunks that keep the positions of their hidden fields without
+  // mines, by their keys. The map is ordered for the same reason as
+  // resident_chunk_keys_.
+  std::map<int64, EvictedChunk> evicted_chunks_;
+  // The bitmaps of the evicted chunks without hidden fields without mines, by
+  // the keys of their super-regions; the chunks of a super-region are
+  // numbered by rows.
+  std::unordered_map<int64, vector<uint64> > resolved_chunk_bitmaps_;
+  // The keys of the super-regions, all of whose chunks are resolved.
+  std::unordered_set<int64> resolved_super_regions_;
+  // The coordinates of the chunks that need to be solved again.
+  std::deque<std::pair<int, int> > active_chunks_;
+  // The view of the window of the mine field solved by window_seeker_. Both
+  // are created by the first window solve and reused by the following ones.
+  scoped_ptr<MineSweeper> window_;
+  scoped_ptr<MineSeeker> window_seeker_;
+
+  bool started_;
+  int64 solve_clock_;
+  int64 num_uncovered_fields_;
+  int safe_field_requests_;
+  int64 num_window_solves_;
+  int64 num_materialized_chunks_;
+  int64 num_evicted_chunks_;
+  int peak_resident_chunks_;
+
+  ProceduralBoardSolver(const ProceduralBoardSolver&);
+  void operator=(const ProceduralBoardSolver&);
+};
+
+}  // namespace mineseeker
+
+#endif  // MINESEEKER_PROCEDURAL_BOARD_SOLVER_H_
@@ -0,0 +1,153 @@
+// Copyright 2012 Ondrej Sykora
+//
+// This file is part of MineSeeker.
+//
+// MineSeeker is free software: you can redistribute it and/or modify it under
+// the terms of the GNU General Public License as published by the Free
+// Software Foundation, either version 3 of the License, or (at your option)
+// any later version.
+//
+// MineSeeker is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+// more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// MineSeeker. If not, see <http://www.gnu.org/licenses/>.
+
+#include "procedural_board_solver.h"
+
+#include "common.h"
+#include "glog/logging.h"
+#include "gtest/gtest.h"
+#include "mineseeker.h"
+#include "procedural_mine_field.h"
+
+namespace mineseeker {
+
+// Checks that the uncovered fields have no mines and that the fields marked as
+// mines have mines. Returns the number of uncovered fields.
+int64 CheckStatesAreSound(const ProceduralMineField& mine_field,
+                          const ProceduralBoardSolver& solver) {
+  int64 num_uncovered_fields = 0;
+  for (int y = 0; y < mine_field.height(); ++y) {
+    for (int x = 0; x < mine_field.width(); ++x) {
+      switch (solver.StateAtPosition(x, y)) {
+        case MineSeekerField::UNCOVERED:
+          EXPECT_FALSE(mine_field.IsMine(x, y)) << x << " " << y;
+          ++num_uncovered_fields;
+          break;
+        case MineSeekerField::MINE:
+          EXPECT_TRUE(mine_field.IsMine(x, y)) << x << " " << y;
+          break;
+        case MineSeekerField::HIDDEN:
+          break;
+      }
+    }
+  }
+  return num_uncovered_fields;
+}
+
+TEST(ProceduralBoardSolverTest, TestSolveSmallBoard) {
+  const int kWidth = 3 * ProceduralBoardSolver::kChunkSize + 17;
+  const int kHeight = 2 * ProceduralBoardSolver::kChunkSize + 5;
+  ProceduralMineField mine_field(kWidth, kHeight, 0.15, 42);
+  ProceduralBoardSolver solver(&mine_field, 1000);
+  EXPECT_TRUE(solver.Solve(kWidth / 2, kHeight / 2, kWidth * kHeight));
+  EXPECT_EQ(solver.num_uncovered_fields(),
+            CheckStatesAreSound(mine_field, solver));
+  int num_safe_fields = 0;
+  for (int y = 0; y < kHeight; ++y) {
+    for (int x = 0; x < kWidth; ++x) {
+      if (!mine_field.IsMine(x, y)) {
+        ++num_safe_fields;
+      }
+    }
+  }
+  // Only the fields enclosed by mines can't be reached from the start field.
+  EXPECT_LT(0.99 * num_safe_fields, solver.num_uncovered_fields());
+  EXPECT_EQ(12, solver.num_materialized_chunks());
+  EXPECT_EQ(0, solver.num_evicted_chunks());
+  EXPECT_LT(0, solver.safe_field_requests());
+}
+
+TEST(ProceduralBoardSolverTest, TestSolveWithLimit) {
+  const int kSize = 10 * ProceduralBoardSolver::kChunkSize;
+  ProceduralMineField mine_field(kSize, kSize, 0.15, 1);
+  ProceduralBoardSolver solver(&mine_field, 1000);
+  EXPECT_TRUE(solver.Solve(kSize / 2, kSize / 2, 1000));
+  EXPECT_LE(1000, solver.num_uncovered_fields());
+  EXPECT_GT(100, solver.num_materialized_chunks());
+  const int64 num_uncovered_fields = solver.num_uncovered_fields();
+
+  // The next call continues from the current state; a single chunk may
+  // uncover more fields than the limit.
+  EXPECT_TRUE(solver.Solve(0, 0, num_uncovered_fields + 10000));
+  EXPECT_LE(num_uncovered_fields + 10000, solver.num_uncovered_fields());
+  EXPECT_EQ(solver.num_uncovered_fields(),
+            CheckStatesAreSound(mine_field, solver));
+}
+
+// Solves the same board with and without eviction; the evicted chunks keep
+// their hidden fields, so both solvers uncover the same number of fields.
+TEST(ProceduralBoardSolverTest, TestEvictChunksBehindFrontier) {
+  const int kSize = 6 * ProceduralBoardSolver::kChunkSize;
+  const int kMaxResidentChunks = 8;
+  ProceduralMineField mine_field(kSize, kSize, 0.12, 3);
+  ProceduralBoardSolver solver(&mine_field, 1000);
+  ProceduralBoardSolver evicting_solver(&mine_field, kMaxResidentChunks);
+  EXPECT_TRUE(solver.Solve(0, 0, kSize * kSize));
+  EXPECT_TRUE(evicting_solver.Solve(0, 0, kSize * kSize));
+
+  EXPECT_EQ(0, solver.num_evicted_chunks());
+  EXPECT_EQ(36, solver.num_resident_chunks());
+  EXPECT_LT(0, evicting_solver.num_evicted_chunks());
+  EXPECT_GT(evicting_solver.num_evicted_chunks(),
+            evicting_solver.num_evicted_chunks_with_hidden_fields());
+  EXPECT_GE(kMaxResidentChunks, evicting_solver.num_resident_chunks());
+  EXPECT_GT(36, evicting_solver.peak_resident_chunks());
+  EXPECT_EQ(evicting_solver.num_uncovered_fields(),
+            CheckStatesAreSound(mine_field, evicting_solver));
+  EXPECT_EQ(solver.num_uncovered_fields(),
+            evicting_solver.num_uncovered_fields());
+}
+
+// With too few chunks in memory for the frontier, the chunks on the frontier
+// are evicted too, and the number of chunks in memory stays bounded.
+TEST(ProceduralBoardSolverTest, TestEvictChunksOnFrontier) {
+  const int kSize = 6 * ProceduralBoardSolver::kChunkSize;
+  const int kMaxResidentChunks = 2;
+  ProceduralMineField mine_field(kSize, kSize, 0.12, 3);
+  ProceduralBoardSolver evicting_solver(&mine_field, kMaxResidentChunks);
+  EXPECT_TRUE(evicting_solver.Solve(kSize / 2, kSize / 2, kSize * kSize / 2));
+
+  EXPECT_GE(kMaxResidentChunks, evicting_solver.num_resident_chunks());
+  EXPECT_LT(0, evicting_solver.num_evicted_chunks_with_hidden_fields());
+  EXPECT_EQ(evicting_solver.num_uncovered_fields(),
+            CheckStatesAreSound(mine_field, evicting_solver));
+  EXPECT_LE(kSize * kSize / 2, evicting_solver.num_uncovered_fields());
+}
+
+TEST(ProceduralBoardSolverTest, TestUnboundedBoard) {
+  const int kMaxSize = 2000000000;
+  const int kStart = kMaxSize / 2;
+  ProceduralMineField mine_field(kMaxSize, kMaxSize, 0.15, 2012);
+  ProceduralBoardSolver solver(&mine_field, 16);
+  EXPECT_TRUE(solver.Solve(kStart, kStart, 50000));
+  EXPECT_LE(50000, solver.num_uncovered_fields());
+  EXPECT_GT(200, solver.num_materialized_chunks());
+  EXPECT_GE(16, solver.num_resident_chunks());
+  const int kRadius = 1000;
+  for (int y = kStart - kRadius; y < kStart + kRadius; ++y) {
+    for (int x = kStart - kRadius; x < kStart + kRadius; ++x) {
+      const MineSeekerField::State state = solver.StateAtPosition(x, y);
+      if (state == MineSeekerField::UNCOVERED) {
+        ASSERT_FALSE(mine_field.IsMine(x, y));
+      } else if (state == MineSeekerField::MINE) {
+        ASSERT_TRUE(mine_field.IsMine(x, y));
+      }
+    }
+  }
+}
+
+}  // namespace mineseeker
@@ -0,0 +1,90 @@
+// Copyright 2012 Ondrej Sykora
+//
+// This file is part of MineSeeker.
+//
+// MineSeeker is free software: you can redistribute it and/or modify it under
+// the terms of the GNU General Public License as published by the Free
+// Software Foundation, either version 3 of the License, or (at your option)
+// any later version.
+//
+// MineSeeker is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+// more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// MineSeeker. If not, see <http://www.gnu.org/licenses/>.
+
+#include "procedural_mine_field.h"
+
+#include "glog/logging.h"
+
+namespace mineseeker {
+
+const int ProceduralMineField::kMineInField;
+
+namespace {
+// The increment of the Weyl sequence and the finalizer of SplitMix64, the same
+// as in CounterRandom.
+const uint64 kGoldenGamma = 0x9e3779b97f4a7c15ULL;
+
+uint64 Mix(uint64 value) {
+  value = (value ^ (value >> 30)) * 0xbf58476d1ce4e5b9ULL;
+  value = (value ^ (value >> 27)) * 0x94d049bb133111ebULL;
+  return value ^ (value >> 31);
+}
+
+// Returns the threshold of the hashes of the fields with mines for the given
+// density.
+uint64 DensityThreshold(double density) {
+  CHECK_GE(density, 0.0);
+  CHECK_LE(density, 1.0);
+  // 2^64 can't be represented by uint64; the fields with the largest hash
+  // never contain a mine.
+  const double kTwoToThe64 = 18446744073709551616.0;
+  if (density >= 1.0) {
+    return ~0ULL;
+  }
+  return static_cast<uint64>(density * kTwoToThe64);
+}
+}  // namespace
+
+ProceduralMineField::ProceduralMineField(int width,
+                                         int height,
+                                         double density,
+                                         uint64 seed)
+    : width_(width),
+      height_(height),
+      density_(density),
+      seed_(seed),
+      threshold_(DensityThreshold(density)) {
+  CHECK_GT(width, 0);
+  CHECK_GT(height, 0);
+}
+
+uint64 ProceduralMineField::Hash(int x, int y) const {
+  const uint64 position =
+      (static_cast<uint64>(y) << 32) | static_cast<uint32_t>(x);
+  return Mix(Mix(seed_) + (position + 1) * kGoldenGamma);
+}
+
+int ProceduralMineField::NumberOfMinesAroundField(int x, int y) const {
+  CHECK_GE(x, 0);
+  CHECK_LT(x, width_);
+  CHECK_GE(y, 0);
+  CHECK_LT(y, height_);
+  if (IsMine(x, y)) {
+    return kMineInField;
+  }
+  int num_mines = 0;
+  for (int j = y - 1; j <= y + 1; ++j) {
+    for (int i = x - 1; i <= x + 1; ++i) {
+      if ((i != x || j != y) && IsMine(i, j)) {
+        ++num_mines;
+      }
+    }
+  }
+  return num_mines;
+}
+
+}  // namespace mineseeker
@@ -0,0 +1,82 @@
+// Copyright 2012 Ondrej Sykora
+//
+// This file is part of MineSeeker.
+//
+// MineSeeker is free software: you can redistribute it and/or modify it under
+// the terms of the GNU General Public License as published by the Free
+// Software Foundation, either version 3 of the License, or (at your option)
+// any later version.
+//
+// MineSeeker is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+// more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// MineSeeker. If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef MINESEEKER_PROCEDURAL_MINE_FIELD_H_
+#define MINESEEKER_PROCEDURAL_MINE_FIELD_H_
+
+#include "common.h"
+#include "mine_source.h"
+
+namespace mineseeker {
+
+// A mine field whose mines are a deterministic hash of the seed and the
+// coordinates of the field. Nothing is stored, so the mine field can be as
+// large as the coordinates allow; each field contains a mine with the given
+// probability, independently of the other fields. All methods are
+// thread-safe.
+//
+// Typical usage:
+// ProceduralMineField mine_field(kMaxSize, kMaxSize, 0.15, seed);
+// if (!mine_field.IsMine(x, y)) {
+//   const int mines_around = mine_field.NumberOfMinesAroundField(x, y);
+//   ...
+// }
+class ProceduralMineField : public MineSource {
+ public:
+  // The value returned by NumberOfMinesAroundField for fields with a mine;
+  // the same as MineSweeper::kMineInField.
+  static const int kMineInField = -1;
+
+  // Creates a mine field of the given size, where each field contains a mine
+  // with probability 'density'.
+  ProceduralMineField(int width, int height, double density, uint64 seed);
+
+  // Checks if there is a mine at the position (x, y). Returns false for
+  // positions outside of the mine field.
+  virtual bool IsMine(int x, int y) const {
+    if (x < 0 || y < 0 || x >= width_ || y >= height_) {
+      return false;
+    }
+    return Hash(x, y) < threshold_;
+  }
+  // Returns the number of mines around the field, or kMineInField if the
+  // field itself contains a mine.
+  int NumberOfMinesAroundField(int x, int y) const;
+
+  virtual int width() const { return width_; }
+  virtual int height() const { return height_; }
+  double density() const { return density_; }
+  uint64 seed() const { return seed_; }
+
+ private:
+  // Returns the hash of the position (x, y).
+  uint64 Hash(int x, int y) const;
+
+  const int width_;
+  const int height_;
+  const double density_;
+  const uint64 seed_;
+  // A field contains a mine if its hash is below the threshold.
+  const uint64 threshold_;
+
+  ProceduralMineField(const ProceduralMineField&);
+  void operator=(const ProceduralMineField&);
+};
+
+}  // namespace mineseeker
+
+#endif  // MINESEEKER_PROCEDURAL_MINE_FIELD_H_
@@ -0,0 +1,92 @@
+// Copyright 2012 Ondrej Sykora
+//
+// This file is part of MineSeeker.
+//
+// MineSeeker is free software: you can redistribute it and/or modify it under
+// the terms of the GNU General Public License as published by the Free
+// Software Foundation, either version 3 of the License, or (at your option)
+// any later version.
+//
+// MineSeeker is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+// more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// MineSeeker. If not, see <http://www.gnu.org/licenses/>.
+
+#include "procedural_mine_field.h"
+
+#include "common.h"
+#include "glog/logging.h"
+#include "gtest/gtest.h"
+
+namespace mineseeker {
+
+TEST(ProceduralMineFieldTest, TestIsMine) {
+  const int kSize = 200;
+  const double kDensity = 0.2;
+  ProceduralMineField mine_field(kSize, kSize, kDensity, 12345);
+  ProceduralMineField same_mine_field(kSize, kSize, kDensity, 12345);
+  ProceduralMineField other_mine_field(kSize, kSize, kDensity, 54321);
+  EXPECT_EQ(kSize, mine_field.width());
+  EXPECT_EQ(kSize, mine_field.height());
+  int num_mines = 0;
+  int num_differences = 0;
+  for (int y = 0; y < kSize; ++y) {
+    for (int x = 0; x < kSize; ++x) {
+      EXPECT_EQ(mine_field.IsMine(x, y), same_mine_field.IsMine(x, y));
+      if (mine_field.IsMine(x, y)) {
+        ++num_mines;
+      }
+      if (mine_field.IsMine(x, y) != other_mine_field.IsMine(x, y)) {
+        ++num_differences;
+      }
+    }
+  }
+  // The expected number of mines is 8000, with a standard deviation of 80.
+  EXPECT_LT(7500, num_mines);
+  EXPECT_GT(8500, num_mines);
+  EXPECT_LT(5000, num_differences);
+  EXPECT_FALSE(mine_field.IsMine(-1, 0));
+  EXPECT_FALSE(mine_field.IsMine(0, kSize));
+}
+
+TEST(ProceduralMineFieldTest, TestNumberOfMinesAroundField) {
+  const int kSize = 50;
+  ProceduralMineField mine_field(kSize, kSize, 0.3, 7);
+  for (int y = 0; y < kSize; ++y) {
+    for (int x = 0; x < kSize; ++x) {
+      if (mine_field.IsMine(x, y)) {
+        EXPECT_EQ(ProceduralMineField::kMineInField,
+                  mine_field.NumberOfMinesAroundField(x, y));
+        continue;
+      }
+      int num_mines = 0;
+      for (int j = y - 1; j <= y + 1; ++j) {
+        for (int i = x - 1; i <= x + 1; ++i) {
+          if (i >= 0 && j >= 0 && i < kSize && j < kSize
+              && mine_field.IsMine(i, j)) {
+            ++num_mines;
+          }
+        }
+      }
+      EXPECT_EQ(num_mines, mine_field.NumberOfMinesAroundField(x, y));
+    }
+  }
+}
+
+TEST(ProceduralMineFieldTest, TestDensityLimits) {
+  const int kMaxSize = 2000000000;
+  ProceduralMineField no_mines(kMaxSize, kMaxSize, 0.0, 1);
+  ProceduralMineField all_mines(kMaxSize, kMaxSize, 1.0, 1);
+  for (int i = 0; i < 1000; ++i) {
+    const int x = kMaxSize - 1 - i * 1000003;
+    const int y = i * 999983;
+    EXPECT_FALSE(no_mines.IsMine(x, y));
+    EXPECT_TRUE(all_mines.IsMine(x, y));
+  }
+  EXPECT_EQ(0, no_mines.NumberOfMinesAroundField(kMaxSize - 1, kMaxSize - 1));
+}
+
+}  // namespace mineseeker
@@ -0,0 +1,163 @@
+// Copyright 2012 Ondrej Sykora
+//
+// This file is part of MineSeeker.
+//
+// MineSeeker is free software: you can redistribute it and/or modify it under
+// the terms of the GNU General Public License as published by the Free
+// Software Foundation, either version 3 of the License, or (at your option)
+// any later version.
+//
+// MineSeeker is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+// more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// MineSeeker. If not, see <http://www.gnu.org/licenses/>.
+
+#include "propagation_scheduler.h"
+
+#include <time.h>
+#include <sstream>
+
+#include "glog/logging.h"
+
+namespace mineseeker {
+
+const int64 PropagationScheduler::kUnlimitedBudget = -1;
+
+namespace {
+// Returns the value of a monotonic clock in nanoseconds.
+int64 MonotonicTimeNs() {
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return static_cast<int64>(now.tv_sec) * 1000000000LL + now.tv_nsec;
+}
+}  // namespace
+
+PropagationScheduler::PropagationScheduler()
+    : perf_counters_(NULL), current_tier_(-1) {}
+
+PropagationScheduler::~PropagationScheduler() {
+  for (int i = 0; i < tiers_.size(); ++i) {
+    delete tiers_[i].tier;
+  }
+}
+
+int PropagationScheduler::AddTier(const string& name,
+                                  PropagationTier* tier,
+                                  int64 budget) {
+  CHECK_NOTNULL(tier);
+  CHECK(budget >= 0 || budget == kUnlimitedBudget);
+  Tier new_tier;
+  new_tier.name = name;
+  new_tier.tier = tier;
+  new_tier.budget = budget;
+  tiers_.push_back(new_tier);
+  return tiers_.size() - 1;
+}
+
+bool PropagationScheduler::HasBudget(const Tier& tier) const {
+  return tier.budget == kUnlimitedBudget
+      || tier.statistics.num_steps < tier.budget;
+}
+
+bool PropagationScheduler::HasPendingWork() const {
+  for (int i = 0; i < tiers_.size(); ++i) {
+    if (HasBudget(tiers_[i]) && tiers_[i].tier->HasPendingWork()) {
+      return true;
+    }
+  }
+  return false;
+}
+
+bool PropagationScheduler::RunStep() {
+  for (int i = 0; i < tiers_.size(); ++i) {
+    Tier* const tier = &tiers_[i];
+    if (!tier->tier->HasPendingWork()) {
+      continue;
+    }
+    if (!HasBudget(*tier)) {
+      ++tier->statistics.num_skipped_for_budget;
+      continue;
+    }
+    PerfCounterValues start_counters;
+    if (perf_counters_ != NULL) {
+      perf_counters_->Read(&start_counters);
+    }
+    const int64 start_time = MonotonicTimeNs();
+    current_tier_ = i;
+    const bool result = tier->tier->RunStep();
+    current_tier_ = -1;
+    tier->statistics.total_time_ns += MonotonicTimeNs() - start_time;
+    if (perf_counters_ != NULL) {
+      PerfCounterValues end_counters;
+      perf_counters_->Read(&end_counters);
+      end_counters.Subtract(start_counters);
+      tier->statistics.perf_counters.Add(end_counters);
+    }
+    ++tier->statistics.num_steps;
+    if (!result) {
+      ++tier->statistics.num_failed_steps;
+    }
+    return result;
+  }
+  return false;
+}
+
+const string& PropagationScheduler::tier_name(int tier) const {
+  CHECK_GE(tier, 0);
+  CHECK_LT(tier, tiers_.size());
+  return tiers_[tier].name;
+}
+
+int64 PropagationScheduler::tier_budget(int tier) const {
+  CHECK_GE(tier, 0);
+  CHECK_LT(tier, tiers_.size());
+  return tiers_[tier].budget;
+}
+
+void PropagationScheduler::set_tier_budget(int tier, int64 budget) {
+  CHECK_GE(tier, 0);
+  CHECK_LT(tier, tiers_.size());
+  CHECK(budget >= 0 || budget == kUnlimitedBudget);
+  tiers_[tier].budget = budget;
+}
+
+const PropagationTierStatistics& PropagationScheduler::tier_statistics(
+    int tier) const {
+  CHECK_GE(tier, 0);
+  CHECK_LT(tier, tiers_.size());
+  return tiers_[tier].statistics;
+}
+
+void PropagationScheduler::ResetStatistics() {
+  for (int i = 0; i < tiers_.size(); ++i) {
+    tiers_[i].statistics = PropagationTierStatistics();
+  }
+}
+
+void PropagationScheduler::DebugString(string* out) const {
+  CHECK_NOTNULL(out);
+  std::stringstream out_stream;
+  for (int i = 0; i < tiers_.size(); ++i) {
+    const Tier& tier = tiers_[i];
+    out_stream << tier.name << ": steps = " << tier.statistics.num_steps
+               << ", failed = " << tier.statistics.num_failed_steps
+               << ", skipped = " << tier.statistics.num_skipped_for_budget
+               << ", time = " << tier.statistics.total_time_ns / 1000 << " us";
+    if (perf_counters_ != NULL) {
+      for (int counter = 0; counter < PerfCounterValues::kNumCounters;
+           ++counter) {
+        if (perf_counters_->IsAvailable(counter)) {
+          out_stream << ", " << PerfCounterValues::CounterName(counter)
+                     << " = " << tier.statistics.perf_counters.values[counter];
+        }
+      }
+    }
+    out_stream << std::endl;
+  }
+  *out = out_stream.str();
+}
+
+}  // namespace mineseeker
@@ -0,0 +1,175 @@
+// Copyright 2012 Ondrej Sykora
+//
+// This file is part of MineSeeker.
+//
+// MineSeeker is free software: you can redistribute it and/or modify it under
+// the terms of the GNU General Public License as published by the Free
+// Software Foundation, either version 3 of the License, or (at your option)
+// any later version.
+//
+// MineSeeker is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+// more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// MineSeeker. If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef MINESEEKER_PROPAGATION_SCHEDULER_H_
+#define MINESEEKER_PROPAGATION_SCHEDULER_H_
+
+#include "common.h"
+#include "perf_counters.h"
+
+namespace mineseeker {
+
+// A single tier of propagation in the PropagationScheduler. Each tier is a
+// source of work of a certain cost (e.g. uncovering fields, filtering the
+// configurations of a single field, enumerating a connected component of the
+// frontier), and it performs the work one step at a time.
+class PropagationTier {
+ public:
+  virtual ~PropagationTier() {}
+
+  // Returns true if the tier has some work that can be done.
+  virtual bool HasPendingWork() const = 0;
+  // Performs a single unit of work. Returns false if the tier could not make
+  // any progress; in such case, the scheduler stops.
+  virtual bool RunStep() = 0;
+};
+
+// Implements PropagationTier by calling methods of an object. This allows the
+// owner of the scheduler to implement the tiers as its (private) methods.
+template<typename T>
+class MethodPropagationTier : public PropagationTier {
+ public:
+  typedef bool (T::*HasPendingWorkMethod)() const;
+  typedef bool (T::*RunStepMethod)();
+
+  MethodPropagationTier(T* object,
+                        HasPendingWorkMethod has_pending_work,
+                        RunStepMethod run_step)
+      : object_(object),
+        has_pending_work_(has_pending_work),
+        run_step_(run_step) {}
+
+  virtual bool HasPendingWork() const {
+    return (object_->*has_pending_work_)();
+  }
+  virtual bool RunStep() { return (object_->*run_step_)(); }
+
+ private:
+  T* object_;
+  HasPendingWorkMethod has_pending_work_;
+  RunStepMethod run_step_;
+};
+
+// Statistics collected by the scheduler for a single tier.
+struct PropagationTierStatistics {
+  PropagationTierStatistics()
+      : num_steps(0),
+        num_failed_steps(0),
+        num_skipped_for_budget(0),
+        total_time_ns(0) {}
+
+  // The number of steps performed by the tier.
+  int64 num_steps;
+  // The number of steps, in which the tier did not make any progress.
+  int64 num_failed_steps;
+  // The number of times the tier had pending work, but it was not run because
+  // it ran out of its budget.
+  int64 num_skipped_for_budget;
+  // The total time spent in the steps of the tier, in nanoseconds.
+  int64 total_time_ns;
+  // The values of the hardware performance counters accumulated over the steps
+  // of the tier. Collected only when the scheduler has performance counters.
+  PerfCounterValues perf_counters;
+};
+
+// Schedules work between an ordered list of propagation tiers. The tiers are
+// ordered by the cost of their work, starting with the cheapest one. In each
+// step, the scheduler runs a single step of the cheapest tier that has pending
+// work; an expensive tier is thus only run when all the cheaper tiers ran out
+// of work.
+//
+// Each tier has a budget - the maximal number of steps it can perform. When the
+// budget of the tier is exhausted, the scheduler skips the tier even if it
+// has pending work.
+//
+// Typical usage:
+// PropagationScheduler scheduler;
+// scheduler.AddTier("uncover", new MyUncoverTier(),
+//                   PropagationScheduler::kUnlimitedBudget);
+// scheduler.AddTier("search", new MySearchTier(), 1000);
+// while (scheduler.RunStep()) {}
+class PropagationScheduler {
+ public:
+  // The budget for tiers that are not limited in the number of steps.
+  static const int64 kUnlimitedBudget;
+
+  PropagationScheduler();
+  ~PropagationScheduler();
+
+  // Adds a new tier to the scheduler. The tier is added after all tiers that
+  // were added before, i.e. it is more expensive than them. Takes ownership of
+  // the tier. Returns the index of the new tier.
+  int AddTier(const string& name, PropagationTier* tier, int64 budget);
+
+  // Runs a single step of the cheapest tier that has pending work and that has
+  // not exhausted its budget. Returns the result of the step of the tier, or
+  // false if no tier could be run.
+  bool RunStep();
+
+  // Returns true if at least one tier has pending work and remaining budget.
+  bool HasPendingWork() const;
+
+  // Information about the tiers.
+  int num_tiers() const { return tiers_.size(); }
+  const string& tier_name(int tier) const;
+  int64 tier_budget(int tier) const;
+  void set_tier_budget(int tier, int64 budget);
+  const PropagationTierStatistics& tier_statistics(int tier) const;
+  // Returns the index of the tier whose step is running, or -1 when no step
+  // is running.
+  int current_tier() const { return current_tier_; }
+
+  // Sets the performance counters that are read around each step of the tiers
+  // and accumulated in the statistics of the tiers. Reading the counters has a
+  // cost comparable to a cheap step, so they are not read by default. The
+  // scheduler does not take ownership of the counters; they must belong to the
+  // thread that runs the scheduler. Pass NULL to stop collecting the counters.
+  void set_perf_counters(const PerfCounters* perf_counters) {
+    perf_counters_ = perf_counters;
+  }
+
+  // Resets the statistics of all tiers. The budgets of the tiers are counted
+  // from the statistics, so this method also restores the budgets.
+  void ResetStatistics();
+
+  // Exports the statistics of all tiers to a human-readable string. Erases any
+  // content that was stored in out previously.
+  void DebugString(string* out) const;
+
+ private:
+  struct Tier {
+    string name;
+    PropagationTier* tier;
+    int64 budget;
+    PropagationTierStatistics statistics;
+  };
+
+  // Returns true if the tier still has some budget left.
+  bool HasBudget(const Tier& tier) const;
+
+  vector<Tier> tiers_;
+  const PerfCounters* perf_counters_;
+  int current_tier_;
+
+  // The scheduler owns the tiers; copying the scheduler is not allowed.
+  PropagationScheduler(const PropagationScheduler&);
+  void operator=(const PropagationScheduler&);
+};
+
+}  // namespace mineseeker
+
+#endif  // MINESEEKER_PROPAGATION_SCHEDULER_H_
@@ -0,0 +1,194 @@
+// Copyright 2012 Ondrej Sykora
+//
+// This file is part of MineSeeker.
+//
+// MineSeeker is free software: you can redistribute it and/or modify it under
+// the terms of the GNU General Public License as published by the Free
+// Software Foundation, either version 3 of the License, or (at your option)
+// any later version.
+//
+// MineSeeker is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+// more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// MineSeeker. If not, see <http://www.gnu.org/licenses/>.
+
+#include "common.h"
+#include "glog/logging.h"
+#include "gtest/gtest.h"
+#include "propagation_scheduler.h"
+
+namespace mineseeker {
+
+namespace {
+// A propagation tier that has a given number of steps of pending work. Each
+// step appends the name of the tier to a shared log, so that the tests can
+// check the order in which the steps were run.
+class LoggingTier : public PropagationTier {
+ public:
+  LoggingTier(const string& name, int num_pending_steps, string* log)
+      : name_(name),
+        num_pending_steps_(num_pending_steps),
+        log_(log) {}
+
+  virtual bool HasPendingWork() const { return num_pending_steps_ > 0; }
+  virtual bool RunStep() {
+    --num_pending_steps_;
+    log_->append(name_);
+    return true;
+  }
+
+  void AddPendingSteps(int num_steps) { num_pending_steps_ += num_steps; }
+
+ private:
+  const string name_;
+  int num_pending_steps_;
+  string* log_;
+};
+
+// A propagation tier that always has pending work, but never makes progress.
+class FailingTier : public PropagationTier {
+ public:
+  virtual bool HasPendingWork() const { return true; }
+  virtual bool RunStep() { return false; }
+};
+
+// A propagation tier with a single step that records the current tier of the
+// scheduler during the step.
+class CurrentTierTier : public PropagationTier {
+ public:
+  CurrentTierTier(const PropagationScheduler* scheduler, int* current_tier)
+      : scheduler_(scheduler), current_tier_(current_tier), done_(false) {}
+
+  virtual bool HasPendingWork() const { return !done_; }
+  virtual bool RunStep() {
+    *current_tier_ = scheduler_->current_tier();
+    done_ = true;
+    return true;
+  }
+
+ private:
+  const PropagationScheduler* scheduler_;
+  int* current_tier_;
+  bool done_;
+};
+}  // namespace
+
+TEST(PropagationSchedulerTest, TestNoTiers) {
+  PropagationScheduler scheduler;
+  EXPECT_EQ(0, scheduler.num_tiers());
+  EXPECT_FALSE(scheduler.HasPendingWork());
+  EXPECT_FALSE(scheduler.RunStep());
+}
+
+TEST(PropagationSchedulerTest, TestRunsCheapestTierFirst) {
+  PropagationScheduler scheduler;
+  string log;
+  LoggingTier* const cheap_tier = new LoggingTier("a", 2, &log);
+  EXPECT_EQ(0, scheduler.AddTier("cheap", cheap_tier,
+                                 PropagationScheduler::kUnlimitedBudget));
+  EXPECT_EQ(1, scheduler.AddTier("expensive", new LoggingTier("b", 3, &log),
+                                 PropagationScheduler::kUnlimitedBudget));
+  EXPECT_EQ(2, scheduler.num_tiers());
+  EXPECT_EQ("cheap", scheduler.tier_name(0));
+  EXPECT_EQ("expensive", scheduler.tier_name(1));
+
+  EXPECT_TRUE(scheduler.RunStep());
+  EXPECT_TRUE(scheduler.RunStep());
+  EXPECT_TRUE(scheduler.RunStep());
+  EXPECT_EQ("aab", log);
+
+  // New work in the cheap tier is done before the rest of the expensive work.
+  cheap_tier->AddPendingSteps(1);
+  while (scheduler.RunStep()) {}
+  EXPECT_EQ("aababb", log);
+  EXPECT_FALSE(scheduler.HasPendingWork());
+
+  EXPECT_EQ(3, scheduler.tier_statistics(0).num_steps);
+  EXPECT_EQ(3, scheduler.tier_statistics(1).num_steps);
+  EXPECT_EQ(0, scheduler.tier_statistics(0).num_failed_steps);
+}
+
+TEST(PropagationSchedulerTest, TestBudget) {
+  PropagationScheduler scheduler;
+  string log;
+  scheduler.AddTier("cheap", new LoggingTier("a", 5, &log), 2);
+  scheduler.AddTier("expensive", new LoggingTier("b", 2, &log),
+                    PropagationScheduler::kUnlimitedBudget);
+  EXPECT_EQ(2, scheduler.tier_budget(0));
+
+  while (scheduler.RunStep()) {}
+  EXPECT_EQ("aabb", log);
+  EXPECT_EQ(2, scheduler.tier_statistics(0).num_steps);
+  EXPECT_EQ(3, scheduler.tier_statistics(0).num_skipped_for_budget);
+  EXPECT_FALSE(scheduler.HasPendingWork());
+
+  // Raising the budget allows the tier to finish its work.
+  scheduler.set_tier_budget(0, 4);
+  EXPECT_TRUE(scheduler.HasPendingWork());
+  while (scheduler.RunStep()) {}
+  EXPECT_EQ("aabbaa", log);
+
+  scheduler.ResetStatistics();
+  EXPECT_EQ(0, scheduler.tier_statistics(0).num_steps);
+  EXPECT_TRUE(scheduler.HasPendingWork());
+}
+
+TEST(PropagationSchedulerTest, TestFailedStep) {
+  PropagationScheduler scheduler;
+  string log;
+  scheduler.AddTier("cheap", new LoggingTier("a", 1, &log),
+                    PropagationScheduler::kUnlimitedBudget);
+  scheduler.AddTier("failing", new FailingTier(),
+                    PropagationScheduler::kUnlimitedBudget);
+
+  EXPECT_TRUE(scheduler.RunStep());
+  EXPECT_FALSE(scheduler.RunStep());
+  EXPECT_EQ("a", log);
+  EXPECT_EQ(1, scheduler.tier_statistics(1).num_steps);
+  EXPECT_EQ(1, scheduler.tier_statistics(1).num_failed_steps);
+
+  string debug_output;
+  scheduler.DebugString(&debug_output);
+  EXPECT_NE(string::npos, debug_output.find("failing: steps = 1"));
+}
+
+TEST(PropagationSchedulerTest, TestCurrentTier) {
+  PropagationScheduler scheduler;
+  string log;
+  int current_tier = -1;
+  scheduler.AddTier("cheap", new LoggingTier("a", 1, &log),
+                    PropagationScheduler::kUnlimitedBudget);
+  scheduler.AddTier("current", new CurrentTierTier(&scheduler, &current_tier),
+                    PropagationScheduler::kUnlimitedBudget);
+  EXPECT_EQ(-1, scheduler.current_tier());
+
+  while (scheduler.RunStep()) {}
+  EXPECT_EQ(1, current_tier);
+  EXPECT_EQ(-1, scheduler.current_tier());
+}
+
+TEST(PropagationSchedulerTest, TestPerfCounters) {
+  PerfCounters perf_counters;
+  PropagationScheduler scheduler;
+  scheduler.set_perf_counters(&perf_counters);
+  string log;
+  scheduler.AddTier("cheap", new LoggingTier("a", 100, &log),
+                    PropagationScheduler::kUnlimitedBudget);
+
+  while (scheduler.RunStep()) {}
+  EXPECT_EQ(100, scheduler.tier_statistics(0).num_steps);
+  const PerfCounterValues& counters =
+      scheduler.tier_statistics(0).perf_counters;
+  if (perf_counters.IsAvailable(PerfCounterValues::INSTRUCTIONS)) {
+    EXPECT_LT(0, counters.values[PerfCounterValues::INSTRUCTIONS]);
+  } else {
+    // The counters are not available in this environment; the statistics are
+    // collected without them.
+    EXPECT_EQ(0, counters.values[PerfCounterValues::INSTRUCTIONS]);
+  }
+}
+
+}  // namespace mineseeker
@@ -0,0 +1,169 @@
+// Copyright 2012 Ondrej Sykora
+//
+// This file is part of MineSeeker.
+//
+// MineSeeker is free software: you can redistribute it and/or modify it under
+// the terms of the GNU General Public License as published by the Free
+// Software Foundation, either version 3 of the License, or (at your option)
+// any later version.
+//
+// MineSeeker is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+// more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// MineSeeker. If not, see <http://www.gnu.org/licenses/>.
+
+#include "solver_statistics.h"
+
+#include <algorithm>
+#include <sstream>
+
+#include "glog/logging.h"
+
+namespace mineseeker {
+
+const int SolverStatistics::kNumConfigurationCountBuckets;
+
+namespace {
+// Writes the string as a JSON string literal, with quotes.
+void WriteJsonString(const string& value, std::ostream* out) {
+  *out << '"';
+  for (int i = 0; i < value.size(); ++i) {
+    const char c = value[i];
+    if (c == '"' || c == '\\') {
+      *out << '\\';
+    }
+    *out << c;
+  }
+  *out << '"';
+}
+}  // namespace
+
+SolverStatistics::SolverStatistics() {
+  Reset();
+}
+
+void SolverStatistics::Reset() {
+  solve_time_ns = 0;
+  safe_field_requests = 0;
+  guesses = 0;
+  num_configuration_removals = 0;
+  for (int i = 0; i < kNumQueues; ++i) {
+    num_queue_pushes[i] = 0;
+    num_queue_pops[i] = 0;
+  }
+  num_pair_checks = 0;
+  num_redundant_pair_checks = 0;
+  for (int i = 0; i < phases.size(); ++i) {
+    const string name = phases[i].name;
+    phases[i] = Phase();
+    phases[i].name = name;
+  }
+  for (int i = 0; i < kNumConfigurationCountBuckets; ++i) {
+    configuration_count_histogram[i] = 0;
+  }
+}
+
+void SolverStatistics::Add(const SolverStatistics& other) {
+  solve_time_ns += other.solve_time_ns;
+  safe_field_requests += other.safe_field_requests;
+  guesses += other.guesses;
+  num_configuration_removals += other.num_configuration_removals;
+  for (int i = 0; i < kNumQueues; ++i) {
+    num_queue_pushes[i] += other.num_queue_pushes[i];
+    num_queue_pops[i] += other.num_queue_pops[i];
+  }
+  num_pair_checks += other.num_pair_checks;
+  num_redundant_pair_checks += other.num_redundant_pair_checks;
+  if (!other.phases.empty()) {
+    if (phases.empty()) {
+      phases.resize(other.phases.size());
+      for (int i = 0; i < phases.size(); ++i) {
+        phases[i].name = other.phases[i].name;
+      }
+    }
+    CHECK_EQ(phases.size(), other.phases.size());
+    for (int i = 0; i < phases.size(); ++i) {
+      phases[i].num_steps += other.phases[i].num_steps;
+      phases[i].time_ns += other.phases[i].time_ns;
+      phases[i].num_resolved_fields += other.phases[i].num_resolved_fields;
+    }
+  }
+  for (int i = 0; i < kNumConfigurationCountBuckets; ++i) {
+    configuration_count_histogram[i] += other.configuration_count_histogram[i];
+  }
+}
+
+int SolverStatistics::ConfigurationCountBucket(int num_configurations) {
+  DCHECK_GE(num_configurations, 0);
+  DCHECK_LE(num_configurations, 256);
+  if (num_configurations == 0) {
+    return 0;
+  }
+  return 32 - __builtin_clz(num_configurations);
+}
+
+const char* SolverStatistics::QueueName(int queue) {
+  switch (queue) {
+    case UNCOVER_QUEUE:
+      return "uncover";
+    case UPDATE_QUEUE:
+      return "update";
+    case SUBSET_UPDATE_QUEUE:
+      return "subset_update";
+    case PAIR_UPDATE_QUEUE:
+      return "pair_update";
+    default:
+      LOG(FATAL) << "Invalid queue: " << queue;
+  }
+  return NULL;
+}
+
+void SolverStatistics::ToJson(string* out) const {
+  CHECK_NOTNULL(out);
+  std::stringstream out_stream;
+  out_stream << "{\"solve_time_ns\": " << solve_time_ns
+             << ", \"safe_field_requests\": " << safe_field_requests
+             << ", \"guesses\": " << guesses
+             << ", \"configuration_removals\": " << num_configuration_removals
+             << ", \"queues\": {";
+  for (int i = 0; i < kNumQueues; ++i) {
+    if (i > 0) {
+      out_stream << ", ";
+    }
+    out_stream << "\"" << QueueName(i) << "\": {\"pushes\": "
+               << num_queue_pushes[i] << ", \"pops\": " << num_queue_pops[i]
+               << "}";
+  }
+  out_stream << "}, \"pair_checks\": " << num_pair_checks
+             << ", \"redundant_pair_checks\": " << num_redundant_pair_checks
+             << ", \"phases\": [";
+  for (int i = 0; i < phases.size(); ++i) {
+    const Phase& phase = phases[i];
+    if (i > 0) {
+      out_stream << ", ";
+    }
+    out_stream << "{\"name\": ";
+    WriteJsonString(phase.name, &out_stream);
+    out_stream << ", \"steps\": " << phase.num_steps
+               << ", \"time_ns\": " << phase.time_ns
+               << ", \"resolved_fields\": " << phase.num_resolved_fields
+               << "}";
+  }
+  out_stream << "], \"configuration_count_histogram\": [";
+  for (int i = 0; i < kNumConfigurationCountBuckets; ++i) {
+    if (i > 0) {
+      out_stream << ", ";
+    }
+    const int min_count = i == 0 ? 0 : 1 << (i - 1);
+    const int max_count = i == 0 ? 0 : std::min(256, (1 << i) - 1);
+    out_stream << "{\"min\": " << min_count << ", \"max\": " << max_count
+               << ", \"count\": " << configuration_count_histogram[i] << "}";
+  }
+  out_stream << "]}";
+  *out = out_stream.str();
+}
+
+}  // namespace mineseeker
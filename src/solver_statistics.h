@@ -0,0 +1,114 @@
+// Copyright 2012 Ondrej Sykora
+//
+// This file is part of MineSeeker.
+//
+// MineSeeker is free software: you can redistribute it and/or modify it under
+// the terms of the GNU General Public License as published by the Free
+// Software Foundation, either version 3 of the License, or (at your option)
+// any later version.
+//
+// MineSeeker is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+// more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// MineSeeker. If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef MINESEEKER_SOLVER_STATISTICS_H_
+#define MINESEEKER_SOLVER_STATISTICS_H_
+
+#include "common.h"
+
+namespace mineseeker {
+
+// Statistics of a single solve: counters of the work done by the solver,
+// the times spent in the phases (propagation tiers) of the solver and a
+// histogram of the sizes of the sets of configurations. The counters count all
+// work done by the solver, including the work that was later undone by rolling
+// back to a checkpoint.
+//
+// Typical usage:
+// MineSeeker mine_seeker(mine_sweeper);
+// mine_seeker.Solve();
+// SolverStatistics statistics;
+// mine_seeker.GetStatistics(&statistics);
+// string json;
+// statistics.ToJson(&json);
+struct SolverStatistics {
+  // The work queues of the solver.
+  enum Queue {
+    UNCOVER_QUEUE,
+    UPDATE_QUEUE,
+    SUBSET_UPDATE_QUEUE,
+    PAIR_UPDATE_QUEUE,
+    // The number of queues; not a valid queue.
+    kNumQueues,
+  };
+  // The number of buckets of the histogram of the sizes of the sets of
+  // configurations. The bucket 0 contains empty sets, and the bucket i > 0
+  // contains the sets with 2^(i-1) to 2^i - 1 configurations; the last bucket
+  // contains only the set of all 256 configurations.
+  static const int kNumConfigurationCountBuckets = 10;
+
+  // The statistics of a single phase of the solver.
+  struct Phase {
+    Phase() : num_steps(0), time_ns(0), num_resolved_fields(0) {}
+
+    string name;
+    // The number of steps of the phase and the total time spent in them.
+    int64 num_steps;
+    int64 time_ns;
+    // The number of fields uncovered or marked as mines by the phase.
+    int64 num_resolved_fields;
+  };
+
+  SolverStatistics();
+
+  // Resets all counters to zero; keeps the phases and their names.
+  void Reset();
+  // Adds the counters of another object to this one. The phases are matched
+  // by their indices; the other object may not have any phases.
+  void Add(const SolverStatistics& other);
+
+  // Adds a set with the given number of configurations to the histogram.
+  void AddConfigurationCount(int num_configurations) {
+    ++configuration_count_histogram[
+        ConfigurationCountBucket(num_configurations)];
+  }
+  // Returns the bucket of the histogram for the given number of
+  // configurations.
+  static int ConfigurationCountBucket(int num_configurations);
+  // Returns the name of the queue, e.g. "uncover".
+  static const char* QueueName(int queue);
+
+  // Exports the statistics as a JSON object. Erases any content that was
+  // stored in out previously.
+  void ToJson(string* out) const;
+
+  // The total time spent in MineSeeker::Solve.
+  int64 solve_time_ns;
+  // The number of hints and guesses used by the solver; see
+  // MineSeeker::safe_field_requests and MineSeeker::guesses.
+  int64 safe_field_requests;
+  int64 guesses;
+  // The number of configurations removed from the sets of the fields.
+  int64 num_configuration_removals;
+  // The numbers of items pushed to and popped from the queues. The items moved
+  // between the queues of the parallel propagation are not counted.
+  int64 num_queue_pushes[kNumQueues];
+  int64 num_queue_pops[kNumQueues];
+  // The number of checks of pairs of fields, and the number of the checks
+  // that did not change anything.
+  int64 num_pair_checks;
+  int64 num_redundant_pair_checks;
+  // The phases of the solver, in the order of the propagation tiers.
+  vector<Phase> phases;
+  // The histogram of the sizes of the sets of configurations, sampled each
+  // time the configurations of an uncovered field are filtered.
+  int64 configuration_count_histogram[kNumConfigurationCountBuckets];
+};
+
+}  // namespace mineseeker
+
+#endif  // MINESEEKER_SOLVER_STATISTICS_H_
@@ -0,0 +1,89 @@
+// Copyright 2012 Ondrej Sykora
+//
+// This file is part of MineSeeker.
+//
+// MineSeeker is free software: you can redistribute it and/or modify it under
+// the terms of the GNU General Public License as published by the Free
+// Software Foundation, either version 3 of the License, or (at your option)
+// any later version.
+//
+// MineSeeker is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+// more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// MineSeeker. If not, see <http://www.gnu.org/licenses/>.
+
+#include "common.h"
+#include "glog/logging.h"
+#include "gtest/gtest.h"
+#include "solver_statistics.h"
+
+namespace mineseeker {
+
+TEST(SolverStatisticsTest, TestConfigurationCountBucket) {
+  EXPECT_EQ(0, SolverStatistics::ConfigurationCountBucket(0));
+  EXPECT_EQ(1, SolverStatistics::ConfigurationCountBucket(1));
+  EXPECT_EQ(2, SolverStatistics::ConfigurationCountBucket(2));
+  EXPECT_EQ(2, SolverStatistics::ConfigurationCountBucket(3));
+  EXPECT_EQ(3, SolverStatistics::ConfigurationCountBucket(4));
+  EXPECT_EQ(8, SolverStatistics::ConfigurationCountBucket(255));
+  EXPECT_EQ(SolverStatistics::kNumConfigurationCountBuckets - 1,
+            SolverStatistics::ConfigurationCountBucket(256));
+}
+
+TEST(SolverStatisticsTest, TestAddAndReset) {
+  SolverStatistics first;
+  first.phases.resize(2);
+  first.phases[0].name = "first";
+  first.phases[1].name = "second";
+  first.phases[1].num_resolved_fields = 3;
+  first.num_queue_pushes[SolverStatistics::PAIR_UPDATE_QUEUE] = 5;
+  first.AddConfigurationCount(7);
+
+  // Statistics without phases can be added to statistics with phases, and the
+  // other way round.
+  SolverStatistics second;
+  second.num_pair_checks = 2;
+  second.Add(first);
+  second.Add(first);
+  first.Add(second);
+  ASSERT_EQ(2, second.phases.size());
+  EXPECT_EQ("second", second.phases[1].name);
+  EXPECT_EQ(6, second.phases[1].num_resolved_fields);
+  EXPECT_EQ(10,
+            second.num_queue_pushes[SolverStatistics::PAIR_UPDATE_QUEUE]);
+  EXPECT_EQ(2, second.configuration_count_histogram[3]);
+  EXPECT_EQ(2, first.num_pair_checks);
+  EXPECT_EQ(9, first.phases[1].num_resolved_fields);
+
+  first.Reset();
+  ASSERT_EQ(2, first.phases.size());
+  EXPECT_EQ("first", first.phases[0].name);
+  EXPECT_EQ(0, first.phases[1].num_resolved_fields);
+  EXPECT_EQ(0, first.num_pair_checks);
+  EXPECT_EQ(0, first.configuration_count_histogram[3]);
+}
+
+TEST(SolverStatisticsTest, TestToJson) {
+  SolverStatistics statistics;
+  statistics.phases.resize(1);
+  statistics.phases[0].name = "re\"veal";
+  statistics.phases[0].num_steps = 4;
+  statistics.num_queue_pops[SolverStatistics::UNCOVER_QUEUE] = 12;
+  statistics.AddConfigurationCount(256);
+
+  string json;
+  statistics.ToJson(&json);
+  EXPECT_EQ('{', json[0]);
+  EXPECT_EQ('}', json[json.size() - 1]);
+  EXPECT_NE(string::npos,
+            json.find("\"uncover\": {\"pushes\": 0, \"pops\": 12}"));
+  EXPECT_NE(string::npos,
+            json.find("{\"name\": \"re\\\"veal\", \"steps\": 4"));
+  EXPECT_NE(string::npos,
+            json.find("{\"min\": 256, \"max\": 256, \"count\": 1}"));
+}
+
+}  // namespace mineseeker
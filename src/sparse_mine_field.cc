@@ -0,0 +1,222 @@
+// Copyright 2012 Ondrej Sykora
+//
+// This file is part of MineSeeker.
+//
+// MineSeeker is free software: you can redistribute it and/or modify it under
+// the terms of the GNU General Public License as published by the Free
+// Software Foundation, either version 3 of the License, or (at your option)
+// any later version.
+//
+// MineSeeker is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+// more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// MineSeeker. If not, see <http://www.gnu.org/licenses/>.
+
+#include "sparse_mine_field.h"
+
+#include <algorithm>
+#include <unordered_set>
+
+#include "glog/logging.h"
+
+namespace mineseeker {
+
+const int SparseMineField::kMineInField;
+const int SparseMineField::kTileSize;
+const int SparseMineField::kNumCachedTiles = 256;
+
+SparseMineField::SparseMineField(int width, int height)
+    : width_(width),
+      height_(height),
+      tiles_per_row_((width + kTileSize - 1) / kTileSize),
+      num_mines_(0),
+      num_hits_(0),
+      num_misses_(0) {
+  CHECK_GT(width, 0);
+  CHECK_GT(height, 0);
+}
+
+const vector<int>* SparseMineField::Row(int y) const {
+  const std::unordered_map<int, vector<int> >::const_iterator row =
+      rows_.find(y);
+  return row == rows_.end() ? NULL : &row->second;
+}
+
+bool SparseMineField::IsMine(int x, int y) const {
+  CHECK_GE(x, 0);
+  CHECK_LT(x, width_);
+  CHECK_GE(y, 0);
+  CHECK_LT(y, height_);
+  const vector<int>* const row = Row(y);
+  return row != NULL && std::binary_search(row->begin(), row->end(), x);
+}
+
+bool SparseMineField::SetMine(int x, int y, bool is_mine) {
+  CHECK_GE(x, 0);
+  CHECK_LT(x, width_);
+  CHECK_GE(y, 0);
+  CHECK_LT(y, height_);
+  vector<int>* const row = &rows_[y];
+  const vector<int>::iterator position =
+      std::lower_bound(row->begin(), row->end(), x);
+  const bool was_mine = position != row->end() && *position == x;
+  if (was_mine == is_mine) {
+    if (row->empty()) {
+      rows_.erase(y);
+    }
+    return false;
+  }
+  if (is_mine) {
+    row->insert(position, x);
+    ++num_mines_;
+  } else {
+    row->erase(position);
+    --num_mines_;
+    if (row->empty()) {
+      rows_.erase(y);
+    }
+  }
+  std::lock_guard<std::mutex> lock(mutex_);
+  UpdateCachedTiles(x, y, is_mine);
+  return true;
+}
+
+int SparseMineField::CountMinesAround(int x, int y) const {
+  int num_mines = 0;
+  for (int row_y = std::max(0, y - 1); row_y <= std::min(height_ - 1, y + 1);
+       ++row_y) {
+    const vector<int>* const row = Row(row_y);
+    if (row == NULL) {
+      continue;
+    }
+    for (vector<int>::const_iterator it =
+             std::lower_bound(row->begin(), row->end(), x - 1);
+         it != row->end() && *it <= x + 1; ++it) {
+      if (*it != x || row_y != y) {
+        ++num_mines;
+      }
+    }
+  }
+  return num_mines;
+}
+
+void SparseMineField::ComputeTile(int64 key, Tile* tile) const {
+  tile->key = key;
+  std::fill(tile->counts, tile->counts + ARRAYSIZE(tile->counts), 0);
+  const int tile_x = (key % tiles_per_row_) * kTileSize;
+  const int tile_y = (key / tiles_per_row_) * kTileSize;
+  // Each mine in the tile or next to it adds one to its neighbors in the tile;
+  // the fields with mines are marked after all mines were counted.
+  for (int y = std::max(0, tile_y - 1);
+       y <= std::min(height_ - 1, tile_y + kTileSize); ++y) {
+    const vector<int>* const row = Row(y);
+    if (row == NULL) {
+      continue;
+    }
+    for (vector<int>::const_iterator it =
+             std::lower_bound(row->begin(), row->end(), tile_x - 1);
+         it != row->end() && *it <= tile_x + kTileSize; ++it) {
+      for (int j = std::max(tile_y, y - 1);
+           j <= std::min(tile_y + kTileSize - 1, y + 1); ++j) {
+        for (int i = std::max(tile_x, *it - 1);
+             i <= std::min(tile_x + kTileSize - 1, *it + 1); ++i) {
+          ++tile->counts[(j - tile_y) * kTileSize + i - tile_x];
+        }
+      }
+    }
+  }
+  for (int y = tile_y; y < std::min(height_, tile_y + kTileSize); ++y) {
+    const vector<int>* const row = Row(y);
+    if (row == NULL) {
+      continue;
+    }
+    for (vector<int>::const_iterator it =
+             std::lower_bound(row->begin(), row->end(), tile_x);
+         it != row->end() && *it < tile_x + kTileSize; ++it) {
+      tile->counts[(y - tile_y) * kTileSize + *it - tile_x] = kMineInField;
+    }
+  }
+}
+
+int SparseMineField::NumberOfMinesAroundField(int x, int y) const {
+  CHECK_GE(x, 0);
+  CHECK_LT(x, width_);
+  CHECK_GE(y, 0);
+  CHECK_LT(y, height_);
+  const int64 key = TileKey(x, y);
+  const int index = (y % kTileSize) * kTileSize + x % kTileSize;
+  std::lock_guard<std::mutex> lock(mutex_);
+  const std::unordered_map<int64, TileList::iterator>::iterator cached =
+      tile_index_.find(key);
+  if (cached != tile_index_.end()) {
+    ++num_hits_;
+    tiles_.splice(tiles_.begin(), tiles_, cached->second);
+    return tiles_.front().counts[index];
+  }
+  ++num_misses_;
+  if (tiles_.size() < kNumCachedTiles) {
+    tiles_.push_front(Tile());
+  } else {
+    // The least recently used tile is reused for the new one.
+    tile_index_.erase(tiles_.back().key);
+    tiles_.splice(tiles_.begin(), tiles_, --tiles_.end());
+  }
+  ComputeTile(key, &tiles_.front());
+  tile_index_[key] = tiles_.begin();
+  return tiles_.front().counts[index];
+}
+
+void SparseMineField::UpdateCachedTiles(int x, int y, bool is_mine) {
+  for (int j = std::max(0, y - 1); j <= std::min(height_ - 1, y + 1); ++j) {
+    for (int i = std::max(0, x - 1); i <= std::min(width_ - 1, x + 1); ++i) {
+      const std::unordered_map<int64, TileList::iterator>::iterator cached =
+          tile_index_.find(TileKey(i, j));
+      if (cached == tile_index_.end()) {
+        continue;
+      }
+      int8* const count =
+          &cached->second->counts[(j % kTileSize) * kTileSize + i % kTileSize];
+      if (i == x && j == y) {
+        *count = is_mine ? kMineInField : CountMinesAround(x, y);
+      } else if (*count != kMineInField) {
+        *count += is_mine ? 1 : -1;
+      }
+    }
+  }
+}
+
+int64 SparseMineField::CountFieldsNearMines() const {
+  std::unordered_set<int64> fields;
+  fields.reserve(9 * num_mines_);
+  for (std::unordered_map<int, vector<int> >::const_iterator row =
+           rows_.begin();
+       row != rows_.end(); ++row) {
+    const int y = row->first;
+    for (int k = 0; k < row->second.size(); ++k) {
+      const int x = row->second[k];
+      for (int j = std::max(0, y - 1); j <= std::min(height_ - 1, y + 1);
+           ++j) {
+        for (int i = std::max(0, x - 1); i <= std::min(width_ - 1, x + 1);
+             ++i) {
+          fields.insert(static_cast<int64>(j) * width_ + i);
+        }
+      }
+    }
+  }
+  return fields.size();
+}
+
+int64 SparseMineField::num_hits() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return num_hits_;
+}
+
+int64 SparseMineField::num_misses() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return num_misses_;
+}
+
+}  // namespace mineseeker
@@ -0,0 +1,126 @@
+// Copyright 2012 Ondrej Sykora
+//
+// This file is part of MineSeeker.
+//
+// MineSeeker is free software: you can redistribute it and/or modify it under
+// the terms of the GNU General Public License as published by the Free
+// Software Foundation, either version 3 of the License, or (at your option)
+// any later version.
+//
+// MineSeeker is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+// more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// MineSeeker. If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef MINESEEKER_SPARSE_MINE_FIELD_H_
+#define MINESEEKER_SPARSE_MINE_FIELD_H_
+
+#include <list>
+#include <mutex>
+#include <unordered_map>
+
+#include "common.h"
+
+namespace mineseeker {
+
+// Stores the mines of a large mine field with few mines. The mines are kept in
+// a sorted index of the x coordinates for each row that has a mine, so the
+// memory is proportional to the number of mines, not to the size of the mine
+// field. The numbers of neighboring mines are not stored; they are computed on
+// demand for square tiles of the mine field, and the most recently used tiles
+// are kept in a small LRU cache. Changes of the mines update the cached tiles
+// in place.
+//
+// The methods that read the mine field are thread-safe; the cache is protected
+// by a mutex. The changes of the mines must not run concurrently with any
+// other method.
+//
+// Typical usage:
+// SparseMineField mine_field(1000000, 1000000);
+// mine_field.SetMine(12345, 67890, true);
+// const int mines_around = mine_field.NumberOfMinesAroundField(12345, 67891);
+class SparseMineField {
+ public:
+  // The value returned by NumberOfMinesAroundField for fields with a mine;
+  // the same as MineSweeper::kMineInField.
+  static const int kMineInField = -1;
+  // The width and the height of the cached tiles.
+  static const int kTileSize = 32;
+  // The number of tiles kept in the cache.
+  static const int kNumCachedTiles;
+
+  // Creates an empty mine field of the given size.
+  SparseMineField(int width, int height);
+
+  // Places or removes a mine at the given position. Returns true if the
+  // mine field changed.
+  bool SetMine(int x, int y, bool is_mine);
+  // Checks if there is a mine at the position (x, y). Does not use the cache.
+  bool IsMine(int x, int y) const;
+  // Returns the number of mines around the field, or kMineInField if the
+  // field itself contains a mine.
+  int NumberOfMinesAroundField(int x, int y) const;
+
+  // Returns the number of fields that contain a mine or have a mine among
+  // their neighbors. Takes time proportional to the number of mines.
+  int64 CountFieldsNearMines() const;
+
+  int width() const { return width_; }
+  int height() const { return height_; }
+  int num_mines() const { return num_mines_; }
+
+  // Returns the number of calls of NumberOfMinesAroundField that found their
+  // tile in the cache, and the number of calls that had to compute the tile.
+  int64 num_hits() const;
+  int64 num_misses() const;
+
+ private:
+  // The numbers of neighboring mines of a tile, indexed by
+  // (y % kTileSize) * kTileSize + x % kTileSize.
+  struct Tile {
+    int64 key;
+    int8 counts[kTileSize * kTileSize];
+  };
+  typedef std::list<Tile> TileList;
+
+  // Returns the key of the tile that contains the field (x, y).
+  int64 TileKey(int x, int y) const {
+    return static_cast<int64>(y / kTileSize) * tiles_per_row_ + x / kTileSize;
+  }
+  // Returns the sorted x coordinates of the mines in the row, or NULL if the
+  // row has no mines.
+  const vector<int>* Row(int y) const;
+  // Counts the mines around the field directly from the index.
+  int CountMinesAround(int x, int y) const;
+  // Computes the numbers of neighboring mines of the tile with the given key.
+  void ComputeTile(int64 key, Tile* tile) const;
+  // Updates the cached tiles around the field (x, y) after a mine was placed
+  // to or removed from the field. Must be called with mutex_ held.
+  void UpdateCachedTiles(int x, int y, bool is_mine);
+
+  const int width_;
+  const int height_;
+  const int64 tiles_per_row_;
+  int num_mines_;
+  // The x coordinates of the mines in each row that has at least one mine.
+  std::unordered_map<int, vector<int> > rows_;
+
+  // Protects the cache and its statistics.
+  mutable std::mutex mutex_;
+  // The cached tiles, the most recently used one first, and the index of the
+  // tiles by their keys.
+  mutable TileList tiles_;
+  mutable std::unordered_map<int64, TileList::iterator> tile_index_;
+  mutable int64 num_hits_;
+  mutable int64 num_misses_;
+
+  SparseMineField(const SparseMineField&);
+  void operator=(const SparseMineField&);
+};
+
+}  // namespace mineseeker
+
+#endif  // MINESEEKER_SPARSE_MINE_FIELD_H_
@@ -0,0 +1,123 @@
+// Copyright 2012 Ondrej Sykora
+//
+// This file is part of MineSeeker.
+//
+// MineSeeker is free software: you can redistribute it and/or modify it under
+// the terms of the GNU General Public License as published by the Free
+// Software Foundation, either version 3 of the License, or (at your option)
+// any later version.
+//
+// MineSeeker is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+// more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// MineSeeker. If not, see <http://www.gnu.org/licenses/>.
+
+#include "sparse_mine_field.h"
+
+#include <random>
+
+#include "common.h"
+#include "glog/logging.h"
+#include "gtest/gtest.h"
+
+namespace mineseeker {
+
+// Computes the number of mines around the field (x, y) from a dense matrix of
+// mines.
+int CountMinesInMatrix(const vector<vector<bool> >& mines, int x, int y) {
+  if (mines[x][y]) {
+    return SparseMineField::kMineInField;
+  }
+  int num_mines = 0;
+  for (int i = x - 1; i <= x + 1; ++i) {
+    for (int j = y - 1; j <= y + 1; ++j) {
+      if (i >= 0 && j >= 0 && i < mines.size() && j < mines[i].size()
+          && mines[i][j]) {
+        ++num_mines;
+      }
+    }
+  }
+  return num_mines;
+}
+
+TEST(SparseMineFieldTest, TestSetMine) {
+  SparseMineField mine_field(10, 5);
+  EXPECT_EQ(10, mine_field.width());
+  EXPECT_EQ(5, mine_field.height());
+  EXPECT_EQ(0, mine_field.num_mines());
+  EXPECT_FALSE(mine_field.IsMine(3, 2));
+
+  EXPECT_TRUE(mine_field.SetMine(3, 2, true));
+  EXPECT_FALSE(mine_field.SetMine(3, 2, true));
+  EXPECT_TRUE(mine_field.SetMine(4, 2, true));
+  EXPECT_EQ(2, mine_field.num_mines());
+  EXPECT_TRUE(mine_field.IsMine(3, 2));
+  EXPECT_EQ(SparseMineField::kMineInField,
+            mine_field.NumberOfMinesAroundField(3, 2));
+  EXPECT_EQ(2, mine_field.NumberOfMinesAroundField(3, 1));
+  EXPECT_EQ(1, mine_field.NumberOfMinesAroundField(5, 3));
+  EXPECT_EQ(0, mine_field.NumberOfMinesAroundField(0, 0));
+  // Two mines and their neighbors; the mines are next to each other.
+  EXPECT_EQ(12, mine_field.CountFieldsNearMines());
+
+  // The cached tile is updated by the changes.
+  EXPECT_TRUE(mine_field.SetMine(3, 2, false));
+  EXPECT_FALSE(mine_field.SetMine(3, 2, false));
+  EXPECT_EQ(1, mine_field.num_mines());
+  EXPECT_EQ(1, mine_field.NumberOfMinesAroundField(3, 2));
+  EXPECT_EQ(1, mine_field.NumberOfMinesAroundField(3, 1));
+  EXPECT_EQ(9, mine_field.CountFieldsNearMines());
+}
+
+// Compares the numbers with a dense matrix on a mine field with many tiles,
+// so that the tiles are evicted from the cache and the changes update both
+// the cached and the evicted tiles.
+TEST(SparseMineFieldTest, TestMatchesDenseMatrix) {
+  const int kWidth = 20 * SparseMineField::kTileSize + 7;
+  const int kHeight = 15 * SparseMineField::kTileSize + 3;
+  const int kNumChanges = 20000;
+  const int kNumQueries = 20000;
+  std::mt19937 random(17);
+  std::uniform_int_distribution<int> x_distribution(0, kWidth - 1);
+  std::uniform_int_distribution<int> y_distribution(0, kHeight - 1);
+
+  SparseMineField mine_field(kWidth, kHeight);
+  vector<vector<bool> > mines(kWidth, vector<bool>(kHeight, false));
+  for (int round = 0; round < 3; ++round) {
+    for (int i = 0; i < kNumChanges; ++i) {
+      const int x = x_distribution(random);
+      const int y = y_distribution(random);
+      const bool is_mine = random() % 2 == 0;
+      EXPECT_EQ(mines[x][y] != is_mine, mine_field.SetMine(x, y, is_mine));
+      mines[x][y] = is_mine;
+    }
+    for (int i = 0; i < kNumQueries; ++i) {
+      const int x = x_distribution(random);
+      const int y = y_distribution(random);
+      ASSERT_EQ(CountMinesInMatrix(mines, x, y),
+                mine_field.NumberOfMinesAroundField(x, y))
+          << "Field " << x << " " << y;
+    }
+  }
+  EXPECT_GT(mine_field.num_hits(), 0);
+  EXPECT_GT(mine_field.num_misses(), SparseMineField::kNumCachedTiles);
+}
+
+TEST(SparseMineFieldTest, TestHugeMineField) {
+  const int kSize = 1000000;
+  SparseMineField mine_field(kSize, kSize);
+  mine_field.SetMine(0, 0, true);
+  mine_field.SetMine(kSize - 1, kSize - 1, true);
+  mine_field.SetMine(500000, 123456, true);
+  EXPECT_EQ(3, mine_field.num_mines());
+  EXPECT_EQ(1, mine_field.NumberOfMinesAroundField(1, 1));
+  EXPECT_EQ(1, mine_field.NumberOfMinesAroundField(kSize - 2, kSize - 1));
+  EXPECT_EQ(1, mine_field.NumberOfMinesAroundField(500001, 123457));
+  EXPECT_EQ(0, mine_field.NumberOfMinesAroundField(500002, 123457));
+  EXPECT_EQ(4 + 4 + 9, mine_field.CountFieldsNearMines());
+}
+
+}  // namespace mineseeker
@@ -0,0 +1,223 @@
+// Copyright 2012 Ondrej Sykora
+//
+// This file is part of MineSeeker.
+//
+// MineSeeker is free software: you can redistribute it and/or modify it under
+// the terms of the GNU General Public License as published by the Free
+// Software Foundation, either version 3 of the License, or (at your option)
+// any later version.
+//
+// MineSeeker is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+// more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// MineSeeker. If not, see <http://www.gnu.org/licenses/>.
+
+#include "streaming_board_solver.h"
+
+#include <algorithm>
+#include <deque>
+
+#include "binary_board.h"
+#include "glog/logging.h"
+#include "mine_source.h"
+#include "mineseeker.h"
+#include "minesweeper.h"
+#include "propagation_scheduler.h"
+
+namespace mineseeker {
+
+const int StreamingBoardSolver::kContextRows = 2;
+
+namespace {
+// A mine source over a band of consecutive rows of the mine field. The rows
+// are appended at the bottom and dropped from the top as the band slides
+// down; the positions in the rows that are not in the band must not be
+// queried.
+class BandMineSource : public MineSource {
+ public:
+  BandMineSource(int width, int height)
+      : width_(width), height_(height), first_row_(0) {}
+
+  virtual bool IsMine(int x, int y) const {
+    if (x < 0 || x >= width_ || y < 0 || y >= height_) {
+      return false;
+    }
+    DCHECK_GE(y, first_row_);
+    DCHECK_LT(y, end_row());
+    return rows_[y - first_row_][x];
+  }
+  virtual int width() const { return width_; }
+  virtual int height() const { return height_; }
+
+  // The index of the row after the last row of the band.
+  int end_row() const { return first_row_ + rows_.size(); }
+  int num_rows() const { return rows_.size(); }
+
+  // Appends a row at the bottom of the band. Erases the content of 'mines'.
+  void AddRow(vector<bool>* mines) {
+    CHECK_NOTNULL(mines);
+    rows_.push_back(vector<bool>());
+    rows_.back().swap(*mines);
+  }
+  // Removes the rows above 'row' from the band.
+  void DropRowsBefore(int row) {
+    while (first_row_ < row && !rows_.empty()) {
+      rows_.pop_front();
+      ++first_row_;
+    }
+  }
+
+ private:
+  const int width_;
+  const int height_;
+  int first_row_;
+  std::deque<vector<bool> > rows_;
+};
+}  // namespace
+
+StreamingBoardSolver::StreamingBoardSolver(int window_rows)
+    : window_rows_(window_rows),
+      safe_field_requests_(0),
+      num_uncovered_fields_(0),
+      num_band_solves_(0),
+      peak_resident_rows_(0) {
+  CHECK_GE(window_rows, 4);
+}
+
+bool StreamingBoardSolver::Solve(std::istream* in, std::ostream* out) {
+  CHECK_NOTNULL(in);
+  CHECK_NOTNULL(out);
+  safe_field_requests_ = 0;
+  num_uncovered_fields_ = 0;
+  num_band_solves_ = 0;
+  peak_resident_rows_ = 0;
+
+  BinaryBoardReader reader(in);
+  if (!reader.ReadHeader()) {
+    return false;
+  }
+  const int width = reader.width();
+  const int height = reader.height();
+  BandMineSource mine_source(width, height);
+  // The states of the rows from states_first_row; the rows are written to the
+  // output when they leave the context of the band.
+  std::deque<string> states;
+  int states_first_row = 0;
+  vector<bool> mines;
+
+  // The first row that is not final.
+  int next_row = 0;
+  while (next_row < height) {
+    ++num_band_solves_;
+    const int band_start = std::max(0, next_row - kContextRows);
+    const int band_end = std::min(height, next_row + window_rows_);
+    // The numbers of the fields in the band depend also on the rows right
+    // above and below it.
+    while (mine_source.end_row() < std::min(height, band_end + 1)) {
+      if (!reader.ReadRow(&mines)) {
+        return false;
+      }
+      mine_source.AddRow(&mines);
+    }
+    mine_source.DropRowsBefore(band_start - 1);
+    peak_resident_rows_ = std::max(peak_resident_rows_,
+                                   mine_source.num_rows());
+    while (states_first_row < band_start) {
+      out->write(states.front().data(), width);
+      states.pop_front();
+      ++states_first_row;
+    }
+    while (states_first_row + states.size() < band_end) {
+      states.push_back(string(width, MineSeekerField::HIDDEN));
+    }
+
+    const MineSweeper band(&mine_source, 0, band_start, width,
+                           band_end - band_start);
+    MineSeeker seeker(band);
+    seeker.UseEnumerationInsteadOfLocalTiers();
+    seeker.mutable_scheduler()->set_tier_budget(MineSeeker::GUESS_TIER, 0);
+    for (int y = 0; y < band.height(); ++y) {
+      for (int x = 0; x < width; ++x) {
+        if (states[y][x] == MineSeekerField::MINE) {
+          seeker.MarkAsMine(x, y);
+        }
+      }
+    }
+    for (int y = 0; y < band.height(); ++y) {
+      for (int x = 0; x < width; ++x) {
+        if (states[y][x] == MineSeekerField::UNCOVERED
+            && !band.IsOnWindowBorder(x, y)) {
+          seeker.UncoverField(x, y);
+        }
+      }
+    }
+    seeker.ContinueSolving();
+
+    // The upper half of the rows of the band is finished with hints, so that
+    // the lower half provides the uncovered fields for the next band. The
+    // last band is finished completely.
+    const int last_final_row = band_end == height
+        ? height
+        : next_row + (band_end - next_row) / 2;
+    for (int row = next_row; row < last_final_row; ++row) {
+      const int y = row - band_start;
+      for (;;) {
+        if (seeker.is_dead()) {
+          LOG(ERROR) << "The solver stepped on a mine in the band at row "
+                     << band_start;
+          return false;
+        }
+        // Prefer the fields with no mines around them, which uncover a
+        // region of the board.
+        int hint_x = -1;
+        for (int x = 0; x < width; ++x) {
+          if (seeker.StateAtPosition(x, y) == MineSeekerField::HIDDEN
+              && !band.IsMine(x, y)) {
+            if (band.NumberOfMinesAroundField(x, y) == 0) {
+              hint_x = x;
+              break;
+            }
+            if (hint_x < 0) {
+              hint_x = x;
+            }
+          }
+        }
+        if (hint_x < 0) {
+          break;
+        }
+        ++safe_field_requests_;
+        seeker.UncoverField(hint_x, y);
+        seeker.ContinueSolving();
+      }
+    }
+    if (seeker.is_dead()) {
+      LOG(ERROR) << "The solver stepped on a mine in the band at row "
+                 << band_start;
+      return false;
+    }
+
+    for (int y = 0; y < band.height(); ++y) {
+      for (int x = 0; x < width; ++x) {
+        const MineSeekerField::State state = seeker.StateAtPosition(x, y);
+        if (state == MineSeekerField::HIDDEN
+            || states[y][x] != MineSeekerField::HIDDEN) {
+          continue;
+        }
+        states[y][x] = state;
+        if (state == MineSeekerField::UNCOVERED) {
+          ++num_uncovered_fields_;
+        }
+      }
+    }
+    next_row = last_final_row;
+  }
+  for (int i = 0; i < states.size(); ++i) {
+    out->write(states[i].data(), width);
+  }
+  return out->good();
+}
+
+}  // namespace mineseeker
@@ -0,0 +1,84 @@
+// Copyright 2012 Ondrej Sykora
+//
+// This file is part of MineSeeker.
+//
+// MineSeeker is free software: you can redistribute it and/or modify it under
+// the terms of the GNU General Public License as published by the Free
+// Software Foundation, either version 3 of the License, or (at your option)
+// any later version.
+//
+// MineSeeker is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+// more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// MineSeeker. If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef MINESEEKER_STREAMING_BOARD_SOLVER_H_
+#define MINESEEKER_STREAMING_BOARD_SOLVER_H_
+
+#include <istream>
+#include <ostream>
+
+#include "common.h"
+
+namespace mineseeker {
+
+// Solves a mine field in the binary format (see binary_board.h) that does not
+// fit in the memory, by streaming it from the top to the bottom in horizontal
+// bands.
+//
+// The solver keeps only a sliding band of window_rows rows in memory, together
+// with the kContextRows rows above it and the row below it. It solves the band
+// with a MineSeeker on a window of the rows (see MineSweeper::WINDOW), asks for
+// safe fields until the upper half of the band is uncovered, and then slides
+// the band down. The rows that leave the context are final; they are written
+// to the output and removed from the memory. The peak memory is thus
+// proportional to width * window_rows, regardless of the height of the mine
+// field.
+//
+// Typical usage:
+// StreamingBoardSolver solver(64);
+// std::ofstream states("states.bin");
+// if (!solver.Solve(&std::cin, &states)) { ... }
+class StreamingBoardSolver {
+ public:
+  // The number of final rows kept above the band. The fields of the first row
+  // below them are constrained by the uncovered fields of the lower row; the
+  // upper row is on the border of the window, and its numbers count mines
+  // that are no longer in the memory.
+  static const int kContextRows;
+
+  // Creates a solver that solves bands of window_rows rows; there must be at
+  // least four rows in a band.
+  explicit StreamingBoardSolver(int window_rows);
+
+  // Reads the mine field from 'in' and writes the states of its fields to
+  // 'out' as soon as their rows are final. Each row is written as width bytes
+  // with the values of MineSeekerField::State. Returns false if the input is
+  // not a valid mine field or the solver stepped on a mine. Does not take
+  // ownership of the streams.
+  bool Solve(std::istream* in, std::ostream* out);
+
+  // Statistics of the last solve.
+  int64 safe_field_requests() const { return safe_field_requests_; }
+  int64 num_uncovered_fields() const { return num_uncovered_fields_; }
+  int64 num_band_solves() const { return num_band_solves_; }
+  // The largest number of rows of mines that were in memory at the same time.
+  int peak_resident_rows() const { return peak_resident_rows_; }
+
+ private:
+  const int window_rows_;
+  int64 safe_field_requests_;
+  int64 num_uncovered_fields_;
+  int64 num_band_solves_;
+  int peak_resident_rows_;
+
+  StreamingBoardSolver(const StreamingBoardSolver&);
+  void operator=(const StreamingBoardSolver&);
+};
+
+}  // namespace mineseeker
+
+#endif  // MINESEEKER_STREAMING_BOARD_SOLVER_H_
@@ -0,0 +1,104 @@
+// Copyright 2012 Ondrej Sykora
+//
+// This file is part of MineSeeker.
+//
+// MineSeeker is free software: you can redistribute it and/or modify it under
+// the terms of the GNU General Public License as published by the Free
+// Software Foundation, either version 3 of the License, or (at your option)
+// any later version.
+//
+// MineSeeker is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+// more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// MineSeeker. If not, see <http://www.gnu.org/licenses/>.
+
+#include "streaming_board_solver.h"
+
+#include <sstream>
+
+#include "binary_board.h"
+#include "common.h"
+#include "glog/logging.h"
+#include "gtest/gtest.h"
+#include "mineseeker.h"
+#include "procedural_mine_field.h"
+
+namespace mineseeker {
+
+// Writes the mine field in the binary format to 'out'.
+void WriteBinaryBoard(const ProceduralMineField& mine_field, string* out) {
+  CHECK_NOTNULL(out);
+  out->clear();
+  AppendBinaryBoardHeader(mine_field.width(), mine_field.height(), out);
+  vector<bool> row(mine_field.width());
+  for (int y = 0; y < mine_field.height(); ++y) {
+    for (int x = 0; x < mine_field.width(); ++x) {
+      row[x] = mine_field.IsMine(x, y);
+    }
+    AppendBinaryBoardRow(row, out);
+  }
+}
+
+TEST(StreamingBoardSolverTest, TestSolveBoard) {
+  const int kWidth = 150;
+  const int kHeight = 1000;
+  const int kWindowRows = 32;
+  ProceduralMineField mine_field(kWidth, kHeight, 0.15, 7);
+  string board;
+  WriteBinaryBoard(mine_field, &board);
+  std::istringstream in(board);
+  std::ostringstream out;
+  StreamingBoardSolver solver(kWindowRows);
+  ASSERT_TRUE(solver.Solve(&in, &out));
+
+  const string states = out.str();
+  ASSERT_EQ(kWidth * kHeight, states.size());
+  int num_safe_fields = 0;
+  int num_uncovered_fields = 0;
+  for (int y = 0; y < kHeight; ++y) {
+    for (int x = 0; x < kWidth; ++x) {
+      const bool is_mine = mine_field.IsMine(x, y);
+      if (!is_mine) {
+        ++num_safe_fields;
+      }
+      switch (states[y * kWidth + x]) {
+        case MineSeekerField::UNCOVERED:
+          EXPECT_FALSE(is_mine) << x << " " << y;
+          ++num_uncovered_fields;
+          break;
+        case MineSeekerField::MINE:
+          EXPECT_TRUE(is_mine) << x << " " << y;
+          break;
+        case MineSeekerField::HIDDEN:
+          EXPECT_TRUE(is_mine) << x << " " << y;
+          break;
+        default:
+          ADD_FAILURE() << "Invalid state at " << x << " " << y;
+      }
+    }
+  }
+  // The rows are finished with hints, so all safe fields are uncovered.
+  EXPECT_EQ(num_safe_fields, num_uncovered_fields);
+  EXPECT_EQ(num_uncovered_fields, solver.num_uncovered_fields());
+  EXPECT_LT(0, solver.safe_field_requests());
+  EXPECT_LT(kHeight / kWindowRows, solver.num_band_solves());
+  // The band, its context and the rows right above and below it.
+  EXPECT_GE(kWindowRows + StreamingBoardSolver::kContextRows + 2,
+            solver.peak_resident_rows());
+}
+
+TEST(StreamingBoardSolverTest, TestTruncatedBoard) {
+  ProceduralMineField mine_field(40, 100, 0.15, 3);
+  string board;
+  WriteBinaryBoard(mine_field, &board);
+  board.resize(board.size() - 50);
+  std::istringstream in(board);
+  std::ostringstream out;
+  StreamingBoardSolver solver(8);
+  EXPECT_FALSE(solver.Solve(&in, &out));
+}
+
+}  // namespace mineseeker
@@ -0,0 +1,110 @@
+// Copyright 2012 Ondrej Sykora
+//
+// This file is part of MineSeeker.
+//
+// MineSeeker is free software: you can redistribute it and/or modify it under
+// the terms of the GNU General Public License as published by the Free
+// Software Foundation, either version 3 of the License, or (at your option)
+// any later version.
+//
+// MineSeeker is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+// more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// MineSeeker. If not, see <http://www.gnu.org/licenses/>.
+
+#include "thread_pool.h"
+
+#include "glog/logging.h"
+
+namespace mineseeker {
+
+ThreadPool::ThreadPool(int num_threads)
+    : num_threads_(num_threads),
+      generation_(0),
+      num_busy_workers_(0),
+      stopping_(false),
+      task_(NULL),
+      num_items_(0),
+      next_item_(0) {
+  CHECK_GT(num_threads, 0);
+  // The calling thread of ParallelFor is one of the threads of the pool.
+  for (int i = 1; i < num_threads_; ++i) {
+    workers_.push_back(std::thread(&ThreadPool::WorkerLoop, this));
+  }
+}
+
+ThreadPool::~ThreadPool() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stopping_ = true;
+  }
+  work_available_.notify_all();
+  for (int i = 0; i < workers_.size(); ++i) {
+    workers_[i].join();
+  }
+}
+
+void ThreadPool::ParallelFor(int num_items, Task* task) {
+  CHECK_NOTNULL(task);
+  CHECK_GE(num_items, 0);
+  if (workers_.empty() || num_items <= 1) {
+    for (int item = 0; item < num_items; ++item) {
+      task->Run(item);
+    }
+    return;
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    task_ = task;
+    num_items_ = num_items;
+    next_item_.store(0);
+    num_busy_workers_ = workers_.size();
+    ++generation_;
+  }
+  work_available_.notify_all();
+  ProcessItems();
+
+  std::unique_lock<std::mutex> lock(mutex_);
+  while (num_busy_workers_ > 0) {
+    work_finished_.wait(lock);
+  }
+  task_ = NULL;
+}
+
+void ThreadPool::ProcessItems() {
+  for (;;) {
+    const int item = next_item_.fetch_add(1);
+    if (item >= num_items_) {
+      return;
+    }
+    task_->Run(item);
+  }
+}
+
+void ThreadPool::WorkerLoop() {
+  int64 last_generation = 0;
+  for (;;) {
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      while (!stopping_ && generation_ == last_generation) {
+        work_available_.wait(lock);
+      }
+      if (stopping_) {
+        return;
+      }
+      last_generation = generation_;
+    }
+    ProcessItems();
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      --num_busy_workers_;
+    }
+    work_finished_.notify_one();
+  }
+}
+
+}  // namespace mineseeker
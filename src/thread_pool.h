@@ -0,0 +1,99 @@
+// Copyright 2012 Ondrej Sykora
+//
+// This file is part of MineSeeker.
+//
+// MineSeeker is free software: you can redistribute it and/or modify it under
+// the terms of the GNU General Public License as published by the Free
+// Software Foundation, either version 3 of the License, or (at your option)
+// any later version.
+//
+// MineSeeker is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+// more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// MineSeeker. If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef MINESEEKER_THREAD_POOL_H_
+#define MINESEEKER_THREAD_POOL_H_
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+#include "common.h"
+
+namespace mineseeker {
+
+// A fixed-size pool of worker threads for running data-parallel loops. The
+// threads are created in the constructor and they wait for work until the
+// pool is destroyed.
+//
+// Typical usage:
+// class MyTask : public ThreadPool::Task {
+//  public:
+//   virtual void Run(int item) { ... }
+// };
+// ThreadPool pool(4);
+// MyTask task;
+// pool.ParallelFor(num_items, &task);
+class ThreadPool {
+ public:
+  // The interface for the body of a parallel loop.
+  class Task {
+   public:
+    virtual ~Task() {}
+    // Processes a single item of the loop. This method is called concurrently
+    // from multiple threads.
+    virtual void Run(int item) = 0;
+  };
+
+  // Creates a pool with the given number of threads. With a single thread,
+  // the loops are run directly in the calling thread.
+  explicit ThreadPool(int num_threads);
+  ~ThreadPool();
+
+  // Calls task->Run(item) for all items in [0, num_items), distributing the
+  // items among the threads of the pool. Blocks until all items are
+  // processed. The calling thread also processes items. Must not be called
+  // concurrently from multiple threads.
+  void ParallelFor(int num_items, Task* task);
+
+  int num_threads() const { return num_threads_; }
+
+ private:
+  // The main loop of the worker threads.
+  void WorkerLoop();
+  // Processes items of the current loop until there are none left.
+  void ProcessItems();
+
+  const int num_threads_;
+  vector<std::thread> workers_;
+
+  // Protects the fields below and is used with the condition variables.
+  std::mutex mutex_;
+  // Signals the workers that a new loop started or that they should stop.
+  std::condition_variable work_available_;
+  // Signals the caller of ParallelFor that the workers finished the loop.
+  std::condition_variable work_finished_;
+  // Incremented with each call to ParallelFor; the workers use it to detect
+  // new loops.
+  int64 generation_;
+  // The number of workers that are still processing the current loop.
+  int num_busy_workers_;
+  bool stopping_;
+
+  // The current loop. The next item is claimed by the threads atomically.
+  Task* task_;
+  int num_items_;
+  std::atomic<int> next_item_;
+
+  ThreadPool(const ThreadPool&);
+  void operator=(const ThreadPool&);
+};
+
+}  // namespace mineseeker
+
+#endif  // MINESEEKER_THREAD_POOL_H_
@@ -0,0 +1,68 @@
+// Copyright 2012 Ondrej Sykora
+//
+// This file is part of MineSeeker.
+//
+// MineSeeker is free software: you can redistribute it and/or modify it under
+// the terms of the GNU General Public License as published by the Free
+// Software Foundation, either version 3 of the License, or (at your option)
+// any later version.
+//
+// MineSeeker is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+// more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// MineSeeker. If not, see <http://www.gnu.org/licenses/>.
+
+#include "common.h"
+#include "glog/logging.h"
+#include "gtest/gtest.h"
+#include "thread_pool.h"
+
+namespace mineseeker {
+
+namespace {
+// Records the number of times each item was processed.
+class CountingTask : public ThreadPool::Task {
+ public:
+  explicit CountingTask(int num_items) : counts_(num_items, 0) {}
+
+  virtual void Run(int item) { ++counts_[item]; }
+
+  int count(int item) const { return counts_[item]; }
+
+ private:
+  vector<int> counts_;
+};
+}  // namespace
+
+TEST(ThreadPoolTest, TestSingleThread) {
+  ThreadPool pool(1);
+  EXPECT_EQ(1, pool.num_threads());
+  const int kNumItems = 10;
+  CountingTask task(kNumItems);
+  pool.ParallelFor(kNumItems, &task);
+  for (int i = 0; i < kNumItems; ++i) {
+    EXPECT_EQ(1, task.count(i));
+  }
+}
+
+TEST(ThreadPoolTest, TestParallelFor) {
+  const int kNumThreads = 4;
+  ThreadPool pool(kNumThreads);
+  EXPECT_EQ(kNumThreads, pool.num_threads());
+
+  // Runs several loops of different sizes to check that the pool can be
+  // reused and that each item is processed exactly once.
+  const int kNumItems[] = { 0, 1, 3, 1000, 17 };
+  for (int i = 0; i < ARRAYSIZE(kNumItems); ++i) {
+    CountingTask task(kNumItems[i]);
+    pool.ParallelFor(kNumItems[i], &task);
+    for (int item = 0; item < kNumItems[i]; ++item) {
+      EXPECT_EQ(1, task.count(item)) << "Item " << item << " of loop " << i;
+    }
+  }
+}
+
+}  // namespace mineseeker
@@ -0,0 +1,198 @@
+// Copyright 2012 Ondrej Sykora
+//
+// This file is part of MineSeeker.
+//
+// MineSeeker is free software: you can redistribute it and/or modify it under
+// the terms of the GNU General Public License as published by the Free
+// Software Foundation, either version 3 of the License, or (at your option)
+// any later version.
+//
+// MineSeeker is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+// more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// MineSeeker. If not, see <http://www.gnu.org/licenses/>.
+
+#include "tracer.h"
+
+#include <time.h>
+#include <algorithm>
+#include <limits>
+#include <sstream>
+
+#include "glog/logging.h"
+
+namespace mineseeker {
+
+const int Tracer::kDefaultEventsPerThread = 1 << 15;
+
+std::atomic<Tracer*> Tracer::active_tracer_(NULL);
+std::atomic<int64> Tracer::next_tracer_id_(0);
+
+namespace {
+// The buffer of the current thread and the identifier of the tracer that owns
+// it.
+thread_local int64 current_buffer_tracer_id = -1;
+thread_local void* current_buffer = NULL;
+}  // namespace
+
+Tracer::Tracer(int events_per_thread)
+    : id_(next_tracer_id_.fetch_add(1)),
+      events_per_thread_(events_per_thread),
+      start_time_ns_(NowNs()) {
+  CHECK_GT(events_per_thread, 0);
+}
+
+Tracer::~Tracer() {
+  CHECK(active_tracer_.load() != this) << "The tracer was not stopped";
+  for (int i = 0; i < buffers_.size(); ++i) {
+    delete buffers_[i];
+  }
+}
+
+void Tracer::Start() {
+  Tracer* expected = NULL;
+  CHECK(active_tracer_.compare_exchange_strong(expected, this))
+      << "Another tracer is already started";
+}
+
+void Tracer::Stop() {
+  Tracer* expected = this;
+  CHECK(active_tracer_.compare_exchange_strong(expected, NULL))
+      << "The tracer is not started";
+}
+
+int64 Tracer::NowNs() {
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return static_cast<int64>(now.tv_sec) * 1000000000LL + now.tv_nsec;
+}
+
+void Tracer::RecordComplete(EventType type,
+                            int64 start_ns,
+                            int x, int y,
+                            int x2, int y2) {
+  if (IsEnabled()) {
+    const int64 now = NowNs();
+    RecordEvent(type, start_ns, now - start_ns, x, y, x2, y2);
+  }
+}
+
+void Tracer::RecordEvent(EventType type,
+                         int64 time_ns,
+                         int64 duration_ns,
+                         int x, int y,
+                         int x2, int y2) {
+  Tracer* const tracer = active_tracer_.load(std::memory_order_acquire);
+  if (tracer == NULL) {
+    return;
+  }
+  ThreadBuffer* const buffer = tracer->BufferForCurrentThread();
+  Event* const event = &buffer->events[
+      buffer->num_recorded_events % buffer->events.size()];
+  event->timestamp_ns = time_ns - tracer->start_time_ns_;
+  event->duration_ns = static_cast<int32_t>(
+      std::min<int64>(duration_ns, std::numeric_limits<int32_t>::max()));
+  event->type = type;
+  event->x = x;
+  event->y = y;
+  event->x2 = x2;
+  event->y2 = y2;
+  ++buffer->num_recorded_events;
+}
+
+Tracer::ThreadBuffer* Tracer::BufferForCurrentThread() {
+  if (current_buffer_tracer_id == id_) {
+    return static_cast<ThreadBuffer*>(current_buffer);
+  }
+  std::lock_guard<std::mutex> lock(mutex_);
+  ThreadBuffer* const buffer =
+      new ThreadBuffer(buffers_.size(), events_per_thread_);
+  buffers_.push_back(buffer);
+  current_buffer_tracer_id = id_;
+  current_buffer = buffer;
+  return buffer;
+}
+
+const char* Tracer::EventTypeName(int type) {
+  switch (type) {
+    case UNCOVER:
+      return "uncover";
+    case MARK_MINE:
+      return "mark_mine";
+    case CONFIGURATION_UPDATE:
+      return "configuration_update";
+    case PAIR_UPDATE:
+      return "pair_update";
+    case HINT:
+      return "hint";
+    default:
+      LOG(FATAL) << "Invalid event type: " << type;
+  }
+  return NULL;
+}
+
+int64 Tracer::num_events() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  int64 num_events = 0;
+  for (int i = 0; i < buffers_.size(); ++i) {
+    num_events += std::min<int64>(buffers_[i]->num_recorded_events,
+                                  buffers_[i]->events.size());
+  }
+  return num_events;
+}
+
+int64 Tracer::num_dropped_events() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  int64 num_dropped_events = 0;
+  for (int i = 0; i < buffers_.size(); ++i) {
+    num_dropped_events += std::max<int64>(
+        0, buffers_[i]->num_recorded_events - buffers_[i]->events.size());
+  }
+  return num_dropped_events;
+}
+
+void Tracer::ToChromeTraceJson(string* out) const {
+  CHECK_NOTNULL(out);
+  std::lock_guard<std::mutex> lock(mutex_);
+  std::stringstream out_stream;
+  out_stream.setf(std::ios::fixed);
+  out_stream.precision(3);
+  out_stream << "{\"traceEvents\": [";
+  bool first_event = true;
+  for (int i = 0; i < buffers_.size(); ++i) {
+    const ThreadBuffer& buffer = *buffers_[i];
+    const int64 size = buffer.events.size();
+    const int64 first = std::max<int64>(0, buffer.num_recorded_events - size);
+    for (int64 j = first; j < buffer.num_recorded_events; ++j) {
+      const Event& event = buffer.events[j % size];
+      if (!first_event) {
+        out_stream << ",";
+      }
+      first_event = false;
+      // The timestamps of the trace-event format are in microseconds.
+      out_stream << "\n{\"name\": \"" << EventTypeName(event.type)
+                 << "\", \"cat\": \"solver\", \"pid\": 1, \"tid\": "
+                 << buffer.index << ", \"ts\": "
+                 << event.timestamp_ns / 1000.0;
+      if (event.duration_ns >= 0) {
+        out_stream << ", \"ph\": \"X\", \"dur\": "
+                   << event.duration_ns / 1000.0;
+      } else {
+        out_stream << ", \"ph\": \"i\", \"s\": \"t\"";
+      }
+      out_stream << ", \"args\": {\"x\": " << event.x << ", \"y\": "
+                 << event.y;
+      if (event.x2 >= 0) {
+        out_stream << ", \"x2\": " << event.x2 << ", \"y2\": " << event.y2;
+      }
+      out_stream << "}}";
+    }
+  }
+  out_stream << "\n], \"displayTimeUnit\": \"ns\"}\n";
+  *out = out_stream.str();
+}
+
+}  // namespace mineseeker
@@ -0,0 +1,198 @@
+// Copyright 2012 Ondrej Sykora
+//
+// This file is part of MineSeeker.
+//
+// MineSeeker is free software: you can redistribute it and/or modify it under
+// the terms of the GNU General Public License as published by the Free
+// Software Foundation, either version 3 of the License, or (at your option)
+// any later version.
+//
+// MineSeeker is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+// more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// MineSeeker. If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef MINESEEKER_TRACER_H_
+#define MINESEEKER_TRACER_H_
+
+#include <atomic>
+#include <mutex>
+
+#include "common.h"
+
+namespace mineseeker {
+
+// Records the events of the solver (uncovering fields, marking mines, updates
+// of configurations, pair updates and hints) with their timestamps, and
+// exports them in the Chrome trace-event format, which can be viewed in
+// chrome://tracing or Perfetto.
+//
+// The events are recorded only while a tracer is started; at most one tracer
+// can be started at a time. When no tracer is started, recording an event is
+// a single test of a global pointer. Each thread records its events to its own
+// ring buffer of a fixed size, so the threads do not wait for each other; when
+// the buffer is full, the oldest events of the thread are overwritten.
+//
+// Typical usage:
+// Tracer tracer(Tracer::kDefaultEventsPerThread);
+// tracer.Start();
+// ... run the solver ...
+// tracer.Stop();
+// string json;
+// tracer.ToChromeTraceJson(&json);
+class Tracer {
+ public:
+  // The types of the recorded events.
+  enum EventType {
+    UNCOVER,
+    MARK_MINE,
+    CONFIGURATION_UPDATE,
+    PAIR_UPDATE,
+    HINT,
+    // The number of event types; not a valid event type.
+    kNumEventTypes,
+  };
+
+  // The default size of the ring buffer of a thread. The buffer of a thread is
+  // allocated when the thread records its first event, and each event takes
+  // 32 bytes, so the default buffer takes 1 MiB per thread.
+  static const int kDefaultEventsPerThread;
+
+  // Creates a new tracer that keeps the last events_per_thread events of each
+  // thread. The tracer is not started.
+  explicit Tracer(int events_per_thread);
+  // The tracer must be stopped before it is destroyed.
+  ~Tracer();
+
+  // Starts and stops recording the events to this tracer. No other tracer may
+  // be started at the same time.
+  void Start();
+  void Stop();
+
+  // Returns true if a tracer is started.
+  static bool IsEnabled() {
+    return active_tracer_.load(std::memory_order_relaxed) != NULL;
+  }
+  // Returns the current time in nanoseconds; used for the timestamps of the
+  // events.
+  static int64 NowNs();
+  // Records an event without duration for the field (x, y) to the started
+  // tracer, if there is one.
+  static void RecordInstant(EventType type, int x, int y) {
+    if (IsEnabled()) {
+      RecordEvent(type, NowNs(), -1, x, y, -1, -1);
+    }
+  }
+  // Records an event that started at start_ns and ends now, for the field
+  // (x, y) and optionally the second field (x2, y2) of a pair.
+  static void RecordComplete(EventType type,
+                             int64 start_ns,
+                             int x, int y,
+                             int x2, int y2);
+  // Returns the name of the event type, e.g. "uncover".
+  static const char* EventTypeName(int type);
+
+  // Returns the number of events in the buffers, and the number of events that
+  // were overwritten because the buffers were full.
+  int64 num_events() const;
+  int64 num_dropped_events() const;
+
+  // Exports the recorded events in the Chrome trace-event JSON format. Erases
+  // any content that was stored in out previously. Must not be called while
+  // other threads record to the tracer.
+  void ToChromeTraceJson(string* out) const;
+
+ private:
+  // A single recorded event, in the binary form stored in the buffers.
+  struct Event {
+    // The time of the event, relative to the creation of the tracer.
+    int64 timestamp_ns;
+    // The duration of the event, or -1 for events without duration.
+    int32_t duration_ns;
+    int32_t type;
+    int32_t x;
+    int32_t y;
+    int32_t x2;
+    int32_t y2;
+  };
+
+  // The ring buffer of a single thread.
+  struct ThreadBuffer {
+    ThreadBuffer(int thread_index, int size)
+        : index(thread_index), events(size), num_recorded_events(0) {}
+
+    const int index;
+    vector<Event> events;
+    // The total number of events recorded by the thread; the next event is
+    // stored at num_recorded_events % events.size().
+    int64 num_recorded_events;
+  };
+
+  // Records an event to the started tracer, if there is one.
+  static void RecordEvent(EventType type,
+                          int64 time_ns,
+                          int64 duration_ns,
+                          int x, int y,
+                          int x2, int y2);
+  // Returns the buffer of the calling thread; creates it on the first call
+  // from the thread.
+  ThreadBuffer* BufferForCurrentThread();
+
+  // The started tracer, or NULL if no tracer is started.
+  static std::atomic<Tracer*> active_tracer_;
+  // The identifiers of the tracers. The threads cache their buffer together
+  // with the identifier of the tracer that owns it.
+  static std::atomic<int64> next_tracer_id_;
+
+  const int64 id_;
+  const int events_per_thread_;
+  // The time when the tracer was created.
+  const int64 start_time_ns_;
+  // Protects buffers_.
+  mutable std::mutex mutex_;
+  vector<ThreadBuffer*> buffers_;
+
+  Tracer(const Tracer&);
+  void operator=(const Tracer&);
+};
+
+// Records an event with the duration of the scope of the object. When no
+// tracer is started at the beginning of the scope, the event is not recorded.
+// A disabled scope costs two well-predicted branches: a test of the started
+// tracer when the scope begins, and a test of the recorded start time when it
+// ends.
+//
+// Typical usage:
+// void UpdateField(int x, int y) {
+//   TraceScope trace(Tracer::CONFIGURATION_UPDATE, x, y, -1, -1);
+//   ...
+// }
+class TraceScope {
+ public:
+  TraceScope(Tracer::EventType type, int x, int y, int x2, int y2)
+      : type_(type), x_(x), y_(y), x2_(x2), y2_(y2),
+        start_ns_(Tracer::IsEnabled() ? Tracer::NowNs() : -1) {}
+  ~TraceScope() {
+    if (start_ns_ >= 0) {
+      Tracer::RecordComplete(type_, start_ns_, x_, y_, x2_, y2_);
+    }
+  }
+
+ private:
+  const Tracer::EventType type_;
+  const int x_;
+  const int y_;
+  const int x2_;
+  const int y2_;
+  const int64 start_ns_;
+
+  TraceScope(const TraceScope&);
+  void operator=(const TraceScope&);
+};
+
+}  // namespace mineseeker
+
+#endif  // MINESEEKER_TRACER_H_
@@ -0,0 +1,114 @@
+// Copyright 2012 Ondrej Sykora
+//
+// This file is part of MineSeeker.
+//
+// MineSeeker is free software: you can redistribute it and/or modify it under
+// the terms of the GNU General Public License as published by the Free
+// Software Foundation, either version 3 of the License, or (at your option)
+// any later version.
+//
+// MineSeeker is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+// more details.
+//
+// You should have received a copy of the GNU General Public License along with
+// MineSeeker. If not, see <http://www.gnu.org/licenses/>.
+
+#include <thread>
+
+#include "common.h"
+#include "glog/logging.h"
+#include "gtest/gtest.h"
+#include "tracer.h"
+
+namespace mineseeker {
+
+TEST(TracerTest, TestDisabled) {
+  Tracer tracer(16);
+  EXPECT_FALSE(Tracer::IsEnabled());
+  Tracer::RecordInstant(Tracer::HINT, 1, 2);
+  {
+    TraceScope trace(Tracer::UNCOVER, 1, 2, -1, -1);
+  }
+  EXPECT_EQ(0, tracer.num_events());
+}
+
+TEST(TracerTest, TestRecordEvents) {
+  Tracer tracer(16);
+  tracer.Start();
+  EXPECT_TRUE(Tracer::IsEnabled());
+  Tracer::RecordInstant(Tracer::MARK_MINE, 3, 4);
+  {
+    TraceScope trace(Tracer::PAIR_UPDATE, 5, 6, 7, 8);
+  }
+  tracer.Stop();
+  EXPECT_FALSE(Tracer::IsEnabled());
+  // Events after stopping the tracer are not recorded.
+  Tracer::RecordInstant(Tracer::HINT, 1, 2);
+  EXPECT_EQ(2, tracer.num_events());
+  EXPECT_EQ(0, tracer.num_dropped_events());
+
+  string json;
+  tracer.ToChromeTraceJson(&json);
+  EXPECT_EQ(0, json.find("{\"traceEvents\": ["));
+  EXPECT_NE(string::npos, json.find(
+      "{\"name\": \"mark_mine\", \"cat\": \"solver\", \"pid\": 1, "
+      "\"tid\": 0"));
+  EXPECT_NE(string::npos, json.find("\"ph\": \"i\""));
+  EXPECT_NE(string::npos, json.find("\"name\": \"pair_update\""));
+  EXPECT_NE(string::npos, json.find("\"ph\": \"X\", \"dur\": "));
+  EXPECT_NE(string::npos,
+            json.find("\"args\": {\"x\": 5, \"y\": 6, \"x2\": 7, \"y2\": 8}"));
+  EXPECT_EQ(string::npos, json.find("\"hint\""));
+}
+
+TEST(TracerTest, TestRingBuffer) {
+  Tracer tracer(4);
+  tracer.Start();
+  for (int i = 0; i < 10; ++i) {
+    Tracer::RecordInstant(Tracer::UNCOVER, i, 0);
+  }
+  tracer.Stop();
+  EXPECT_EQ(4, tracer.num_events());
+  EXPECT_EQ(6, tracer.num_dropped_events());
+
+  // Only the last four events are kept, in the order in which they were
+  // recorded.
+  string json;
+  tracer.ToChromeTraceJson(&json);
+  EXPECT_EQ(string::npos, json.find("\"x\": 5,"));
+  const size_t sixth = json.find("\"x\": 6,");
+  const size_t last = json.find("\"x\": 9,");
+  EXPECT_NE(string::npos, sixth);
+  EXPECT_NE(string::npos, last);
+  EXPECT_LT(sixth, last);
+}
+
+TEST(TracerTest, TestThreads) {
+  Tracer tracer(16);
+  tracer.Start();
+  Tracer::RecordInstant(Tracer::UNCOVER, 0, 0);
+  std::thread thread([]() {
+    Tracer::RecordInstant(Tracer::UNCOVER, 1, 1);
+    Tracer::RecordInstant(Tracer::UNCOVER, 2, 2);
+  });
+  thread.join();
+  tracer.Stop();
+  EXPECT_EQ(3, tracer.num_events());
+
+  string json;
+  tracer.ToChromeTraceJson(&json);
+  EXPECT_NE(string::npos, json.find("\"tid\": 0"));
+  EXPECT_NE(string::npos, json.find("\"tid\": 1"));
+
+  // A new tracer gets new buffers for the same threads.
+  Tracer second_tracer(16);
+  second_tracer.Start();
+  Tracer::RecordInstant(Tracer::UNCOVER, 0, 0);
+  second_tracer.Stop();
+  EXPECT_EQ(1, second_tracer.num_events());
+  EXPECT_EQ(3, tracer.num_events());
+}
+
+}  // namespace mineseeker